@@ -345,6 +345,12 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         description="Sample all lights (for indirect samples), rather than randomly picking one",
         default=True,
     )
+    use_light_tree: BoolProperty(
+        name="Light Tree",
+        description="Sample lights with a tree built over their positions, orientations and strengths, "
+        "reducing noise in scenes with many lights (only used when sampling one light at a time)",
+        default=False,
+    )
     light_sampling_threshold: FloatProperty(
         name="Light Sampling Threshold",
         description="Probabilistically terminate light samples when the light contribution is below this threshold (more noise but faster rendering). "
@@ -728,6 +734,20 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         items=enum_texture_limit
     )
 
+    use_texture_cache: BoolProperty(
+        name="Texture Cache",
+        description="Load the tiles of image texture files on demand instead of whole images, "
+        "to keep the memory usage of large textures bounded (CPU only)",
+        default=False,
+    )
+
+    texture_cache_size: IntProperty(
+        name="Cache Size",
+        description="Maximum memory used by the texture cache, in megabytes",
+        default=1024,
+        min=64, max=65536,
+    )
+
     ao_bounces: IntProperty(
         name="AO Bounces",
         default=0,
@@ -295,6 +295,7 @@ void BlenderSync::sync_integrator()
   integrator->sample_all_lights_direct = get_boolean(cscene, "sample_all_lights_direct");
   integrator->sample_all_lights_indirect = get_boolean(cscene, "sample_all_lights_indirect");
   integrator->light_sampling_threshold = get_float(cscene, "light_sampling_threshold");
+  integrator->use_light_tree = get_boolean(cscene, "use_light_tree");
 
   int diffuse_samples = get_int(cscene, "diffuse_samples");
   int glossy_samples = get_int(cscene, "glossy_samples");
@@ -337,6 +338,15 @@ void BlenderSync::sync_integrator()
 
   if (integrator->modified(previntegrator))
     integrator->tag_update(scene);
+
+  /* The light distribution depends on whether the light tree is used. */
+  if (integrator->use_light_tree != previntegrator.use_light_tree ||
+      (integrator->use_light_tree &&
+       (integrator->method != previntegrator.method ||
+        integrator->sample_all_lights_direct != previntegrator.sample_all_lights_direct ||
+        integrator->sample_all_lights_indirect != previntegrator.sample_all_lights_indirect))) {
+    scene->light_manager->tag_update(scene);
+  }
 }
 
 /* Film */
@@ -726,6 +736,9 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
     params.texture_limit = 0;
   }
 
+  params.use_texture_cache = RNA_boolean_get(&cscene, "use_texture_cache");
+  params.texture_cache_size = RNA_int_get(&cscene, "texture_cache_size");
+
   /* TODO(sergey): Once OSL supports per-microarchitecture optimization get
    * rid of this.
    */
@@ -37,6 +37,7 @@
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
 #include "util/util_progress.h"
+#include "util/util_task.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -103,7 +104,13 @@ int BVHStackEntry::encodeIdx() const
 BVH::BVH(const BVHParams &params_,
          const vector<Geometry *> &geometry_,
          const vector<Object *> &objects_)
-    : params(params_), geometry(geometry_), objects(objects_)
+    : params(params_),
+      geometry(geometry_),
+      objects(objects_),
+      refit_cost(0.0f),
+      top_level_nodes_size(0),
+      top_level_leaf_nodes_size(0),
+      top_level_prim_size(0)
 {
 }
 
@@ -196,16 +203,47 @@ void BVH::build(Progress &progress, Stats *)
 
 void BVH::refit(Progress &progress)
 {
-  progress.set_substatus("Packing BVH primitives");
-  pack_primitives();
-
-  if (progress.get_cancel())
-    return;
+  /* The top level primitives are the instances and the geometry with applied transform,
+   * which is only refitted when the geometry was not modified, so there is nothing to pack. */
+  if (!params.top_level) {
+    progress.set_substatus("Packing BVH primitives");
+    pack_primitives();
+
+    if (progress.get_cancel())
+      return;
+  }
 
   progress.set_substatus("Refitting BVH nodes");
+  refit_cost = 0.0f;
   refit_nodes();
 }
 
+template<typename T>
+static void copy_array_head(array<T> &to, const array<T> &from, size_t size)
+{
+  to.resize(size);
+  if (size) {
+    memcpy(to.data(), from.data(), sizeof(T) * size);
+  }
+}
+
+BVH *BVH::copy_top_level() const
+{
+  assert(params.top_level);
+
+  BVH *bvh = BVH::create(params, geometry, objects);
+  copy_array_head(bvh->pack.nodes, pack.nodes, top_level_nodes_size);
+  copy_array_head(bvh->pack.leaf_nodes, pack.leaf_nodes, top_level_leaf_nodes_size);
+  copy_array_head(bvh->pack.prim_type, pack.prim_type, top_level_prim_size);
+  copy_array_head(bvh->pack.prim_index, pack.prim_index, top_level_prim_size);
+  copy_array_head(bvh->pack.prim_object, pack.prim_object, top_level_prim_size);
+  bvh->pack.root_index = pack.root_index;
+  bvh->top_level_nodes_size = top_level_nodes_size;
+  bvh->top_level_leaf_nodes_size = top_level_leaf_nodes_size;
+  bvh->top_level_prim_size = top_level_prim_size;
+  return bvh;
+}
+
 void BVH::refit_primitives(int start, int end, BoundBox &bbox, uint &visibility)
 {
   /* Refit range of primitives. */
@@ -346,8 +384,6 @@ void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
    * BVH's are stored in global arrays. This function merges them into the
    * top level BVH, adjusting indexes and offsets where appropriate.
    */
-  const bool use_qbvh = (params.bvh_layout == BVH_LAYOUT_BVH4);
-  const bool use_obvh = (params.bvh_layout == BVH_LAYOUT_BVH8);
 
   /* Adjust primitive index to point to the triangle in the global array, for
    * geometry with transform applied and already in the top level BVH.
@@ -358,10 +394,9 @@ void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
     }
   }
 
-  /* track offsets of instanced BVH data in global array */
-  size_t prim_offset = pack.prim_index.size();
-  size_t nodes_offset = nodes_size;
-  size_t nodes_leaf_offset = leaf_nodes_size;
+  top_level_nodes_size = nodes_size;
+  top_level_leaf_nodes_size = leaf_nodes_size;
+  top_level_prim_size = pack.prim_index.size();
 
   /* clear array that gives the node indexes for instanced objects */
   pack.object_node.clear();
@@ -401,19 +436,11 @@ void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
     pack.prim_time.resize(prim_index_size);
   }
 
-  int *pack_prim_index = (pack.prim_index.size()) ? &pack.prim_index[0] : NULL;
-  int *pack_prim_type = (pack.prim_type.size()) ? &pack.prim_type[0] : NULL;
-  int *pack_prim_object = (pack.prim_object.size()) ? &pack.prim_object[0] : NULL;
-  uint *pack_prim_visibility = (pack.prim_visibility.size()) ? &pack.prim_visibility[0] : NULL;
-  float4 *pack_prim_tri_verts = (pack.prim_tri_verts.size()) ? &pack.prim_tri_verts[0] : NULL;
-  uint *pack_prim_tri_index = (pack.prim_tri_index.size()) ? &pack.prim_tri_index[0] : NULL;
-  int4 *pack_nodes = (pack.nodes.size()) ? &pack.nodes[0] : NULL;
-  int4 *pack_leaf_nodes = (pack.leaf_nodes.size()) ? &pack.leaf_nodes[0] : NULL;
-  float2 *pack_prim_time = (pack.prim_time.size()) ? &pack.prim_time[0] : NULL;
-
+  /* Assign the offsets of the instance BVH's in the global arrays, the data of every
+   * geometry is then merged in parallel since the destination ranges don't overlap. */
   map<Geometry *, int> geometry_map;
+  TaskPool pool;
 
-  /* merge */
   foreach (Object *ob, objects) {
     Geometry *geom = ob->geometry;
 
@@ -429,151 +456,174 @@ void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
      * node offset for this object */
     map<Geometry *, int>::iterator it = geometry_map.find(geom);
 
-    if (geometry_map.find(geom) != geometry_map.end()) {
-      int noffset = it->second;
-      pack.object_node[object_offset++] = noffset;
+    if (it != geometry_map.end()) {
+      pack.object_node[object_offset++] = it->second;
       continue;
     }
 
-    BVH *bvh = geom->bvh;
-
-    int noffset = nodes_offset;
-    int noffset_leaf = nodes_leaf_offset;
-    int geom_prim_offset = geom->prim_offset;
+    const BVH *bvh = geom->bvh;
 
     /* fill in node indexes for instances */
     if (bvh->pack.root_index == -1)
-      pack.object_node[object_offset++] = -noffset_leaf - 1;
+      pack.object_node[object_offset++] = -(int)pack_leaf_nodes_offset - 1;
     else
-      pack.object_node[object_offset++] = noffset;
+      pack.object_node[object_offset++] = pack_nodes_offset;
 
     geometry_map[geom] = pack.object_node[object_offset - 1];
 
-    /* merge primitive, object and triangle indexes */
-    if (bvh->pack.prim_index.size()) {
-      size_t bvh_prim_index_size = bvh->pack.prim_index.size();
-      int *bvh_prim_index = &bvh->pack.prim_index[0];
-      int *bvh_prim_type = &bvh->pack.prim_type[0];
-      uint *bvh_prim_visibility = &bvh->pack.prim_visibility[0];
-      uint *bvh_prim_tri_index = &bvh->pack.prim_tri_index[0];
-      float2 *bvh_prim_time = bvh->pack.prim_time.size() ? &bvh->pack.prim_time[0] : NULL;
-
-      for (size_t i = 0; i < bvh_prim_index_size; i++) {
-        if (bvh->pack.prim_type[i] & PRIMITIVE_ALL_CURVE) {
-          pack_prim_index[pack_prim_index_offset] = bvh_prim_index[i] + geom_prim_offset;
-          pack_prim_tri_index[pack_prim_index_offset] = -1;
-        }
-        else {
-          pack_prim_index[pack_prim_index_offset] = bvh_prim_index[i] + geom_prim_offset;
-          pack_prim_tri_index[pack_prim_index_offset] = bvh_prim_tri_index[i] +
-                                                        pack_prim_tri_verts_offset;
-        }
+    pool.push(function_bind(&BVH::pack_instance,
+                            this,
+                            geom,
+                            pack_prim_index_offset,
+                            pack_prim_tri_verts_offset,
+                            pack_nodes_offset,
+                            pack_leaf_nodes_offset));
+
+    pack_prim_index_offset += bvh->pack.prim_index.size();
+    pack_prim_tri_verts_offset += bvh->pack.prim_tri_verts.size();
+    pack_nodes_offset += bvh->pack.nodes.size();
+    pack_leaf_nodes_offset += bvh->pack.leaf_nodes.size();
+  }
 
-        pack_prim_type[pack_prim_index_offset] = bvh_prim_type[i];
-        pack_prim_visibility[pack_prim_index_offset] = bvh_prim_visibility[i];
-        pack_prim_object[pack_prim_index_offset] = 0;  // unused for instances
-        if (bvh_prim_time != NULL) {
-          pack_prim_time[pack_prim_index_offset] = bvh_prim_time[i];
-        }
-        pack_prim_index_offset++;
+  pool.wait_work();
+}
+
+void BVH::pack_instance(const Geometry *geom,
+                        size_t prim_offset,
+                        size_t prim_tri_verts_offset,
+                        size_t nodes_offset,
+                        size_t leaf_nodes_offset)
+{
+  const bool use_qbvh = (params.bvh_layout == BVH_LAYOUT_BVH4);
+  const bool use_obvh = (params.bvh_layout == BVH_LAYOUT_BVH8);
+
+  const BVH *bvh = geom->bvh;
+  const int noffset = nodes_offset;
+  const int noffset_leaf = leaf_nodes_offset;
+  const int geom_prim_offset = geom->prim_offset;
+
+  /* merge primitive, object and triangle indexes */
+  if (bvh->pack.prim_index.size()) {
+    size_t bvh_prim_index_size = bvh->pack.prim_index.size();
+    const int *bvh_prim_index = &bvh->pack.prim_index[0];
+    const int *bvh_prim_type = &bvh->pack.prim_type[0];
+    const uint *bvh_prim_visibility = &bvh->pack.prim_visibility[0];
+    const uint *bvh_prim_tri_index = &bvh->pack.prim_tri_index[0];
+    const float2 *bvh_prim_time = bvh->pack.prim_time.size() ? &bvh->pack.prim_time[0] : NULL;
+    float2 *pack_prim_time = (pack.prim_time.size()) ? &pack.prim_time[0] : NULL;
+    size_t pack_prim_index_offset = prim_offset;
+
+    for (size_t i = 0; i < bvh_prim_index_size; i++) {
+      if (bvh_prim_type[i] & PRIMITIVE_ALL_CURVE) {
+        pack.prim_index[pack_prim_index_offset] = bvh_prim_index[i] + geom_prim_offset;
+        pack.prim_tri_index[pack_prim_index_offset] = -1;
+      }
+      else {
+        pack.prim_index[pack_prim_index_offset] = bvh_prim_index[i] + geom_prim_offset;
+        pack.prim_tri_index[pack_prim_index_offset] = bvh_prim_tri_index[i] +
+                                                      prim_tri_verts_offset;
       }
-    }
 
-    /* Merge triangle vertices data. */
-    if (bvh->pack.prim_tri_verts.size()) {
-      const size_t prim_tri_size = bvh->pack.prim_tri_verts.size();
-      memcpy(pack_prim_tri_verts + pack_prim_tri_verts_offset,
-             &bvh->pack.prim_tri_verts[0],
-             prim_tri_size * sizeof(float4));
-      pack_prim_tri_verts_offset += prim_tri_size;
+      pack.prim_type[pack_prim_index_offset] = bvh_prim_type[i];
+      pack.prim_visibility[pack_prim_index_offset] = bvh_prim_visibility[i];
+      pack.prim_object[pack_prim_index_offset] = 0;  // unused for instances
+      if (bvh_prim_time != NULL) {
+        pack_prim_time[pack_prim_index_offset] = bvh_prim_time[i];
+      }
+      pack_prim_index_offset++;
     }
+  }
 
-    /* merge nodes */
-    if (bvh->pack.leaf_nodes.size()) {
-      int4 *leaf_nodes_offset = &bvh->pack.leaf_nodes[0];
-      size_t leaf_nodes_offset_size = bvh->pack.leaf_nodes.size();
-      for (size_t i = 0, j = 0; i < leaf_nodes_offset_size; i += BVH_NODE_LEAF_SIZE, j++) {
-        int4 data = leaf_nodes_offset[i];
-        data.x += prim_offset;
-        data.y += prim_offset;
-        pack_leaf_nodes[pack_leaf_nodes_offset] = data;
-        for (int j = 1; j < BVH_NODE_LEAF_SIZE; ++j) {
-          pack_leaf_nodes[pack_leaf_nodes_offset + j] = leaf_nodes_offset[i + j];
-        }
-        pack_leaf_nodes_offset += BVH_NODE_LEAF_SIZE;
+  /* Merge triangle vertices data. */
+  if (bvh->pack.prim_tri_verts.size()) {
+    memcpy(&pack.prim_tri_verts[prim_tri_verts_offset],
+           &bvh->pack.prim_tri_verts[0],
+           bvh->pack.prim_tri_verts.size() * sizeof(float4));
+  }
+
+  /* merge nodes */
+  if (bvh->pack.leaf_nodes.size()) {
+    const int4 *bvh_leaf_nodes = &bvh->pack.leaf_nodes[0];
+    size_t bvh_leaf_nodes_size = bvh->pack.leaf_nodes.size();
+    int4 *pack_leaf_nodes = &pack.leaf_nodes[leaf_nodes_offset];
+    for (size_t i = 0; i < bvh_leaf_nodes_size; i += BVH_NODE_LEAF_SIZE) {
+      int4 data = bvh_leaf_nodes[i];
+      data.x += prim_offset;
+      data.y += prim_offset;
+      pack_leaf_nodes[i] = data;
+      for (int j = 1; j < BVH_NODE_LEAF_SIZE; ++j) {
+        pack_leaf_nodes[i + j] = bvh_leaf_nodes[i + j];
       }
     }
+  }
 
-    if (bvh->pack.nodes.size()) {
-      int4 *bvh_nodes = &bvh->pack.nodes[0];
-      size_t bvh_nodes_size = bvh->pack.nodes.size();
+  if (bvh->pack.nodes.size()) {
+    const int4 *bvh_nodes = &bvh->pack.nodes[0];
+    size_t bvh_nodes_size = bvh->pack.nodes.size();
+    int4 *pack_nodes = &pack.nodes[0];
+    size_t pack_nodes_offset = nodes_offset;
 
-      for (size_t i = 0, j = 0; i < bvh_nodes_size; j++) {
-        size_t nsize, nsize_bbox;
-        if (bvh_nodes[i].x & PATH_RAY_NODE_UNALIGNED) {
-          if (use_obvh) {
-            nsize = BVH_UNALIGNED_ONODE_SIZE;
-            nsize_bbox = BVH_UNALIGNED_ONODE_SIZE - 1;
-          }
-          else {
-            nsize = use_qbvh ? BVH_UNALIGNED_QNODE_SIZE : BVH_UNALIGNED_NODE_SIZE;
-            nsize_bbox = (use_qbvh) ? BVH_UNALIGNED_QNODE_SIZE - 1 : 0;
-          }
+    for (size_t i = 0; i < bvh_nodes_size;) {
+      size_t nsize, nsize_bbox;
+      if (bvh_nodes[i].x & PATH_RAY_NODE_UNALIGNED) {
+        if (use_obvh) {
+          nsize = BVH_UNALIGNED_ONODE_SIZE;
+          nsize_bbox = BVH_UNALIGNED_ONODE_SIZE - 1;
         }
         else {
-          if (use_obvh) {
-            nsize = BVH_ONODE_SIZE;
-            nsize_bbox = BVH_ONODE_SIZE - 1;
-          }
-          else {
-            nsize = (use_qbvh) ? BVH_QNODE_SIZE : BVH_NODE_SIZE;
-            nsize_bbox = (use_qbvh) ? BVH_QNODE_SIZE - 1 : 0;
-          }
+          nsize = use_qbvh ? BVH_UNALIGNED_QNODE_SIZE : BVH_UNALIGNED_NODE_SIZE;
+          nsize_bbox = (use_qbvh) ? BVH_UNALIGNED_QNODE_SIZE - 1 : 0;
         }
-
-        memcpy(pack_nodes + pack_nodes_offset, bvh_nodes + i, nsize_bbox * sizeof(int4));
-
-        /* Modify offsets into arrays */
-        int4 data = bvh_nodes[i + nsize_bbox];
-        int4 data1 = bvh_nodes[i + nsize_bbox - 1];
+      }
+      else {
         if (use_obvh) {
-          data.z += (data.z < 0) ? -noffset_leaf : noffset;
-          data.w += (data.w < 0) ? -noffset_leaf : noffset;
-          data.x += (data.x < 0) ? -noffset_leaf : noffset;
-          data.y += (data.y < 0) ? -noffset_leaf : noffset;
-          data1.z += (data1.z < 0) ? -noffset_leaf : noffset;
-          data1.w += (data1.w < 0) ? -noffset_leaf : noffset;
-          data1.x += (data1.x < 0) ? -noffset_leaf : noffset;
-          data1.y += (data1.y < 0) ? -noffset_leaf : noffset;
+          nsize = BVH_ONODE_SIZE;
+          nsize_bbox = BVH_ONODE_SIZE - 1;
         }
         else {
-          data.z += (data.z < 0) ? -noffset_leaf : noffset;
-          data.w += (data.w < 0) ? -noffset_leaf : noffset;
-          if (use_qbvh) {
-            data.x += (data.x < 0) ? -noffset_leaf : noffset;
-            data.y += (data.y < 0) ? -noffset_leaf : noffset;
-          }
+          nsize = (use_qbvh) ? BVH_QNODE_SIZE : BVH_NODE_SIZE;
+          nsize_bbox = (use_qbvh) ? BVH_QNODE_SIZE - 1 : 0;
         }
-        pack_nodes[pack_nodes_offset + nsize_bbox] = data;
-        if (use_obvh) {
-          pack_nodes[pack_nodes_offset + nsize_bbox - 1] = data1;
+      }
+
+      memcpy(pack_nodes + pack_nodes_offset, bvh_nodes + i, nsize_bbox * sizeof(int4));
+
+      /* Modify offsets into arrays */
+      int4 data = bvh_nodes[i + nsize_bbox];
+      int4 data1 = bvh_nodes[i + nsize_bbox - 1];
+      if (use_obvh) {
+        data.z += (data.z < 0) ? -noffset_leaf : noffset;
+        data.w += (data.w < 0) ? -noffset_leaf : noffset;
+        data.x += (data.x < 0) ? -noffset_leaf : noffset;
+        data.y += (data.y < 0) ? -noffset_leaf : noffset;
+        data1.z += (data1.z < 0) ? -noffset_leaf : noffset;
+        data1.w += (data1.w < 0) ? -noffset_leaf : noffset;
+        data1.x += (data1.x < 0) ? -noffset_leaf : noffset;
+        data1.y += (data1.y < 0) ? -noffset_leaf : noffset;
+      }
+      else {
+        data.z += (data.z < 0) ? -noffset_leaf : noffset;
+        data.w += (data.w < 0) ? -noffset_leaf : noffset;
+        if (use_qbvh) {
+          data.x += (data.x < 0) ? -noffset_leaf : noffset;
+          data.y += (data.y < 0) ? -noffset_leaf : noffset;
         }
+      }
+      pack_nodes[pack_nodes_offset + nsize_bbox] = data;
+      if (use_obvh) {
+        pack_nodes[pack_nodes_offset + nsize_bbox - 1] = data1;
+      }
 
-        /* Usually this copies nothing, but we better
-         * be prepared for possible node size extension.
-         */
-        memcpy(&pack_nodes[pack_nodes_offset + nsize_bbox + 1],
-               &bvh_nodes[i + nsize_bbox + 1],
-               sizeof(int4) * (nsize - (nsize_bbox + 1)));
+      /* Usually this copies nothing, but we better
+       * be prepared for possible node size extension.
+       */
+      memcpy(&pack_nodes[pack_nodes_offset + nsize_bbox + 1],
+             &bvh_nodes[i + nsize_bbox + 1],
+             sizeof(int4) * (nsize - (nsize_bbox + 1)));
 
-        pack_nodes_offset += nsize;
-        i += nsize;
-      }
+      pack_nodes_offset += nsize;
+      i += nsize;
     }
-
-    nodes_offset += bvh->pack.nodes.size();
-    nodes_leaf_offset += bvh->pack.leaf_nodes.size();
-    prim_offset += bvh->pack.prim_index.size();
   }
 }
 
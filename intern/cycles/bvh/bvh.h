@@ -101,11 +101,24 @@ class BVH {
 
   void refit(Progress &progress);
 
+  /* Surface area of the inner nodes relative to the root after the last refit, it grows as the
+   * refitted nodes start to overlap. */
+  float refit_cost;
+
+  /* Copy of the top level nodes and primitives, without the merged instance BVH's. It is
+   * refitted instead of building the scene BVH again when only objects were modified. */
+  BVH *copy_top_level() const;
+
  protected:
   BVH(const BVHParams &params,
       const vector<Geometry *> &geometry,
       const vector<Object *> &objects);
 
+  /* Size of the top level part of the packed arrays, the instance BVH's follow it. */
+  size_t top_level_nodes_size;
+  size_t top_level_leaf_nodes_size;
+  size_t top_level_prim_size;
+
   /* Refit range of primitives. */
   void refit_primitives(int start, int end, BoundBox &bbox, uint &visibility);
 
@@ -115,6 +128,11 @@ class BVH {
 
   /* merge instance BVH's */
   void pack_instances(size_t nodes_size, size_t leaf_nodes_size);
+  void pack_instance(const Geometry *geom,
+                     size_t prim_offset,
+                     size_t prim_tri_verts_offset,
+                     size_t nodes_offset,
+                     size_t leaf_nodes_offset);
 
   /* for subclasses to implement */
   virtual void pack_nodes(const BVHNode *root) = 0;
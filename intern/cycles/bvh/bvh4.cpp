@@ -375,11 +375,12 @@ void BVH4::pack_nodes(const BVHNode *root)
 
 void BVH4::refit_nodes()
 {
-  assert(!params.top_level);
-
   BoundBox bbox = BoundBox::empty;
   uint visibility = 0;
   refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility);
+
+  const float root_area = bbox.safe_area();
+  refit_cost = (root_area > 0.0f) ? refit_cost / root_area : 0.0f;
 }
 
 void BVH4::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
@@ -441,6 +442,8 @@ void BVH4::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     else {
       pack_aligned_node(idx, child_bbox, &c[0], visibility, 0.0f, 1.0f, num_nodes);
     }
+
+    refit_cost += bbox.safe_area();
   }
 }
 
@@ -911,6 +911,23 @@ void CUDADevice::mem_copy_to(device_memory &mem)
   }
 }
 
+void CUDADevice::mem_copy_to_range(device_memory &mem, size_t offset, size_t size)
+{
+  if (mem.type == MEM_PIXELS || mem.type == MEM_TEXTURE || !mem.device_pointer) {
+    mem_copy_to(mem);
+  }
+  else if (mem.host_pointer) {
+    CUDAContextScope scope(this);
+
+    /* Same as generic_copy_to, mapped host memory is already up to date. */
+    if (cuda_mem_map[&mem].use_mapped_host == false || mem.host_pointer != mem.shared_pointer) {
+      cuda_assert(cuMemcpyHtoD(cuda_device_ptr(mem.device_pointer) + offset,
+                               (char *)mem.host_pointer + offset,
+                               size));
+    }
+  }
+}
+
 void CUDADevice::mem_copy_from(device_memory &mem, int y, int w, int h, int elem)
 {
   if (mem.type == MEM_PIXELS && !background) {
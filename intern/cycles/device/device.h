@@ -78,6 +78,7 @@ class DeviceInfo {
   bool display_device;       /* GPU is used as a display device. */
   bool has_half_images;      /* Support half-float textures. */
   bool has_volume_decoupled; /* Decoupled volume shading. */
+  bool has_light_tree;       /* Light tree sampling of many lights. */
   bool has_osl;              /* Support Open Shading Language. */
   bool use_split_kernel;     /* Use split or mega kernel. */
   bool has_profiling;        /* Supports runtime collection of profiling info. */
@@ -94,6 +95,7 @@ class DeviceInfo {
     display_device = false;
     has_half_images = false;
     has_volume_decoupled = false;
+    has_light_tree = false;
     has_osl = false;
     use_split_kernel = false;
     has_profiling = false;
@@ -360,6 +362,12 @@ class Device {
     return NULL;
   }
 
+  /* image texture cache, only for CPU device */
+  virtual void *oiio_memory()
+  {
+    return NULL;
+  }
+
   /* load/compile kernels, must be called before adding tasks */
   virtual bool load_kernels(const DeviceRequestedFeatures & /*requested_features*/)
   {
@@ -461,6 +469,11 @@ class Device {
 
   virtual void mem_alloc(device_memory &mem) = 0;
   virtual void mem_copy_to(device_memory &mem) = 0;
+  /* Copy a byte range of the host memory to the device, copies all of it by default. */
+  virtual void mem_copy_to_range(device_memory &mem, size_t /*offset*/, size_t /*size*/)
+  {
+    mem_copy_to(mem);
+  }
   virtual void mem_copy_from(device_memory &mem, int y, int w, int h, int elem) = 0;
   virtual void mem_zero(device_memory &mem) = 0;
   virtual void mem_free(device_memory &mem) = 0;
@@ -34,6 +34,7 @@
 #include "kernel/kernel_types.h"
 #include "kernel/split/kernel_split_data.h"
 #include "kernel/kernel_globals.h"
+#include "kernel/kernel_oiio_globals.h"
 
 #include "kernel/filter/filter.h"
 
@@ -174,6 +175,8 @@ class CPUDevice : public Device {
   OSLGlobals osl_globals;
 #endif
 
+  OIIOGlobals oiio_globals;
+
   bool use_split_kernel;
 
   DeviceRequestedFeatures requested_features;
@@ -290,6 +293,7 @@ class CPUDevice : public Device {
 #ifdef WITH_OSL
     kernel_globals.osl = &osl_globals;
 #endif
+    kernel_globals.oiio = &oiio_globals;
     use_split_kernel = DebugFlags().cpu.split_kernel;
     if (use_split_kernel) {
       VLOG(1) << "Will be using split kernel.";
@@ -405,6 +409,15 @@ class CPUDevice : public Device {
     }
   }
 
+  void mem_copy_to_range(device_memory &mem, size_t /*offset*/, size_t /*size*/)
+  {
+    if (mem.type == MEM_TEXTURE || !mem.device_pointer) {
+      mem_copy_to(mem);
+    }
+
+    /* copy is no-op */
+  }
+
   void mem_copy_from(device_memory & /*mem*/, int /*y*/, int /*w*/, int /*h*/, int /*elem*/)
   {
     /* no-op */
@@ -509,6 +522,11 @@ class CPUDevice : public Device {
 #endif
   }
 
+  void *oiio_memory()
+  {
+    return &oiio_globals;
+  }
+
   void thread_run(DeviceTask *task)
   {
     if (task->type == DeviceTask::RENDER || task->type == DeviceTask::DENOISE)
@@ -1255,6 +1273,7 @@ void device_cpu_info(vector<DeviceInfo> &devices)
   info.id = "CPU";
   info.num = 0;
   info.has_volume_decoupled = true;
+  info.has_light_tree = true;
   info.has_osl = true;
   info.has_half_images = true;
   info.has_profiling = true;
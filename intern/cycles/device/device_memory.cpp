@@ -94,6 +94,13 @@ void device_memory::device_copy_to()
   }
 }
 
+void device_memory::device_copy_to_range(size_t offset, size_t size)
+{
+  if (host_pointer) {
+    device->mem_copy_to_range(*this, offset, size);
+  }
+}
+
 void device_memory::device_copy_from(int y, int w, int h, int elem)
 {
   assert(type != MEM_TEXTURE && type != MEM_READ_ONLY);
@@ -245,6 +245,7 @@ class device_memory {
   void device_alloc();
   void device_free();
   void device_copy_to();
+  void device_copy_to_range(size_t offset, size_t size);
   void device_copy_from(int y, int w, int h, int elem);
   void device_zero();
 
@@ -427,6 +428,14 @@ template<typename T> class device_vector : public device_memory {
     device_copy_to();
   }
 
+  /* Copy only the elements from start to start + num, the device memory must be allocated
+   * with the current size. */
+  void copy_to_device(size_t start, size_t num)
+  {
+    assert(start + num <= data_size);
+    device_copy_to_range(start * sizeof(T), num * sizeof(T));
+  }
+
   void copy_from_device()
   {
     device_copy_from(0, data_width, data_height, sizeof(T));
@@ -221,6 +221,28 @@ class MultiDevice : public Device {
     stats.mem_alloc(mem.device_size - existing_size);
   }
 
+  void mem_copy_to_range(device_memory &mem, size_t offset, size_t size)
+  {
+    if (!mem.device_pointer) {
+      mem_copy_to(mem);
+      return;
+    }
+
+    device_ptr key = mem.device_pointer;
+    size_t existing_size = mem.device_size;
+
+    foreach (SubDevice &sub, devices) {
+      mem.device = sub.device;
+      mem.device_pointer = sub.ptr_map[key];
+      mem.device_size = existing_size;
+
+      sub.device->mem_copy_to_range(mem, offset, size);
+    }
+
+    mem.device = this;
+    mem.device_pointer = key;
+  }
+
   void mem_copy_from(device_memory &mem, int y, int w, int h, int elem)
   {
     device_ptr key = mem.device_pointer;
@@ -45,6 +45,8 @@ struct OSLThreadData;
 struct OSLShadingSystem;
 #  endif
 
+struct OIIOGlobals;
+
 typedef unordered_map<float, float> CoverageMap;
 
 struct Intersection;
@@ -64,6 +66,9 @@ typedef struct KernelGlobals {
   OSLThreadData *osl_tdata;
 #  endif
 
+  /* Image texture cache, textures not in the cache are in __texture_info. */
+  OIIOGlobals *oiio;
+
   /* **** Run-time data ****  */
 
   /* Heap-allocated storage for transparent shadows intersections. */
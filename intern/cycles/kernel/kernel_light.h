@@ -527,10 +527,249 @@ ccl_device float background_light_pdf(KernelGlobals *kg, float3 P, float3 direct
 }
 #endif
 
+#ifdef __LIGHT_TREE__
+/* Light Tree
+ *
+ * Local lights are sampled by traversing the tree from the root, choosing a child proportionally
+ * to an estimate of its contribution at the shading point. The estimate bounds the energy,
+ * distance and orientation of the emitters in the child, the receiver normal is not taken into
+ * account. Distant and background lights are sampled uniformly after the tree emitters. */
+
+ccl_device float light_tree_importance(const float3 P,
+                                       const float3 center,
+                                       const float radius,
+                                       const float3 axis,
+                                       const float theta_o,
+                                       const float theta_e,
+                                       const float energy)
+{
+  if (energy == 0.0f) {
+    return 0.0f;
+  }
+
+  float dist;
+  const float3 D = safe_normalize_len(P - center, &dist);
+
+  /* Smallest angle between the emitter normals and the direction to the point, considering the
+   * angle under which the bounds are seen. */
+  const float theta_u = (dist > radius) ? safe_asinf(radius / dist) : M_PI_F;
+  const float theta = safe_acosf(dot(axis, D));
+  const float theta_prime = max(theta - theta_o - theta_u, 0.0f);
+  if (theta_prime >= theta_e) {
+    return 0.0f;
+  }
+
+  const float dist_squared = max(dist * dist, radius * radius);
+  return (dist_squared > 0.0f) ? energy * cosf(theta_prime) / dist_squared : energy;
+}
+
+ccl_device_inline float light_tree_node_importance(KernelGlobals *kg, const float3 P, int index)
+{
+  const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, index);
+  const float3 bbox_min = make_float3(knode->bbox_min[0], knode->bbox_min[1], knode->bbox_min[2]);
+  const float3 bbox_max = make_float3(knode->bbox_max[0], knode->bbox_max[1], knode->bbox_max[2]);
+  const float3 axis = make_float3(knode->axis[0], knode->axis[1], knode->axis[2]);
+
+  return light_tree_importance(P,
+                               0.5f * (bbox_min + bbox_max),
+                               0.5f * len(bbox_max - bbox_min),
+                               axis,
+                               knode->theta_o,
+                               knode->theta_e,
+                               knode->energy);
+}
+
+ccl_device_inline float light_tree_emitter_importance(KernelGlobals *kg,
+                                                      const float3 P,
+                                                      int index)
+{
+  const ccl_global KernelLightTreeEmitter *kemitter = &kernel_tex_fetch(__light_tree_emitters,
+                                                                        index);
+  const float3 centroid = make_float3(
+      kemitter->centroid[0], kemitter->centroid[1], kemitter->centroid[2]);
+  const float3 axis = make_float3(kemitter->axis[0], kemitter->axis[1], kemitter->axis[2]);
+
+  return light_tree_importance(
+      P, centroid, kemitter->radius, axis, kemitter->theta_o, kemitter->theta_e, kemitter->energy);
+}
+
+/* Sample an emitter of the tree, returning its index in the light distribution or -1 if no
+ * emitter contributes to the point. The random number is rescaled to be reused. */
+ccl_device int light_tree_sample(KernelGlobals *kg, const float3 P, float *randu, float *pdf)
+{
+  float r = *randu;
+  float selection_pdf = 1.0f;
+  int index = 0;
+  const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, 0);
+
+  while (knode->num_emitters == 0) {
+    const int left = index + 1;
+    const int right = knode->second_child;
+    const float importance_left = light_tree_node_importance(kg, P, left);
+    const float importance_right = light_tree_node_importance(kg, P, right);
+    const float total_importance = importance_left + importance_right;
+    if (total_importance == 0.0f) {
+      return -1;
+    }
+
+    const float prob_left = importance_left / total_importance;
+    if (r < prob_left) {
+      index = left;
+      r = r / prob_left;
+      selection_pdf *= prob_left;
+    }
+    else {
+      index = right;
+      r = (r - prob_left) / (1.0f - prob_left);
+      selection_pdf *= 1.0f - prob_left;
+    }
+    knode = &kernel_tex_fetch(__light_tree_nodes, index);
+  }
+
+  /* Pick an emitter of the leaf proportionally to its importance. */
+  const int first_emitter = knode->first_emitter;
+  const int num_emitters = knode->num_emitters;
+  float importance[LIGHT_TREE_MAX_LEAF_SIZE];
+  float total_importance = 0.0f;
+  for (int i = 0; i < num_emitters; i++) {
+    importance[i] = light_tree_emitter_importance(kg, P, first_emitter + i);
+    total_importance += importance[i];
+  }
+  if (total_importance == 0.0f) {
+    return -1;
+  }
+
+  r *= total_importance;
+  int i = 0;
+  for (; i < num_emitters - 1; i++) {
+    if (r < importance[i]) {
+      break;
+    }
+    r -= importance[i];
+  }
+  if (importance[i] == 0.0f) {
+    return -1;
+  }
+
+  *randu = saturate(r / importance[i]);
+  *pdf = selection_pdf * importance[i] / total_importance;
+  return first_emitter + i;
+}
+
+/* Probability of sampling an emitter of the tree at a point, among all lights. */
+ccl_device float light_tree_pdf(KernelGlobals *kg, const float3 P, int emitter)
+{
+  const int leaf = kernel_tex_fetch(__light_tree_emitters, emitter).leaf;
+  const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, leaf);
+
+  float total_importance = 0.0f, emitter_importance = 0.0f;
+  for (int i = 0; i < knode->num_emitters; i++) {
+    const float importance = light_tree_emitter_importance(kg, P, knode->first_emitter + i);
+    if (knode->first_emitter + i == emitter) {
+      emitter_importance = importance;
+    }
+    total_importance += importance;
+  }
+  if (emitter_importance == 0.0f) {
+    return 0.0f;
+  }
+
+  /* Probabilities of choosing the nodes from the leaf up to the root. */
+  float pdf = emitter_importance / total_importance;
+  int index = leaf;
+  int parent = knode->parent;
+  while (parent != -1) {
+    const ccl_global KernelLightTreeNode *kparent = &kernel_tex_fetch(__light_tree_nodes, parent);
+    const float importance_left = light_tree_node_importance(kg, P, parent + 1);
+    const float importance_right = light_tree_node_importance(kg, P, kparent->second_child);
+    const float importance = (index == parent + 1) ? importance_left : importance_right;
+    if (importance == 0.0f) {
+      return 0.0f;
+    }
+    pdf *= importance / (importance_left + importance_right);
+
+    index = parent;
+    parent = kparent->parent;
+  }
+
+  return pdf * kernel_data.integrator.pdf_light_tree;
+}
+
+/* Sample a light with the tree or uniformly among the distant and background lights, returning
+ * its index in the light distribution. */
+ccl_device int light_tree_distribution_sample(KernelGlobals *kg,
+                                              const float3 P,
+                                              float *randu,
+                                              float *pdf)
+{
+  const float pdf_light_tree = kernel_data.integrator.pdf_light_tree;
+  if (*randu < pdf_light_tree) {
+    *randu = *randu / pdf_light_tree;
+    const int index = light_tree_sample(kg, P, randu, pdf);
+    *pdf *= pdf_light_tree;
+    return index;
+  }
+
+  const int num_emitters = kernel_data.integrator.num_light_tree_emitters;
+  const int num_infinite = kernel_data.integrator.num_distribution - num_emitters;
+  const float r = (*randu - pdf_light_tree) / (1.0f - pdf_light_tree) * num_infinite;
+  const int index = min((int)r, num_infinite - 1);
+  *randu = saturate(r - index);
+  *pdf = kernel_data.integrator.pdf_lights;
+  return num_emitters + index;
+}
+#endif
+
+/* Probability of selecting a lamp among all lights, the pdf of the sampling of the lamp itself
+ * is not included. */
+ccl_device_inline float lamp_light_selection_pdf(KernelGlobals *kg, int lamp, const float3 P)
+{
+#ifdef __LIGHT_TREE__
+  if (kernel_data.integrator.use_light_tree) {
+    const int emitter = kernel_tex_fetch(__light_tree_lookup, lamp);
+    if (emitter != -1) {
+      return light_tree_pdf(kg, P, emitter);
+    }
+  }
+#endif
+  return kernel_data.integrator.pdf_lights;
+}
+
+/* Probability per unit area of selecting a triangle among all lights. */
+ccl_device_inline float triangle_light_selection_pdf(KernelGlobals *kg,
+                                                     int object,
+                                                     int prim,
+                                                     const float3 P)
+{
+#ifdef __LIGHT_TREE__
+  if (kernel_data.integrator.use_light_tree) {
+    /* Each object references its table of triangle emitters and its first primitive. */
+    const int num_lights = kernel_data.integrator.num_all_lights;
+    const int table = kernel_tex_fetch(__light_tree_lookup, num_lights + object * 2);
+    if (table == -1) {
+      return 0.0f;
+    }
+    const int prim_offset = kernel_tex_fetch(__light_tree_lookup, num_lights + object * 2 + 1);
+    const int emitter = kernel_tex_fetch(__light_tree_lookup, table + prim - prim_offset);
+    if (emitter == -1) {
+      return 0.0f;
+    }
+    const float area = kernel_tex_fetch(__light_tree_emitters, emitter).area;
+    return (area > 0.0f) ? light_tree_pdf(kg, P, emitter) / area : 0.0f;
+  }
+#endif
+  return kernel_data.integrator.pdf_triangles;
+}
+
 /* Regular Light */
 
-ccl_device_inline bool lamp_light_sample(
-    KernelGlobals *kg, int lamp, float randu, float randv, float3 P, LightSample *ls)
+ccl_device_inline bool lamp_light_sample(KernelGlobals *kg,
+                                         int lamp,
+                                         float randu,
+                                         float randv,
+                                         float3 P,
+                                         float pdf_selection,
+                                         LightSample *ls)
 {
   const ccl_global KernelLight *klight = &kernel_tex_fetch(__lights, lamp);
   LightType type = (LightType)klight->type;
@@ -645,7 +884,7 @@ ccl_device_inline bool lamp_light_sample(
     }
   }
 
-  ls->pdf *= kernel_data.integrator.pdf_lights;
+  ls->pdf *= pdf_selection;
 
   return (ls->pdf > 0.0f);
 }
@@ -783,7 +1022,7 @@ ccl_device bool lamp_light_eval(
     return false;
   }
 
-  ls->pdf *= kernel_data.integrator.pdf_lights;
+  ls->pdf *= lamp_light_selection_pdf(kg, lamp, P);
 
   return true;
 }
@@ -822,12 +1061,11 @@ ccl_device_inline bool triangle_world_space_vertices(
   return has_motion;
 }
 
-ccl_device_inline float triangle_light_pdf_area(KernelGlobals *kg,
-                                                const float3 Ng,
+ccl_device_inline float triangle_light_pdf_area(const float3 Ng,
                                                 const float3 I,
-                                                float t)
+                                                float t,
+                                                float pdf)
 {
-  float pdf = kernel_data.integrator.pdf_triangles;
   float cos_pi = fabsf(dot(Ng, I));
 
   if (cos_pi == 0.0f)
@@ -845,6 +1083,13 @@ ccl_device_forceinline float triangle_light_pdf(KernelGlobals *kg, ShaderData *s
   float3 V[3];
   bool has_motion = triangle_world_space_vertices(kg, sd->object, sd->prim, sd->time, V);
 
+  /* sd contains the point on the light source, Px is the point that we're shading */
+  const float3 Px = sd->P + sd->I * t;
+  const float pdf_area = triangle_light_selection_pdf(kg, sd->object, sd->prim, Px);
+  if (pdf_area == 0.0f) {
+    return 0.0f;
+  }
+
   const float3 e0 = V[1] - V[0];
   const float3 e1 = V[2] - V[0];
   const float3 e2 = V[2] - V[1];
@@ -853,9 +1098,6 @@ ccl_device_forceinline float triangle_light_pdf(KernelGlobals *kg, ShaderData *s
   const float distance_to_plane = fabsf(dot(N, sd->I * t)) / dot(N, N);
 
   if (longest_edge_squared > distance_to_plane * distance_to_plane) {
-    /* sd contains the point on the light source
-     * calculate Px, the point that we're shading */
-    const float3 Px = sd->P + sd->I * t;
     const float3 v0_p = V[0] - Px;
     const float3 v1_p = V[1] - Px;
     const float3 v2_p = V[2] - Px;
@@ -883,12 +1125,12 @@ ccl_device_forceinline float triangle_light_pdf(KernelGlobals *kg, ShaderData *s
       else {
         area = 0.5f * len(N);
       }
-      const float pdf = area * kernel_data.integrator.pdf_triangles;
+      const float pdf = area * pdf_area;
       return pdf / solid_angle;
     }
   }
   else {
-    float pdf = triangle_light_pdf_area(kg, sd->Ng, sd->I, t);
+    float pdf = triangle_light_pdf_area(sd->Ng, sd->I, t, pdf_area);
     if (has_motion) {
       const float area = 0.5f * len(N);
       if (UNLIKELY(area == 0.0f)) {
@@ -912,7 +1154,8 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg,
                                                   float randv,
                                                   float time,
                                                   LightSample *ls,
-                                                  const float3 P)
+                                                  const float3 P,
+                                                  const float pdf_area)
 {
   /* A naive heuristic to decide between costly solid angle sampling
    * and simple area sampling, comparing the distance to the triangle plane
@@ -1036,7 +1279,7 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg,
         triangle_world_space_vertices(kg, object, prim, -1.0f, V);
         area = triangle_area(V[0], V[1], V[2]);
       }
-      const float pdf = area * kernel_data.integrator.pdf_triangles;
+      const float pdf = area * pdf_area;
       ls->pdf = pdf / solid_angle;
     }
   }
@@ -1050,7 +1293,7 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg,
     ls->P = u * V[0] + v * V[1] + t * V[2];
     /* compute incoming direction, distance and pdf */
     ls->D = normalize_len(ls->P - P, &ls->t);
-    ls->pdf = triangle_light_pdf_area(kg, ls->Ng, -ls->D, ls->t);
+    ls->pdf = triangle_light_pdf_area(ls->Ng, -ls->D, ls->t, pdf_area);
     if (has_motion && area != 0.0f) {
       /* scale the PDF.
        * area = the area the sample was taken from
@@ -1118,9 +1361,23 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
                                       int bounce,
                                       LightSample *ls)
 {
+  float pdf_selection = kernel_data.integrator.pdf_lights;
+
   if (lamp < 0) {
     /* sample index */
-    int index = light_distribution_sample(kg, &randu);
+    int index;
+#ifdef __LIGHT_TREE__
+    if (kernel_data.integrator.use_light_tree) {
+      index = light_tree_distribution_sample(kg, P, &randu, &pdf_selection);
+      if (index == -1) {
+        return false;
+      }
+    }
+    else
+#endif
+    {
+      index = light_distribution_sample(kg, &randu);
+    }
 
     /* fetch light data */
     const ccl_global KernelLightDistribution *kdistribution = &kernel_tex_fetch(
@@ -1130,8 +1387,14 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
     if (prim >= 0) {
       int object = kdistribution->mesh_light.object_id;
       int shader_flag = kdistribution->mesh_light.shader_flag;
+      float pdf_area = kernel_data.integrator.pdf_triangles;
+#ifdef __LIGHT_TREE__
+      if (kernel_data.integrator.use_light_tree) {
+        pdf_area = pdf_selection / kernel_tex_fetch(__light_tree_emitters, index).area;
+      }
+#endif
 
-      triangle_light_sample(kg, prim, object, randu, randv, time, ls, P);
+      triangle_light_sample(kg, prim, object, randu, randv, time, ls, P, pdf_area);
       ls->shader |= shader_flag;
       return (ls->pdf > 0.0f);
     }
@@ -1143,7 +1406,7 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
     return false;
   }
 
-  return lamp_light_sample(kg, lamp, randu, randv, P, ls);
+  return lamp_light_sample(kg, lamp, randu, randv, P, pdf_selection, ls);
 }
 
 ccl_device_inline int light_select_num_samples(KernelGlobals *kg, int index)
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KERNEL_OIIO_GLOBALS_H__
+#define __KERNEL_OIIO_GLOBALS_H__
+
+#include <OpenImageIO/texture.h>
+
+#include "util/util_texture.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+class ColorSpaceProcessor;
+
+/* Image texture read from the OpenImageIO texture cache instead of device memory. */
+struct OIIOTexture {
+  OIIOTexture()
+      : handle(NULL),
+        processor(NULL),
+        compress_as_srgb(false),
+        interpolation(INTERPOLATION_LINEAR),
+        extension(EXTENSION_REPEAT)
+  {
+  }
+
+  OIIO::TextureSystem::TextureHandle *handle;
+  /* Conversion of the file pixels to scene linear, NULL when they are used as is. */
+  ColorSpaceProcessor *processor;
+  /* Encode the scene linear pixels as sRGB, like the images loaded in memory. */
+  bool compress_as_srgb;
+  InterpolationType interpolation;
+  ExtensionType extension;
+};
+
+/* OIIO Globals
+ *
+ * Texture cache of the CPU device. The tiles of the image files are loaded on demand
+ * and evicted when the cache is over its memory budget. The image manager creates the
+ * texture system and fills the textures before rendering. */
+
+struct OIIOGlobals {
+  OIIOGlobals()
+  {
+    tex_sys = NULL;
+  }
+
+  OIIO::TextureSystem *tex_sys;
+
+  /* Textures by flat slot, images loaded in memory have a NULL handle. */
+  vector<OIIOTexture> textures;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __KERNEL_OIIO_GLOBALS_H__ */
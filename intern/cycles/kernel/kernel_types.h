@@ -53,6 +53,8 @@ CCL_NAMESPACE_BEGIN
 
 #define VOLUME_BOUNDS_MAX 1024
 
+#define LIGHT_TREE_MAX_LEAF_SIZE 8
+
 #define BECKMANN_TABLE_SIZE 256
 
 #define SHADER_NONE (~0)
@@ -135,6 +137,7 @@ CCL_NAMESPACE_BEGIN
 #  endif
 #  define __VOLUME_DECOUPLED__
 #  define __VOLUME_RECORD_ALL__
+#  define __LIGHT_TREE__
 #endif /* __KERNEL_CPU__ */
 
 #ifdef __KERNEL_CUDA__
@@ -1309,6 +1312,11 @@ typedef struct KernelIntegrator {
   int num_portals;
   int portal_offset;
 
+  /* light tree */
+  int use_light_tree;
+  int num_light_tree_emitters;
+  float pdf_light_tree;
+
   /* bounces */
   int min_bounce;
   int max_bounce;
@@ -1366,7 +1374,7 @@ typedef struct KernelIntegrator {
 
   int max_closures;
 
-  int pad1;
+  int pad1, pad2;
 } KernelIntegrator;
 static_assert_align(KernelIntegrator, 16);
 
@@ -1535,6 +1543,39 @@ typedef struct KernelLightDistribution {
 } KernelLightDistribution;
 static_assert_align(KernelLightDistribution, 16);
 
+/* Light tree node, bounding the position, orientation and energy of its emitters. The first
+ * child of an inner node directly follows it, leaves reference a range of emitters. */
+typedef struct KernelLightTreeNode {
+  float bbox_min[3];
+  float energy;
+  float bbox_max[3];
+  /* Spread of the emitter normals around the axis. */
+  float theta_o;
+  float axis[3];
+  /* Spread of the emission around the normals. */
+  float theta_e;
+  /* Index of the second child for inner nodes, -1 for leaves. */
+  int second_child;
+  int first_emitter;
+  int num_emitters;
+  int parent;
+} KernelLightTreeNode;
+static_assert_align(KernelLightTreeNode, 16);
+
+/* Light tree emitter, in the same order as the light distribution. */
+typedef struct KernelLightTreeEmitter {
+  float centroid[3];
+  float energy;
+  float axis[3];
+  float theta_o;
+  float theta_e;
+  float radius;
+  /* Triangle area, the tree gives the probability of the whole triangle. */
+  float area;
+  int leaf;
+} KernelLightTreeEmitter;
+static_assert_align(KernelLightTreeEmitter, 16);
+
 typedef struct KernelParticle {
   int index;
   float age;
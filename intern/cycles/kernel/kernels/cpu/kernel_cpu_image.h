@@ -17,6 +17,10 @@
 #ifndef __KERNEL_CPU_IMAGE_H__
 #define __KERNEL_CPU_IMAGE_H__
 
+#include "kernel/kernel_oiio_globals.h"
+
+#include "render/colorspace.h"
+
 CCL_NAMESPACE_BEGIN
 
 /* Make template functions private so symbols don't conflict between kernels with different
@@ -470,8 +474,70 @@ template<typename T> struct TextureInterpolator {
 #undef SET_CUBIC_SPLINE_WEIGHTS
 };
 
+/* Lookup in the OpenImageIO texture cache, which loads the tiles of the file on demand. There
+ * are no ray differentials for image textures, so the finest mipmap level is used. */
+ccl_device float4 kernel_tex_image_cache_lookup(KernelGlobals *kg,
+                                                const OIIOTexture &tex,
+                                                float x,
+                                                float y)
+{
+  OIIO::TextureSystem *tex_sys = kg->oiio->tex_sys;
+  OIIO::TextureOpt options;
+
+  switch (tex.interpolation) {
+    case INTERPOLATION_CLOSEST:
+      options.interpmode = OIIO::TextureOpt::InterpClosest;
+      break;
+    case INTERPOLATION_CUBIC:
+      options.interpmode = OIIO::TextureOpt::InterpBicubic;
+      break;
+    case INTERPOLATION_SMART:
+      options.interpmode = OIIO::TextureOpt::InterpSmartBicubic;
+      break;
+    default:
+      options.interpmode = OIIO::TextureOpt::InterpBilinear;
+      break;
+  }
+
+  switch (tex.extension) {
+    case EXTENSION_EXTEND:
+      options.swrap = options.twrap = OIIO::TextureOpt::WrapClamp;
+      break;
+    case EXTENSION_CLIP:
+      options.swrap = options.twrap = OIIO::TextureOpt::WrapBlack;
+      break;
+    default:
+      options.swrap = options.twrap = OIIO::TextureOpt::WrapPeriodic;
+      break;
+  }
+
+  /* Opaque alpha for images without an alpha channel. */
+  options.fill = 1.0f;
+
+  /* Images in memory are stored bottom to top. */
+  float result[4];
+  if (!tex_sys->texture(
+          tex.handle, NULL, options, x, 1.0f - y, 0.0f, 0.0f, 0.0f, 0.0f, 4, result)) {
+    /* Clear the error so it doesn't accumulate. */
+    tex_sys->geterror();
+    return make_float4(
+        TEX_IMAGE_MISSING_R, TEX_IMAGE_MISSING_G, TEX_IMAGE_MISSING_B, TEX_IMAGE_MISSING_A);
+  }
+
+  if (tex.processor) {
+    ColorSpaceManager::to_scene_linear(tex.processor, result, 4);
+  }
+
+  float4 rgba = make_float4(result[0], result[1], result[2], result[3]);
+  return (tex.compress_as_srgb) ? color_linear_to_srgb_v4(rgba) : rgba;
+}
+
 ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, float y)
 {
+  if (kg->oiio && (size_t)id < kg->oiio->textures.size() && kg->oiio->textures[id].handle) {
+    return kernel_tex_image_cache_lookup(kg, kg->oiio->textures[id], x, y);
+  }
+
   const TextureInfo &info = kernel_tex_fetch(__texture_info, id);
 
   switch (kernel_tex_type(id)) {
@@ -41,6 +41,7 @@
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
 #include "util/util_progress.h"
+#include "util/util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -261,14 +262,21 @@ void Geometry::tag_update(Scene *scene, bool rebuild)
 
 /* Geometry Manager */
 
+/* Maximum growth of the scene BVH refit cost over its build cost before building it again. */
+static const float SCENE_BVH_MAX_REFIT_COST_FACTOR = 1.5f;
+
 GeometryManager::GeometryManager()
 {
   need_update = true;
   need_flags_update = true;
+  need_full_update = true;
+  scene_bvh = NULL;
+  scene_bvh_build_cost = 0.0f;
 }
 
 GeometryManager::~GeometryManager()
 {
+  delete scene_bvh;
 }
 
 void GeometryManager::update_osl_attributes(Device *device,
@@ -1040,9 +1048,17 @@ void GeometryManager::device_update_bvh(Device *device,
   }
 #endif
 
+  delete scene_bvh;
+  scene_bvh = NULL;
+  scene_bvh_geometry.clear();
+
+  double time_start = time_dt();
+
   BVH *bvh = BVH::create(bparams, scene->geometry, scene->objects);
   bvh->build(progress, &device->stats);
 
+  scene->update_stats->bvh.add_entry(NamedTimeEntry("Scene BVH build", time_dt() - time_start));
+
   if (progress.get_cancel()) {
 #ifdef WITH_EMBREE
     if (bparams.bvh_layout == BVH_LAYOUT_EMBREE) {
@@ -1055,9 +1071,25 @@ void GeometryManager::device_update_bvh(Device *device,
     return;
   }
 
+  /* Keep the top level of dynamic BVHs to refit it when only objects are modified. */
+  if (bparams.bvh_type == SceneParams::BVH_DYNAMIC &&
+      (bparams.bvh_layout == BVH_LAYOUT_BVH2 || bparams.bvh_layout == BVH_LAYOUT_BVH4 ||
+       bparams.bvh_layout == BVH_LAYOUT_BVH8)) {
+    scene_bvh = bvh->copy_top_level();
+    foreach (Object *object, scene->objects) {
+      scene_bvh_geometry.push_back(object->is_traceable() ? object->geometry : NULL);
+    }
+
+    /* Refitting the unmodified nodes measures the cost of the tree as built. */
+    scene_bvh->refit(progress);
+    scene_bvh_build_cost = scene_bvh->refit_cost;
+  }
+
   /* copy to device */
   progress.set_status("Updating Scene BVH", "Copying BVH to device");
 
+  time_start = time_dt();
+
   PackedBVH &pack = bvh->pack;
 
   if (pack.nodes.size()) {
@@ -1108,6 +1140,65 @@ void GeometryManager::device_update_bvh(Device *device,
   bvh->copy_to_device(progress, dscene);
 
   delete bvh;
+
+  scene->update_stats->bvh.add_entry(
+      NamedTimeEntry("Scene BVH copy to device", time_dt() - time_start));
+}
+
+bool GeometryManager::device_refit_bvh(Device * /*device*/,
+                                       DeviceScene *dscene,
+                                       Scene *scene,
+                                       Progress &progress)
+{
+  if (scene_bvh == NULL || scene_bvh_geometry.size() != scene->objects.size()) {
+    return false;
+  }
+
+  /* The top level primitives reference the objects by index, so the objects and the geometry
+   * they instance must be the same as when the BVH was built. */
+  for (size_t i = 0; i < scene->objects.size(); i++) {
+    Object *object = scene->objects[i];
+    Geometry *geom = object->is_traceable() ? object->geometry : NULL;
+    if (scene_bvh->objects[i] != object || scene_bvh_geometry[i] != geom) {
+      return false;
+    }
+  }
+
+  progress.set_status("Updating Scene BVH", "Refitting");
+
+  double time_start = time_dt();
+
+  scene_bvh->refit(progress);
+  if (progress.get_cancel()) {
+    return true;
+  }
+
+  /* Refitting keeps the topology built for the previous object transforms, build again once
+   * the nodes overlap too much to be traversed efficiently. */
+  if (scene_bvh->refit_cost > scene_bvh_build_cost * SCENE_BVH_MAX_REFIT_COST_FACTOR) {
+    VLOG(1) << "Scene BVH refit cost " << scene_bvh->refit_cost << " exceeds build cost "
+            << scene_bvh_build_cost << ", rebuilding.";
+    return false;
+  }
+
+  /* The top level nodes come first in the packed arrays, the merged instance BVHs and the
+   * primitives are not modified. */
+  PackedBVH &pack = scene_bvh->pack;
+  if (pack.nodes.size()) {
+    memcpy(dscene->bvh_nodes.data(), pack.nodes.data(), pack.nodes.size() * sizeof(int4));
+    dscene->bvh_nodes.copy_to_device(0, pack.nodes.size());
+  }
+  if (pack.leaf_nodes.size()) {
+    memcpy(dscene->bvh_leaf_nodes.data(),
+           pack.leaf_nodes.data(),
+           pack.leaf_nodes.size() * sizeof(int4));
+    dscene->bvh_leaf_nodes.copy_to_device(0, pack.leaf_nodes.size());
+  }
+
+  scene->update_stats->bvh.add_entry(NamedTimeEntry("Scene BVH refit", time_dt() - time_start));
+  scene->update_stats->num_scene_bvh_refits++;
+
+  return true;
 }
 
 void GeometryManager::device_update_preprocess(Device *device, Scene *scene, Progress &progress)
@@ -1230,6 +1321,7 @@ void GeometryManager::device_update(Device *device,
   VLOG(1) << "Total " << scene->geometry.size() << " meshes.";
 
   bool true_displacement_used = false;
+  bool geometry_modified = false;
   size_t total_tess_needed = 0;
 
   foreach (Geometry *geom, scene->geometry) {
@@ -1238,6 +1330,10 @@ void GeometryManager::device_update(Device *device,
         geom->need_update = true;
     }
 
+    if (geom->need_update) {
+      geometry_modified = true;
+    }
+
     if (geom->need_update && geom->type == Geometry::MESH) {
       Mesh *mesh = static_cast<Mesh *>(geom);
 
@@ -1265,6 +1361,29 @@ void GeometryManager::device_update(Device *device,
     }
   }
 
+  /* Only objects were modified, the packed geometry and the geometry BVHs are kept. OSL
+   * attributes are stored per object, so they are always packed again. */
+  if (!need_full_update && !geometry_modified && !device->osl_memory()) {
+    Scene::MotionType need_motion = scene->need_motion();
+    foreach (Object *object, scene->objects) {
+      object->compute_bounds(need_motion == Scene::MOTION_BLUR);
+    }
+
+    if (!device_refit_bvh(device, dscene, scene, progress)) {
+      device_free_bvh(dscene);
+      device_update_bvh(device, dscene, scene, progress);
+    }
+    if (progress.get_cancel())
+      return;
+
+    scene->update_stats->num_partial_geometry_updates++;
+    need_update = false;
+    return;
+  }
+
+  /* Until the update is done the packed geometry is incomplete. */
+  need_full_update = true;
+
   /* Tessellate meshes that are using subdivision */
   if (total_tess_needed) {
     Camera *dicing_camera = scene->dicing_camera;
@@ -1358,6 +1477,8 @@ void GeometryManager::device_update(Device *device,
 
   TaskPool pool;
 
+  double time_start = time_dt();
+
   size_t i = 0;
   foreach (Geometry *geom, scene->geometry) {
     if (geom->need_update) {
@@ -1373,6 +1494,8 @@ void GeometryManager::device_update(Device *device,
   pool.wait_work(&summary);
   VLOG(2) << "Objects BVH build pool statistics:\n" << summary.full_report();
 
+  scene->update_stats->bvh.add_entry(NamedTimeEntry("Geometry BVHs", time_dt() - time_start));
+
   foreach (Shader *shader, scene->shaders) {
     shader->need_update_geometry = false;
   }
@@ -1398,6 +1521,7 @@ void GeometryManager::device_update(Device *device,
     return;
 
   need_update = false;
+  need_full_update = false;
 
   if (true_displacement_used) {
     /* Re-tag flags for update, so they're re-evaluated
@@ -1410,7 +1534,7 @@ void GeometryManager::device_update(Device *device,
   }
 }
 
-void GeometryManager::device_free(Device *device, DeviceScene *dscene)
+void GeometryManager::device_free_bvh(DeviceScene *dscene)
 {
   dscene->bvh_nodes.free();
   dscene->bvh_leaf_nodes.free();
@@ -1422,6 +1546,15 @@ void GeometryManager::device_free(Device *device, DeviceScene *dscene)
   dscene->prim_index.free();
   dscene->prim_object.free();
   dscene->prim_time.free();
+
+  delete scene_bvh;
+  scene_bvh = NULL;
+  scene_bvh_geometry.clear();
+}
+
+void GeometryManager::device_free(Device *device, DeviceScene *dscene)
+{
+  device_free_bvh(dscene);
   dscene->tri_shader.free();
   dscene->tri_vnormal.free();
   dscene->tri_vindex.free();
@@ -1455,6 +1588,7 @@ void GeometryManager::device_free(Device *device, DeviceScene *dscene)
 void GeometryManager::tag_update(Scene *scene)
 {
   need_update = true;
+  need_full_update = true;
   scene->object_manager->need_update = true;
 }
 
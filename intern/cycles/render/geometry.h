@@ -147,6 +147,8 @@ class GeometryManager {
   /* Update Flags */
   bool need_update;
   bool need_flags_update;
+  /* Pack all geometry, otherwise when no geometry was modified only the scene BVH is built. */
+  bool need_full_update;
 
   /* Constructor/Destructor */
   GeometryManager();
@@ -156,6 +158,7 @@ class GeometryManager {
   void device_update_preprocess(Device *device, Scene *scene, Progress &progress);
   void device_update(Device *device, DeviceScene *dscene, Scene *scene, Progress &progress);
   void device_free(Device *device, DeviceScene *dscene);
+  void device_free_bvh(DeviceScene *dscene);
 
   /* Updates */
   void tag_update(Scene *scene);
@@ -194,10 +197,18 @@ class GeometryManager {
                                 Progress &progress);
 
   void device_update_bvh(Device *device, DeviceScene *dscene, Scene *scene, Progress &progress);
+  bool device_refit_bvh(Device *device, DeviceScene *dscene, Scene *scene, Progress &progress);
 
   void device_update_displacement_images(Device *device, Scene *scene, Progress &progress);
 
   void device_update_volume_images(Device *device, Scene *scene, Progress &progress);
+
+  /* Top level of the dynamic scene BVH, refitted when only object transforms changed. */
+  BVH *scene_bvh;
+  /* Geometry of each object when the scene BVH was built, NULL for objects not traced. */
+  vector<Geometry *> scene_bvh_geometry;
+  /* Refit cost of the scene BVH as built, refitting stops once the cost grew too much. */
+  float scene_bvh_build_cost;
 };
 
 CCL_NAMESPACE_END
@@ -16,6 +16,7 @@
 
 #include "render/image.h"
 #include "device/device.h"
+#include "kernel/kernel_oiio_globals.h"
 #include "render/colorspace.h"
 #include "render/scene.h"
 #include "render/stats.h"
@@ -98,6 +99,7 @@ ImageManager::ImageManager(const DeviceInfo &info)
 {
   need_update = true;
   osl_texture_system = NULL;
+  texture_cache = NULL;
   animation_frame = 0;
 
   /* Set image limits */
@@ -774,6 +776,84 @@ bool ImageManager::file_load_image(Image *img,
   return true;
 }
 
+bool ImageManager::texture_cache_load_image(Device *device,
+                                            Scene *scene,
+                                            Image *img,
+                                            int flat_slot)
+{
+  /* Builtin and volume images are loaded in memory, as are images resized by the texture
+   * limit. */
+  if (!scene->params.use_texture_cache || img->builtin_data || img->metadata.depth > 1 ||
+      scene->params.texture_limit > 0) {
+    return false;
+  }
+
+  /* The texture system associates the alpha of all files, images that need unassociated
+   * alpha are loaded in memory. */
+  const bool has_alpha = (img->metadata.channels == 2 || img->metadata.channels == 4);
+  if (has_alpha && !image_associate_alpha(img)) {
+    return false;
+  }
+
+  OIIOGlobals *oiio = (OIIOGlobals *)device->oiio_memory();
+  if (oiio == NULL) {
+    return false;
+  }
+
+  thread_scoped_lock device_lock(device_mutex);
+
+  if (oiio->tex_sys == NULL) {
+    oiio->tex_sys = OIIO::TextureSystem::create(false);
+    oiio->tex_sys->attribute("automip", 1);
+    oiio->tex_sys->attribute("autotile", 64);
+    oiio->tex_sys->attribute("gray_to_rgb", 1);
+    oiio->tex_sys->attribute("max_memory_MB", (float)scene->params.texture_cache_size);
+  }
+  texture_cache = oiio;
+
+  OIIO::TextureSystem::TextureHandle *handle = oiio->tex_sys->get_texture_handle(
+      ustring(img->filename));
+  if (handle == NULL || !oiio->tex_sys->good(handle)) {
+    oiio->tex_sys->geterror();
+    return false;
+  }
+
+  if (flat_slot >= oiio->textures.size()) {
+    /* Allocate some slots in advance, to reduce amount of re-allocations. */
+    oiio->textures.resize(flat_slot + 128);
+  }
+
+  /* Same conversions as file_load_image(), applied at lookup time. */
+  const ImageDataType type = img->metadata.type;
+  const bool is_rgba = (type == IMAGE_DATA_TYPE_FLOAT4 || type == IMAGE_DATA_TYPE_HALF4 ||
+                        type == IMAGE_DATA_TYPE_BYTE4 || type == IMAGE_DATA_TYPE_USHORT4);
+  const bool convert = is_rgba && img->metadata.colorspace != u_colorspace_raw &&
+                       img->metadata.colorspace != u_colorspace_srgb;
+
+  OIIOTexture &tex = oiio->textures[flat_slot];
+  tex.handle = handle;
+  tex.processor = (convert) ? ColorSpaceManager::get_processor(img->metadata.colorspace) : NULL;
+  tex.compress_as_srgb = convert && img->metadata.compress_as_srgb;
+  tex.interpolation = img->interpolation;
+  tex.extension = img->extension;
+
+  return true;
+}
+
+void ImageManager::texture_cache_free_image(Image *img, int flat_slot)
+{
+  thread_scoped_lock device_lock(device_mutex);
+
+  if (texture_cache == NULL || flat_slot >= texture_cache->textures.size() ||
+      texture_cache->textures[flat_slot].handle == NULL) {
+    return;
+  }
+
+  /* Reopen the file on the next lookup, in case it changed. */
+  texture_cache->tex_sys->invalidate(ustring(img->filename));
+  texture_cache->textures[flat_slot] = OIIOTexture();
+}
+
 void ImageManager::device_load_image(
     Device *device, Scene *scene, ImageDataType type, int slot, Progress *progress)
 {
@@ -795,12 +875,19 @@ void ImageManager::device_load_image(
   img->mem_name = string_printf("__tex_image_%s_%03d", name_from_type(type), flat_slot);
 
   /* Free previous texture in slot. */
+  texture_cache_free_image(img, flat_slot);
   if (img->mem) {
     thread_scoped_lock device_lock(device_mutex);
     delete img->mem;
     img->mem = NULL;
   }
 
+  /* Read file image through the texture cache when possible. */
+  if (texture_cache_load_image(device, scene, img, flat_slot)) {
+    img->need_load = false;
+    return;
+  }
+
   /* Create new texture. */
   if (type == IMAGE_DATA_TYPE_FLOAT4) {
     device_vector<float4> *tex_img = new device_vector<float4>(
@@ -981,6 +1068,8 @@ void ImageManager::device_free_image(Device *, ImageDataType type, int slot)
 #endif
     }
 
+    texture_cache_free_image(img, type_index_to_flattened_slot(slot, type));
+
     if (img->mem) {
       thread_scoped_lock device_lock(device_mutex);
       delete img->mem;
@@ -1094,16 +1183,54 @@ void ImageManager::device_free(Device *device)
     }
     images[type].clear();
   }
+
+  if (texture_cache) {
+    OIIO::TextureSystem::destroy(texture_cache->tex_sys);
+    texture_cache->tex_sys = NULL;
+    texture_cache->textures.clear();
+    texture_cache = NULL;
+  }
+}
+
+static int64_t texture_cache_stat(OIIO::TextureSystem *tex_sys, const char *name)
+{
+  long long value = 0;
+  if (!tex_sys->getattribute(name, TypeDesc::INT64, &value)) {
+    int int_value = 0;
+    tex_sys->getattribute(name, TypeDesc::INT, &int_value);
+    value = int_value;
+  }
+  return value;
 }
 
 void ImageManager::collect_statistics(RenderStats *stats)
 {
   for (int type = 0; type < IMAGE_DATA_NUM_TYPES; type++) {
     foreach (const Image *image, images[type]) {
+      if (image == NULL || image->mem == NULL) {
+        /* Freed slot, or image read through the texture cache. */
+        continue;
+      }
       stats->image.textures.add_entry(
           NamedSizeEntry(path_filename(image->filename), image->mem->memory_size()));
     }
   }
+
+  if (texture_cache && texture_cache->tex_sys) {
+    OIIO::TextureSystem *tex_sys = texture_cache->tex_sys;
+    TextureCacheStats &cache = stats->image.cache;
+    float max_memory_MB = 0.0f;
+    tex_sys->getattribute("max_memory_MB", TypeDesc::FLOAT, &max_memory_MB);
+
+    cache.used = true;
+    cache.num_files = texture_cache_stat(tex_sys, "stat:unique_files");
+    cache.memory_used = texture_cache_stat(tex_sys, "stat:cache_memory_used");
+    cache.memory_limit = (size_t)max_memory_MB * 1024 * 1024;
+    cache.images_size = texture_cache_stat(tex_sys, "stat:image_size");
+    cache.bytes_read = texture_cache_stat(tex_sys, "stat:bytes_read");
+    cache.tile_lookups = texture_cache_stat(tex_sys, "stat:find_tile_calls");
+    cache.tile_misses = texture_cache_stat(tex_sys, "stat:find_tile_cache_misses");
+  }
 }
 
 CCL_NAMESPACE_END
@@ -35,6 +35,7 @@ class Progress;
 class RenderStats;
 class Scene;
 class ColorSpaceProcessor;
+struct OIIOGlobals;
 
 class ImageMetaData {
  public:
@@ -174,6 +175,8 @@ class ImageManager {
 
   vector<Image *> images[IMAGE_DATA_NUM_TYPES];
   void *osl_texture_system;
+  /* Texture cache of the device, when file images are read through it. */
+  OIIOGlobals *texture_cache;
 
   bool file_load_image_generic(Image *img, unique_ptr<ImageInput> *in);
 
@@ -185,6 +188,9 @@ class ImageManager {
 
   void metadata_detect_colorspace(ImageMetaData &metadata, const char *file_format);
 
+  bool texture_cache_load_image(Device *device, Scene *scene, Image *img, int flat_slot);
+  void texture_cache_free_image(Image *img, int flat_slot);
+
   void device_load_image(
       Device *device, Scene *scene, ImageDataType type, int slot, Progress *progress);
   void device_free_image(Device *device, ImageDataType type, int slot);
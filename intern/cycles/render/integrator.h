@@ -74,6 +74,8 @@ class Integrator : public Node {
   bool sample_all_lights_direct;
   bool sample_all_lights_indirect;
   float light_sampling_threshold;
+  /* Sample lights with the light tree, when lights are sampled one at a time. */
+  bool use_light_tree;
 
   enum Method {
     BRANCHED_PATH = 0,
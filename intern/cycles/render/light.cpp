@@ -20,6 +20,7 @@
 #include "render/film.h"
 #include "render/graph.h"
 #include "render/light.h"
+#include "render/light_tree.h"
 #include "render/mesh.h"
 #include "render/nodes.h"
 #include "render/object.h"
@@ -28,6 +29,7 @@
 
 #include "util/util_foreach.h"
 #include "util/util_hash.h"
+#include "util/util_map.h"
 #include "util/util_path.h"
 #include "util/util_progress.h"
 #include "util/util_logging.h"
@@ -257,7 +259,7 @@ bool LightManager::object_usable_as_light(Object *object)
   return false;
 }
 
-void LightManager::device_update_distribution(Device *,
+void LightManager::device_update_distribution(Device *device,
                                               DeviceScene *dscene,
                                               Scene *scene,
                                               Progress &progress)
@@ -462,6 +464,23 @@ void LightManager::device_update_distribution(Device *,
 
     kintegrator->use_lamp_mis = use_lamp_mis;
 
+    /* Light tree, only used when sampling one light at a time. */
+    Integrator *integrator = scene->integrator;
+    const bool use_light_tree = integrator->use_light_tree && device->info.has_light_tree &&
+                                (integrator->method == Integrator::PATH ||
+                                 !(integrator->sample_all_lights_direct ||
+                                   integrator->sample_all_lights_indirect));
+    if (use_light_tree) {
+      device_update_light_tree(dscene, scene, progress);
+      if (progress.get_cancel())
+        return;
+    }
+    else {
+      kintegrator->use_light_tree = false;
+      kintegrator->num_light_tree_emitters = 0;
+      kintegrator->pdf_light_tree = 0.0f;
+    }
+
     /* bit of an ugly hack to compensate for emitting triangles influencing
      * amount of samples we get for this pass */
     kfilm->pass_shadow_scale = 1.0f;
@@ -495,6 +514,9 @@ void LightManager::device_update_distribution(Device *,
     kintegrator->pdf_triangles = 0.0f;
     kintegrator->pdf_lights = 0.0f;
     kintegrator->use_lamp_mis = false;
+    kintegrator->use_light_tree = false;
+    kintegrator->num_light_tree_emitters = 0;
+    kintegrator->pdf_light_tree = 0.0f;
     kintegrator->num_portals = 0;
     kintegrator->portal_offset = 0;
     kintegrator->portal_pdf = 0.0f;
@@ -503,6 +525,198 @@ void LightManager::device_update_distribution(Device *,
   }
 }
 
+/* Estimate of the emission of a shader, shaders with varying emission are assumed to have unit
+ * strength. */
+static float light_tree_shader_energy(Shader *shader, map<Shader *, float> &shader_energy)
+{
+  map<Shader *, float>::iterator it = shader_energy.find(shader);
+  if (it != shader_energy.end()) {
+    return it->second;
+  }
+
+  float3 emission;
+  const float energy = (shader->is_constant_emission(&emission)) ? average(fabs(emission)) : 1.0f;
+  shader_energy[shader] = energy;
+  return energy;
+}
+
+void LightManager::device_update_light_tree(DeviceScene *dscene, Scene *scene, Progress &progress)
+{
+  progress.set_status("Updating Lights", "Building light tree");
+
+  KernelIntegrator *kintegrator = &dscene->data.integrator;
+  KernelLightDistribution *distribution = dscene->light_distribution.data();
+  const int num_distribution = kintegrator->num_distribution;
+  const int num_lights = kintegrator->num_all_lights;
+  const int num_objects = scene->objects.size();
+
+  /* Enabled lights, in the order of the kernel lights. */
+  vector<Light *> lights;
+  foreach (Light *light, scene->lights) {
+    if (light->is_enabled) {
+      lights.push_back(light);
+    }
+  }
+
+  /* Lookup of the emitter of each lamp, followed by the triangle table and primitive offset of
+   * each object, then the tables of the emissive objects. */
+  vector<int> lookup(num_lights + num_objects * 2, -1);
+  /* Lookup entry of each light of the distribution. */
+  vector<int> lookup_index(num_distribution, -1);
+
+  vector<LightTreeEmitter> emitters;
+  vector<int> infinite_lights;
+  map<Shader *, float> shader_energy;
+
+  for (int i = 0; i < num_distribution; i++) {
+    const KernelLightDistribution &kdistribution = distribution[i];
+    LightTreeEmitter emitter;
+    emitter.bbox = BoundBox::empty;
+    emitter.area = 0.0f;
+    emitter.index = i;
+
+    if (kdistribution.prim >= 0) {
+      const int object_id = kdistribution.mesh_light.object_id;
+      Object *object = scene->objects[object_id];
+      Mesh *mesh = static_cast<Mesh *>(object->geometry);
+
+      if (lookup[num_lights + object_id * 2] == -1) {
+        lookup[num_lights + object_id * 2] = lookup.size();
+        lookup[num_lights + object_id * 2 + 1] = mesh->prim_offset;
+        lookup.resize(lookup.size() + mesh->num_triangles(), -1);
+      }
+      const int triangle = kdistribution.prim - mesh->prim_offset;
+      lookup_index[i] = lookup[num_lights + object_id * 2] + triangle;
+
+      Mesh::Triangle t = mesh->get_triangle(triangle);
+      if (!t.valid(&mesh->verts[0])) {
+        /* Never sampled. */
+        emitter.centroid = object->bounds.center();
+        emitter.radius = 0.0f;
+        emitter.bbox.grow(emitter.centroid);
+        emitter.bcone = OrientationBounds(make_float3(0.0f, 0.0f, 1.0f), M_PI_F, M_PI_2_F);
+        emitter.energy = 0.0f;
+        emitters.push_back(emitter);
+        continue;
+      }
+
+      float3 p[3] = {mesh->verts[t.v[0]], mesh->verts[t.v[1]], mesh->verts[t.v[2]]};
+      if (!mesh->transform_applied) {
+        for (int k = 0; k < 3; k++) {
+          p[k] = transform_point(&object->tfm, p[k]);
+        }
+      }
+
+      emitter.centroid = (p[0] + p[1] + p[2]) * (1.0f / 3.0f);
+      float radius_squared = 0.0f;
+      for (int k = 0; k < 3; k++) {
+        emitter.bbox.grow(p[k]);
+        radius_squared = max(radius_squared, len_squared(p[k] - emitter.centroid));
+      }
+      emitter.radius = sqrtf(radius_squared);
+
+      const float3 N = cross(p[1] - p[0], p[2] - p[0]);
+      const float N_len = len(N);
+      const float3 axis = (N_len > 0.0f) ? N / N_len : make_float3(0.0f, 0.0f, 1.0f);
+      emitter.area = 0.5f * N_len;
+
+      /* Triangles emit on both sides. */
+      emitter.bcone = OrientationBounds(axis, M_PI_F, M_PI_2_F);
+
+      const int shader_index = mesh->shader[triangle];
+      Shader *shader = (shader_index < mesh->used_shaders.size()) ?
+                           mesh->used_shaders[shader_index] :
+                           scene->default_surface;
+      emitter.energy = emitter.area * light_tree_shader_energy(shader, shader_energy);
+    }
+    else {
+      const int lamp = ~kdistribution.prim;
+      const Light *light = lights[lamp];
+
+      if (light->type == LIGHT_DISTANT || light->type == LIGHT_BACKGROUND) {
+        infinite_lights.push_back(i);
+        continue;
+      }
+      lookup_index[i] = lamp;
+
+      const float strength = average(fabs(light->strength));
+      emitter.centroid = light->co;
+
+      if (light->type == LIGHT_AREA) {
+        const float3 axisu = light->axisu * (light->sizeu * light->size);
+        const float3 axisv = light->axisv * (light->sizev * light->size);
+        emitter.bbox.grow(light->co + 0.5f * (axisu + axisv));
+        emitter.bbox.grow(light->co + 0.5f * (axisu - axisv));
+        emitter.bbox.grow(light->co - 0.5f * (axisu + axisv));
+        emitter.bbox.grow(light->co - 0.5f * (axisu - axisv));
+        emitter.radius = 0.5f * sqrtf(len_squared(axisu) + len_squared(axisv));
+        emitter.bcone = OrientationBounds(safe_normalize(light->dir), 0.0f, M_PI_2_F);
+        emitter.energy = 0.25f * strength;
+      }
+      else {
+        emitter.bbox.grow(light->co, light->size);
+        emitter.radius = light->size;
+        if (light->type == LIGHT_SPOT) {
+          emitter.bcone = OrientationBounds(
+              safe_normalize(light->dir), 0.0f, min(0.5f * light->spot_angle, M_PI_2_F));
+        }
+        else {
+          emitter.bcone = OrientationBounds(make_float3(0.0f, 0.0f, 1.0f), M_PI_F, M_PI_2_F);
+        }
+        emitter.energy = 0.25f * M_1_PI_F * strength;
+      }
+    }
+
+    emitters.push_back(emitter);
+  }
+
+  if (progress.get_cancel())
+    return;
+
+  LightTree tree(emitters, progress);
+
+  if (progress.get_cancel())
+    return;
+
+  /* Reorder the distribution, the tree emitters followed by the distant and background lights.
+   * The cumulative areas are not used when sampling the tree. */
+  const int num_emitters = emitters.size();
+  const int num_infinite = infinite_lights.size();
+  vector<KernelLightDistribution> original_distribution(distribution,
+                                                        distribution + num_distribution);
+
+  for (int i = 0; i < num_emitters; i++) {
+    const int index = emitters[i].index;
+    distribution[i] = original_distribution[index];
+    lookup[lookup_index[index]] = i;
+  }
+  for (int i = 0; i < num_infinite; i++) {
+    distribution[num_emitters + i] = original_distribution[infinite_lights[i]];
+  }
+
+  if (num_emitters > 0) {
+    KernelLightTreeNode *knodes = dscene->light_tree_nodes.alloc(tree.num_nodes);
+    KernelLightTreeEmitter *kemitters = dscene->light_tree_emitters.alloc(num_emitters);
+    tree.pack(knodes, kemitters);
+    dscene->light_tree_nodes.copy_to_device();
+    dscene->light_tree_emitters.copy_to_device();
+  }
+
+  int *klookup = dscene->light_tree_lookup.alloc(lookup.size());
+  memcpy(klookup, &lookup[0], sizeof(int) * lookup.size());
+  dscene->light_tree_lookup.copy_to_device();
+
+  /* Sample the tree and the distant lights with the same probability. */
+  const float pdf_light_tree = (num_emitters == 0) ? 0.0f : (num_infinite > 0) ? 0.5f : 1.0f;
+  kintegrator->use_light_tree = true;
+  kintegrator->num_light_tree_emitters = num_emitters;
+  kintegrator->pdf_light_tree = pdf_light_tree;
+  kintegrator->pdf_lights = (num_infinite > 0) ? (1.0f - pdf_light_tree) / num_infinite : 0.0f;
+
+  VLOG(1) << "Light tree built with " << tree.num_nodes << " nodes for " << num_emitters
+          << " emitters, " << num_infinite << " distant lights sampled separately.";
+}
+
 static void background_cdf(
     int start, int end, int res_x, int res_y, const vector<float3> *pixels, float2 *cond_cdf)
 {
@@ -934,6 +1148,9 @@ void LightManager::device_update(Device *device,
 void LightManager::device_free(Device *, DeviceScene *dscene)
 {
   dscene->light_distribution.free();
+  dscene->light_tree_nodes.free();
+  dscene->light_tree_emitters.free();
+  dscene->light_tree_lookup.free();
   dscene->lights.free();
   dscene->light_background_marginal_cdf.free();
   dscene->light_background_conditional_cdf.free();
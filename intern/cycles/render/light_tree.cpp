@@ -0,0 +1,412 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/light_tree.h"
+
+#include "util/util_algorithm.h"
+#include "util/util_math.h"
+#include "util/util_progress.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Orientation Bounds */
+
+float OrientationBounds::measure() const
+{
+  const float theta_w = min(theta_o + theta_e, M_PI_F);
+  const float cos_o = cosf(theta_o);
+  const float sin_o = sinf(theta_o);
+
+  return M_2PI_F * (1.0f - cos_o) + M_PI_2_F * (2.0f * theta_w * sin_o -
+                                                cosf(theta_o - 2.0f * theta_w) -
+                                                2.0f * theta_o * sin_o + cos_o);
+}
+
+OrientationBounds merge(const OrientationBounds &cone_a, const OrientationBounds &cone_b)
+{
+  if (cone_a.is_empty()) {
+    return cone_b;
+  }
+  if (cone_b.is_empty()) {
+    return cone_a;
+  }
+
+  /* a is the bounds with the largest spread of normals. */
+  const bool swap_cones = (cone_b.theta_o > cone_a.theta_o);
+  const OrientationBounds &a = (swap_cones) ? cone_b : cone_a;
+  const OrientationBounds &b = (swap_cones) ? cone_a : cone_b;
+
+  const float theta_d = safe_acosf(dot(a.axis, b.axis));
+  const float theta_e = max(a.theta_e, b.theta_e);
+
+  /* The normals of b are within a. */
+  if (min(theta_d + b.theta_o, M_PI_F) <= a.theta_o) {
+    return OrientationBounds(a.axis, a.theta_o, theta_e);
+  }
+
+  /* Otherwise rotate the axis of a towards the axis of b, to cover both. */
+  const float theta_o = 0.5f * (a.theta_o + theta_d + b.theta_o);
+  if (theta_o >= M_PI_F) {
+    return OrientationBounds(a.axis, M_PI_F, theta_e);
+  }
+
+  const float3 ortho = b.axis - a.axis * dot(a.axis, b.axis);
+  const float ortho_len = len(ortho);
+  if (ortho_len < 1e-6f) {
+    return OrientationBounds(a.axis, M_PI_F, theta_e);
+  }
+
+  const float theta_r = theta_o - a.theta_o;
+  const float3 axis = normalize(a.axis * cosf(theta_r) + ortho * (sinf(theta_r) / ortho_len));
+  return OrientationBounds(axis, theta_o, theta_e);
+}
+
+/* Build Node */
+
+struct LightTreeBuildNode {
+  BoundBox bbox;
+  OrientationBounds bcone;
+  float energy;
+  int first_emitter;
+  int num_emitters;
+  LightTreeBuildNode *children[2];
+
+  LightTreeBuildNode()
+      : bbox(BoundBox::empty), energy(0.0f), first_emitter(0), num_emitters(0)
+  {
+    children[0] = children[1] = NULL;
+  }
+
+  ~LightTreeBuildNode()
+  {
+    delete children[0];
+    delete children[1];
+  }
+
+  bool is_leaf() const
+  {
+    return children[0] == NULL;
+  }
+};
+
+/* Cost of a node in the surface area orientation heuristic. */
+static float light_tree_cost(const BoundBox &bbox, const OrientationBounds &bcone, float energy)
+{
+  return energy * bcone.measure() * bbox.safe_area();
+}
+
+/* Bucket of an emitter along a dimension of the centroid bounds. */
+struct LightTreeBucketIndex {
+  LightTreeBucketIndex(const BoundBox &centroid_bbox, int dim, int num_buckets)
+      : dim(dim), num_buckets(num_buckets)
+  {
+    offset = centroid_bbox.min[dim];
+    const float extent = centroid_bbox.max[dim] - offset;
+    scale = (extent > 0.0f) ? num_buckets / extent : 0.0f;
+  }
+
+  int operator()(const LightTreeEmitter &emitter) const
+  {
+    const int bucket = (int)((emitter.centroid[dim] - offset) * scale);
+    return clamp(bucket, 0, num_buckets - 1);
+  }
+
+  int dim;
+  int num_buckets;
+  float offset;
+  float scale;
+};
+
+struct LightTreeBucketPredicate {
+  LightTreeBucketPredicate(const LightTreeBucketIndex &bucket_index, int split_bucket)
+      : bucket_index(bucket_index), split_bucket(split_bucket)
+  {
+  }
+
+  bool operator()(const LightTreeEmitter &emitter) const
+  {
+    return bucket_index(emitter) <= split_bucket;
+  }
+
+  LightTreeBucketIndex bucket_index;
+  int split_bucket;
+};
+
+struct LightTreeCentroidCompare {
+  explicit LightTreeCentroidCompare(int dim) : dim(dim)
+  {
+  }
+
+  bool operator()(const LightTreeEmitter &a, const LightTreeEmitter &b) const
+  {
+    return a.centroid[dim] < b.centroid[dim];
+  }
+
+  int dim;
+};
+
+/* Light Tree */
+
+LightTree::LightTree(vector<LightTreeEmitter> &emitters_, Progress &progress_)
+    : num_nodes(0), emitters(emitters_), root(NULL), progress(progress_)
+{
+  if (emitters.empty()) {
+    return;
+  }
+
+  root = new LightTreeBuildNode();
+  recursive_build(root, 0, emitters.size());
+  task_pool.wait_work();
+
+  num_nodes = count_nodes(root);
+}
+
+LightTree::~LightTree()
+{
+  delete root;
+}
+
+void LightTree::recursive_build(LightTreeBuildNode *node, int begin, int end)
+{
+  BoundBox centroid_bbox = BoundBox::empty;
+  for (int i = begin; i < end; i++) {
+    const LightTreeEmitter &emitter = emitters[i];
+    node->bbox.grow(emitter.bbox);
+    node->bcone = merge(node->bcone, emitter.bcone);
+    node->energy += emitter.energy;
+    centroid_bbox.grow(emitter.centroid);
+  }
+  node->first_emitter = begin;
+  node->num_emitters = end - begin;
+
+  if (node->num_emitters == 1 || progress.get_cancel()) {
+    return;
+  }
+
+  int middle;
+  if (!find_split(node, begin, end, centroid_bbox, &middle)) {
+    if (node->num_emitters <= LIGHT_TREE_MAX_LEAF_SIZE) {
+      return;
+    }
+
+    /* Too many emitters for a leaf and no useful split, typically when all centroids are the
+     * same. Split in two halves along the largest dimension. */
+    const float3 extent = centroid_bbox.size();
+    int dim = (extent.x >= extent.y) ? 0 : 1;
+    if (extent.z > extent[dim]) {
+      dim = 2;
+    }
+    middle = (begin + end) / 2;
+    std::nth_element(emitters.begin() + begin,
+                     emitters.begin() + middle,
+                     emitters.begin() + end,
+                     LightTreeCentroidCompare(dim));
+  }
+
+  node->children[0] = new LightTreeBuildNode();
+  node->children[1] = new LightTreeBuildNode();
+
+  if (node->num_emitters < THREAD_TASK_SIZE) {
+    recursive_build(node->children[0], begin, middle);
+    recursive_build(node->children[1], middle, end);
+  }
+  else {
+    /* Threaded build, the children write to separate ranges of the emitters. */
+    task_pool.push(
+        function_bind(&LightTree::recursive_build, this, node->children[0], begin, middle), true);
+    task_pool.push(
+        function_bind(&LightTree::recursive_build, this, node->children[1], middle, end), true);
+  }
+}
+
+bool LightTree::find_split(LightTreeBuildNode *node,
+                           int begin,
+                           int end,
+                           const BoundBox &centroid_bbox,
+                           int *r_middle)
+{
+  struct Bucket {
+    BoundBox bbox;
+    OrientationBounds bcone;
+    float energy;
+    int count;
+
+    Bucket() : bbox(BoundBox::empty), energy(0.0f), count(0)
+    {
+    }
+
+    void add(const Bucket &other)
+    {
+      bbox.grow(other.bbox);
+      bcone = merge(bcone, other.bcone);
+      energy += other.energy;
+      count += other.count;
+    }
+  };
+
+  const float3 extent = centroid_bbox.size();
+  const float max_extent = max3(extent);
+
+  float best_cost = FLT_MAX;
+  int best_dim = -1;
+  int best_bucket = -1;
+
+  for (int dim = 0; dim < 3; dim++) {
+    if (!(extent[dim] > 0.0f)) {
+      continue;
+    }
+
+    const LightTreeBucketIndex bucket_index(centroid_bbox, dim, NUM_BUCKETS);
+    Bucket buckets[NUM_BUCKETS];
+    for (int i = begin; i < end; i++) {
+      const LightTreeEmitter &emitter = emitters[i];
+      Bucket &bucket = buckets[bucket_index(emitter)];
+      bucket.bbox.grow(emitter.bbox);
+      bucket.bcone = merge(bucket.bcone, emitter.bcone);
+      bucket.energy += emitter.energy;
+      bucket.count++;
+    }
+
+    /* Cost of the emitters right of each split. */
+    float right_cost[NUM_BUCKETS];
+    int right_count[NUM_BUCKETS];
+    Bucket right;
+    for (int b = NUM_BUCKETS - 1; b > 0; b--) {
+      right.add(buckets[b]);
+      right_cost[b] = (right.count) ? light_tree_cost(right.bbox, right.bcone, right.energy) :
+                                      0.0f;
+      right_count[b] = right.count;
+    }
+
+    /* Regularization favoring splits of the longest dimension, since the cost of thin boxes is
+     * not lower along it. */
+    const float regularization = max_extent / extent[dim];
+
+    Bucket left;
+    for (int b = 0; b < NUM_BUCKETS - 1; b++) {
+      left.add(buckets[b]);
+      if (left.count == 0 || right_count[b + 1] == 0) {
+        continue;
+      }
+
+      const float cost = regularization *
+                         (light_tree_cost(left.bbox, left.bcone, left.energy) + right_cost[b + 1]);
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_dim = dim;
+        best_bucket = b;
+      }
+    }
+  }
+
+  if (best_dim == -1) {
+    return false;
+  }
+
+  /* Keep small nodes as leaves when splitting doesn't reduce the cost. */
+  if (node->num_emitters <= LIGHT_TREE_MAX_LEAF_SIZE &&
+      light_tree_cost(node->bbox, node->bcone, node->energy) <= best_cost) {
+    return false;
+  }
+
+  const LightTreeBucketIndex bucket_index(centroid_bbox, best_dim, NUM_BUCKETS);
+  vector<LightTreeEmitter>::iterator middle = std::partition(
+      emitters.begin() + begin,
+      emitters.begin() + end,
+      LightTreeBucketPredicate(bucket_index, best_bucket));
+  *r_middle = middle - emitters.begin();
+
+  return true;
+}
+
+int LightTree::count_nodes(const LightTreeBuildNode *node) const
+{
+  if (node->is_leaf()) {
+    return 1;
+  }
+  return 1 + count_nodes(node->children[0]) + count_nodes(node->children[1]);
+}
+
+int LightTree::pack_node(const LightTreeBuildNode *node,
+                         int parent,
+                         KernelLightTreeNode *knodes,
+                         KernelLightTreeEmitter *kemitters,
+                         int *next_index) const
+{
+  const int index = (*next_index)++;
+  KernelLightTreeNode &knode = knodes[index];
+
+  knode.bbox_min[0] = node->bbox.min.x;
+  knode.bbox_min[1] = node->bbox.min.y;
+  knode.bbox_min[2] = node->bbox.min.z;
+  knode.energy = node->energy;
+  knode.bbox_max[0] = node->bbox.max.x;
+  knode.bbox_max[1] = node->bbox.max.y;
+  knode.bbox_max[2] = node->bbox.max.z;
+  knode.theta_o = node->bcone.theta_o;
+  knode.axis[0] = node->bcone.axis.x;
+  knode.axis[1] = node->bcone.axis.y;
+  knode.axis[2] = node->bcone.axis.z;
+  knode.theta_e = node->bcone.theta_e;
+  knode.parent = parent;
+
+  if (node->is_leaf()) {
+    knode.second_child = -1;
+    knode.first_emitter = node->first_emitter;
+    knode.num_emitters = node->num_emitters;
+
+    for (int i = node->first_emitter; i < node->first_emitter + node->num_emitters; i++) {
+      kemitters[i].leaf = index;
+    }
+  }
+  else {
+    /* The first child directly follows its parent. */
+    knode.first_emitter = node->first_emitter;
+    knode.num_emitters = 0;
+    pack_node(node->children[0], index, knodes, kemitters, next_index);
+    knode.second_child = pack_node(node->children[1], index, knodes, kemitters, next_index);
+  }
+
+  return index;
+}
+
+void LightTree::pack(KernelLightTreeNode *knodes, KernelLightTreeEmitter *kemitters) const
+{
+  for (size_t i = 0; i < emitters.size(); i++) {
+    const LightTreeEmitter &emitter = emitters[i];
+    KernelLightTreeEmitter &kemitter = kemitters[i];
+
+    kemitter.centroid[0] = emitter.centroid.x;
+    kemitter.centroid[1] = emitter.centroid.y;
+    kemitter.centroid[2] = emitter.centroid.z;
+    kemitter.energy = emitter.energy;
+    kemitter.axis[0] = emitter.bcone.axis.x;
+    kemitter.axis[1] = emitter.bcone.axis.y;
+    kemitter.axis[2] = emitter.bcone.axis.z;
+    kemitter.theta_o = emitter.bcone.theta_o;
+    kemitter.theta_e = emitter.bcone.theta_e;
+    kemitter.radius = emitter.radius;
+    kemitter.area = emitter.area;
+    kemitter.leaf = -1;
+  }
+
+  if (root) {
+    int next_index = 0;
+    pack_node(root, -1, knodes, kemitters, &next_index);
+  }
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIGHT_TREE_H__
+#define __LIGHT_TREE_H__
+
+#include "kernel/kernel_types.h"
+
+#include "util/util_boundbox.h"
+#include "util/util_task.h"
+#include "util/util_types.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+class Progress;
+
+/* Bounds of the emission directions: the normals are within theta_o of the axis, and the
+ * emission is within theta_e of the normals. */
+struct OrientationBounds {
+  float3 axis;
+  float theta_o;
+  float theta_e;
+
+  /* Empty bounds. */
+  OrientationBounds() : axis(make_float3(0.0f, 0.0f, 1.0f)), theta_o(-1.0f), theta_e(0.0f)
+  {
+  }
+
+  OrientationBounds(const float3 &axis_, float theta_o_, float theta_e_)
+      : axis(axis_), theta_o(theta_o_), theta_e(theta_e_)
+  {
+  }
+
+  bool is_empty() const
+  {
+    return theta_o < 0.0f;
+  }
+
+  /* Measure of the directions covered by the bounds, weighted by the emission cosine. */
+  float measure() const;
+};
+
+OrientationBounds merge(const OrientationBounds &a, const OrientationBounds &b);
+
+/* Light with a position, a triangle or a point, spot or area lamp. */
+struct LightTreeEmitter {
+  BoundBox bbox;
+  float3 centroid;
+  /* Radius of the bounding sphere around the centroid. */
+  float radius;
+  OrientationBounds bcone;
+  float energy;
+  /* Triangle area, zero for lamps. */
+  float area;
+  /* Index of the emitter before the build. */
+  int index;
+};
+
+struct LightTreeBuildNode;
+
+/* Light Tree
+ *
+ * Binary tree of the emitters, split using the surface area orientation heuristic from
+ * "Importance Sampling of Many Lights with Adaptive Tree Splitting" (Conty Estevez and Kulla).
+ * The build reorders the emitters so every node references a contiguous range of them. */
+
+class LightTree {
+ public:
+  LightTree(vector<LightTreeEmitter> &emitters, Progress &progress);
+  ~LightTree();
+
+  int num_nodes;
+
+  /* Fill the kernel nodes and emitters, in the order of the reordered emitters. */
+  void pack(KernelLightTreeNode *knodes, KernelLightTreeEmitter *kemitters) const;
+
+ protected:
+  enum { THREAD_TASK_SIZE = 4096 };
+  enum { NUM_BUCKETS = 12 };
+
+  void recursive_build(LightTreeBuildNode *node, int begin, int end);
+  bool find_split(LightTreeBuildNode *node,
+                  int begin,
+                  int end,
+                  const BoundBox &centroid_bbox,
+                  int *r_middle);
+  int pack_node(const LightTreeBuildNode *node,
+                int parent,
+                KernelLightTreeNode *knodes,
+                KernelLightTreeEmitter *kemitters,
+                int *next_index) const;
+  int count_nodes(const LightTreeBuildNode *node) const;
+
+  /* Emitters, reordered by the build. */
+  vector<LightTreeEmitter> &emitters;
+  LightTreeBuildNode *root;
+
+  /* Progress reporting. */
+  Progress &progress;
+
+  /* Threads. */
+  TaskPool task_pool;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __LIGHT_TREE_H__ */
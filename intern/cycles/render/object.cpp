@@ -23,6 +23,7 @@
 #include "render/object.h"
 #include "render/particles.h"
 #include "render/scene.h"
+#include "render/stats.h"
 
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
@@ -110,6 +111,8 @@ Object::Object() : Node(node_type)
   particle_system = NULL;
   particle_index = 0;
   bounds = BoundBox::empty;
+  need_update = true;
+  index = -1;
 }
 
 Object::~Object()
@@ -205,6 +208,8 @@ void Object::apply_transform(bool apply_to_motion)
 
 void Object::tag_update(Scene *scene)
 {
+  need_update = true;
+
   if (geometry) {
     if (geometry->transform_applied)
       geometry->need_update = true;
@@ -216,7 +221,6 @@ void Object::tag_update(Scene *scene)
   }
 
   scene->camera->need_flags_update = true;
-  scene->curve_system_manager->need_update = true;
   scene->geometry_manager->need_update = true;
   scene->object_manager->need_update = true;
 }
@@ -277,6 +281,7 @@ ObjectManager::ObjectManager()
 {
   need_update = true;
   need_flags_update = true;
+  need_full_update = true;
 }
 
 ObjectManager::~ObjectManager()
@@ -347,6 +352,33 @@ static float object_surface_area(UpdateObjectTransformState *state,
   return surface_area;
 }
 
+/* Offsets of the object geometry data in the packed device arrays, return true if changed. */
+static bool object_update_mesh_offsets(KernelObject &kobject, Geometry *geom)
+{
+  bool update = false;
+
+  if (geom->type == Geometry::MESH) {
+    Mesh *mesh = static_cast<Mesh *>(geom);
+    if (mesh->patch_table) {
+      uint patch_map_offset = 2 * (mesh->patch_table_offset + mesh->patch_table->total_size() -
+                                   mesh->patch_table->num_nodes * PATCH_NODE_SIZE) -
+                              mesh->patch_offset;
+
+      if (kobject.patch_map_offset != patch_map_offset) {
+        kobject.patch_map_offset = patch_map_offset;
+        update = true;
+      }
+    }
+  }
+
+  if (kobject.attribute_map_offset != geom->attr_map_offset) {
+    kobject.attribute_map_offset = geom->attr_map_offset;
+    update = true;
+  }
+
+  return update;
+}
+
 void ObjectManager::device_update_object_transform(UpdateObjectTransformState *state, Object *ob)
 {
   KernelObject &kobject = state->objects[ob->index];
@@ -584,6 +616,14 @@ void ObjectManager::device_update(Device *device,
 
   VLOG(1) << "Total " << scene->objects.size() << " objects.";
 
+  if (!need_full_update && device_update_modified(dscene, scene, progress)) {
+    return;
+  }
+
+  bool objects_changed = dscene->objects.size() != scene->objects.size();
+
+  /* Until the update is done the device arrays are incomplete. */
+  need_full_update = true;
   device_free(device, dscene);
 
   if (scene->objects.size() == 0)
@@ -592,9 +632,17 @@ void ObjectManager::device_update(Device *device,
   /* Assign object IDs. */
   int index = 0;
   foreach (Object *object, scene->objects) {
+    if (object->index != index) {
+      objects_changed = true;
+    }
     object->index = index++;
   }
 
+  /* The geometry attributes and BVH refer to the objects by index. */
+  if (objects_changed) {
+    scene->geometry_manager->need_full_update = true;
+  }
+
   /* set object transform matrices, before applying static transforms */
   progress.set_status("Updating Objects", "Copying Transformations to device");
   device_update_transforms(dscene, scene, progress);
@@ -607,7 +655,115 @@ void ObjectManager::device_update(Device *device,
   if (scene->params.bvh_type == SceneParams::BVH_STATIC) {
     progress.set_status("Updating Objects", "Applying Static Transformations");
     apply_static_transforms(dscene, scene, progress);
+
+    if (progress.get_cancel())
+      return;
+  }
+
+  foreach (Object *object, scene->objects) {
+    object->need_update = false;
+  }
+  need_full_update = false;
+}
+
+bool ObjectManager::device_update_modified(DeviceScene *dscene, Scene *scene, Progress &progress)
+{
+  /* Static BVH applies the transforms to the geometry, which then needs a full update. */
+  if (scene->params.bvh_type != SceneParams::BVH_DYNAMIC) {
+    return false;
+  }
+
+  const size_t num_objects = scene->objects.size();
+  if (num_objects == 0 || dscene->objects.size() != num_objects) {
+    return false;
+  }
+
+  /* Offsets in the motion blur array depend on the motion steps of all objects. */
+  UpdateObjectTransformState state;
+  state.need_motion = scene->need_motion();
+  if (state.need_motion == Scene::MOTION_BLUR) {
+    return false;
+  }
+
+  const size_t motion_pass_size = (state.need_motion == Scene::MOTION_PASS) ?
+                                      OBJECT_MOTION_PASS_SIZE * num_objects :
+                                      0;
+  if (dscene->object_motion_pass.size() != motion_pass_size) {
+    return false;
+  }
+
+  /* Find the modified objects, the indices must be unchanged. */
+  vector<Object *> modified_objects;
+  for (size_t i = 0; i < num_objects; i++) {
+    Object *object = scene->objects[i];
+    if (object->index != (int)i) {
+      return false;
+    }
+    if (object->need_update || object->geometry->need_update) {
+      modified_objects.push_back(object);
+    }
+  }
+
+  /* Many objects are faster to update with the threaded update of all objects. */
+  if (num_objects >= 64 && modified_objects.size() * 4 > num_objects) {
+    return false;
+  }
+
+  progress.set_status("Updating Objects", "Copying Modified Transformations to device");
+
+  state.have_motion = dscene->data.bvh.have_motion;
+  state.have_curves = dscene->data.bvh.have_curves;
+  state.scene = scene;
+  state.queue_start_object = 0;
+  state.objects = dscene->objects.data();
+  state.object_flag = dscene->object_flag.data();
+  state.object_motion = NULL;
+  state.object_motion_pass = (state.need_motion == Scene::MOTION_PASS) ?
+                                 dscene->object_motion_pass.data() :
+                                 NULL;
+
+  int numparticles = 1;
+  foreach (ParticleSystem *psys, scene->particle_systems) {
+    state.particle_offset[psys] = numparticles;
+    numparticles += psys->particles.size();
+  }
+
+  int first_index = (int)num_objects, last_index = -1;
+  foreach (Object *object, modified_objects) {
+    device_update_object_transform(&state, object);
+
+    /* The geometry offsets are unchanged, or updated again by the geometry manager when it
+     * packs the geometry. */
+    object_update_mesh_offsets(state.objects[object->index], object->geometry);
+
+    first_index = min(first_index, object->index);
+    last_index = max(last_index, object->index);
+    object->need_update = false;
+
+    if (progress.get_cancel()) {
+      return true;
+    }
   }
+
+  /* Patch the modified range of the device arrays in place. */
+  if (last_index >= first_index) {
+    const size_t num_modified = last_index - first_index + 1;
+    dscene->objects.copy_to_device(first_index, num_modified);
+    if (state.need_motion == Scene::MOTION_PASS) {
+      dscene->object_motion_pass.copy_to_device(OBJECT_MOTION_PASS_SIZE * first_index,
+                                                OBJECT_MOTION_PASS_SIZE * num_modified);
+    }
+  }
+
+  /* Flags may only be added, clearing them requires to check all objects. */
+  dscene->data.bvh.have_motion = state.have_motion;
+  dscene->data.bvh.have_curves = state.have_curves;
+
+  scene->update_stats->num_partial_object_updates++;
+
+  VLOG(1) << "Updated " << modified_objects.size() << " modified objects.";
+
+  return true;
 }
 
 void ObjectManager::device_update_flags(
@@ -659,6 +815,8 @@ void ObjectManager::device_update_flags(
     }
 
     if (bounds_valid) {
+      /* Flags of objects which were not modified are kept from the previous update. */
+      object_flag[object->index] &= ~SD_OBJECT_INTERSECTS_VOLUME;
       foreach (Object *volume_object, volume_objects) {
         if (object == volume_object) {
           continue;
@@ -692,24 +850,7 @@ void ObjectManager::device_update_mesh_offsets(Device *, DeviceScene *dscene, Sc
   bool update = false;
 
   foreach (Object *object, scene->objects) {
-    Geometry *geom = object->geometry;
-
-    if (geom->type == Geometry::MESH) {
-      Mesh *mesh = static_cast<Mesh *>(geom);
-      if (mesh->patch_table) {
-        uint patch_map_offset = 2 * (mesh->patch_table_offset + mesh->patch_table->total_size() -
-                                     mesh->patch_table->num_nodes * PATCH_NODE_SIZE) -
-                                mesh->patch_offset;
-
-        if (kobjects[object->index].patch_map_offset != patch_map_offset) {
-          kobjects[object->index].patch_map_offset = patch_map_offset;
-          update = true;
-        }
-      }
-    }
-
-    if (kobjects[object->index].attribute_map_offset != geom->attr_map_offset) {
-      kobjects[object->index].attribute_map_offset = geom->attr_map_offset;
+    if (object_update_mesh_offsets(kobjects[object->index], object->geometry)) {
       update = true;
     }
   }
@@ -799,6 +940,7 @@ void ObjectManager::apply_static_transforms(DeviceScene *dscene, Scene *scene, P
 void ObjectManager::tag_update(Scene *scene)
 {
   need_update = true;
+  need_full_update = true;
   scene->curve_system_manager->need_update = true;
   scene->geometry_manager->need_update = true;
   scene->light_manager->need_update = true;
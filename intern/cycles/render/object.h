@@ -66,6 +66,10 @@ class Object : public Node {
   ParticleSystem *particle_system;
   int particle_index;
 
+  /* Set by tag_update(), the object manager only uploads the modified objects when the
+   * list of objects didn't change. */
+  bool need_update;
+
   Object();
   ~Object();
 
@@ -111,6 +115,8 @@ class ObjectManager {
  public:
   bool need_update;
   bool need_flags_update;
+  /* Update all objects, instead of only the objects tagged by Object::tag_update(). */
+  bool need_full_update;
 
   ObjectManager();
   ~ObjectManager();
@@ -135,6 +141,7 @@ class ObjectManager {
   string get_cryptomatte_assets(Scene *scene);
 
  protected:
+  bool device_update_modified(DeviceScene *dscene, Scene *scene, Progress &progress);
   void device_update_object_transform(UpdateObjectTransformState *state, Object *ob);
   void device_update_object_transform_task(UpdateObjectTransformState *state);
   bool device_update_object_transform_pop_work(UpdateObjectTransformState *state,
@@ -30,6 +30,7 @@
 #include "render/particles.h"
 #include "render/scene.h"
 #include "render/shader.h"
+#include "render/stats.h"
 #include "render/svm.h"
 #include "render/tables.h"
 
@@ -37,6 +38,7 @@
 #include "util/util_guarded_allocator.h"
 #include "util/util_logging.h"
 #include "util/util_progress.h"
+#include "util/util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -70,6 +72,9 @@ DeviceScene::DeviceScene(Device *device)
       attributes_float3(device, "__attributes_float3", MEM_TEXTURE),
       attributes_uchar4(device, "__attributes_uchar4", MEM_TEXTURE),
       light_distribution(device, "__light_distribution", MEM_TEXTURE),
+      light_tree_nodes(device, "__light_tree_nodes", MEM_TEXTURE),
+      light_tree_emitters(device, "__light_tree_emitters", MEM_TEXTURE),
+      light_tree_lookup(device, "__light_tree_lookup", MEM_TEXTURE),
       lights(device, "__lights", MEM_TEXTURE),
       light_background_marginal_cdf(device, "__light_background_marginal_cdf", MEM_TEXTURE),
       light_background_conditional_cdf(device, "__light_background_conditional_cdf", MEM_TEXTURE),
@@ -101,6 +106,7 @@ Scene::Scene(const SceneParams &params_, Device *device)
   particle_system_manager = new ParticleSystemManager();
   curve_system_manager = new CurveSystemManager();
   bake_manager = new BakeManager();
+  update_stats = new SceneUpdateStats();
 
   /* OSL only works on the CPU */
   if (device->info.has_osl)
@@ -172,9 +178,46 @@ void Scene::free_memory(bool final)
     delete curve_system_manager;
     delete image_manager;
     delete bake_manager;
+    delete update_stats;
   }
 }
 
+/* Accumulates the device update time of each manager in the scene update statistics. A
+ * manager is timed from its begin() call until the next one, or until the update ends or is
+ * cancelled. */
+class DeviceUpdateTimer {
+ public:
+  explicit DeviceUpdateTimer(SceneUpdateStats *stats)
+      : stats_(stats), name_(NULL), time_start_(0.0)
+  {
+  }
+
+  ~DeviceUpdateTimer()
+  {
+    end();
+  }
+
+  void begin(const char *name)
+  {
+    end();
+    name_ = name;
+    time_start_ = time_dt();
+  }
+
+  void end()
+  {
+    if (name_ != NULL) {
+      stats_->device_update.add_entry(NamedTimeEntry(name_, time_dt() - time_start_));
+      name_ = NULL;
+    }
+  }
+
+ protected:
+  SceneUpdateStats *stats_;
+  const char *name_;
+  double time_start_;
+};
+
 void Scene::device_update(Device *device_, Progress &progress)
 {
   if (!device)
@@ -182,6 +225,9 @@ void Scene::device_update(Device *device_, Progress &progress)
 
   bool print_stats = need_data_update();
 
+  DeviceUpdateTimer timer(update_stats);
+  update_stats->num_updates++;
+
   /* The order of updates is important, because there's dependencies between
    * the different managers, using data computed by previous managers.
    *
@@ -194,101 +240,118 @@ void Scene::device_update(Device *device_, Progress &progress)
    */
 
   progress.set_status("Updating Shaders");
+  timer.begin("Shaders");
   shader_manager->device_update(device, &dscene, this, progress);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
   progress.set_status("Updating Background");
+  timer.begin("Background");
   background->device_update(device, &dscene, this);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
   progress.set_status("Updating Camera");
+  timer.begin("Camera");
   camera->device_update(device, &dscene, this);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
+  timer.begin("Meshes Flags");
   geometry_manager->device_update_preprocess(device, this, progress);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
   progress.set_status("Updating Objects");
+  timer.begin("Objects");
   object_manager->device_update(device, &dscene, this, progress);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
   progress.set_status("Updating Hair Systems");
+  timer.begin("Hair Systems");
   curve_system_manager->device_update(device, &dscene, this, progress);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
   progress.set_status("Updating Particle Systems");
+  timer.begin("Particle Systems");
   particle_system_manager->device_update(device, &dscene, this, progress);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
   progress.set_status("Updating Meshes");
+  timer.begin("Meshes");
   geometry_manager->device_update(device, &dscene, this, progress);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
   progress.set_status("Updating Objects Flags");
+  timer.begin("Objects Flags");
   object_manager->device_update_flags(device, &dscene, this, progress);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
   progress.set_status("Updating Images");
+  timer.begin("Images");
   image_manager->device_update(device, this, progress);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
   progress.set_status("Updating Camera Volume");
+  timer.begin("Camera Volume");
   camera->device_update_volume(device, &dscene, this);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
   progress.set_status("Updating Lookup Tables");
+  timer.begin("Lookup Tables");
   lookup_tables->device_update(device, &dscene);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
   progress.set_status("Updating Lights");
+  timer.begin("Lights");
   light_manager->device_update(device, &dscene, this, progress);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
   progress.set_status("Updating Integrator");
+  timer.begin("Integrator");
   integrator->device_update(device, &dscene, this);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
   progress.set_status("Updating Film");
+  timer.begin("Film");
   film->device_update(device, &dscene, this);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
   progress.set_status("Updating Lookup Tables");
+  timer.begin("Lookup Tables");
   lookup_tables->device_update(device, &dscene);
 
   if (progress.get_cancel() || device->have_error())
     return;
 
   progress.set_status("Updating Baking");
+  timer.begin("Baking");
   bake_manager->device_update(device, &dscene, this, progress);
 
   if (progress.get_cancel() || device->have_error())
@@ -296,9 +359,12 @@ void Scene::device_update(Device *device_, Progress &progress)
 
   if (device->have_error() == false) {
     progress.set_status("Updating Device", "Writing constant memory");
+    timer.begin("Device Constants");
     device->const_copy_to("__data", &dscene.data, sizeof(dscene.data));
   }
 
+  timer.end();
+
   if (print_stats) {
     size_t mem_used = util_guarded_get_mem_used();
     size_t mem_peak = util_guarded_get_mem_peak();
@@ -394,6 +460,7 @@ void Scene::collect_statistics(RenderStats *stats)
 {
   geometry_manager->collect_statistics(this, stats);
   image_manager->collect_statistics(stats);
+  stats->update = *update_stats;
 }
 
 CCL_NAMESPACE_END
@@ -57,6 +57,7 @@ class Progress;
 class BakeManager;
 class BakeData;
 class RenderStats;
+class SceneUpdateStats;
 
 /* Scene Device Data */
 
@@ -104,6 +105,9 @@ class DeviceScene {
 
   /* lights */
   device_vector<KernelLightDistribution> light_distribution;
+  device_vector<KernelLightTreeNode> light_tree_nodes;
+  device_vector<KernelLightTreeEmitter> light_tree_emitters;
+  device_vector<int> light_tree_lookup;
   device_vector<KernelLight> lights;
   device_vector<float2> light_background_marginal_cdf;
   device_vector<float2> light_background_conditional_cdf;
@@ -169,6 +173,10 @@ class SceneParams {
   int num_bvh_time_steps;
   bool persistent_data;
   int texture_limit;
+  /* Read file image textures through a tiled cache with a memory budget in megabytes,
+   * only supported by the CPU device. */
+  bool use_texture_cache;
+  int texture_cache_size;
 
   bool background;
 
@@ -182,6 +190,8 @@ class SceneParams {
     num_bvh_time_steps = 0;
     persistent_data = false;
     texture_limit = 0;
+    use_texture_cache = false;
+    texture_cache_size = 1024;
     background = true;
   }
 
@@ -192,7 +202,9 @@ class SceneParams {
              use_bvh_spatial_split == params.use_bvh_spatial_split &&
              use_bvh_unaligned_nodes == params.use_bvh_unaligned_nodes &&
              num_bvh_time_steps == params.num_bvh_time_steps &&
-             persistent_data == params.persistent_data && texture_limit == params.texture_limit);
+             persistent_data == params.persistent_data && texture_limit == params.texture_limit &&
+             use_texture_cache == params.use_texture_cache &&
+             texture_cache_size == params.texture_cache_size);
   }
 };
 
@@ -244,6 +256,9 @@ class Scene {
   /* mutex must be locked manually by callers */
   thread_mutex mutex;
 
+  /* device update statistics */
+  SceneUpdateStats *update_stats;
+
   Scene(const SceneParams &params, Device *device);
   ~Scene();
 
@@ -34,6 +34,12 @@ bool namedSizeEntryComparator(const NamedSizeEntry &a, const NamedSizeEntry &b)
   return a.size > b.size;
 }
 
+bool namedTimeEntryComparator(const NamedTimeEntry &a, const NamedTimeEntry &b)
+{
+  /* We sort in descending order. */
+  return a.time > b.time;
+}
+
 bool namedTimeSampleEntryComparator(const NamedNestedSampleStats &a,
                                     const NamedNestedSampleStats &b)
 {
@@ -87,6 +93,54 @@ string NamedSizeStats::full_report(int indent_level)
   return result;
 }
 
+/* Named time entry. */
+
+NamedTimeEntry::NamedTimeEntry() : name(""), time(0.0), count(0)
+{
+}
+
+NamedTimeEntry::NamedTimeEntry(const string &name, double time)
+    : name(name), time(time), count(1)
+{
+}
+
+/* Named time statistics. */
+
+NamedTimeStats::NamedTimeStats() : total_time(0.0)
+{
+}
+
+void NamedTimeStats::add_entry(const NamedTimeEntry &entry)
+{
+  total_time += entry.time;
+  foreach (NamedTimeEntry &existing, entries) {
+    if (existing.name == entry.name) {
+      existing.time += entry.time;
+      existing.count += entry.count;
+      return;
+    }
+  }
+  entries.push_back(entry);
+}
+
+string NamedTimeStats::full_report(int indent_level)
+{
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+  const string double_indent = indent + indent;
+  string result = "";
+  result += string_printf("%sTotal time: %.4fs\n", indent.c_str(), total_time);
+  sort(entries.begin(), entries.end(), namedTimeEntryComparator);
+  foreach (const NamedTimeEntry &entry, entries) {
+    result += string_printf("%s%-32s %.4fs (%d updates, %.4fs average)\n",
+                            double_indent.c_str(),
+                            entry.name.c_str(),
+                            entry.time,
+                            entry.count,
+                            entry.time / max(entry.count, 1));
+  }
+  return result;
+}
+
 /* Named time sample statistics. */
 
 NamedNestedSampleStats::NamedNestedSampleStats() : name(""), self_samples(0), sum_samples(0)
@@ -210,6 +264,44 @@ string MeshStats::full_report(int indent_level)
   return result;
 }
 
+/* Texture cache statistics. */
+
+TextureCacheStats::TextureCacheStats()
+    : used(false),
+      num_files(0),
+      memory_used(0),
+      memory_limit(0),
+      images_size(0),
+      bytes_read(0),
+      tile_lookups(0),
+      tile_misses(0)
+{
+}
+
+string TextureCacheStats::full_report(int indent_level)
+{
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+  const uint64_t tile_hits = tile_lookups - min(tile_misses, tile_lookups);
+  const double hit_rate = (tile_lookups) ? 100.0 * tile_hits / tile_lookups : 0.0;
+  string result = "";
+  result += string_printf("%sFiles: %d\n", indent.c_str(), num_files);
+  result += string_printf("%sMemory: %s of %s\n",
+                          indent.c_str(),
+                          string_human_readable_size(memory_used).c_str(),
+                          string_human_readable_size(memory_limit).c_str());
+  result += string_printf("%sImages size: %s, read from files: %s\n",
+                          indent.c_str(),
+                          string_human_readable_size(images_size).c_str(),
+                          string_human_readable_size(bytes_read).c_str());
+  result += string_printf("%sTile lookups: %s, hits: %s, misses: %s (%.2f%% hit rate)\n",
+                          indent.c_str(),
+                          string_human_readable_number(tile_lookups).c_str(),
+                          string_human_readable_number(tile_hits).c_str(),
+                          string_human_readable_number(tile_misses).c_str(),
+                          hit_rate);
+  return result;
+}
+
 /* Image statistics. */
 
 ImageStats::ImageStats()
@@ -221,6 +313,34 @@ string ImageStats::full_report(int indent_level)
   const string indent(indent_level * kIndentNumSpaces, ' ');
   string result = "";
   result += indent + "Textures:\n" + textures.full_report(indent_level + 1);
+  if (cache.used) {
+    result += indent + "Texture cache:\n" + cache.full_report(indent_level + 1);
+  }
+  return result;
+}
+
+/* Scene update statistics. */
+
+SceneUpdateStats::SceneUpdateStats()
+    : num_updates(0),
+      num_partial_object_updates(0),
+      num_partial_geometry_updates(0),
+      num_scene_bvh_refits(0)
+{
+}
+
+string SceneUpdateStats::full_report(int indent_level)
+{
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+  string result = "";
+  result += string_printf("%sDevice updates: %d\n", indent.c_str(), num_updates);
+  result += string_printf(
+      "%sPartial object updates: %d\n", indent.c_str(), num_partial_object_updates);
+  result += string_printf(
+      "%sPartial geometry updates: %d\n", indent.c_str(), num_partial_geometry_updates);
+  result += string_printf("%sScene BVH refits: %d\n", indent.c_str(), num_scene_bvh_refits);
+  result += indent + "Managers:\n" + device_update.full_report(indent_level + 1);
+  result += indent + "BVH:\n" + bvh.full_report(indent_level + 1);
   return result;
 }
 
@@ -306,6 +426,7 @@ string RenderStats::full_report()
   string result = "";
   result += "Mesh statistics:\n" + mesh.full_report(1);
   result += "Image statistics:\n" + image.full_report(1);
+  result += "Scene update statistics:\n" + update.full_report(1);
   if (has_profiling) {
     result += "Kernel statistics:\n" + kernel.full_report(1);
     result += "Shader statistics:\n" + shaders.full_report(1);
@@ -64,6 +64,36 @@ class NamedSizeStats {
   vector<NamedSizeEntry> entries;
 };
 
+/* Named statistics entry, which corresponds to a time in seconds accumulated over a number
+ * of measurements. */
+class NamedTimeEntry {
+ public:
+  NamedTimeEntry();
+  NamedTimeEntry(const string &name, double time);
+
+  string name;
+  double time;
+  int count;
+};
+
+/* Container of named time entries, entries with the same name are accumulated. Used, for
+ * example, to store the device update time of each scene manager. */
+class NamedTimeStats {
+ public:
+  NamedTimeStats();
+
+  /* Add entry to the statistics. */
+  void add_entry(const NamedTimeEntry &entry);
+
+  /* Generate full human-readable report. */
+  string full_report(int indent_level = 0);
+
+  /* Total time of all entries. */
+  double total_time;
+
+  vector<NamedTimeEntry> entries;
+};
+
 class NamedNestedSampleStats {
  public:
   NamedNestedSampleStats();
@@ -124,6 +154,30 @@ class MeshStats {
   NamedSizeStats geometry;
 };
 
+/* Statistics about the image texture cache, which loads tiles of the image files on demand. */
+class TextureCacheStats {
+ public:
+  TextureCacheStats();
+
+  /* Generate full human-readable report. */
+  string full_report(int indent_level = 0);
+
+  bool used;
+  int num_files;
+
+  /* Memory used by the tiles and the budget of the cache. */
+  size_t memory_used;
+  size_t memory_limit;
+
+  /* Uncompressed size of all the files, and bytes actually read from them. */
+  size_t images_size;
+  size_t bytes_read;
+
+  /* Tile lookups, and the ones which had to read the tile from a file. */
+  uint64_t tile_lookups;
+  uint64_t tile_misses;
+};
+
 /* Statistics about images held in memory. */
 class ImageStats {
  public:
@@ -133,6 +187,29 @@ class ImageStats {
   string full_report(int indent_level = 0);
 
   NamedSizeStats textures;
+  TextureCacheStats cache;
+};
+
+/* Statistics about the synchronization of the scene to the device. */
+class SceneUpdateStats {
+ public:
+  SceneUpdateStats();
+
+  /* Generate full human-readable report. */
+  string full_report(int indent_level = 0);
+
+  /* Time spent in the device update of each manager, over all updates. */
+  NamedTimeStats device_update;
+  /* Time spent building the geometry BVHs and building or refitting the scene BVH. */
+  NamedTimeStats bvh;
+
+  int num_updates;
+  /* Object updates which only uploaded the modified objects. */
+  int num_partial_object_updates;
+  /* Geometry updates which only rebuilt the scene BVH, without packing the geometry. */
+  int num_partial_geometry_updates;
+  /* Partial geometry updates which refitted the scene BVH instead of building it. */
+  int num_scene_bvh_refits;
 };
 
 /* Render process statistics. */
@@ -150,6 +227,7 @@ class RenderStats {
 
   MeshStats mesh;
   ImageStats image;
+  SceneUpdateStats update;
   NamedNestedSampleStats kernel;
   NamedSampleCountStats shaders;
   NamedSampleCountStats objects;
@@ -317,6 +317,7 @@ class OBJECT_PT_instancing(ObjectButtonsPanel, Panel):
         elif ob.instance_type == 'COLLECTION':
             col = layout.column()
             col.prop(ob, "instance_collection", text="Collection")
+            col.prop(ob.game, "use_static_instances")
 
         if ob.instance_type != 'NONE' or ob.particle_systems:
             col = flow.column(align=True)
@@ -639,6 +639,8 @@ class NODE_PT_quality(bpy.types.Panel):
         col = layout.column()
         col.prop(tree, "use_opencl")
         col.prop(tree, "use_groupnode_buffer")
+        col.prop(tree, "use_buffer_execution")
+        col.prop(tree, "use_result_cache")
         col.prop(tree, "use_two_pass")
         col.prop(tree, "use_viewer_border")
         col.separator()
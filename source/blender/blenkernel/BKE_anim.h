@@ -69,6 +69,17 @@ struct ListBase *object_duplilist(struct Depsgraph *depsgraph,
                                   struct Object *ob);
 void free_object_duplilist(struct ListBase *lb);
 
+/**
+ * Instances given at runtime to a collection instancer, generated in place of the
+ * collection duplis. See #Object_Runtime.dupli_instances.
+ */
+typedef struct DupliInstances {
+  /* Original object and world matrix of each instance. */
+  struct Object **obs;
+  float (*mats)[4][4];
+  int len;
+} DupliInstances;
+
 typedef struct DupliObject {
   struct DupliObject *next, *prev;
   struct Object *ob;
@@ -190,6 +190,9 @@ enum {
 	/** On write, restore paths after editing them (G_FILE_RELATIVE_REMAP) */
 	G_FILE_SAVE_COPY         = (1 << 27),
 /* #define G_FILE_GLSL_NO_ENV_LIGHTING (1 << 28) */ /* deprecated */
+	/** With #G_FILE_COMPRESS, compress in independent blocks on all threads,
+	 * with an index to seek in the file. */
+	G_FILE_COMPRESS_BLOCKS   = (1 << 29),
 };
 
 /** Don't overwrite these flags when reading a file. */
@@ -53,6 +53,8 @@ void BKE_image_free_packedfiles(struct Image *image);
 void BKE_image_free_views(struct Image *image);
 void BKE_image_free_buffers(struct Image *image);
 void BKE_image_free_buffers_ex(struct Image *image, bool do_lock);
+/* changes whenever any image buffer is loaded, replaced or freed */
+unsigned int BKE_image_buffer_generation(void);
 /* call from library */
 void BKE_image_free(struct Image *image);
 
@@ -37,6 +37,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "IMB_colormanagement.h"
 #include "IMB_imbuf_types.h"
 #include "IMB_imbuf.h"
@@ -103,6 +105,20 @@
 static CLG_LogRef LOG = {"bke.image"};
 static ThreadMutex *image_mutex;
 
+/* Incremented whenever a cached image buffer is added, replaced or freed, so a buffer address
+ * together with it identifies the pixels it held (addresses get reused after a reload). */
+static uint32_t image_buffer_generation = 0;
+
+static void image_buffer_generation_tag(void)
+{
+  atomic_add_and_fetch_uint32(&image_buffer_generation, 1);
+}
+
+unsigned int BKE_image_buffer_generation(void)
+{
+  return atomic_fetch_and_add_uint32(&image_buffer_generation, 0);
+}
+
 /* prototypes */
 static int image_num_files(struct Image *ima);
 static ImBuf *image_acquire_ibuf(Image *ima, ImageUser *iuser, void **r_lock);
@@ -164,6 +180,7 @@ static void imagecache_put(Image *image, int index, ImBuf *ibuf)
   key.index = index;
 
   IMB_moviecache_put(image->cache, &key, ibuf);
+  image_buffer_generation_tag();
 }
 
 static void imagecache_remove(Image *image, int index)
@@ -175,6 +192,7 @@ static void imagecache_remove(Image *image, int index)
   ImageCacheKey key;
   key.index = index;
   IMB_moviecache_remove(image->cache, &key);
+  image_buffer_generation_tag();
 }
 
 static struct ImBuf *imagecache_get(Image *image, int index)
@@ -205,6 +223,7 @@ static void image_free_cached_frames(Image *image)
   if (image->cache) {
     IMB_moviecache_free(image->cache);
     image->cache = NULL;
+    image_buffer_generation_tag();
   }
 }
 
@@ -321,6 +321,22 @@ static const DupliGenerator gen_dupli_collection = {
     make_duplis_collection /* make_duplis */
 };
 
+/* OB_DUPLICOLLECTION with runtime instances */
+static void make_duplis_instances(const DupliContext *ctx)
+{
+  const DupliInstances *instances = DEG_get_original_object(ctx->object)->runtime.dupli_instances;
+
+  for (int i = 0; i < instances->len; i++) {
+    Object *ob = DEG_get_evaluated_object(ctx->depsgraph, instances->obs[i]);
+    make_dupli(ctx, ob, instances->mats[i], i);
+  }
+}
+
+static const DupliGenerator gen_dupli_instances = {
+    OB_DUPLICOLLECTION,   /* type */
+    make_duplis_instances /* make_duplis */
+};
+
 /* OB_DUPLIVERTS */
 typedef struct VertexDupliData {
   Mesh *me_eval;
@@ -1113,6 +1129,9 @@ static const DupliGenerator *get_dupli_generator(const DupliContext *ctx)
     }
   }
   else if (transflag & OB_DUPLICOLLECTION) {
+    if (DEG_get_original_object(ctx->object)->runtime.dupli_instances) {
+      return &gen_dupli_instances;
+    }
     return &gen_dupli_collection;
   }
 
@@ -89,6 +89,11 @@ typedef struct BVHTreeRayHit {
   float dist;
 } BVHTreeRayHit;
 
+enum {
+  /* Split the nodes with a binned surface area heuristic instead of the median of the largest
+   * axis, slower to build but faster to query on unevenly distributed geometry. */
+  BVH_BUILD_SAH = (1 << 0),
+};
 enum {
   /* Use a priority queue to process nodes in the optimal order (for slow callbacks) */
   BVH_OVERLAP_USE_THREADING = (1 << 0),
@@ -101,6 +106,9 @@ enum {
 enum {
   /* calculate IsectRayPrecalc data */
   BVH_RAYCAST_WATERTIGHT = (1 << 0),
+  /* Batched ray-cast only, cast the packets of rays on all threads
+   * (callback must be thread-safe). */
+  BVH_RAYCAST_USE_THREADING = (1 << 1),
 };
 #define BVH_RAYCAST_DEFAULT (BVH_RAYCAST_WATERTIGHT)
 #define BVH_RAYCAST_DIST_MAX (FLT_MAX / 2.0f)
@@ -144,6 +152,7 @@ typedef bool (*BVHTree_WalkOrderCallback)(const BVHTreeAxisRange *bounds,
                                           void *userdata);
 
 BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis);
+BVHTree *BLI_bvhtree_new_ex(int maxsize, float epsilon, char tree_type, char axis, int flag);
 void BLI_bvhtree_free(BVHTree *tree);
 
 /* construct: first insert points, then call balance */
@@ -231,6 +240,16 @@ void BLI_bvhtree_ray_cast_all(BVHTree *tree,
                               BVHTree_RayCastCallback callback,
                               void *userdata);
 
+int BLI_bvhtree_ray_cast_batch(BVHTree *tree,
+                               const float (*origins)[3],
+                               const float (*directions)[3],
+                               const int rays_len,
+                               float radius,
+                               BVHTreeRayHit *hits,
+                               BVHTree_RayCastCallback callback,
+                               void *userdata,
+                               int flag);
+
 float BLI_bvhtree_bb_raycast(const float bv[6],
                              const float light_start[3],
                              const float light_end[3],
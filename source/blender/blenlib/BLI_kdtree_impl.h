@@ -53,6 +53,20 @@ int BLI_kdtree_nd_(range_search)(const KDTree *tree,
                                  KDTreeNearest **r_nearest,
                                  const float range) ATTR_NONNULL(1, 2) ATTR_WARN_UNUSED_RESULT;
 
+int BLI_kdtree_nd_(find_nearest_n_batch)(const KDTree *tree,
+                                         const float (*co)[KD_DIMS],
+                                         const uint co_len,
+                                         KDTreeNearest *r_nearest,
+                                         int *r_nearest_len,
+                                         const uint nearest_len_capacity) ATTR_NONNULL(1, 2, 4, 5);
+int BLI_kdtree_nd_(range_search_batch)(const KDTree *tree,
+                                       const float (*co)[KD_DIMS],
+                                       const uint co_len,
+                                       const float range,
+                                       KDTreeNearest *r_nearest,
+                                       int *r_nearest_len,
+                                       const uint nearest_len_capacity) ATTR_NONNULL(1, 2, 5, 6);
+
 int BLI_kdtree_nd_(find_nearest_cb)(
     const KDTree *tree,
     const float co[KD_DIMS],
@@ -36,8 +36,9 @@ struct BLI_mempool;
 
 /* Task Scheduler
  *
- * Central scheduler that holds running threads ready to execute tasks. A single
- * queue holds the task from all pools.
+ * Central scheduler that holds running threads ready to execute tasks. Each thread
+ * has a deque of the tasks it pushed, it runs them first and idle threads steal them.
+ * A single queue holds the tasks pushed from other threads.
  *
  * Init/exit must be called before/after any task pools are created/freed, and
  * must be called from the main threads. All other scheduler and pool functions
@@ -113,8 +114,8 @@ void *BLI_task_pool_userdata(TaskPool *pool);
 ThreadMutex *BLI_task_pool_user_mutex(TaskPool *pool);
 
 /* Delayed push, use that to reduce thread overhead by accumulating
- * all new tasks into local queue first and pushing it to scheduler
- * from within a single mutex lock.
+ * all new tasks into the thread deque first and waking up idle threads
+ * only once at the end.
  */
 void BLI_task_pool_delayed_push_begin(TaskPool *pool, int thread_id);
 void BLI_task_pool_delayed_push_end(TaskPool *pool, int thread_id);
@@ -30,12 +30,17 @@
  *
  * - Ray-cast:
  *   #BLI_bvhtree_ray_cast, #BVHRayCastData
+ * - Batched ray-cast of ray packets:
+ *   #BLI_bvhtree_ray_cast_batch, #BVHRayPacket
  * - Nearest point on surface:
  *   #BLI_bvhtree_find_nearest, #BVHNearestData
  * - Overlapping 2 trees:
  *   #BLI_bvhtree_overlap, #BVHOverlapData_Shared, #BVHOverlapData_Thread
  * - Range Query:
  *   #BLI_bvhtree_range_query
+ *
+ * The tree is built by splitting the nodes at the median of their largest axis,
+ * or with a binned surface area heuristic, see #BVH_BUILD_SAH.
  */
 
 #include <assert.h>
@@ -50,8 +55,14 @@
 #include "BLI_task.h"
 #include "BLI_heap_simple.h"
 
+#include "atomic_ops.h"
+
 #include "BLI_strict_flags.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 /* used for iterative_raycast */
 // #define USE_SKIP_LINKS
 
@@ -72,6 +83,12 @@
 #  define KDOPBVH_THREAD_LEAF_THRESHOLD 1024
 #endif
 
+/* Number of bins per axis to evaluate the surface area heuristic. */
+#define BVH_SAH_BINS 16
+/* The top nodes are built on a single thread until the sub-trees are this fraction of the
+ * tree, then the sub-trees are built in parallel. */
+#define BVH_SAH_THREAD_SUBTREES 256
+
 /* -------------------------------------------------------------------- */
 /** \name Struct Definitions
  * \{ */
@@ -102,11 +119,12 @@ struct BVHTree {
   axis_t start_axis, stop_axis; /* bvhtree_kdop_axes array indices according to axis */
   axis_t axis;                  /* kdop type (6 => OBB, 7 => AABB, ...) */
   char tree_type;               /* type of tree (4 => quadtree) */
+  char flag;                    /* build options, BVH_BUILD_* */
 };
 
 /* optimization, ensure we stay small */
-BLI_STATIC_ASSERT((sizeof(void *) == 8 && sizeof(BVHTree) <= 48) ||
-                      (sizeof(void *) == 4 && sizeof(BVHTree) <= 32),
+BLI_STATIC_ASSERT((sizeof(void *) == 8 && sizeof(BVHTree) <= 56) ||
+                      (sizeof(void *) == 4 && sizeof(BVHTree) <= 36),
                   "over sized")
 
 /* avoid duplicating vars in BVHOverlapData_Thread */
@@ -859,14 +877,367 @@ static void non_recursive_bvh_div_nodes(const BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Surface Area Heuristic Build
+ *
+ * Alternative to #non_recursive_bvh_div_nodes for #BVH_BUILD_SAH.
+ *
+ * Each branch is split in two at the plane minimizing the surface area heuristic,
+ * evaluated over #BVH_SAH_BINS bins of the leaf centers along each axis.
+ * For trees of more than two children per branch,
+ * the child with the largest area is split again until the branch is full.
+ *
+ * Leafs are partitioned in place in the nodes array and the branches are allocated in the
+ * order they are created, so children always have a greater index than their parent.
+ * The bounding volumes are computed afterwards with #BLI_bvhtree_update_tree.
+ * \{ */
+
+typedef struct BVHSahBin {
+  float min[3], max[3];
+  int count;
+} BVHSahBin;
+
+/* Branch to build, from the leafs in the range [begin, end). */
+typedef struct BVHSahItem {
+  BVHNode *node;
+  int begin, end;
+  float area;
+} BVHSahItem;
+
+typedef struct BVHSahBuildData {
+  const BVHTree *tree;
+  BVHNode **leafs_array;
+  /* Number of allocated branches, atomic. */
+  int32_t branches_len;
+  BVHSahItem *subtrees;
+} BVHSahBuildData;
+
+static float bvh_sah_area(const float min[3], const float max[3])
+{
+  const float d[3] = {max[0] - min[0], max[1] - min[1], max[2] - min[2]};
+  if (d[0] < 0.0f || d[1] < 0.0f || d[2] < 0.0f) {
+    return 0.0f;
+  }
+  return d[0] * d[1] + d[1] * d[2] + d[2] * d[0];
+}
+
+static void bvh_sah_bounds_add(float min[3], float max[3], const float *bv)
+{
+  for (int axis = 0; axis < 3; axis++) {
+    min[axis] = min_ff(min[axis], bv[2 * axis]);
+    max[axis] = max_ff(max[axis], bv[2 * axis + 1]);
+  }
+}
+
+static void bvh_sah_bin_add(float min[3], float max[3], const BVHSahBin *bin)
+{
+  for (int axis = 0; axis < 3; axis++) {
+    min[axis] = min_ff(min[axis], bin->min[axis]);
+    max[axis] = max_ff(max[axis], bin->max[axis]);
+  }
+}
+
+BLI_INLINE float bvh_sah_center(const float *bv, const int axis)
+{
+  return (bv[2 * axis] + bv[2 * axis + 1]) * 0.5f;
+}
+
+BLI_INLINE int bvh_sah_bin_index(const float *bv,
+                                 const int axis,
+                                 const float center_min[3],
+                                 const float bin_scale[3])
+{
+  const int bin = (int)((bvh_sah_center(bv, axis) - center_min[axis]) * bin_scale[axis]);
+  return min_ii(max_ii(bin, 0), BVH_SAH_BINS - 1);
+}
+
+static float bvh_sah_range_area(BVHNode **leafs_array, const int begin, const int end)
+{
+  float min[3], max[3];
+  INIT_MINMAX(min, max);
+  for (int i = begin; i < end; i++) {
+    bvh_sah_bounds_add(min, max, leafs_array[i]->bv);
+  }
+  return bvh_sah_area(min, max);
+}
+
+/**
+ * Split the leafs in [begin, end) at the plane of lowest cost, return the first leaf
+ * of the second half.
+ */
+static int bvh_sah_split(
+    BVHNode **leafs_array, const int begin, const int end, int *r_axis, float r_area[2])
+{
+  float center_min[3], center_max[3], bin_scale[3];
+  BVHSahBin bins[3][BVH_SAH_BINS];
+  int axis, i;
+
+  if (end - begin == 2) {
+    *r_axis = get_largest_axis(leafs_array[begin]->bv) / 2;
+    r_area[0] = bvh_sah_range_area(leafs_array, begin, begin + 1);
+    r_area[1] = bvh_sah_range_area(leafs_array, begin + 1, end);
+    return begin + 1;
+  }
+
+  INIT_MINMAX(center_min, center_max);
+  for (i = begin; i < end; i++) {
+    const float *bv = leafs_array[i]->bv;
+    const float center[3] = {
+        bvh_sah_center(bv, 0), bvh_sah_center(bv, 1), bvh_sah_center(bv, 2)};
+    minmax_v3v3_v3(center_min, center_max, center);
+  }
+
+  for (axis = 0; axis < 3; axis++) {
+    const float extent = center_max[axis] - center_min[axis];
+    bin_scale[axis] = (extent > 0.0f) ? ((float)BVH_SAH_BINS * (1.0f - FLT_EPSILON) / extent) :
+                                        0.0f;
+    for (int b = 0; b < BVH_SAH_BINS; b++) {
+      INIT_MINMAX(bins[axis][b].min, bins[axis][b].max);
+      bins[axis][b].count = 0;
+    }
+  }
+
+  for (i = begin; i < end; i++) {
+    const float *bv = leafs_array[i]->bv;
+    for (axis = 0; axis < 3; axis++) {
+      BVHSahBin *bin = &bins[axis][bvh_sah_bin_index(bv, axis, center_min, bin_scale)];
+      bvh_sah_bounds_add(bin->min, bin->max, bv);
+      bin->count++;
+    }
+  }
+
+  float best_cost = FLT_MAX;
+  int best_axis = -1, best_bin = 0;
+  for (axis = 0; axis < 3; axis++) {
+    float right_area[BVH_SAH_BINS], min[3], max[3], area;
+    int right_count[BVH_SAH_BINS], count = 0;
+
+    if (bin_scale[axis] == 0.0f) {
+      continue;
+    }
+
+    INIT_MINMAX(min, max);
+    for (int b = BVH_SAH_BINS - 1; b > 0; b--) {
+      const BVHSahBin *bin = &bins[axis][b];
+      bvh_sah_bin_add(min, max, bin);
+      count += bin->count;
+      right_area[b] = bvh_sah_area(min, max);
+      right_count[b] = count;
+    }
+
+    INIT_MINMAX(min, max);
+    count = 0;
+    for (int b = 1; b < BVH_SAH_BINS; b++) {
+      const BVHSahBin *bin = &bins[axis][b - 1];
+      bvh_sah_bin_add(min, max, bin);
+      count += bin->count;
+      if (count == 0 || right_count[b] == 0) {
+        continue;
+      }
+      area = bvh_sah_area(min, max);
+      const float cost = area * (float)count + right_area[b] * (float)right_count[b];
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_axis = axis;
+        best_bin = b;
+        r_area[0] = area;
+        r_area[1] = right_area[b];
+      }
+    }
+  }
+
+  int mid;
+  if (best_axis == -1) {
+    /* All centers are at the same position, split in the middle. */
+    mid = (begin + end) / 2;
+    *r_axis = 0;
+    r_area[0] = bvh_sah_range_area(leafs_array, begin, mid);
+    r_area[1] = bvh_sah_range_area(leafs_array, mid, end);
+  }
+  else {
+    int j = end - 1;
+    i = begin;
+    while (i <= j) {
+      if (bvh_sah_bin_index(leafs_array[i]->bv, best_axis, center_min, bin_scale) < best_bin) {
+        i++;
+      }
+      else {
+        SWAP(BVHNode *, leafs_array[i], leafs_array[j]);
+        j--;
+      }
+    }
+    mid = i;
+    *r_axis = best_axis;
+  }
+
+  BLI_assert(mid > begin && mid < end);
+  return mid;
+}
+
+/**
+ * Split the leafs of a branch in its children,
+ * return the number of children which are branches to build, written to \a r_children.
+ */
+static int bvh_sah_build_node(BVHSahBuildData *data,
+                              const BVHSahItem *item,
+                              BVHSahItem r_children[MAX_TREETYPE])
+{
+  const BVHTree *tree = data->tree;
+  BVHNode **leafs_array = data->leafs_array;
+  BVHNode *node = item->node;
+  int range[MAX_TREETYPE][2];
+  float area[MAX_TREETYPE];
+  int range_len = 1, children_len = 0, main_axis = -1;
+  int k;
+
+  range[0][0] = item->begin;
+  range[0][1] = item->end;
+  area[0] = item->area;
+
+  while (range_len < tree->tree_type) {
+    int best = -1;
+    for (k = 0; k < range_len; k++) {
+      if ((range[k][1] - range[k][0] > 1) && (best == -1 || area[k] > area[best])) {
+        best = k;
+      }
+    }
+    if (best == -1) {
+      break;
+    }
+
+    int axis;
+    float split_area[2];
+    const int mid = bvh_sah_split(leafs_array, range[best][0], range[best][1], &axis, split_area);
+    if (main_axis == -1) {
+      main_axis = axis;
+    }
+
+    /* Keep the children ordered along the axes they were split on. */
+    for (k = range_len; k > best + 1; k--) {
+      copy_v2_v2_int(range[k], range[k - 1]);
+      area[k] = area[k - 1];
+    }
+    range[best + 1][0] = mid;
+    range[best + 1][1] = range[best][1];
+    range[best][1] = mid;
+    area[best] = split_area[0];
+    area[best + 1] = split_area[1];
+    range_len++;
+  }
+
+  node->main_axis = (char)max_ii(main_axis, 0);
+  node->totnode = (char)range_len;
+
+  for (k = 0; k < tree->tree_type; k++) {
+    BVHNode *child = NULL;
+    if (k < range_len) {
+      if (range[k][1] - range[k][0] == 1) {
+        child = leafs_array[range[k][0]];
+      }
+      else {
+        const int branch = atomic_fetch_and_add_int32(&data->branches_len, 1);
+        child = &tree->nodearray[tree->totleaf + branch];
+        r_children[children_len].node = child;
+        r_children[children_len].begin = range[k][0];
+        r_children[children_len].end = range[k][1];
+        r_children[children_len].area = area[k];
+        children_len++;
+      }
+      child->parent = node;
+    }
+    node->children[k] = child;
+  }
+
+  return children_len;
+}
+
+static void bvh_sah_build_subtree_cb(void *__restrict userdata,
+                                     const int index,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BVHSahBuildData *data = userdata;
+  BVHSahItem children[MAX_TREETYPE];
+  BLI_Stack *stack = BLI_stack_new(sizeof(BVHSahItem), __func__);
+
+  BLI_stack_push(stack, &data->subtrees[index]);
+  while (!BLI_stack_is_empty(stack)) {
+    BVHSahItem item;
+    BLI_stack_pop(stack, &item);
+    const int children_len = bvh_sah_build_node(data, &item, children);
+    for (int k = 0; k < children_len; k++) {
+      BLI_stack_push(stack, &children[k]);
+    }
+  }
+
+  BLI_stack_free(stack);
+}
+
+/**
+ * Build the branches from the leafs, return the number of branches.
+ */
+static int bvh_sah_build(const BVHTree *tree, BVHNode **leafs_array)
+{
+  BVHSahBuildData data = {
+      .tree = tree,
+      .leafs_array = leafs_array,
+      .branches_len = 1,
+      .subtrees = NULL,
+  };
+  const int subtree_leafs_max = max_ii(tree->totleaf / BVH_SAH_THREAD_SUBTREES,
+                                       KDOPBVH_THREAD_LEAF_THRESHOLD);
+  BVHSahItem item, children[MAX_TREETYPE];
+
+  item.node = &tree->nodearray[tree->totleaf];
+  item.node->parent = NULL;
+  item.begin = 0;
+  item.end = tree->totleaf;
+  item.area = bvh_sah_range_area(leafs_array, 0, tree->totleaf);
+
+  /* Build the top of the tree, the branches with few leafs are built in parallel after. */
+  BLI_Stack *stack = BLI_stack_new(sizeof(BVHSahItem), __func__);
+  BLI_Stack *subtrees = BLI_stack_new(sizeof(BVHSahItem), __func__);
+  BLI_stack_push(stack, &item);
+  while (!BLI_stack_is_empty(stack)) {
+    BLI_stack_pop(stack, &item);
+    if (item.end - item.begin <= subtree_leafs_max) {
+      BLI_stack_push(subtrees, &item);
+      continue;
+    }
+    const int children_len = bvh_sah_build_node(&data, &item, children);
+    for (int k = 0; k < children_len; k++) {
+      BLI_stack_push(stack, &children[k]);
+    }
+  }
+  BLI_stack_free(stack);
+
+  const int subtrees_len = (int)BLI_stack_count(subtrees);
+  if (subtrees_len) {
+    data.subtrees = MEM_mallocN(sizeof(*data.subtrees) * (size_t)subtrees_len, __func__);
+    BLI_stack_pop_n(subtrees, data.subtrees, (uint)subtrees_len);
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (tree->totleaf > KDOPBVH_THREAD_LEAF_THRESHOLD);
+    BLI_task_parallel_range(0, subtrees_len, &data, bvh_sah_build_subtree_cb, &settings);
+
+    MEM_freeN(data.subtrees);
+  }
+  BLI_stack_free(subtrees);
+
+  return data.branches_len;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree API
  * \{ */
 
 /**
+ * \param flag: Build options, #BVH_BUILD_SAH.
  * \note many callers don't check for ``NULL`` return.
  */
-BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis)
+BVHTree *BLI_bvhtree_new_ex(int maxsize, float epsilon, char tree_type, char axis, int flag)
 {
   BVHTree *tree;
   int numnodes, i;
@@ -885,6 +1256,7 @@ BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis)
     tree->epsilon = epsilon;
     tree->tree_type = tree_type;
     tree->axis = axis;
+    tree->flag = (char)flag;
 
     if (axis == 26) {
       tree->start_axis = 0;
@@ -913,8 +1285,12 @@ BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis)
       goto fail;
     }
 
-    /* Allocate arrays */
-    numnodes = maxsize + implicit_needed_branches(tree_type, maxsize) + tree_type;
+    /* Allocate arrays, the number of branches of a SAH tree depends on the leafs position,
+     * at most one less than the number of leafs. */
+    numnodes = maxsize +
+               ((flag & BVH_BUILD_SAH) ? max_ii(1, maxsize - 1) :
+                                         implicit_needed_branches(tree_type, maxsize)) +
+               tree_type;
 
     tree->nodes = MEM_callocN(sizeof(BVHNode *) * (size_t)numnodes, "BVHNodes");
     tree->nodebv = MEM_callocN(sizeof(float) * (size_t)(axis * numnodes), "BVHNodeBV");
@@ -938,6 +1314,11 @@ fail:
   return NULL;
 }
 
+BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis)
+{
+  return BLI_bvhtree_new_ex(maxsize, epsilon, tree_type, axis, 0);
+}
+
 void BLI_bvhtree_free(BVHTree *tree)
 {
   if (tree) {
@@ -957,17 +1338,31 @@ void BLI_bvhtree_balance(BVHTree *tree)
    * (some big bug goes here if its being called more than once per tree) */
   BLI_assert(tree->totbranch == 0);
 
-  /* Build the implicit tree */
-  non_recursive_bvh_div_nodes(
-      tree, tree->nodearray + (tree->totleaf - 1), leafs_array, tree->totleaf);
+  /* The heuristic uses the X, Y and Z axes, only available when the k-DOP starts with them. */
+  const bool use_sah = (tree->flag & BVH_BUILD_SAH) && (tree->start_axis == 0) &&
+                       (tree->totleaf > 1);
+
+  if (use_sah) {
+    tree->totbranch = bvh_sah_build(tree, leafs_array);
+  }
+  else {
+    /* Build the implicit tree */
+    non_recursive_bvh_div_nodes(
+        tree, tree->nodearray + (tree->totleaf - 1), leafs_array, tree->totleaf);
+    tree->totbranch = implicit_needed_branches(tree->tree_type, tree->totleaf);
+  }
 
   /* current code expects the branches to be linked to the nodes array
    * we perform that linkage here */
-  tree->totbranch = implicit_needed_branches(tree->tree_type, tree->totleaf);
   for (int i = 0; i < tree->totbranch; i++) {
     tree->nodes[tree->totleaf + i] = &tree->nodearray[tree->totleaf + i];
   }
 
+  if (use_sah) {
+    /* Compute the bounding volumes of the branches. */
+    BLI_bvhtree_update_tree(tree);
+  }
+
 #ifdef USE_SKIP_LINKS
   build_skip_links(tree, tree->nodes[tree->totleaf], NULL, NULL);
 #endif
@@ -1989,6 +2384,271 @@ void BLI_bvhtree_ray_cast_all(BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name BLI_bvhtree_ray_cast_batch
+ *
+ * Casts many rays at once: consecutive rays are grouped in packets which traverse the tree
+ * together, so each node is fetched once per packet and tested against all its rays with SIMD.
+ * Packets are most efficient for coherent rays (close origins and similar directions).
+ *
+ * \{ */
+
+/* Number of rays traversing the tree together, the width of the SIMD slab test. */
+#define BVH_RAY_PACKET_SIZE 4
+
+/* Minimum number of packets handled by a thread. */
+#define BVH_RAY_PACKET_THREAD_MIN 16
+
+typedef struct BVHRayPacket {
+  /* The rays as structure of arrays, to test a node against all of them at once. */
+  float origin[3][BVH_RAY_PACKET_SIZE];
+  float idot_axis[3][BVH_RAY_PACKET_SIZE];
+  /* Distance of the current hit of each ray. */
+  float dist[BVH_RAY_PACKET_SIZE];
+  /* Sum of the ray directions, used to pick the order the children are traversed. */
+  float direction_sum[3];
+  /* Rays used in the packet, the last packet may be partially filled. */
+  int mask;
+
+  BVHTreeRay ray[BVH_RAY_PACKET_SIZE];
+  BVHTreeRayHit *hit[BVH_RAY_PACKET_SIZE];
+#ifdef USE_KDOPBVH_WATERTIGHT
+  struct IsectRayPrecalc isect_precalc[BVH_RAY_PACKET_SIZE];
+#endif
+} BVHRayPacket;
+
+typedef struct BVHRayCastBatchData {
+  const BVHTree *tree;
+  const float (*origins)[3];
+  const float (*directions)[3];
+  int rays_len;
+  float radius;
+  BVHTreeRayHit *hits;
+
+  BVHTree_RayCastCallback callback;
+  void *userdata;
+  int flag;
+} BVHRayCastBatchData;
+
+/**
+ * Slab test of a node against the rays of a packet, the same test as #fast_ray_nearest_hit
+ * or #ray_nearest_hit when the rays have a radius.
+ *
+ * \return The mask of the rays reaching the node before their current hit.
+ */
+static int ray_packet_nearest_hit(const BVHRayPacket *packet,
+                                  const float radius,
+                                  const float bv[6],
+                                  const int mask,
+                                  float r_dist[BVH_RAY_PACKET_SIZE])
+{
+  /* Rays with a radius only hit nodes in front of their origin. */
+  const float near_init = (radius == 0.0f) ? -FLT_MAX : 0.0f;
+
+#ifdef __SSE2__
+  __m128 near = _mm_set1_ps(near_init);
+  __m128 far = _mm_set1_ps(FLT_MAX);
+
+  for (int i = 0; i != 3; i++, bv += 2) {
+    const __m128 origin = _mm_loadu_ps(packet->origin[i]);
+    const __m128 idot = _mm_loadu_ps(packet->idot_axis[i]);
+    const __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bv[0] - radius), origin), idot);
+    const __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bv[1] + radius), origin), idot);
+    near = _mm_max_ps(near, _mm_min_ps(t1, t2));
+    far = _mm_min_ps(far, _mm_max_ps(t1, t2));
+  }
+
+  const __m128 hit = _mm_and_ps(_mm_cmple_ps(_mm_max_ps(near, _mm_setzero_ps()), far),
+                                _mm_cmplt_ps(near, _mm_loadu_ps(packet->dist)));
+  _mm_storeu_ps(r_dist, near);
+  return _mm_movemask_ps(hit) & mask;
+#else
+  int hit_mask = 0;
+
+  for (int lane = 0; lane < BVH_RAY_PACKET_SIZE; lane++) {
+    float near = near_init;
+    float far = FLT_MAX;
+
+    for (int i = 0; i != 3; i++) {
+      const float t1 = (bv[2 * i] - radius - packet->origin[i][lane]) * packet->idot_axis[i][lane];
+      const float t2 = (bv[2 * i + 1] + radius - packet->origin[i][lane]) *
+                       packet->idot_axis[i][lane];
+      near = max_ff(near, min_ff(t1, t2));
+      far = min_ff(far, max_ff(t1, t2));
+    }
+
+    if (max_ff(near, 0.0f) <= far && near < packet->dist[lane]) {
+      hit_mask |= (1 << lane);
+    }
+    r_dist[lane] = near;
+  }
+  return hit_mask & mask;
+#endif
+}
+
+static void dfs_raycast_packet(const BVHRayCastBatchData *data,
+                               BVHRayPacket *packet,
+                               const BVHNode *node,
+                               int mask)
+{
+  float dist[BVH_RAY_PACKET_SIZE];
+
+  mask = ray_packet_nearest_hit(packet, data->radius, node->bv, mask, dist);
+  if (mask == 0) {
+    return;
+  }
+
+  if (node->totnode == 0) {
+    for (int lane = 0; lane < BVH_RAY_PACKET_SIZE; lane++) {
+      if ((mask & (1 << lane)) == 0) {
+        continue;
+      }
+
+      BVHTreeRayHit *hit = packet->hit[lane];
+      if (data->callback) {
+        data->callback(data->userdata, node->index, &packet->ray[lane], hit);
+      }
+      else {
+        hit->index = node->index;
+        hit->dist = dist[lane];
+        madd_v3_v3v3fl(hit->co, packet->ray[lane].origin, packet->ray[lane].direction, dist[lane]);
+      }
+      packet->dist[lane] = hit->dist;
+    }
+  }
+  else {
+    /* pick loop direction to dive into the tree (based on rays direction and split axis) */
+    if (packet->direction_sum[node->main_axis] > 0.0f) {
+      for (int i = 0; i != node->totnode; i++) {
+        dfs_raycast_packet(data, packet, node->children[i], mask);
+      }
+    }
+    else {
+      for (int i = node->totnode - 1; i >= 0; i--) {
+        dfs_raycast_packet(data, packet, node->children[i], mask);
+      }
+    }
+  }
+}
+
+static void bvhtree_ray_packet_init(const BVHRayCastBatchData *data,
+                                    const int ray_start,
+                                    BVHRayPacket *packet)
+{
+  zero_v3(packet->direction_sum);
+  packet->mask = 0;
+
+  for (int lane = 0; lane < BVH_RAY_PACKET_SIZE; lane++) {
+    const int ray_index = ray_start + lane;
+
+    if (ray_index >= data->rays_len) {
+      /* Unused lane, never closer than its hit. */
+      for (int i = 0; i < 3; i++) {
+        packet->origin[i][lane] = 0.0f;
+        packet->idot_axis[i][lane] = 0.0f;
+      }
+      packet->dist[lane] = -FLT_MAX;
+      packet->hit[lane] = NULL;
+      continue;
+    }
+
+    BVHTreeRay *ray = &packet->ray[lane];
+    copy_v3_v3(ray->origin, data->origins[ray_index]);
+    copy_v3_v3(ray->direction, data->directions[ray_index]);
+    ray->radius = data->radius;
+
+    BLI_ASSERT_UNIT_V3(ray->direction);
+
+    for (int i = 0; i < 3; i++) {
+      const float ray_dot_axis = ray->direction[i];
+      packet->origin[i][lane] = ray->origin[i];
+      packet->idot_axis[i][lane] = (fabsf(ray_dot_axis) < FLT_EPSILON) ? FLT_MAX :
+                                                                          1.0f / ray_dot_axis;
+    }
+    add_v3_v3(packet->direction_sum, ray->direction);
+
+#ifdef USE_KDOPBVH_WATERTIGHT
+    if (data->flag & BVH_RAYCAST_WATERTIGHT) {
+      isect_ray_tri_watertight_v3_precalc(&packet->isect_precalc[lane], ray->direction);
+      ray->isect_precalc = &packet->isect_precalc[lane];
+    }
+    else {
+      ray->isect_precalc = NULL;
+    }
+#endif
+
+    packet->hit[lane] = &data->hits[ray_index];
+    packet->dist[lane] = data->hits[ray_index].dist;
+    packet->mask |= (1 << lane);
+  }
+}
+
+static void bvhtree_ray_cast_batch_task_cb(void *__restrict userdata,
+                                           const int packet_index,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHRayCastBatchData *data = userdata;
+  const BVHNode *root = data->tree->nodes[data->tree->totleaf];
+  BVHRayPacket packet;
+
+  bvhtree_ray_packet_init(data, packet_index * BVH_RAY_PACKET_SIZE, &packet);
+  dfs_raycast_packet(data, &packet, root, packet.mask);
+}
+
+/**
+ * Cast an array of rays, the batched version of #BLI_bvhtree_ray_cast_ex.
+ *
+ * \param hits: One hit per ray, initialized by the caller like the \a hit argument of
+ * #BLI_bvhtree_ray_cast_ex (index -1 and the maximum distance of the ray).
+ * \param callback: Must be thread-safe when #BVH_RAYCAST_USE_THREADING is used.
+ * \return The number of rays which hit something.
+ */
+int BLI_bvhtree_ray_cast_batch(BVHTree *tree,
+                               const float (*origins)[3],
+                               const float (*directions)[3],
+                               const int rays_len,
+                               float radius,
+                               BVHTreeRayHit *hits,
+                               BVHTree_RayCastCallback callback,
+                               void *userdata,
+                               int flag)
+{
+  const BVHNode *root = tree->nodes[tree->totleaf];
+
+  if (root != NULL && rays_len > 0) {
+    BVHRayCastBatchData data = {
+        .tree = tree,
+        .origins = origins,
+        .directions = directions,
+        .rays_len = rays_len,
+        .radius = radius,
+        .hits = hits,
+        .callback = callback,
+        .userdata = userdata,
+        .flag = flag,
+    };
+    const int packets_len = (rays_len + BVH_RAY_PACKET_SIZE - 1) / BVH_RAY_PACKET_SIZE;
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (flag & BVH_RAYCAST_USE_THREADING) &&
+                             (packets_len > BVH_RAY_PACKET_THREAD_MIN);
+    settings.min_iter_per_thread = BVH_RAY_PACKET_THREAD_MIN;
+
+    BLI_task_parallel_range(0, packets_len, &data, bvhtree_ray_cast_batch_task_cb, &settings);
+  }
+
+  int hits_len = 0;
+  for (int i = 0; i < rays_len; i++) {
+    if (hits[i].index != -1) {
+      hits_len++;
+    }
+  }
+  return hits_len;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree_range_query
  *
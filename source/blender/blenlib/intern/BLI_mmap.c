@@ -0,0 +1,160 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bli
+ *
+ * Read-only memory mapping of files, used to read files in place instead of
+ * copying their content into allocated buffers.
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef WIN32
+#  include <io.h>
+#  include <windows.h>
+#else
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
+#if defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__) || \
+    defined(__DragonFly__)
+#  include <sys/param.h>
+#  include <sys/mount.h>
+#  define USE_STATFS_MNT_LOCAL
+#elif defined(__linux__)
+#  include <sys/vfs.h>
+#  define USE_STATFS_MAGIC
+#endif
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_mmap.h"
+#include "BLI_utildefines.h"
+
+struct BLI_mmap_file {
+  void *memory;
+  size_t length;
+#ifdef WIN32
+  HANDLE handle;
+#endif
+};
+
+/* Network file systems can fail reading a page long after the file is opened,
+ * only map files from local drives. */
+static bool mmap_file_is_local(int fd)
+{
+#if defined(WIN32)
+  FILE_REMOTE_PROTOCOL_INFO info;
+  /* Only succeeds for files opened through a network redirector. */
+  return !GetFileInformationByHandleEx(
+      (HANDLE)_get_osfhandle(fd), FileRemoteProtocolInfo, &info, sizeof(info));
+#elif defined(USE_STATFS_MNT_LOCAL)
+  struct statfs disk;
+  if (fstatfs(fd, &disk) != 0) {
+    return false;
+  }
+  return (disk.f_flags & MNT_LOCAL) != 0;
+#elif defined(USE_STATFS_MAGIC)
+  struct statfs disk;
+  if (fstatfs(fd, &disk) != 0) {
+    return false;
+  }
+  switch ((unsigned int)disk.f_type) {
+    case 0x6969:     /* NFS */
+    case 0x517B:     /* SMB */
+    case 0xFF534D42: /* CIFS */
+    case 0xFE534D42: /* SMB2 */
+    case 0x564c:     /* NCP */
+    case 0x5346414F: /* AFS */
+    case 0x65735546: /* FUSE (sshfs and other remote file systems) */
+      return false;
+    default:
+      return true;
+  }
+#else
+  UNUSED_VARS(fd);
+  return false;
+#endif
+}
+
+BLI_mmap_file *BLI_mmap_open(int fd)
+{
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+    return NULL;
+  }
+  /* Files larger than the address space on 32 bit systems. */
+  if ((uint64_t)st.st_size > (uint64_t)SIZE_MAX) {
+    return NULL;
+  }
+  if (!mmap_file_is_local(fd)) {
+    return NULL;
+  }
+
+  const size_t length = (size_t)st.st_size;
+  void *memory;
+
+#ifdef WIN32
+  HANDLE handle = CreateFileMapping(
+      (HANDLE)_get_osfhandle(fd), NULL, PAGE_READONLY, 0, 0, NULL);
+  if (handle == NULL) {
+    return NULL;
+  }
+  memory = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0);
+  if (memory == NULL) {
+    CloseHandle(handle);
+    return NULL;
+  }
+#else
+  memory = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (memory == MAP_FAILED) {
+    return NULL;
+  }
+#endif
+
+  BLI_mmap_file *file = MEM_callocN(sizeof(BLI_mmap_file), __func__);
+  file->memory = memory;
+  file->length = length;
+#ifdef WIN32
+  file->handle = handle;
+#endif
+
+  return file;
+}
+
+const void *BLI_mmap_get_pointer(const BLI_mmap_file *file)
+{
+  return file->memory;
+}
+
+size_t BLI_mmap_get_length(const BLI_mmap_file *file)
+{
+  return file->length;
+}
+
+void BLI_mmap_free(BLI_mmap_file *file)
+{
+#ifdef WIN32
+  UnmapViewOfFile(file->memory);
+  CloseHandle(file->handle);
+#else
+  munmap(file->memory, file->length);
+#endif
+  MEM_freeN(file);
+}
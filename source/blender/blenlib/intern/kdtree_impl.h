@@ -22,6 +22,7 @@
 
 #include "BLI_math.h"
 #include "BLI_kdtree_impl.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 #include "BLI_strict_flags.h"
 
@@ -56,6 +57,13 @@ struct KDTree {
 #define KD_NEAR_ALLOC_INC 100 /* alloc increment for collecting nearest */
 #define KD_FOUND_ALLOC_INC 50 /* alloc increment for collecting nearest */
 
+/* Minimum number of nodes to balance the tree in parallel. */
+#define KD_BALANCE_THREAD_MIN 10000
+/* Number of levels split before balancing the sub-trees in parallel. */
+#define KD_BALANCE_THREAD_DEPTH 6
+/* Minimum number of points per thread for batched queries. */
+#define KD_BATCH_THREAD_MIN 256
+
 #define KD_NODE_UNSET ((uint)-1)
 
 /**
@@ -145,19 +153,15 @@ void BLI_kdtree_nd_(insert)(KDTree *tree, int index, const float co[KD_DIMS])
 #endif
 }
 
-static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+/**
+ * Quick-select the median node along \a axis, nodes on its left are lower and nodes on its
+ * right are greater or equal.
+ */
+static uint kdtree_balance_partition(KDTreeNode *nodes, uint nodes_len, uint axis)
 {
-  KDTreeNode *node;
   float co;
   uint left, right, median, i, j;
 
-  if (nodes_len <= 0) {
-    return KD_NODE_UNSET;
-  }
-  else if (nodes_len == 1) {
-    return 0 + ofs;
-  }
-
   /* quicksort style sorting around median */
   left = 0;
   right = nodes_len - 1;
@@ -190,6 +194,23 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
     }
   }
 
+  return median;
+}
+
+static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+{
+  KDTreeNode *node;
+  uint median;
+
+  if (nodes_len <= 0) {
+    return KD_NODE_UNSET;
+  }
+  else if (nodes_len == 1) {
+    return 0 + ofs;
+  }
+
+  median = kdtree_balance_partition(nodes, nodes_len, axis);
+
   /* set node and sort subnodes */
   node = &nodes[median];
   node->d = axis;
@@ -201,6 +222,93 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
   return median + ofs;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Parallel Balance
+ *
+ * The top levels of the tree are split on a single thread, the sub-trees below them cover
+ * separate ranges of the nodes and are balanced in parallel.
+ * The resulting tree is the same as the one built by #kdtree_balance.
+ * \{ */
+
+typedef struct KDTreeBalanceSubTree {
+  KDTreeNode *nodes;
+  uint nodes_len;
+  uint axis;
+  uint ofs;
+  /* Where to store the root of the sub-tree. */
+  uint *r_root;
+} KDTreeBalanceSubTree;
+
+typedef struct KDTreeBalanceData {
+  KDTreeBalanceSubTree subtrees[1 << KD_BALANCE_THREAD_DEPTH];
+  uint subtrees_len;
+} KDTreeBalanceData;
+
+static void kdtree_balance_split(KDTreeBalanceData *data,
+                                 KDTreeNode *nodes,
+                                 uint nodes_len,
+                                 uint axis,
+                                 const uint ofs,
+                                 const uint depth,
+                                 uint *r_root)
+{
+  KDTreeNode *node;
+  uint median;
+
+  if (depth == KD_BALANCE_THREAD_DEPTH || nodes_len < KD_BALANCE_THREAD_MIN / 4) {
+    KDTreeBalanceSubTree *subtree = &data->subtrees[data->subtrees_len++];
+    subtree->nodes = nodes;
+    subtree->nodes_len = nodes_len;
+    subtree->axis = axis;
+    subtree->ofs = ofs;
+    subtree->r_root = r_root;
+    return;
+  }
+
+  median = kdtree_balance_partition(nodes, nodes_len, axis);
+
+  node = &nodes[median];
+  node->d = axis;
+  *r_root = median + ofs;
+  axis = (axis + 1) % KD_DIMS;
+  kdtree_balance_split(data, nodes, median, axis, ofs, depth + 1, &node->left);
+  kdtree_balance_split(data,
+                       nodes + median + 1,
+                       (nodes_len - (median + 1)),
+                       axis,
+                       (median + 1) + ofs,
+                       depth + 1,
+                       &node->right);
+}
+
+static void kdtree_balance_subtree_cb(void *__restrict userdata,
+                                      const int index,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  KDTreeBalanceData *data = userdata;
+  KDTreeBalanceSubTree *subtree = &data->subtrees[index];
+  *subtree->r_root = kdtree_balance(
+      subtree->nodes, subtree->nodes_len, subtree->axis, subtree->ofs);
+}
+
+static uint kdtree_balance_parallel(KDTreeNode *nodes, uint nodes_len)
+{
+  KDTreeBalanceData *data = MEM_mallocN(sizeof(*data), __func__);
+  uint root;
+
+  data->subtrees_len = 0;
+  kdtree_balance_split(data, nodes, nodes_len, 0, 0, 0, &root);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  BLI_task_parallel_range(0, (int)data->subtrees_len, data, kdtree_balance_subtree_cb, &settings);
+
+  MEM_freeN(data);
+  return root;
+}
+
+/** \} */
+
 void BLI_kdtree_nd_(balance)(KDTree *tree)
 {
   if (tree->root != KD_NODE_ROOT_IS_INIT) {
@@ -210,7 +318,12 @@ void BLI_kdtree_nd_(balance)(KDTree *tree)
     }
   }
 
-  tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0);
+  if (tree->nodes_len >= KD_BALANCE_THREAD_MIN) {
+    tree->root = kdtree_balance_parallel(tree->nodes, tree->nodes_len);
+  }
+  else {
+    tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0);
+  }
 
 #ifdef DEBUG
   tree->is_balanced = true;
@@ -806,6 +919,215 @@ finally:
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Batched Queries
+ *
+ * Run one query per point and write the results in caller provided arrays,
+ * the points are queried in parallel.
+ * \{ */
+
+/* Node to visit, with the squared distance to the region of space it covers. */
+typedef struct KDTreeStackItem {
+  uint node;
+  float dist_sq;
+} KDTreeStackItem;
+
+static KDTreeStackItem *realloc_stack_items(KDTreeStackItem *stack,
+                                            uint *stack_len_capacity,
+                                            const bool is_alloc)
+{
+  KDTreeStackItem *stack_new = MEM_mallocN(
+      (*stack_len_capacity + KD_NEAR_ALLOC_INC) * sizeof(*stack), "KDTree.treestack");
+  memcpy(stack_new, stack, *stack_len_capacity * sizeof(*stack));
+  if (is_alloc) {
+    MEM_freeN(stack);
+  }
+  *stack_len_capacity += KD_NEAR_ALLOC_INC;
+  return stack_new;
+}
+
+/**
+ * Find the \a nearest_len_capacity nearest nodes at a squared distance up to \a dist_sq_max.
+ *
+ * Unlike #BLI_kdtree_3d_find_nearest_n, the distance to the splitting planes is kept for
+ * the nodes on the stack, so sub-trees which got out of reach since they were added
+ * are skipped entirely.
+ */
+static uint kdtree_find_nearest_n_bounded(const KDTree *tree,
+                                          const float co[KD_DIMS],
+                                          KDTreeNearest r_nearest[],
+                                          const uint nearest_len_capacity,
+                                          const float dist_sq_max)
+{
+  const KDTreeNode *nodes = tree->nodes;
+  KDTreeStackItem *stack, stack_default[KD_STACK_INIT];
+  uint stack_len_capacity, cur = 0;
+  uint nearest_len = 0;
+  float dist_sq_limit = dist_sq_max;
+
+  stack = stack_default;
+  stack_len_capacity = ARRAY_SIZE(stack_default);
+
+  stack[cur].node = tree->root;
+  stack[cur].dist_sq = 0.0f;
+  cur++;
+
+  while (cur--) {
+    const KDTreeStackItem item = stack[cur];
+    const bool is_full = (nearest_len == nearest_len_capacity);
+
+    /* Nodes at the limit are only added until the results are full. */
+    if (is_full ? (item.dist_sq >= dist_sq_limit) : (item.dist_sq > dist_sq_limit)) {
+      continue;
+    }
+
+    const KDTreeNode *node = &nodes[item.node];
+    const float plane_dist = node->co[node->d] - co[node->d];
+    const float plane_dist_sq = max_ff(SQUARE(plane_dist), item.dist_sq);
+    const uint child_near = (plane_dist < 0.0f) ? node->right : node->left;
+    const uint child_far = (plane_dist < 0.0f) ? node->left : node->right;
+
+    if (plane_dist_sq <= dist_sq_limit) {
+      const float dist_sq = len_squared_vnvn(node->co, co);
+      if (is_full ? (dist_sq < dist_sq_limit) : (dist_sq <= dist_sq_limit)) {
+        nearest_ordered_insert(
+            r_nearest, &nearest_len, nearest_len_capacity, node->index, dist_sq, node->co);
+        if (nearest_len == nearest_len_capacity) {
+          dist_sq_limit = r_nearest[nearest_len - 1].dist;
+        }
+      }
+
+      if (child_far != KD_NODE_UNSET) {
+        stack[cur].node = child_far;
+        stack[cur].dist_sq = plane_dist_sq;
+        cur++;
+      }
+    }
+    if (child_near != KD_NODE_UNSET) {
+      stack[cur].node = child_near;
+      stack[cur].dist_sq = item.dist_sq;
+      cur++;
+    }
+
+    if (UNLIKELY(cur + KD_DIMS > stack_len_capacity)) {
+      stack = realloc_stack_items(stack, &stack_len_capacity, stack_default != stack);
+    }
+  }
+
+  for (uint i = 0; i < nearest_len; i++) {
+    r_nearest[i].dist = sqrtf(r_nearest[i].dist);
+  }
+
+  if (stack != stack_default) {
+    MEM_freeN(stack);
+  }
+
+  return nearest_len;
+}
+
+typedef struct KDTreeBatchData {
+  const KDTree *tree;
+  const float (*co)[KD_DIMS];
+  KDTreeNearest *r_nearest;
+  int *r_nearest_len;
+  uint nearest_len_capacity;
+  float dist_sq_max;
+} KDTreeBatchData;
+
+static void kdtree_batch_cb(void *__restrict userdata,
+                            const int index,
+                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const KDTreeBatchData *data = userdata;
+  KDTreeNearest *r_nearest = &data->r_nearest[(size_t)index * data->nearest_len_capacity];
+
+  data->r_nearest_len[index] = (int)kdtree_find_nearest_n_bounded(
+      data->tree, data->co[index], r_nearest, data->nearest_len_capacity, data->dist_sq_max);
+}
+
+static int kdtree_batch(const KDTree *tree,
+                        const float (*co)[KD_DIMS],
+                        const uint co_len,
+                        KDTreeNearest *r_nearest,
+                        int *r_nearest_len,
+                        const uint nearest_len_capacity,
+                        const float dist_sq_max)
+{
+  int found = 0;
+
+#ifdef DEBUG
+  BLI_assert(tree->is_balanced == true);
+#endif
+
+  if (UNLIKELY((tree->root == KD_NODE_UNSET) || nearest_len_capacity == 0)) {
+    memset(r_nearest_len, 0, sizeof(*r_nearest_len) * co_len);
+    return 0;
+  }
+
+  KDTreeBatchData data = {
+      .tree = tree,
+      .co = co,
+      .r_nearest = r_nearest,
+      .r_nearest_len = r_nearest_len,
+      .nearest_len_capacity = nearest_len_capacity,
+      .dist_sq_max = dist_sq_max,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (co_len >= KD_BATCH_THREAD_MIN);
+  settings.min_iter_per_thread = KD_BATCH_THREAD_MIN / 4;
+  BLI_task_parallel_range(0, (int)co_len, &data, kdtree_batch_cb, &settings);
+
+  for (uint i = 0; i < co_len; i++) {
+    found += r_nearest_len[i];
+  }
+  return found;
+}
+
+/**
+ * Find the \a nearest_len_capacity nearest nodes of each point in \a co.
+ *
+ * \param r_nearest: An array sized at least `co_len * nearest_len_capacity`,
+ * the results of the point `i` start at `i * nearest_len_capacity`, sorted by distance.
+ * \param r_nearest_len: An array of \a co_len, the number of results of each point.
+ * \returns The number of results of all points.
+ */
+int BLI_kdtree_nd_(find_nearest_n_batch)(const KDTree *tree,
+                                         const float (*co)[KD_DIMS],
+                                         const uint co_len,
+                                         KDTreeNearest *r_nearest,
+                                         int *r_nearest_len,
+                                         const uint nearest_len_capacity)
+{
+  return kdtree_batch(tree, co, co_len, r_nearest, r_nearest_len, nearest_len_capacity, FLT_MAX);
+}
+
+/**
+ * Find the nodes in \a range of each point in \a co,
+ * a version of #BLI_kdtree_3d_range_search which doesn't allocate.
+ *
+ * \param r_nearest: An array sized at least `co_len * nearest_len_capacity`,
+ * the results of the point `i` start at `i * nearest_len_capacity`, sorted by distance.
+ * \param r_nearest_len: An array of \a co_len, the number of results of each point.
+ * \returns The number of results of all points.
+ *
+ * \note When more than \a nearest_len_capacity nodes are in range, only the nearest are kept.
+ */
+int BLI_kdtree_nd_(range_search_batch)(const KDTree *tree,
+                                       const float (*co)[KD_DIMS],
+                                       const uint co_len,
+                                       const float range,
+                                       KDTreeNearest *r_nearest,
+                                       int *r_nearest_len,
+                                       const uint nearest_len_capacity)
+{
+  return kdtree_batch(
+      tree, co, co_len, r_nearest, r_nearest_len, nearest_len_capacity, range * range);
+}
+
+/** \} */
+
 /**
  * Use when we want to loop over nodes ordered by index.
  * Requires indices to be aligned with nodes.
@@ -45,18 +45,22 @@
  */
 #define MEMPOOL_SIZE 256
 
-/* Number of tasks which are pushed directly to local thread queue.
+/* Number of tasks which can be pushed to the deque of a scheduler thread.
  *
- * This allows thread to fetch next task without locking the whole queue.
+ * The thread pushes and pops its own tasks without locking the whole queue,
+ * idle threads steal them. Must be a power of two.
+ */
+#define TASK_DEQUE_SIZE 1024
+
+/* Number of tasks which are pushed directly to the local queue of a thread
+ * which is not managed by the scheduler, no other thread can steal those.
  */
 #define LOCAL_QUEUE_SIZE 1
 
-/* Number of tasks which are allowed to be scheduled in a delayed manner.
- *
- * This allows to use less locks per graph node children schedule. More details
- * could be found at TaskThreadLocalStorage::do_delayed_push.
+/* Push tasks to the thread deques and let idle threads steal them. Without it all tasks go
+ * through the single locked queue, which is only useful to compare both.
  */
-#define DELAYED_QUEUE_SIZE 4096
+#define USE_WORK_STEALING
 
 #ifndef NDEBUG
 #  define ASSERT_THREAD_ID(scheduler, thread_id) \
@@ -88,6 +92,26 @@ typedef struct Task {
   TaskPool *pool;
 } Task;
 
+typedef struct TaskDequeItem {
+  Task *task;
+  /* Copy of task->pool, a thief can't access the task before owning it. */
+  TaskPool *pool;
+} TaskDequeItem;
+
+/* Lock-free work stealing deque with a fixed size (Chase-Lev).
+ *
+ * Only the thread owning the deque pushes and pops tasks at its bottom, any other
+ * thread can steal tasks at its top. Indices are only increasing and are updated with
+ * atomic operations, which are also full memory barriers.
+ */
+typedef struct TaskDeque {
+  int64_t top;
+  /* Avoid false sharing between the thieves and the owner. */
+  char _pad[56];
+  int64_t bottom;
+  volatile TaskDequeItem items[TASK_DEQUE_SIZE];
+} TaskDeque;
+
 /* This is a per-thread storage of pre-allocated tasks.
  *
  * The idea behind this is simple: reduce amount of malloc() calls when pushing
@@ -138,23 +162,22 @@ typedef struct TaskThreadLocalStorage {
    */
   TaskMemPool task_mempool;
 
-  /* Local queue keeps thread alive by keeping small amount of tasks ready
-   * to be picked up without causing global thread locks for synchronization.
+  /* Tasks pushed from this thread, they are picked up next by this thread
+   * without any lock and stolen by idle threads.
    */
-  int num_local_queue;
-  Task *local_queue[LOCAL_QUEUE_SIZE];
+  TaskDeque deque;
+
+  /* Index of the next thread to steal tasks from. */
+  int steal_thread;
 
   /* Thread can be marked for delayed tasks push. This is helpful when it's
    * know that lots of subsequent task pushed will happen from the same thread
    * without "interrupting" for task execution.
    *
-   * We try to accumulate as much tasks as possible in a local queue without
-   * any locks first, and then we push all of them into a scheduler's queue
-   * from within a single mutex lock.
+   * Idle threads are then woken up once at the end instead of for each task.
    */
   bool do_delayed_push;
-  int num_delayed_queue;
-  Task *delayed_queue[DELAYED_QUEUE_SIZE];
+  int num_delayed_push;
 } TaskThreadLocalStorage;
 
 struct TaskPool {
@@ -207,9 +230,24 @@ struct TaskScheduler {
   int num_threads;
   bool background_thread_only;
 
+  /* Tasks pushed from outside of the scheduler threads, or not fitting in their deques. */
   ListBase queue;
   ThreadMutex queue_mutex;
   ThreadCondition queue_cond;
+  /* Number of tasks in the queue, read without lock to skip locking an empty queue. */
+  int num_queued_tasks;
+
+  /* Number of threads waiting on queue_cond. */
+  int num_sleeping_threads;
+  /* Push tasks to the thread deques and steal them, or only use the queue. */
+  bool use_work_stealing;
+
+  /* Threads in BLI_task_pool_work_and_wait() sleep on wait_cond until their pool is done or
+   * has a task they can take. Tasks of any pool being pushed, uncovered by a steal or
+   * done wake them all up, so no pool pointer is needed to notify them. */
+  ThreadMutex wait_mutex;
+  ThreadCondition wait_cond;
+  int num_waiting_threads;
 
   ThreadMutex startup_mutex;
   ThreadCondition startup_cond;
@@ -326,101 +364,321 @@ static void task_free(TaskPool *pool, Task *task, const int thread_id)
   }
 }
 
+/* Task Deque */
+
+BLI_INLINE int64_t task_deque_load(int64_t *value)
+{
+  return atomic_fetch_and_add_int64(value, 0);
+}
+
+BLI_INLINE bool task_deque_is_empty(TaskDeque *deque)
+{
+  return task_deque_load(&deque->top) >= task_deque_load(&deque->bottom);
+}
+
+/* Pool of the task which would be stolen next, NULL if the deque is empty.
+ * Only meant for comparison, the pool can be freed as soon as its task is taken. */
+static TaskPool *task_deque_top_pool(TaskDeque *deque)
+{
+  const int64_t top = task_deque_load(&deque->top);
+  const int64_t bottom = task_deque_load(&deque->bottom);
+
+  if (top >= bottom) {
+    return NULL;
+  }
+
+  return deque->items[top & (TASK_DEQUE_SIZE - 1)].pool;
+}
+
+/* Owner thread only. */
+static bool task_deque_push(TaskDeque *deque, Task *task, const int64_t capacity)
+{
+  const int64_t bottom = task_deque_load(&deque->bottom);
+  const int64_t top = task_deque_load(&deque->top);
+
+  if (bottom - top >= capacity) {
+    return false;
+  }
+
+  volatile TaskDequeItem *item = &deque->items[bottom & (TASK_DEQUE_SIZE - 1)];
+  item->task = task;
+  item->pool = task->pool;
+
+  /* Publish the task to the thieves. */
+  atomic_add_and_fetch_int64(&deque->bottom, 1);
+  return true;
+}
+
+/* Owner thread only, only pop a task from pool if not NULL. */
+static Task *task_deque_pop(TaskDeque *deque, TaskPool *pool)
+{
+  const int64_t bottom = atomic_sub_and_fetch_int64(&deque->bottom, 1);
+  const int64_t top = task_deque_load(&deque->top);
+
+  if (top > bottom) {
+    /* Deque was empty. */
+    atomic_add_and_fetch_int64(&deque->bottom, 1);
+    return NULL;
+  }
+
+  volatile TaskDequeItem *item = &deque->items[bottom & (TASK_DEQUE_SIZE - 1)];
+  if (pool != NULL && item->pool != pool) {
+    /* Task of another pool, leave it for the threads which can run it. */
+    atomic_add_and_fetch_int64(&deque->bottom, 1);
+    return NULL;
+  }
+
+  Task *task = item->task;
+  if (top == bottom) {
+    /* Last task, a thief could be taking it too. */
+    if (atomic_cas_int64(&deque->top, top, top + 1) != top) {
+      task = NULL;
+    }
+    atomic_add_and_fetch_int64(&deque->bottom, 1);
+  }
+
+  return task;
+}
+
+/* Any thread, only steal tasks from pool if not NULL. */
+static Task *task_deque_steal(TaskDeque *deque, TaskPool *pool)
+{
+  const int64_t top = task_deque_load(&deque->top);
+  const int64_t bottom = task_deque_load(&deque->bottom);
+
+  if (top >= bottom) {
+    return NULL;
+  }
+
+  /* The item can't be overwritten as long as top is unchanged. */
+  volatile TaskDequeItem *item = &deque->items[top & (TASK_DEQUE_SIZE - 1)];
+  Task *task = item->task;
+  if (pool != NULL && item->pool != pool) {
+    return NULL;
+  }
+
+  if (atomic_cas_int64(&deque->top, top, top + 1) != top) {
+    return NULL;
+  }
+
+  return task;
+}
+
 /* Task Scheduler */
 
-static void task_pool_num_decrease(TaskPool *pool, size_t done)
+/* Wake up the threads waiting for a pool, after a task was pushed, stolen or done. */
+static void task_scheduler_notify_waiting(TaskScheduler *scheduler)
 {
-  BLI_mutex_lock(&pool->num_mutex);
+  /* The waiting threads check their pool after being counted, either they see the
+   * change or they are counted here. */
+  if (atomic_fetch_and_add_int32(&scheduler->num_waiting_threads, 0) == 0) {
+    return;
+  }
 
-  BLI_assert(pool->num >= done);
+  BLI_mutex_lock(&scheduler->wait_mutex);
+  BLI_condition_notify_all(&scheduler->wait_cond);
+  BLI_mutex_unlock(&scheduler->wait_mutex);
+}
 
-  pool->num -= done;
+static void task_pool_num_decrease(TaskPool *pool, size_t done)
+{
+  TaskScheduler *scheduler = pool->scheduler;
 
-  if (pool->num == 0) {
-    BLI_condition_notify_all(&pool->num_cond);
+  /* Only the last tasks lock, BLI_task_pool_free() locks num_mutex too, so the pool
+   * is not freed before it is unlocked here. */
+  size_t num = atomic_fetch_and_add_z((size_t *)&pool->num, 0);
+  while (num > done) {
+    const size_t prev = atomic_cas_z((size_t *)&pool->num, num, num - done);
+    if (prev == num) {
+      return;
+    }
+    num = prev;
   }
 
+  BLI_mutex_lock(&pool->num_mutex);
+  atomic_sub_and_fetch_z((size_t *)&pool->num, done);
+  BLI_condition_notify_all(&pool->num_cond);
   BLI_mutex_unlock(&pool->num_mutex);
+
+  task_scheduler_notify_waiting(scheduler);
 }
 
 static void task_pool_num_increase(TaskPool *pool, size_t new)
 {
-  BLI_mutex_lock(&pool->num_mutex);
+  atomic_add_and_fetch_z((size_t *)&pool->num, new);
+}
 
-  pool->num += new;
-  BLI_condition_notify_all(&pool->num_cond);
+BLI_INLINE size_t task_pool_num_get(TaskPool *pool)
+{
+  return atomic_fetch_and_add_z((size_t *)&pool->num, 0);
+}
 
-  BLI_mutex_unlock(&pool->num_mutex);
+BLI_INLINE bool task_scheduler_queue_is_empty(TaskScheduler *scheduler)
+{
+  return atomic_fetch_and_add_int32(&scheduler->num_queued_tasks, 0) == 0;
 }
 
-static bool task_scheduler_thread_wait_pop(TaskScheduler *scheduler, Task **task)
+static void task_scheduler_wake_threads(TaskScheduler *scheduler, const bool wake_all)
 {
-  bool found_task = false;
+  /* The sleeping threads check the deques after being counted, either they see the
+   * pushed tasks or they are counted here. */
+  if (atomic_fetch_and_add_int32(&scheduler->num_sleeping_threads, 0) == 0) {
+    return;
+  }
+
   BLI_mutex_lock(&scheduler->queue_mutex);
+  if (wake_all) {
+    BLI_condition_notify_all(&scheduler->queue_cond);
+  }
+  else {
+    BLI_condition_notify_one(&scheduler->queue_cond);
+  }
+  BLI_mutex_unlock(&scheduler->queue_mutex);
+}
 
-  while (!scheduler->queue.first && !scheduler->do_exit) {
-    BLI_condition_wait(&scheduler->queue_cond, &scheduler->queue_mutex);
+/* Pop the first task of the queue which can be run, queue_mutex must be locked.
+ * Only tasks from pool are considered if not NULL. */
+static Task *task_scheduler_queue_pop(TaskScheduler *scheduler, TaskPool *pool)
+{
+  for (Task *task = scheduler->queue.first; task != NULL; task = task->next) {
+    if (pool != NULL) {
+      if (task->pool != pool) {
+        continue;
+      }
+    }
+    else if (scheduler->background_thread_only && !task->pool->run_in_background) {
+      continue;
+    }
+
+    BLI_remlink(&scheduler->queue, task);
+    atomic_sub_and_fetch_int32(&scheduler->num_queued_tasks, 1);
+    return task;
   }
 
-  do {
-    Task *current_task;
+  return NULL;
+}
 
-    /* Assuming we can only have a void queue in 'exit' case here seems logical
-     * (we should only be here after our worker thread has been woken up from a
-     * condition_wait(), which only happens after a new task was added to the queue),
-     * but it is wrong.
-     * Waiting on condition may wake up the thread even if condition is not signaled
-     * (spurious wake-ups), and some race condition may also empty the queue **after**
-     * condition has been signaled, but **before** awoken thread reaches this point...
-     * See http://stackoverflow.com/questions/8594591
-     *
-     * So we only abort here if do_exit is set.
-     */
-    if (scheduler->do_exit) {
-      BLI_mutex_unlock(&scheduler->queue_mutex);
-      return false;
+static Task *task_scheduler_steal(TaskScheduler *scheduler,
+                                  TaskThreadLocalStorage *tls,
+                                  TaskPool *pool)
+{
+  if (!scheduler->use_work_stealing) {
+    return NULL;
+  }
+  /* The background thread only runs background pools. */
+  if (scheduler->background_thread_only && pool == NULL) {
+    return NULL;
+  }
+
+  const int num_deques = scheduler->num_threads + 1;
+  for (int i = 0; i < num_deques; i++) {
+    const int victim = (tls->steal_thread + i) % num_deques;
+    TaskDeque *deque = &scheduler->task_threads[victim].tls.deque;
+    /* A waiting thread also takes the oldest tasks of its own deque, when the newest ones
+     * are from another pool. */
+    if (deque == &tls->deque && pool == NULL) {
+      continue;
     }
 
-    for (current_task = scheduler->queue.first; current_task != NULL;
-         current_task = current_task->next) {
-      TaskPool *pool = current_task->pool;
+    Task *task = task_deque_steal(deque, pool);
+    if (task != NULL) {
+      /* The next task may be one a waiting thread could not reach. */
+      if (!task_deque_is_empty(deque)) {
+        task_scheduler_notify_waiting(scheduler);
+      }
+      /* Keep stealing from the same thread while it has tasks. */
+      tls->steal_thread = victim;
+      return task;
+    }
+  }
 
-      if (scheduler->background_thread_only && !pool->run_in_background) {
-        continue;
+  tls->steal_thread = (tls->steal_thread + 1) % num_deques;
+  return NULL;
+}
+
+/* Test if a sleeping thread has anything to do, queue_mutex must be locked. */
+static bool task_scheduler_has_work(TaskScheduler *scheduler)
+{
+  for (Task *task = scheduler->queue.first; task != NULL; task = task->next) {
+    if (!scheduler->background_thread_only || task->pool->run_in_background) {
+      return true;
+    }
+  }
+
+  if (scheduler->use_work_stealing && !scheduler->background_thread_only) {
+    for (int i = 0; i <= scheduler->num_threads; i++) {
+      if (!task_deque_is_empty(&scheduler->task_threads[i].tls.deque)) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+static Task *task_scheduler_thread_wait_pop(TaskScheduler *scheduler, TaskThread *thread)
+{
+  TaskThreadLocalStorage *tls = &thread->tls;
+
+  while (true) {
+    /* Tasks pushed by this thread first, they're likely to use the same data. */
+    Task *task = task_deque_pop(&tls->deque, NULL);
+    if (task != NULL) {
+      return task;
+    }
+
+    /* Unlocked check, the queue is tested again with the lock. */
+    if (!task_scheduler_queue_is_empty(scheduler)) {
+      BLI_mutex_lock(&scheduler->queue_mutex);
+      task = task_scheduler_queue_pop(scheduler, NULL);
+      BLI_mutex_unlock(&scheduler->queue_mutex);
+      if (task != NULL) {
+        return task;
       }
+    }
 
-      *task = current_task;
-      found_task = true;
-      BLI_remlink(&scheduler->queue, *task);
-      break;
+    task = task_scheduler_steal(scheduler, tls, NULL);
+    if (task != NULL) {
+      return task;
     }
-    if (!found_task) {
+
+    BLI_mutex_lock(&scheduler->queue_mutex);
+    atomic_add_and_fetch_int32(&scheduler->num_sleeping_threads, 1);
+
+    /* Waiting on condition may wake up the thread even if condition is not signaled
+     * (spurious wake-ups), and some race condition may also empty the queue **after**
+     * condition has been signaled, but **before** awoken thread reaches this point...
+     * See http://stackoverflow.com/questions/8594591
+     *
+     * So we only abort here if do_exit is set.
+     */
+    while (!scheduler->do_exit && !task_scheduler_has_work(scheduler)) {
       BLI_condition_wait(&scheduler->queue_cond, &scheduler->queue_mutex);
     }
-  } while (!found_task);
 
-  BLI_mutex_unlock(&scheduler->queue_mutex);
+    atomic_sub_and_fetch_int32(&scheduler->num_sleeping_threads, 1);
+    const bool do_exit = scheduler->do_exit;
+    BLI_mutex_unlock(&scheduler->queue_mutex);
 
-  return true;
+    if (do_exit) {
+      return NULL;
+    }
+  }
 }
 
-BLI_INLINE void handle_local_queue(TaskThreadLocalStorage *tls, const int thread_id)
+BLI_INLINE void task_run_and_free(Task *task, const int thread_id)
 {
-  BLI_assert(!tls->do_delayed_push);
-  while (tls->num_local_queue > 0) {
-    /* We pop task from queue before handling it so handler of the task can
-     * push next job to the local queue.
-     */
-    tls->num_local_queue--;
-    Task *local_task = tls->local_queue[tls->num_local_queue];
-    /* TODO(sergey): Double-check work_and_wait() doesn't handle other's
-     * pool tasks.
-     */
-    TaskPool *local_pool = local_task->pool;
-    local_task->run(local_pool, local_task->taskdata, thread_id);
-    task_free(local_pool, local_task, thread_id);
+  TaskPool *pool = task->pool;
+
+  /* Tasks left in deques of a canceled pool are discarded like the queued ones. */
+  if (!pool->do_cancel) {
+    task->run(pool, task->taskdata, thread_id);
   }
-  BLI_assert(!tls->do_delayed_push);
+
+  task_free(pool, task, thread_id);
+
+  /* notify pool task was done */
+  task_pool_num_decrease(pool, 1);
 }
 
 static void *task_scheduler_thread_run(void *thread_p)
@@ -442,22 +700,10 @@ static void *task_scheduler_thread_run(void *thread_p)
   BLI_mutex_unlock(&scheduler->startup_mutex);
 
   /* keep popping off tasks */
-  while (task_scheduler_thread_wait_pop(scheduler, &task)) {
-    TaskPool *pool = task->pool;
-
-    /* run task */
+  while ((task = task_scheduler_thread_wait_pop(scheduler, thread)) != NULL) {
     BLI_assert(!tls->do_delayed_push);
-    task->run(pool, task->taskdata, thread_id);
+    task_run_and_free(task, thread_id);
     BLI_assert(!tls->do_delayed_push);
-
-    /* delete task */
-    task_free(pool, task, thread_id);
-
-    /* Handle all tasks from local queue. */
-    handle_local_queue(tls, thread_id);
-
-    /* notify pool task was done */
-    task_pool_num_decrease(pool, 1);
   }
 
   return NULL;
@@ -470,11 +716,21 @@ TaskScheduler *BLI_task_scheduler_create(int num_threads)
   /* multiple places can use this task scheduler, sharing the same
    * threads, so we keep track of the number of users. */
   scheduler->do_exit = false;
+#ifdef USE_WORK_STEALING
+  scheduler->use_work_stealing = true;
+#else
+  scheduler->use_work_stealing = false;
+#endif
 
   BLI_listbase_clear(&scheduler->queue);
+  scheduler->num_queued_tasks = 0;
   BLI_mutex_init(&scheduler->queue_mutex);
   BLI_condition_init(&scheduler->queue_cond);
 
+  BLI_mutex_init(&scheduler->wait_mutex);
+  BLI_condition_init(&scheduler->wait_cond);
+  scheduler->num_waiting_threads = 0;
+
   BLI_mutex_init(&scheduler->startup_mutex);
   BLI_condition_init(&scheduler->startup_cond);
   scheduler->num_thread_started = 0;
@@ -508,12 +764,16 @@ TaskScheduler *BLI_task_scheduler_create(int num_threads)
     scheduler->num_threads = num_threads;
     scheduler->threads = MEM_callocN(sizeof(pthread_t) * num_threads, "TaskScheduler threads");
 
+    /* Running threads can steal from any other thread deque. */
     for (i = 0; i < num_threads; i++) {
       TaskThread *thread = &scheduler->task_threads[i + 1];
       thread->scheduler = scheduler;
       thread->id = i + 1;
       initialize_task_tls(&thread->tls);
+    }
 
+    for (i = 0; i < num_threads; i++) {
+      TaskThread *thread = &scheduler->task_threads[i + 1];
       if (pthread_create(&scheduler->threads[i], NULL, task_scheduler_thread_run, thread) != 0) {
         fprintf(stderr, "TaskScheduler failed to launch thread %d/%d\n", i, num_threads);
       }
@@ -563,6 +823,11 @@ void BLI_task_scheduler_free(TaskScheduler *scheduler)
   if (scheduler->task_threads) {
     for (int i = 0; i < scheduler->num_threads + 1; i++) {
       TaskThreadLocalStorage *tls = &scheduler->task_threads[i].tls;
+      /* delete leftover tasks */
+      while ((task = task_deque_pop(&tls->deque, NULL)) != NULL) {
+        task_data_free(task, 0);
+        MEM_freeN(task);
+      }
       free_task_tls(tls);
     }
 
@@ -578,6 +843,8 @@ void BLI_task_scheduler_free(TaskScheduler *scheduler)
   /* delete mutex/condition */
   BLI_mutex_end(&scheduler->queue_mutex);
   BLI_condition_end(&scheduler->queue_cond);
+  BLI_mutex_end(&scheduler->wait_mutex);
+  BLI_condition_end(&scheduler->wait_cond);
   BLI_mutex_end(&scheduler->startup_mutex);
   BLI_condition_end(&scheduler->startup_cond);
 
@@ -602,30 +869,13 @@ static void task_scheduler_push(TaskScheduler *scheduler, Task *task, TaskPriori
   else {
     BLI_addtail(&scheduler->queue, task);
   }
+  atomic_add_and_fetch_int32(&scheduler->num_queued_tasks, 1);
 
   BLI_condition_notify_one(&scheduler->queue_cond);
   BLI_mutex_unlock(&scheduler->queue_mutex);
-}
-
-static void task_scheduler_push_all(TaskScheduler *scheduler,
-                                    TaskPool *pool,
-                                    Task **tasks,
-                                    int num_tasks)
-{
-  if (num_tasks == 0) {
-    return;
-  }
-
-  task_pool_num_increase(pool, num_tasks);
 
-  BLI_mutex_lock(&scheduler->queue_mutex);
-
-  for (int i = 0; i < num_tasks; i++) {
-    BLI_addhead(&scheduler->queue, tasks[i]);
-  }
-
-  BLI_condition_notify_all(&scheduler->queue_cond);
-  BLI_mutex_unlock(&scheduler->queue_mutex);
+  /* A thread waiting for the pool can run the task. */
+  task_scheduler_notify_waiting(scheduler);
 }
 
 static void task_scheduler_clear(TaskScheduler *scheduler, TaskPool *pool)
@@ -642,6 +892,7 @@ static void task_scheduler_clear(TaskScheduler *scheduler, TaskPool *pool)
     if (task->pool == pool) {
       task_data_free(task, pool->thread_id);
       BLI_freelinkN(&scheduler->queue, task);
+      atomic_sub_and_fetch_int32(&scheduler->num_queued_tasks, 1);
 
       done++;
     }
@@ -798,7 +1049,95 @@ void BLI_task_pool_free(TaskPool *pool)
 
 BLI_INLINE bool task_can_use_local_queues(TaskPool *pool, int thread_id)
 {
-  return (thread_id != -1 && (thread_id != pool->thread_id || pool->do_work));
+  return (pool->scheduler->use_work_stealing && thread_id != -1 &&
+          (thread_id != pool->thread_id || pool->do_work));
+}
+
+/* Other threads can only steal from the deques of the scheduler's TLS. */
+BLI_INLINE bool task_tls_is_shared(TaskPool *pool, int thread_id)
+{
+  return !(pool->use_local_tls && thread_id == 0);
+}
+
+/* Push a task to the deque of the calling thread, without any lock. */
+static bool task_pool_push_local(TaskPool *pool, Task *task, int thread_id)
+{
+  /* The pool can be freed once its task is stolen and done. */
+  TaskScheduler *scheduler = pool->scheduler;
+  TaskThreadLocalStorage *tls = get_task_tls(pool, thread_id);
+  const bool is_shared = task_tls_is_shared(pool, thread_id);
+
+  /* Count the task first, it can be stolen as soon as it is pushed. */
+  atomic_add_and_fetch_z((size_t *)&pool->num, 1);
+
+  if (!task_deque_push(&tls->deque, task, is_shared ? TASK_DEQUE_SIZE : LOCAL_QUEUE_SIZE)) {
+    atomic_sub_and_fetch_z((size_t *)&pool->num, 1);
+    return false;
+  }
+
+  /* A thread waiting for the pool can run the task. */
+  task_scheduler_notify_waiting(scheduler);
+
+  if (!is_shared) {
+    return true;
+  }
+
+  /* In delayed push mode idle threads are woken up at the end. */
+  if (tls->do_delayed_push) {
+    tls->num_delayed_push++;
+  }
+  else {
+    task_scheduler_wake_threads(scheduler, false);
+  }
+  return true;
+}
+
+/* Move the tasks of a suspended pool to the deque of the pool thread,
+ * or to the queue when no other thread can steal them. */
+static void task_pool_push_suspended(TaskPool *pool)
+{
+  TaskScheduler *scheduler = pool->scheduler;
+  const int thread_id = pool->thread_id;
+
+  if (scheduler->use_work_stealing && task_tls_is_shared(pool, thread_id)) {
+    TaskThreadLocalStorage *tls = get_task_tls(pool, thread_id);
+
+    atomic_add_and_fetch_z((size_t *)&pool->num, pool->num_suspended);
+
+    Task *task;
+    while ((task = BLI_pophead(&pool->suspended_queue)) != NULL) {
+      if (!task_deque_push(&tls->deque, task, TASK_DEQUE_SIZE)) {
+        BLI_addhead(&pool->suspended_queue, task);
+        break;
+      }
+    }
+
+    if (BLI_listbase_is_empty(&pool->suspended_queue)) {
+      task_scheduler_wake_threads(scheduler, true);
+      pool->num_suspended = 0;
+      return;
+    }
+
+    /* Remaining tasks are moved to the queue, they're already counted. */
+    const int num_remaining = BLI_listbase_count(&pool->suspended_queue);
+    BLI_mutex_lock(&scheduler->queue_mutex);
+    BLI_movelisttolist(&scheduler->queue, &pool->suspended_queue);
+    atomic_add_and_fetch_int32(&scheduler->num_queued_tasks, num_remaining);
+    BLI_condition_notify_all(&scheduler->queue_cond);
+    BLI_mutex_unlock(&scheduler->queue_mutex);
+  }
+  else {
+    task_pool_num_increase(pool, pool->num_suspended);
+    BLI_mutex_lock(&scheduler->queue_mutex);
+
+    BLI_movelisttolist(&scheduler->queue, &pool->suspended_queue);
+    atomic_add_and_fetch_int32(&scheduler->num_queued_tasks, (int)pool->num_suspended);
+
+    BLI_condition_notify_all(&scheduler->queue_cond);
+    BLI_mutex_unlock(&scheduler->queue_mutex);
+  }
+
+  pool->num_suspended = 0;
 }
 
 static void task_pool_push(TaskPool *pool,
@@ -827,25 +1166,15 @@ static void task_pool_push(TaskPool *pool,
     atomic_fetch_and_add_z(&pool->num_suspended, 1);
     return;
   }
-  /* Populate to any local queue first, this is cheapest push ever. */
-  if (task_can_use_local_queues(pool, thread_id)) {
+  /* Populate to the thread deque first, this is cheapest push ever.
+   * These tasks will be picked up next or stolen by idle threads.
+   *
+   * The owner runs them before the queued tasks, so low priority tasks go to the
+   * end of the queue instead.
+   */
+  if (priority == TASK_PRIORITY_HIGH && task_can_use_local_queues(pool, thread_id)) {
     ASSERT_THREAD_ID(pool->scheduler, thread_id);
-    TaskThreadLocalStorage *tls = get_task_tls(pool, thread_id);
-    /* Try to push to a local execution queue.
-     * These tasks will be picked up next.
-     */
-    if (tls->num_local_queue < LOCAL_QUEUE_SIZE) {
-      tls->local_queue[tls->num_local_queue] = task;
-      tls->num_local_queue++;
-      return;
-    }
-    /* If we are in the delayed tasks push mode, we push tasks to a
-     * temporary local queue first without any locks, and then move them
-     * to global execution queue with a single lock.
-     */
-    if (tls->do_delayed_push && tls->num_delayed_queue < DELAYED_QUEUE_SIZE) {
-      tls->delayed_queue[tls->num_delayed_queue] = task;
-      tls->num_delayed_queue++;
+    if (task_pool_push_local(pool, task, thread_id)) {
       return;
     }
   }
@@ -881,6 +1210,42 @@ void BLI_task_pool_push_from_thread(TaskPool *pool,
   task_pool_push(pool, run, taskdata, free_taskdata, NULL, priority, thread_id);
 }
 
+/* Test if a thread waiting for pool has a task to take, wait_mutex must be locked. */
+static bool task_pool_wait_has_work(TaskPool *pool, TaskThreadLocalStorage *tls)
+{
+  TaskScheduler *scheduler = pool->scheduler;
+
+  /* Any task of the deque of the waiting thread is run, see BLI_task_pool_work_and_wait(). */
+  if (!task_deque_is_empty(&tls->deque)) {
+    return true;
+  }
+
+  if (!task_scheduler_queue_is_empty(scheduler)) {
+    bool has_work = false;
+    BLI_mutex_lock(&scheduler->queue_mutex);
+    for (Task *task = scheduler->queue.first; task != NULL; task = task->next) {
+      if (task->pool == pool) {
+        has_work = true;
+        break;
+      }
+    }
+    BLI_mutex_unlock(&scheduler->queue_mutex);
+    if (has_work) {
+      return true;
+    }
+  }
+
+  if (scheduler->use_work_stealing) {
+    for (int i = 0; i <= scheduler->num_threads; i++) {
+      if (task_deque_top_pool(&scheduler->task_threads[i].tls.deque) == pool) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
 void BLI_task_pool_work_and_wait(TaskPool *pool)
 {
   TaskThreadLocalStorage *tls = get_task_tls(pool, pool->thread_id);
@@ -888,15 +1253,7 @@ void BLI_task_pool_work_and_wait(TaskPool *pool)
 
   if (atomic_fetch_and_and_uint8((uint8_t *)&pool->is_suspended, 0)) {
     if (pool->num_suspended) {
-      task_pool_num_increase(pool, pool->num_suspended);
-      BLI_mutex_lock(&scheduler->queue_mutex);
-
-      BLI_movelisttolist(&scheduler->queue, &pool->suspended_queue);
-
-      BLI_condition_notify_all(&scheduler->queue_cond);
-      BLI_mutex_unlock(&scheduler->queue_mutex);
-
-      pool->num_suspended = 0;
+      task_pool_push_suspended(pool);
     }
   }
 
@@ -904,62 +1261,45 @@ void BLI_task_pool_work_and_wait(TaskPool *pool)
 
   ASSERT_THREAD_ID(pool->scheduler, pool->thread_id);
 
-  handle_local_queue(tls, pool->thread_id);
-
-  BLI_mutex_lock(&pool->num_mutex);
-
-  while (pool->num != 0) {
-    Task *task, *work_task = NULL;
-    bool found_task = false;
+  while (task_pool_num_get(pool) != 0) {
+    /* Take tasks from this pool first, starting with the ones pushed by this thread like
+     * the worker threads do. Tasks from other pools could wait for something this thread
+     * is holding. */
+    Task *task = task_deque_pop(&tls->deque, pool);
 
-    BLI_mutex_unlock(&pool->num_mutex);
-
-    BLI_mutex_lock(&scheduler->queue_mutex);
-
-    /* find task from this pool. if we get a task from another pool,
-     * we can get into deadlock */
+    if (task == NULL && !task_scheduler_queue_is_empty(scheduler)) {
+      BLI_mutex_lock(&scheduler->queue_mutex);
+      task = task_scheduler_queue_pop(scheduler, pool);
+      BLI_mutex_unlock(&scheduler->queue_mutex);
+    }
 
-    for (task = scheduler->queue.first; task; task = task->next) {
-      if (task->pool == pool) {
-        work_task = task;
-        found_task = true;
-        BLI_remlink(&scheduler->queue, task);
-        break;
-      }
+    if (task == NULL) {
+      task = task_scheduler_steal(scheduler, tls, pool);
     }
 
-    BLI_mutex_unlock(&scheduler->queue_mutex);
+    /* Tasks of this pool can be behind tasks of other pools in the deque of this thread,
+     * which nothing else runs when there is no idle thread. Run those instead of sleeping. */
+    if (task == NULL) {
+      task = task_deque_pop(&tls->deque, NULL);
+    }
 
     /* if found task, do it, otherwise wait until other tasks are done */
-    if (found_task) {
-      /* run task */
+    if (task != NULL) {
       BLI_assert(!tls->do_delayed_push);
-      work_task->run(pool, work_task->taskdata, pool->thread_id);
+      task_run_and_free(task, pool->thread_id);
       BLI_assert(!tls->do_delayed_push);
-
-      /* delete task */
-      task_free(pool, task, pool->thread_id);
-
-      /* Handle all tasks from local queue. */
-      handle_local_queue(tls, pool->thread_id);
-
-      /* notify pool task was done */
-      task_pool_num_decrease(pool, 1);
-    }
-
-    BLI_mutex_lock(&pool->num_mutex);
-    if (pool->num == 0) {
-      break;
+      continue;
     }
 
-    if (!found_task) {
-      BLI_condition_wait(&pool->num_cond, &pool->num_mutex);
+    /* Sleep until tasks are done or a task can be taken. */
+    BLI_mutex_lock(&scheduler->wait_mutex);
+    atomic_add_and_fetch_int32(&scheduler->num_waiting_threads, 1);
+    if (task_pool_num_get(pool) != 0 && !task_pool_wait_has_work(pool, tls)) {
+      BLI_condition_wait(&scheduler->wait_cond, &scheduler->wait_mutex);
     }
+    atomic_sub_and_fetch_int32(&scheduler->num_waiting_threads, 1);
+    BLI_mutex_unlock(&scheduler->wait_mutex);
   }
-
-  BLI_mutex_unlock(&pool->num_mutex);
-
-  BLI_assert(tls->num_local_queue == 0);
 }
 
 void BLI_task_pool_work_wait_and_reset(TaskPool *pool)
@@ -1007,6 +1347,7 @@ void BLI_task_pool_delayed_push_begin(TaskPool *pool, int thread_id)
     ASSERT_THREAD_ID(pool->scheduler, thread_id);
     TaskThreadLocalStorage *tls = get_task_tls(pool, thread_id);
     tls->do_delayed_push = true;
+    tls->num_delayed_push = 0;
   }
 }
 
@@ -1016,9 +1357,11 @@ void BLI_task_pool_delayed_push_end(TaskPool *pool, int thread_id)
     ASSERT_THREAD_ID(pool->scheduler, thread_id);
     TaskThreadLocalStorage *tls = get_task_tls(pool, thread_id);
     BLI_assert(tls->do_delayed_push);
-    task_scheduler_push_all(pool->scheduler, pool, tls->delayed_queue, tls->num_delayed_queue);
+    if (tls->num_delayed_push != 0) {
+      task_scheduler_wake_threads(pool->scheduler, true);
+    }
     tls->do_delayed_push = false;
-    tls->num_delayed_queue = 0;
+    tls->num_delayed_push = 0;
   }
 }
 
@@ -52,6 +52,18 @@ typedef enum eBlenFileType {
   BLENFILETYPE_RUNTIME = 3,
 } eBlenFileType;
 
+/** Time spent in the phases of #blo_read_file_internal, in seconds. */
+typedef struct BlendFileReadTimings {
+  /** Converting the blocks saved with a different DNA, on all threads. */
+  double reconstruct;
+  /** Reading the data-blocks and their direct data. */
+  double read_blocks;
+  double versioning;
+  /** Reading the linked libraries and linking the data-blocks. */
+  double lib_link;
+  double total;
+} BlendFileReadTimings;
+
 typedef struct BlendFileData {
   struct Main *main;
   struct UserDef *user;
@@ -65,6 +77,8 @@ typedef struct BlendFileData {
   struct ViewLayer *cur_view_layer; /* layer to activate in workspaces when reading without UI */
 
   eBlenFileType type;
+
+  BlendFileReadTimings timings;
 } BlendFileData;
 
 typedef struct WorkspaceConfigFileData {
@@ -0,0 +1,540 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup blenloader
+ *
+ * Seekable block compression of .blend files, see #block_compress.h for the layout.
+ */
+
+#include <string.h>
+
+#ifndef WIN32
+#  include <unistd.h>
+#else
+#  include <io.h>
+#  include "BLI_winstuff.h"
+#endif
+
+#include "zlib.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_system.h"
+#include "BLI_task.h"
+
+#include "block_compress.h"
+
+#define BLOCK_COMPRESS_VERSION '1'
+#define BLOCK_COMPRESS_HEADER_LEN (BLOCK_COMPRESS_MAGIC_LEN + 1)
+
+/* Uncompressed size of a frame, large enough to compress well,
+ * small enough to only decompress the needed part of a file. */
+#define BLOCK_FRAME_SIZE (1 << 20)
+/* Maximum number of frames compressed or decompressed together. */
+#define BLOCK_BATCH_MAX 32
+
+#define BLOCK_INDEX_ENTRY_LEN 16
+#define BLOCK_FOOTER_LEN (16 + BLOCK_COMPRESS_HEADER_LEN)
+
+/* Same speed over size trade off than the gzip compression. */
+#define BLOCK_COMPRESS_LEVEL 1
+
+typedef struct BlockIndexEntry {
+  uint64_t offset;
+  uint32_t compressed_size;
+  uint32_t size;
+} BlockIndexEntry;
+
+/* -------------------------------------------------------------------- */
+/** \name Utilities
+ * \{ */
+
+static void block_store_uint32(uchar *buf, uint32_t value)
+{
+  for (int i = 0; i < 4; i++) {
+    buf[i] = (uchar)(value >> (i * 8));
+  }
+}
+
+static void block_store_uint64(uchar *buf, uint64_t value)
+{
+  for (int i = 0; i < 8; i++) {
+    buf[i] = (uchar)(value >> (i * 8));
+  }
+}
+
+static uint32_t block_load_uint32(const uchar *buf)
+{
+  uint32_t value = 0;
+  for (int i = 0; i < 4; i++) {
+    value |= (uint32_t)buf[i] << (i * 8);
+  }
+  return value;
+}
+
+static uint64_t block_load_uint64(const uchar *buf)
+{
+  uint64_t value = 0;
+  for (int i = 0; i < 8; i++) {
+    value |= (uint64_t)buf[i] << (i * 8);
+  }
+  return value;
+}
+
+static void block_header_fill(char header[BLOCK_COMPRESS_HEADER_LEN])
+{
+  memcpy(header, BLOCK_COMPRESS_MAGIC, BLOCK_COMPRESS_MAGIC_LEN);
+  header[BLOCK_COMPRESS_MAGIC_LEN] = BLOCK_COMPRESS_VERSION;
+}
+
+static bool block_file_write(int file, const void *data, size_t len)
+{
+  while (len > 0) {
+    const int written = write(file, data, (uint)MIN2(len, INT_MAX));
+    if (written <= 0) {
+      return false;
+    }
+    data = POINTER_OFFSET(data, written);
+    len -= (size_t)written;
+  }
+  return true;
+}
+
+static bool block_file_read(int file, void *data, size_t len)
+{
+  while (len > 0) {
+    const int readsize = read(file, data, (uint)MIN2(len, INT_MAX));
+    if (readsize <= 0) {
+      return false;
+    }
+    data = POINTER_OFFSET(data, readsize);
+    len -= (size_t)readsize;
+  }
+  return true;
+}
+
+static int block_batch_size(void)
+{
+  /* Keep all threads busy while the previous frames are written. */
+  return CLAMPIS(BLI_system_thread_count() * 2, 2, BLOCK_BATCH_MAX);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Writing
+ * \{ */
+
+typedef struct BlockWriteFrame {
+  uchar *data;
+  size_t size;
+  uchar *compressed;
+  size_t compressed_size;
+  bool error;
+} BlockWriteFrame;
+
+struct BlockCompressWriter {
+  int file;
+  uint64_t file_offset;
+  bool error;
+
+  /** Frames filled then compressed together, only the last one can be partially filled. */
+  BlockWriteFrame frames[BLOCK_BATCH_MAX];
+  int frames_len;
+  int batch_size;
+
+  BlockIndexEntry *index;
+  uint index_len;
+  uint index_alloc;
+};
+
+static void block_compress_frame_cb(void *__restrict userdata,
+                                    const int index,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BlockWriteFrame *frame = &((BlockWriteFrame *)userdata)[index];
+  uLongf compressed_size = compressBound(BLOCK_FRAME_SIZE);
+
+  frame->error = (compress2(frame->compressed,
+                            &compressed_size,
+                            frame->data,
+                            (uLong)frame->size,
+                            BLOCK_COMPRESS_LEVEL) != Z_OK);
+  frame->compressed_size = compressed_size;
+}
+
+static void block_writer_index_add(BlockCompressWriter *writer, const BlockIndexEntry *entry)
+{
+  if (writer->index_len == writer->index_alloc) {
+    writer->index_alloc = MAX2(writer->index_alloc * 2, 64);
+    writer->index = MEM_reallocN(writer->index, sizeof(*writer->index) * writer->index_alloc);
+  }
+  writer->index[writer->index_len++] = *entry;
+}
+
+/* Compress the filled frames in parallel and write them in order. */
+static void block_writer_flush(BlockCompressWriter *writer)
+{
+  int frames_len = writer->frames_len;
+  if (frames_len > 0 && writer->frames[frames_len - 1].size == 0) {
+    frames_len--;
+  }
+  if (frames_len == 0) {
+    return;
+  }
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, frames_len, writer->frames, block_compress_frame_cb, &settings);
+
+  for (int i = 0; i < frames_len; i++) {
+    BlockWriteFrame *frame = &writer->frames[i];
+    if (frame->error ||
+        !block_file_write(writer->file, frame->compressed, frame->compressed_size)) {
+      writer->error = true;
+    }
+
+    const BlockIndexEntry entry = {
+        writer->file_offset, (uint32_t)frame->compressed_size, (uint32_t)frame->size};
+    block_writer_index_add(writer, &entry);
+
+    writer->file_offset += frame->compressed_size;
+    frame->size = 0;
+  }
+  writer->frames_len = 0;
+}
+
+BlockCompressWriter *blo_block_writer_open(int file)
+{
+  char header[BLOCK_COMPRESS_HEADER_LEN];
+  block_header_fill(header);
+  if (!block_file_write(file, header, sizeof(header))) {
+    return NULL;
+  }
+
+  BlockCompressWriter *writer = MEM_callocN(sizeof(*writer), __func__);
+  writer->file = file;
+  writer->file_offset = sizeof(header);
+  writer->batch_size = block_batch_size();
+
+  for (int i = 0; i < writer->batch_size; i++) {
+    BlockWriteFrame *frame = &writer->frames[i];
+    frame->data = MEM_mallocN(BLOCK_FRAME_SIZE, __func__);
+    frame->compressed = MEM_mallocN(compressBound(BLOCK_FRAME_SIZE), __func__);
+  }
+
+  return writer;
+}
+
+bool blo_block_writer_write(BlockCompressWriter *writer, const void *data, size_t data_len)
+{
+  while (data_len > 0 && !writer->error) {
+    if (writer->frames_len == 0) {
+      writer->frames_len = 1;
+    }
+
+    BlockWriteFrame *frame = &writer->frames[writer->frames_len - 1];
+    const size_t len = MIN2(data_len, BLOCK_FRAME_SIZE - frame->size);
+    memcpy(frame->data + frame->size, data, len);
+    frame->size += len;
+    data = POINTER_OFFSET(data, len);
+    data_len -= len;
+
+    if (frame->size == BLOCK_FRAME_SIZE) {
+      if (writer->frames_len == writer->batch_size) {
+        block_writer_flush(writer);
+      }
+      else {
+        writer->frames_len++;
+      }
+    }
+  }
+
+  return !writer->error;
+}
+
+bool blo_block_writer_close(BlockCompressWriter *writer)
+{
+  block_writer_flush(writer);
+
+  const uint64_t index_offset = writer->file_offset;
+  const size_t index_size = (size_t)writer->index_len * BLOCK_INDEX_ENTRY_LEN;
+  uchar *index = MEM_mallocN(index_size + BLOCK_FOOTER_LEN, __func__);
+
+  for (uint i = 0; i < writer->index_len; i++) {
+    uchar *entry = &index[i * BLOCK_INDEX_ENTRY_LEN];
+    block_store_uint64(entry, writer->index[i].offset);
+    block_store_uint32(entry + 8, writer->index[i].compressed_size);
+    block_store_uint32(entry + 12, writer->index[i].size);
+  }
+
+  uchar *footer = &index[index_size];
+  block_store_uint64(footer, index_offset);
+  block_store_uint32(footer + 8, writer->index_len);
+  block_store_uint32(footer + 12, BLOCK_FRAME_SIZE);
+  block_header_fill((char *)footer + 16);
+
+  if (!writer->error && !block_file_write(writer->file, index, index_size + BLOCK_FOOTER_LEN)) {
+    writer->error = true;
+  }
+  MEM_freeN(index);
+
+  if (close(writer->file) == -1) {
+    writer->error = true;
+  }
+
+  for (int i = 0; i < writer->batch_size; i++) {
+    MEM_freeN(writer->frames[i].data);
+    MEM_freeN(writer->frames[i].compressed);
+  }
+  MEM_SAFE_FREE(writer->index);
+
+  const bool success = !writer->error;
+  MEM_freeN(writer);
+  return success;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Reading
+ * \{ */
+
+typedef struct BlockReadSlot {
+  /** Frame decompressed in this slot, -1 when empty. */
+  int frame;
+  uchar *data;
+  uchar *compressed;
+  bool error;
+} BlockReadSlot;
+
+struct BlockCompressReader {
+  int file;
+  BlockIndexEntry *index;
+  uint frames_len;
+  uint frame_size;
+  uint compressed_size_max;
+  uint64_t size;
+
+  /** Decompressed frames, a frame is always stored in the slot `frame % slots_len`. */
+  BlockReadSlot *slots;
+  int slots_len;
+  /** Last frame read, to detect sequential reading. */
+  int frame_last;
+};
+
+typedef struct BlockDecompressData {
+  BlockCompressReader *reader;
+  BlockReadSlot **slots;
+} BlockDecompressData;
+
+static void block_decompress_frame_cb(void *__restrict userdata,
+                                      const int index,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BlockDecompressData *data = userdata;
+  BlockReadSlot *slot = data->slots[index];
+  const BlockIndexEntry *entry = &data->reader->index[slot->frame];
+  uLongf size = entry->size;
+
+  slot->error = (uncompress(slot->data, &size, slot->compressed, entry->compressed_size) !=
+                     Z_OK ||
+                 size != entry->size);
+}
+
+/* Decompress `frame`, and the following frames when reading sequentially. */
+static bool block_reader_load(BlockCompressReader *reader, int frame)
+{
+  const bool sequential = (frame == reader->frame_last + 1);
+  const int frame_end = sequential ? MIN2(frame + reader->slots_len, (int)reader->frames_len) :
+                                     frame + 1;
+
+  BlockReadSlot *slots[BLOCK_BATCH_MAX];
+  int slots_len = 0;
+
+  /* Reading the file isn't thread safe, load the compressed frames first. */
+  for (int i = frame; i < frame_end; i++) {
+    BlockReadSlot *slot = &reader->slots[i % reader->slots_len];
+    if (slot->frame == i) {
+      continue;
+    }
+    const BlockIndexEntry *entry = &reader->index[i];
+    slot->frame = -1;
+    /* Buffers are allocated on first use, small files only use a few slots. */
+    if (slot->data == NULL) {
+      slot->data = MEM_mallocN(reader->frame_size, __func__);
+      slot->compressed = MEM_mallocN(MAX2(reader->compressed_size_max, 1), __func__);
+    }
+    if (lseek(reader->file, (int64_t)entry->offset, SEEK_SET) == -1 ||
+        !block_file_read(reader->file, slot->compressed, entry->compressed_size)) {
+      return false;
+    }
+    slot->frame = i;
+    slots[slots_len++] = slot;
+  }
+
+  BlockDecompressData data = {reader, slots};
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (slots_len > 1);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, slots_len, &data, block_decompress_frame_cb, &settings);
+
+  bool success = true;
+  for (int i = 0; i < slots_len; i++) {
+    if (slots[i]->error) {
+      slots[i]->frame = -1;
+      success = false;
+    }
+  }
+  return success;
+}
+
+bool blo_block_compress_check_magic(const char *header)
+{
+  return memcmp(header, BLOCK_COMPRESS_MAGIC, BLOCK_COMPRESS_MAGIC_LEN) == 0;
+}
+
+BlockCompressReader *blo_block_reader_open(int file)
+{
+  char header[BLOCK_COMPRESS_HEADER_LEN], header_expected[BLOCK_COMPRESS_HEADER_LEN];
+  uchar footer[BLOCK_FOOTER_LEN];
+  block_header_fill(header_expected);
+
+  const int64_t file_size = lseek(file, 0, SEEK_END);
+  if (file_size < BLOCK_COMPRESS_HEADER_LEN + BLOCK_FOOTER_LEN ||
+      lseek(file, 0, SEEK_SET) == -1 || !block_file_read(file, header, sizeof(header)) ||
+      memcmp(header, header_expected, sizeof(header)) != 0) {
+    return NULL;
+  }
+
+  if (lseek(file, file_size - BLOCK_FOOTER_LEN, SEEK_SET) == -1 ||
+      !block_file_read(file, footer, sizeof(footer)) ||
+      memcmp(footer + 16, header_expected, sizeof(header)) != 0) {
+    return NULL;
+  }
+
+  const uint64_t index_offset = block_load_uint64(footer);
+  const uint frames_len = block_load_uint32(footer + 8);
+  const uint frame_size = block_load_uint32(footer + 12);
+  const uint64_t index_size = (uint64_t)frames_len * BLOCK_INDEX_ENTRY_LEN;
+
+  if (frame_size == 0 || index_offset < BLOCK_COMPRESS_HEADER_LEN ||
+      index_offset + index_size != (uint64_t)(file_size - BLOCK_FOOTER_LEN)) {
+    return NULL;
+  }
+
+  uchar *index = MEM_mallocN(MAX2(index_size, 1), __func__);
+  if (lseek(file, (int64_t)index_offset, SEEK_SET) == -1 ||
+      !block_file_read(file, index, index_size)) {
+    MEM_freeN(index);
+    return NULL;
+  }
+
+  BlockCompressReader *reader = MEM_callocN(sizeof(*reader), __func__);
+  reader->file = file;
+  reader->frames_len = frames_len;
+  reader->frame_size = frame_size;
+  reader->index = MEM_malloc_arrayN(MAX2(frames_len, 1), sizeof(*reader->index), __func__);
+
+  /* Validate the index so reading never goes out of the frames. */
+  bool valid = true;
+  uint64_t offset = BLOCK_COMPRESS_HEADER_LEN;
+  for (uint i = 0; i < frames_len; i++) {
+    BlockIndexEntry *entry = &reader->index[i];
+    entry->offset = block_load_uint64(&index[i * BLOCK_INDEX_ENTRY_LEN]);
+    entry->compressed_size = block_load_uint32(&index[i * BLOCK_INDEX_ENTRY_LEN + 8]);
+    entry->size = block_load_uint32(&index[i * BLOCK_INDEX_ENTRY_LEN + 12]);
+
+    const bool is_last = (i == frames_len - 1);
+    if (entry->offset != offset || entry->size == 0 || entry->size > frame_size ||
+        (!is_last && entry->size != frame_size)) {
+      valid = false;
+      break;
+    }
+    offset += entry->compressed_size;
+    reader->compressed_size_max = MAX2(reader->compressed_size_max, entry->compressed_size);
+    reader->size += entry->size;
+  }
+  MEM_freeN(index);
+
+  if (!valid || offset != index_offset) {
+    blo_block_reader_free(reader);
+    return NULL;
+  }
+
+  reader->slots_len = block_batch_size();
+  reader->slots = MEM_calloc_arrayN(reader->slots_len, sizeof(*reader->slots), __func__);
+  for (int i = 0; i < reader->slots_len; i++) {
+    reader->slots[i].frame = -1;
+  }
+  reader->frame_last = -1;
+
+  return reader;
+}
+
+void blo_block_reader_free(BlockCompressReader *reader)
+{
+  if (reader->slots) {
+    for (int i = 0; i < reader->slots_len; i++) {
+      MEM_SAFE_FREE(reader->slots[i].data);
+      MEM_SAFE_FREE(reader->slots[i].compressed);
+    }
+    MEM_freeN(reader->slots);
+  }
+  MEM_freeN(reader->index);
+  MEM_freeN(reader);
+}
+
+uint64_t blo_block_reader_size(const BlockCompressReader *reader)
+{
+  return reader->size;
+}
+
+int64_t blo_block_reader_read(BlockCompressReader *reader,
+                              void *buffer,
+                              uint64_t offset,
+                              size_t size)
+{
+  size_t readsize = 0;
+
+  while (readsize < size && offset < reader->size) {
+    const int frame = (int)(offset / reader->frame_size);
+    BlockReadSlot *slot = &reader->slots[frame % reader->slots_len];
+
+    if (slot->frame != frame) {
+      if (!block_reader_load(reader, frame)) {
+        return -1;
+      }
+    }
+    reader->frame_last = frame;
+
+    const BlockIndexEntry *entry = &reader->index[frame];
+    const size_t frame_offset = (size_t)(offset - (uint64_t)frame * reader->frame_size);
+    const size_t len = MIN2(size - readsize, entry->size - frame_offset);
+
+    memcpy(POINTER_OFFSET(buffer, readsize), slot->data + frame_offset, len);
+    readsize += len;
+    offset += len;
+  }
+
+  return (int64_t)readsize;
+}
+
+/** \} */
@@ -0,0 +1,68 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ * blenloader block compressed file private function prototypes
+ */
+
+/** \file
+ * \ingroup blenloader
+ */
+
+#ifndef __BLOCK_COMPRESS_H__
+#define __BLOCK_COMPRESS_H__
+
+#include "BLI_sys_types.h"
+
+/**
+ * Block compressed .blend files.
+ *
+ * The file content is split in frames of a fixed uncompressed size, each frame is an
+ * independent zlib stream so they are compressed and decompressed on all threads.
+ * An index of the frames is written after them, allowing to seek in the file and only
+ * decompress the frames of the blocks which are read.
+ *
+ * Layout, all integers are little endian:
+ * - Header: #BLOCK_COMPRESS_MAGIC followed by the format version.
+ * - Frames.
+ * - Index: for each frame its file offset (uint64), compressed and uncompressed size (uint32).
+ * - Footer: index file offset (uint64), number of frames and uncompressed frame size (uint32),
+ *   followed by the header again.
+ */
+
+/* The first 7 bytes, read to recognize the file format. */
+#define BLOCK_COMPRESS_MAGIC "BLENDZB"
+#define BLOCK_COMPRESS_MAGIC_LEN 7
+
+typedef struct BlockCompressWriter BlockCompressWriter;
+typedef struct BlockCompressReader BlockCompressReader;
+
+/* Writing, the file is owned by the writer and closed by #blo_block_writer_close. */
+BlockCompressWriter *blo_block_writer_open(int file);
+bool blo_block_writer_write(BlockCompressWriter *writer, const void *data, size_t data_len);
+/* Write the remaining frames and the index, return false if any write failed. */
+bool blo_block_writer_close(BlockCompressWriter *writer);
+
+/* Reading, the file is not owned by the reader. */
+bool blo_block_compress_check_magic(const char *header);
+BlockCompressReader *blo_block_reader_open(int file);
+void blo_block_reader_free(BlockCompressReader *reader);
+/* Size of the uncompressed content. */
+uint64_t blo_block_reader_size(const BlockCompressReader *reader);
+/* Read uncompressed content at `offset`, return the size read or -1 on error. */
+int64_t blo_block_reader_read(BlockCompressReader *reader,
+                              void *buffer,
+                              uint64_t offset,
+                              size_t size);
+
+#endif /* __BLOCK_COMPRESS_H__ */
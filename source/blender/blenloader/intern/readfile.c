@@ -105,7 +105,11 @@
 #include "BLI_math.h"
 #include "BLI_threads.h"
 #include "BLI_mempool.h"
+#include "BLI_mmap.h"
 #include "BLI_ghash.h"
+#include "BLI_task.h"
+
+#include "PIL_time.h"
 
 #include "BLT_translation.h"
 
@@ -163,6 +167,7 @@
 
 #include "RE_engine.h"
 
+#include "block_compress.h"
 #include "readfile.h"
 
 #include <errno.h>
@@ -230,6 +235,9 @@
  *
  * \note This is disabled when using compression,
  * while zlib supports seek it's unusably slow, see: T61880.
+ *
+ * When the file is memory mapped the delayed blocks are never copied,
+ * their data is read in place from the mapping.
  */
 #define USE_BHEAD_READ_ON_DEMAND
 
@@ -269,6 +277,8 @@ typedef struct BHeadN {
   /** When set, the remainder of this allocation is the data, otherwise it needs to be read. */
   bool has_data;
 #endif
+  /** Data converted to the current DNA ahead of #read_struct, see #read_file_reconstruct. */
+  void *reconstructed;
   struct BHead bhead;
 } BHeadN;
 
@@ -866,6 +876,7 @@ static BHeadN *get_bhead(FileData *fd)
           new_bhead->next = new_bhead->prev = NULL;
           new_bhead->file_offset = fd->file_offset;
           new_bhead->has_data = false;
+          new_bhead->reconstructed = NULL;
           new_bhead->bhead = bhead;
           off64_t seek_new = fd->seek(fd, bhead.len, SEEK_CUR);
           if (seek_new == -1) {
@@ -888,6 +899,7 @@ static BHeadN *get_bhead(FileData *fd)
           new_bhead->file_offset = 0; /* don't seek. */
           new_bhead->has_data = true;
 #endif
+          new_bhead->reconstructed = NULL;
           new_bhead->bhead = bhead;
 
           readsize = fd->read(fd, new_bhead + 1, bhead.len);
@@ -970,11 +982,29 @@ BHead *blo_bhead_next(FileData *fd, BHead *thisblock)
 }
 
 #ifdef USE_BHEAD_READ_ON_DEMAND
+/**
+ * Data of a delayed block in the mapped file, NULL when the file isn't mapped.
+ */
+static const void *blo_bhead_data_mapped(FileData *fd, BHead *thisblock)
+{
+  BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
+  BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+  if (fd->mmap_file == NULL) {
+    return NULL;
+  }
+  return POINTER_OFFSET(BLI_mmap_get_pointer(fd->mmap_file), new_bhead->file_offset);
+}
+
 static bool blo_bhead_read_data(FileData *fd, BHead *thisblock, void *buf)
 {
   bool success = true;
   BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
   BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+  const void *mapped_data = blo_bhead_data_mapped(fd, thisblock);
+  if (mapped_data != NULL) {
+    memcpy(buf, mapped_data, new_bhead->bhead.len);
+    return true;
+  }
   off64_t offset_backup = fd->file_offset;
   if (UNLIKELY(fd->seek(fd, new_bhead->file_offset, SEEK_SET) == -1)) {
     success = false;
@@ -997,6 +1027,7 @@ static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock)
   new_bhead_data->bhead = new_bhead->bhead;
   new_bhead_data->file_offset = new_bhead->file_offset;
   new_bhead_data->has_data = true;
+  new_bhead_data->reconstructed = NULL;
   if (!blo_bhead_read_data(fd, thisblock, new_bhead_data + 1)) {
     MEM_freeN(new_bhead_data);
     return NULL;
@@ -1083,6 +1114,8 @@ static bool read_file_dna(FileData *fd, const char **r_error_message)
       if (fd->filesdna) {
         blo_do_versions_dna(fd->filesdna, fd->fileversion, subversion);
         fd->compflags = DNA_struct_get_compareflags(fd->filesdna, fd->memsdna);
+        fd->reconstruct_info = DNA_reconstruct_info_create(
+            fd->filesdna, fd->memsdna, fd->compflags);
         /* used to retrieve ID names from (bhead+1) */
         fd->id_name_offs = DNA_elem_offset(fd->filesdna, "ID", "char", "name[]");
 
@@ -1198,6 +1231,76 @@ static int fd_read_from_memory(FileData *filedata, void *buffer, uint size)
   return (readsize);
 }
 
+/* Seeking in content of a known length, read from memory. */
+
+static off64_t fd_seek_in_range(FileData *filedata, off64_t offset, int whence, off64_t length)
+{
+  off64_t new_offset;
+
+  switch (whence) {
+    case SEEK_SET:
+      new_offset = offset;
+      break;
+    case SEEK_CUR:
+      new_offset = filedata->file_offset + offset;
+      break;
+    case SEEK_END:
+      new_offset = length + offset;
+      break;
+    default:
+      return -1;
+  }
+
+  if (new_offset < 0 || new_offset > length) {
+    return -1;
+  }
+  filedata->file_offset = new_offset;
+  return new_offset;
+}
+
+/* Block compressed file reading. */
+
+static int fd_read_from_blocks(FileData *filedata, void *buffer, uint size)
+{
+  const int64_t readsize = blo_block_reader_read(
+      filedata->block_reader, buffer, (uint64_t)filedata->file_offset, size);
+
+  if (readsize < 0) {
+    return EOF;
+  }
+  filedata->file_offset += readsize;
+
+  return (int)readsize;
+}
+
+static off64_t fd_seek_from_blocks(FileData *filedata, off64_t offset, int whence)
+{
+  return fd_seek_in_range(
+      filedata, offset, whence, (off64_t)blo_block_reader_size(filedata->block_reader));
+}
+
+/* Memory mapped file reading. */
+
+static int fd_read_from_mmap(FileData *filedata, void *buffer, uint size)
+{
+  const size_t length = BLI_mmap_get_length(filedata->mmap_file);
+  /* don't read more bytes then there are available in the file */
+  const size_t readsize = MIN2((size_t)size, length - (size_t)filedata->file_offset);
+
+  memcpy(buffer,
+         POINTER_OFFSET(BLI_mmap_get_pointer(filedata->mmap_file), filedata->file_offset),
+         readsize);
+  filedata->file_offset += readsize;
+
+  return (int)readsize;
+}
+
+static off64_t fd_seek_from_mmap(FileData *filedata, off64_t offset, int whence)
+{
+  return fd_seek_in_range(
+      filedata, offset, whence, (off64_t)BLI_mmap_get_length(filedata->mmap_file));
+}
+
 /* MemFile reading. */
 
 static int fd_read_from_memfile(FileData *filedata, void *buffer, uint size)
@@ -1311,6 +1414,8 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   FileDataSeekFn *seek_fn = NULL; /* Optional. */
 
   gzFile gzfile = (gzFile)Z_NULL;
+  BLI_mmap_file *mmap_file = NULL;
+  BlockCompressReader *block_reader = NULL;
 
   char header[7];
 
@@ -1335,8 +1440,17 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
     /* Regular file. */
     if (memcmp(header, "BLENDER", sizeof(header)) == 0) {
-      read_fn = fd_read_data_from_file;
-      seek_fn = fd_seek_data_from_file;
+      /* Map local files, the blocks are then read in place without system calls
+       * and the delayed data is never copied into the block list. */
+      mmap_file = BLI_mmap_open(file);
+      if (mmap_file != NULL) {
+        read_fn = fd_read_from_mmap;
+        seek_fn = fd_seek_from_mmap;
+      }
+      else {
+        read_fn = fd_read_data_from_file;
+        seek_fn = fd_seek_data_from_file;
+      }
     }
 
     /* Gzip file. */
@@ -1361,6 +1475,18 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
       }
     }
 
+    /* Block compressed file. */
+    if ((read_fn == NULL) && blo_block_compress_check_magic(header)) {
+      block_reader = blo_block_reader_open(file);
+      if (block_reader == NULL) {
+        BKE_reportf(reports, RPT_WARNING, "Unable to read compressed blocks of '%s'", filepath);
+        return NULL;
+      }
+      /* Frames are decompressed on demand, seeking is cheap. */
+      read_fn = fd_read_from_blocks;
+      seek_fn = fd_seek_from_blocks;
+    }
+
     if (read_fn == NULL) {
       BKE_reportf(reports, RPT_WARNING, "Unrecognized file format '%s'", filepath);
       return NULL;
@@ -1370,6 +1496,8 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
     fd->filedes = file;
     fd->gzfiledes = gzfile;
+    fd->mmap_file = mmap_file;
+    fd->block_reader = block_reader;
 
     fd->read = read_fn;
     fd->seek = seek_fn;
@@ -1552,6 +1680,23 @@ void blo_filedata_free(FileData *fd)
       fd->buffer = NULL;
     }
 
+    if (fd->mmap_file) {
+      BLI_mmap_free(fd->mmap_file);
+      fd->mmap_file = NULL;
+    }
+
+    if (fd->block_reader) {
+      blo_block_reader_free(fd->block_reader);
+      fd->block_reader = NULL;
+    }
+
+    /* Blocks reconstructed ahead but never read. */
+    LISTBASE_FOREACH (BHeadN *, new_bhead, &fd->bhead_list) {
+      if (new_bhead->reconstructed) {
+        MEM_freeN(new_bhead->reconstructed);
+      }
+    }
+
     /* Free all BHeadN data blocks */
 #ifndef NDEBUG
     BLI_freelistN(&fd->bhead_list);
@@ -1568,6 +1713,9 @@ void blo_filedata_free(FileData *fd)
     if (fd->filesdna) {
       DNA_sdna_free(fd->filesdna);
     }
+    if (fd->reconstruct_info) {
+      DNA_reconstruct_info_free(fd->reconstruct_info);
+    }
     if (fd->compflags) {
       MEM_freeN((void *)fd->compflags);
     }
@@ -2236,6 +2384,13 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
   void *temp = NULL;
 
   if (bh->len) {
+    BHeadN *new_bhead = BHEADN_FROM_BHEAD(bh);
+    if (new_bhead->reconstructed) {
+      temp = new_bhead->reconstructed;
+      new_bhead->reconstructed = NULL;
+      return temp;
+    }
+
 #ifdef USE_BHEAD_READ_ON_DEMAND
     BHead *bh_orig = bh;
 #endif
@@ -2256,17 +2411,23 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 
     if (fd->compflags[bh->SDNAnr] != SDNA_CMP_REMOVED) {
       if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
+        const void *data = (bh + 1);
 #ifdef USE_BHEAD_READ_ON_DEMAND
         if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
-          bh = blo_bhead_read_full(fd, bh);
-          if (UNLIKELY(bh == NULL)) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
-            return NULL;
+          /* Reconstruct from the mapped file when its alignment is the one of an allocation,
+           * blocks are only 4 bytes aligned in the file. */
+          data = blo_bhead_data_mapped(fd, bh);
+          if (data == NULL || ((uintptr_t)data & 7) != 0) {
+            bh = blo_bhead_read_full(fd, bh);
+            if (UNLIKELY(bh == NULL)) {
+              fd->flags &= ~FD_FLAGS_FILE_OK;
+              return NULL;
+            }
+            data = (bh + 1);
           }
         }
 #endif
-        temp = DNA_struct_reconstruct(
-            fd->memsdna, fd->filesdna, fd->compflags, bh->SDNAnr, bh->nr, (bh + 1));
+        temp = DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, data);
       }
       else {
         /* SDNA_CMP_EQUAL */
@@ -2299,6 +2460,123 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
   return temp;
 }
 
+/* Size of the data read from the file for a batch of reconstructed blocks,
+ * the data of blocks which are neither in memory nor mapped is kept until its batch is done. */
+#define RECONSTRUCT_BATCH_SIZE (64 * 1024 * 1024)
+
+typedef struct ReconstructTaskData {
+  const DNA_ReconstructInfo *reconstruct_info;
+  BHead **bheads;
+  const void **bheads_data;
+} ReconstructTaskData;
+
+static void read_file_reconstruct_task(void *__restrict userdata,
+                                       const int index,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ReconstructTaskData *data = userdata;
+  BHead *bh = data->bheads[index];
+
+  if (data->bheads_data[index] != NULL) {
+    BHEADN_FROM_BHEAD(bh)->reconstructed = DNA_struct_reconstruct(
+        data->reconstruct_info, bh->SDNAnr, bh->nr, data->bheads_data[index]);
+  }
+}
+
+static bool read_file_reconstruct_needed(const FileData *fd, const BHead *bh)
+{
+  return bh->len && (bh->code == DATA || BKE_idcode_is_valid(bh->code)) &&
+         fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL;
+}
+
+/**
+ * Convert the blocks saved with a different DNA on all threads before reading them,
+ * #read_struct then only has to return the converted data.
+ */
+static void read_file_reconstruct(FileData *fd)
+{
+  if (fd->flags & FD_FLAGS_SWITCH_ENDIAN) {
+    /* Blocks are switched in place by #read_struct before they are converted. */
+    return;
+  }
+
+  int bheads_len = 0;
+  for (BHead *bh = blo_bhead_first(fd); bh; bh = blo_bhead_next(fd, bh)) {
+    if (read_file_reconstruct_needed(fd, bh)) {
+      bheads_len++;
+    }
+  }
+  if (bheads_len == 0) {
+    return;
+  }
+
+  BHead **bheads = MEM_malloc_arrayN(bheads_len, sizeof(*bheads), __func__);
+  const void **bheads_data = MEM_malloc_arrayN(bheads_len, sizeof(*bheads_data), __func__);
+  void **bheads_buffer = MEM_calloc_arrayN(bheads_len, sizeof(*bheads_buffer), __func__);
+
+  int index = 0;
+  for (BHead *bh = blo_bhead_first(fd); bh; bh = blo_bhead_next(fd, bh)) {
+    if (read_file_reconstruct_needed(fd, bh)) {
+      bheads[index++] = bh;
+    }
+  }
+
+  ReconstructTaskData data = {
+      .reconstruct_info = fd->reconstruct_info,
+      .bheads = bheads,
+      .bheads_data = bheads_data,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 16;
+
+  int batch_start = 0;
+  while (batch_start < bheads_len) {
+    size_t batch_size = 0;
+    int batch_end = batch_start;
+
+    /* Reading from the file isn't thread safe, gather the data of the batch first. */
+    for (; batch_end < bheads_len && batch_size < RECONSTRUCT_BATCH_SIZE; batch_end++) {
+      BHead *bh = bheads[batch_end];
+      const void *bh_data = (bh + 1);
+#ifdef USE_BHEAD_READ_ON_DEMAND
+      if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
+        /* Same alignment requirement as #read_struct. */
+        bh_data = blo_bhead_data_mapped(fd, bh);
+        if (bh_data == NULL || ((uintptr_t)bh_data & 7) != 0) {
+          void *buffer = MEM_mallocN(bh->len, __func__);
+          if (blo_bhead_read_data(fd, bh, buffer)) {
+            bheads_buffer[batch_end] = buffer;
+            batch_size += bh->len;
+            bh_data = buffer;
+          }
+          else {
+            /* Let #read_struct report the error. */
+            MEM_freeN(buffer);
+            bh_data = NULL;
+          }
+        }
+      }
+#endif
+      bheads_data[batch_end] = bh_data;
+    }
+
+    BLI_task_parallel_range(batch_start, batch_end, &data, read_file_reconstruct_task, &settings);
+
+    for (int i = batch_start; i < batch_end; i++) {
+      if (bheads_buffer[i]) {
+        MEM_freeN(bheads_buffer[i]);
+      }
+    }
+    batch_start = batch_end;
+  }
+
+  MEM_freeN(bheads);
+  MEM_freeN((void *)bheads_data);
+  MEM_freeN(bheads_buffer);
+}
+
 typedef void (*link_list_cb)(FileData *fd, void *data);
 
 static void link_list_ex(FileData *fd, ListBase *lb, link_list_cb callback) /* only direct data */
@@ -9874,6 +10152,8 @@ static BHead *read_userdef(BlendFileData *bfd, FileData *fd, BHead *bhead)
 
 BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 {
+  const double time_start = PIL_check_seconds_timer();
+  double time_phase;
   BHead *bhead = blo_bhead_first(fd);
   BlendFileData *bfd;
   ListBase mainlist = {NULL, NULL};
@@ -9913,6 +10193,13 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     }
   }
 
+  if ((fd->skip_flags & BLO_READ_SKIP_DATA) == 0 && fd->memfile == NULL) {
+    time_phase = PIL_check_seconds_timer();
+    read_file_reconstruct(fd);
+    bfd->timings.reconstruct = PIL_check_seconds_timer() - time_phase;
+  }
+
+  time_phase = PIL_check_seconds_timer();
   while (bhead) {
     switch (bhead->code) {
       case DATA:
@@ -9963,8 +10250,10 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
         }
     }
   }
+  bfd->timings.read_blocks = PIL_check_seconds_timer() - time_phase;
 
   /* do before read_libraries, but skip undo case */
+  time_phase = PIL_check_seconds_timer();
   if (fd->memfile == NULL) {
     if ((fd->skip_flags & BLO_READ_SKIP_DATA) == 0) {
       do_versions(fd, NULL, bfd->main);
@@ -9974,13 +10263,16 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
       do_versions_userdef(fd, bfd);
     }
   }
+  bfd->timings.versioning = PIL_check_seconds_timer() - time_phase;
 
   if ((fd->skip_flags & BLO_READ_SKIP_DATA) == 0) {
+    time_phase = PIL_check_seconds_timer();
     read_libraries(fd, &mainlist);
 
     blo_join_main(&mainlist);
 
     lib_link_all(fd, bfd->main);
+    bfd->timings.lib_link = PIL_check_seconds_timer() - time_phase;
 
     /* Skip in undo case. */
     if (fd->memfile == NULL) {
@@ -9994,12 +10286,14 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
       BKE_main_id_refcount_recompute(bfd->main, false);
 
       /* Yep, second splitting... but this is a very cheap operation, so no big deal. */
+      time_phase = PIL_check_seconds_timer();
       blo_split_main(&mainlist, bfd->main);
       for (Main *mainvar = mainlist.first; mainvar; mainvar = mainvar->next) {
         BLI_assert(mainvar->versionfile != 0);
         do_versions_after_linking(mainvar, fd->reports);
       }
       blo_join_main(&mainlist);
+      bfd->timings.versioning += PIL_check_seconds_timer() - time_phase;
 
       /* And we have to compute those userrefcounts again, as `do_versions_after_linking()` does
        * not always properly handle user counts, and/or that function does not take into account
@@ -10031,6 +10325,8 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 
   fd->mainlist = NULL; /* Safety, this is local variable, shall not be used afterward. */
 
+  bfd->timings.total = PIL_check_seconds_timer() - time_start;
+
   return bfd;
 }
 
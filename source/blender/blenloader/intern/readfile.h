@@ -79,6 +79,10 @@ typedef struct FileData {
 
 	/** Variables needed for reading from file. */
 	gzFile gzfiledes;
+	/** Mapping of uncompressed local files, read in place. */
+	struct BLI_mmap_file *mmap_file;
+	/** Block compressed files, see #block_compress.h. */
+	struct BlockCompressReader *block_reader;
 	/** Gzip stream for memory decompression. */
 	z_stream strm;
 
@@ -91,6 +95,8 @@ typedef struct FileData {
 	const struct SDNA *memsdna;
 	/** Array of #eSDNA_StructCompare. */
 	const char *compflags;
+	/** Conversion of the structs which are not equal, see #DNA_reconstruct_info_create. */
+	struct DNA_ReconstructInfo *reconstruct_info;
 
 	int fileversion;
 	/** Used to retrieve ID names from (bhead+1). */
@@ -179,6 +179,7 @@
 #include "BLO_undofile.h"
 #include "BLO_writefile.h"
 
+#include "block_compress.h"
 #include "readfile.h"
 
 /* for SDNA_TYPE_FROM_STRUCT() macro */
@@ -205,6 +206,7 @@
 typedef enum {
   WW_WRAP_NONE = 1,
   WW_WRAP_ZLIB,
+  WW_WRAP_ZLIB_BLOCKS,
 } eWriteWrapType;
 
 typedef struct WriteWrap WriteWrap;
@@ -221,6 +223,7 @@ struct WriteWrap {
   union {
     int file_handle;
     gzFile gz_handle;
+    BlockCompressWriter *block_handle;
   } _user_data;
 };
 
@@ -278,6 +281,34 @@ static size_t ww_write_zlib(WriteWrap *ww, const char *buf, size_t buf_len)
 }
 #undef FILE_HANDLE
 
+/* zlib blocks */
+#define FILE_HANDLE(ww) (ww)->_user_data.block_handle
+
+static bool ww_open_zlib_blocks(WriteWrap *ww, const char *filepath)
+{
+  int file;
+
+  file = BLI_open(filepath, O_BINARY + O_WRONLY + O_CREAT + O_TRUNC, 0666);
+
+  if (file != -1) {
+    FILE_HANDLE(ww) = blo_block_writer_open(file);
+    if (FILE_HANDLE(ww) != NULL) {
+      return true;
+    }
+    close(file);
+  }
+  return false;
+}
+static bool ww_close_zlib_blocks(WriteWrap *ww)
+{
+  return blo_block_writer_close(FILE_HANDLE(ww));
+}
+static size_t ww_write_zlib_blocks(WriteWrap *ww, const char *buf, size_t buf_len)
+{
+  return blo_block_writer_write(FILE_HANDLE(ww), buf, buf_len) ? buf_len : 0;
+}
+#undef FILE_HANDLE
+
 /* --- end compression types --- */
 
 static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
@@ -292,6 +323,13 @@ static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
       r_ww->use_buf = false;
       break;
     }
+    case WW_WRAP_ZLIB_BLOCKS: {
+      r_ww->open = ww_open_zlib_blocks;
+      r_ww->close = ww_close_zlib_blocks;
+      r_ww->write = ww_write_zlib_blocks;
+      r_ww->use_buf = false;
+      break;
+    }
     default: {
       r_ww->open = ww_open_none;
       r_ww->close = ww_close_none;
@@ -4267,7 +4305,7 @@ bool BLO_write_file(Main *mainvar,
   BLI_snprintf(tempname, sizeof(tempname), "%s@", filepath);
 
   if (write_flags & G_FILE_COMPRESS) {
-    ww_type = WW_WRAP_ZLIB;
+    ww_type = (write_flags & G_FILE_COMPRESS_BLOCKS) ? WW_WRAP_ZLIB_BLOCKS : WW_WRAP_ZLIB;
   }
   else {
     ww_type = WW_WRAP_NONE;
@@ -4314,9 +4352,12 @@ bool BLO_write_file(Main *mainvar,
   }
 
   /* actual file writing */
-  const bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, thumb);
+  bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, thumb);
 
-  ww.close(&ww);
+  /* Block compression writes the last frames and the index on close. */
+  if (ww.close(&ww) == false) {
+    err = true;
+  }
 
   if (UNLIKELY(path_list_backup)) {
     BKE_bpath_list_restore(mainvar, path_list_flag, path_list_backup);
@@ -109,4 +109,7 @@ typedef enum OrderOfChunks {
 
 #define COM_BLUR_BOKEH_PIXELS 512
 
+/** \brief maximum memory used by the buffers kept between executions, in bytes */
+#define COM_RESULT_CACHE_LIMIT ((size_t)1024 * 1024 * 1024)
+
 #endif /* __COM_DEFINES_H__ */
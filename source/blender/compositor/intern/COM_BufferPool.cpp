@@ -0,0 +1,67 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#include <map>
+
+#include "COM_BufferPool.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_threads.h"
+}
+
+/* Released arrays by size in floats. */
+typedef std::multimap<size_t, float *> FreeBuffers;
+
+static FreeBuffers g_free_buffers;
+static ThreadMutex g_pool_mutex = BLI_MUTEX_INITIALIZER;
+
+float *BufferPool::acquire(size_t num_floats)
+{
+  BLI_mutex_lock(&g_pool_mutex);
+  /* Reuse the smallest array large enough, unless it would waste more than half of it. */
+  FreeBuffers::iterator it = g_free_buffers.lower_bound(num_floats);
+  if (it != g_free_buffers.end() && it->first <= num_floats * 2) {
+    float *buffer = it->second;
+    g_free_buffers.erase(it);
+    BLI_mutex_unlock(&g_pool_mutex);
+    return buffer;
+  }
+  BLI_mutex_unlock(&g_pool_mutex);
+
+  return (float *)MEM_mallocN_aligned(sizeof(float) * num_floats, 16, "COM_BufferPool");
+}
+
+void BufferPool::release(float *buffer)
+{
+  const size_t num_floats = MEM_allocN_len(buffer) / sizeof(float);
+  BLI_mutex_lock(&g_pool_mutex);
+  g_free_buffers.insert(FreeBuffers::value_type(num_floats, buffer));
+  BLI_mutex_unlock(&g_pool_mutex);
+}
+
+void BufferPool::clear()
+{
+  BLI_mutex_lock(&g_pool_mutex);
+  for (FreeBuffers::iterator it = g_free_buffers.begin(); it != g_free_buffers.end(); ++it) {
+    MEM_freeN(it->second);
+  }
+  g_free_buffers.clear();
+  BLI_mutex_unlock(&g_pool_mutex);
+}
@@ -0,0 +1,52 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#ifndef __COM_BUFFERPOOL_H__
+#define __COM_BUFFERPOOL_H__
+
+#include <cstddef>
+
+/**
+ * \brief pool of the float arrays of intermediate buffers
+ *
+ * The buffer execution calculates the inputs of an operation into temporarily buffers the size
+ * of a chunk. Chunks mostly share the same size, so released arrays are kept and reused for the
+ * next chunks instead of being allocated for each of them.
+ * \see NodeOperation.executeArea
+ * \ingroup Memory
+ */
+class BufferPool {
+ public:
+  /**
+   * \brief get an array of at least `num_floats` floats, aligned on 16 bytes
+   */
+  static float *acquire(size_t num_floats);
+
+  /**
+   * \brief give an array back to the pool
+   */
+  static void release(float *buffer);
+
+  /**
+   * \brief free all the arrays of the pool
+   * \note called at the end of an execution, all the arrays must have been released
+   */
+  static void clear();
+};
+
+#endif
@@ -268,6 +268,14 @@ class CompositorContext {
   {
     return (this->getbNodeTree()->flag & NTREE_COM_GROUPNODE_BUFFER) != 0;
   }
+  bool isBufferExecutionEnabled() const
+  {
+    return (this->getbNodeTree()->flag & NTREE_COM_BUFFER_EXECUTION) != 0;
+  }
+  bool isResultCacheEnabled() const
+  {
+    return (this->getbNodeTree()->flag & NTREE_COM_RESULT_CACHE) != 0;
+  }
 };
 
 #endif
@@ -378,6 +378,17 @@ class ExecutionGroup {
    */
   void deinitExecution();
 
+  /**
+   * \brief mark all chunks as executed, when the output buffer was restored from the ResultCache
+   * \note must be called after initExecution
+   */
+  void setChunksExecuted();
+
+  /**
+   * \brief have all chunks of this group been executed
+   */
+  bool isFullyExecuted() const;
+
   /**
    * \brief schedule an ExecutionGroup
    * \note this method will return when all chunks have been calculated, or the execution has
@@ -32,6 +32,9 @@ extern "C" {
 #include "COM_ExecutionGroup.h"
 #include "COM_WorkScheduler.h"
 #include "COM_ReadBufferOperation.h"
+#include "COM_WriteBufferOperation.h"
+#include "COM_BufferPool.h"
+#include "COM_ResultCache.h"
 #include "COM_Debug.h"
 
 #ifdef WITH_CXX_GUARDEDALLOC
@@ -152,6 +155,8 @@ void ExecutionSystem::execute()
   for (index = 0; index < this->m_operations.size(); index++) {
     NodeOperation *operation = this->m_operations[index];
     if (operation->isWriteBufferOperation()) {
+      WriteBufferOperation *writeOperation = (WriteBufferOperation *)operation;
+      writeOperation->setUseBufferExecution(this->m_context.isBufferExecutionEnabled());
       operation->setbNodeTree(this->m_context.getbNodeTree());
       operation->initExecution();
     }
@@ -178,6 +183,10 @@ void ExecutionSystem::execute()
     executionGroup->initExecution();
   }
 
+  if (this->m_context.isResultCacheEnabled()) {
+    restoreCachedResults();
+  }
+
   WorkScheduler::start(this->m_context);
 
   executeGroups(COM_PRIORITY_HIGH);
@@ -189,6 +198,11 @@ void ExecutionSystem::execute()
   WorkScheduler::finish();
   WorkScheduler::stop();
 
+  /* Partially calculated buffers of a canceled execution are not kept. */
+  if (this->m_context.isResultCacheEnabled() && !editingtree->test_break(editingtree->tbh)) {
+    storeCachedResults();
+  }
+
   editingtree->stats_draw(editingtree->sdh, TIP_("Compositing | De-initializing execution"));
   for (index = 0; index < this->m_operations.size(); index++) {
     NodeOperation *operation = this->m_operations[index];
@@ -198,6 +212,46 @@ void ExecutionSystem::execute()
     ExecutionGroup *executionGroup = this->m_groups[index];
     executionGroup->deinitExecution();
   }
+  /* Intermediate buffers of the buffer execution are kept in the pool until here. */
+  BufferPool::clear();
+}
+
+void ExecutionSystem::restoreCachedResults()
+{
+  for (unsigned int index = 0; index < this->m_operations.size(); index++) {
+    NodeOperation *operation = this->m_operations[index];
+    if (!operation->isWriteBufferOperation() || operation->getContentHash() == 0) {
+      continue;
+    }
+    WriteBufferOperation *writeOperation = (WriteBufferOperation *)operation;
+    MemoryProxy *memoryProxy = writeOperation->getMemoryProxy();
+    ExecutionGroup *group = memoryProxy->getExecutor();
+    if (group == NULL || writeOperation->isSingleValue()) {
+      continue;
+    }
+    if (ResultCache::restore(operation->getContentHash(), memoryProxy->getBuffer())) {
+      memoryProxy->getBuffer()->setCreatedState();
+      group->setChunksExecuted();
+    }
+  }
+}
+
+void ExecutionSystem::storeCachedResults()
+{
+  for (unsigned int index = 0; index < this->m_operations.size(); index++) {
+    NodeOperation *operation = this->m_operations[index];
+    if (!operation->isWriteBufferOperation() || operation->getContentHash() == 0) {
+      continue;
+    }
+    WriteBufferOperation *writeOperation = (WriteBufferOperation *)operation;
+    MemoryProxy *memoryProxy = writeOperation->getMemoryProxy();
+    ExecutionGroup *group = memoryProxy->getExecutor();
+    /* Groups only calculate the chunks needed by other groups. */
+    if (group == NULL || writeOperation->isSingleValue() || !group->isFullyExecuted()) {
+      continue;
+    }
+    ResultCache::store(operation->getContentHash(), memoryProxy->getBuffer());
+  }
 }
 
 void ExecutionSystem::executeGroups(CompositorPriority priority)
@@ -189,6 +189,16 @@ class ExecutionSystem {
  private:
   void executeGroups(CompositorPriority priority);
 
+  /**
+   * \brief restore the write buffers found in the ResultCache and skip their execution groups
+   */
+  void restoreCachedResults();
+
+  /**
+   * \brief store the fully calculated write buffers in the ResultCache
+   */
+  void storeCachedResults();
+
   /* allow the DebugInfo class to look at internals */
   friend class DebugInfo;
 
@@ -17,6 +17,7 @@
  */
 
 #include "COM_MemoryBuffer.h"
+#include "COM_BufferPool.h"
 
 #include "MEM_guardedalloc.h"
 
@@ -62,6 +63,8 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, unsigned int chunkNumber, r
       sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
   this->m_state = COM_MB_ALLOCATED;
   this->m_datatype = memoryProxy->getDataType();
+  this->m_is_a_single_elem = false;
+  this->m_pooled = false;
 }
 
 MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, rcti *rect)
@@ -76,6 +79,8 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, rcti *rect)
       sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
   this->m_state = COM_MB_TEMPORARILY;
   this->m_datatype = memoryProxy->getDataType();
+  this->m_is_a_single_elem = false;
+  this->m_pooled = false;
 }
 MemoryBuffer::MemoryBuffer(DataType dataType, rcti *rect)
 {
@@ -90,6 +95,23 @@ MemoryBuffer::MemoryBuffer(DataType dataType, rcti *rect)
       sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
   this->m_state = COM_MB_TEMPORARILY;
   this->m_datatype = dataType;
+  this->m_is_a_single_elem = false;
+  this->m_pooled = false;
+}
+MemoryBuffer::MemoryBuffer(DataType datatype, const rcti *rect, bool is_a_single_elem)
+{
+  BLI_rcti_init(&this->m_rect, rect->xmin, rect->xmax, rect->ymin, rect->ymax);
+  this->m_width = BLI_rcti_size_x(&this->m_rect);
+  this->m_height = BLI_rcti_size_y(&this->m_rect);
+  this->m_memoryProxy = NULL;
+  this->m_chunkNumber = -1;
+  this->m_num_channels = determine_num_channels(datatype);
+  this->m_is_a_single_elem = is_a_single_elem;
+  this->m_pooled = true;
+  const unsigned int num_elems = is_a_single_elem ? 1 : determineBufferSize();
+  this->m_buffer = BufferPool::acquire(num_elems * this->m_num_channels);
+  this->m_state = COM_MB_TEMPORARILY;
+  this->m_datatype = datatype;
 }
 MemoryBuffer *MemoryBuffer::duplicate()
 {
@@ -145,7 +167,12 @@ float MemoryBuffer::getMaximumValue(rcti *rect)
 MemoryBuffer::~MemoryBuffer()
 {
   if (this->m_buffer) {
-    MEM_freeN(this->m_buffer);
+    if (this->m_pooled) {
+      BufferPool::release(this->m_buffer);
+    }
+    else {
+      MEM_freeN(this->m_buffer);
+    }
     this->m_buffer = NULL;
   }
 }
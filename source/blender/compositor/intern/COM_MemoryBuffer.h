@@ -97,6 +97,17 @@ class MemoryBuffer {
   int m_width;
   int m_height;
 
+  /**
+   * \brief the buffer only stores a single element used for all the pixels of its rect
+   */
+  bool m_is_a_single_elem;
+
+  /**
+   * \brief the float buffer comes from the BufferPool
+   * \see BufferPool
+   */
+  bool m_pooled;
+
  public:
   /**
    * \brief construct new MemoryBuffer for a chunk
@@ -113,6 +124,12 @@ class MemoryBuffer {
    */
   MemoryBuffer(DataType datatype, rcti *rect);
 
+  /**
+   * \brief construct new temporarily MemoryBuffer for an area, allocated from the BufferPool
+   * \param is_a_single_elem: only store one element, for areas with a constant value
+   */
+  MemoryBuffer(DataType datatype, const rcti *rect, bool is_a_single_elem);
+
   /**
    * \brief destructor
    */
@@ -140,6 +157,36 @@ class MemoryBuffer {
     return this->m_buffer;
   }
 
+  /**
+   * \brief does this buffer store a single element for all its pixels
+   */
+  bool isASingleElem() const
+  {
+    return this->m_is_a_single_elem;
+  }
+
+  /**
+   * \brief number of floats between two consecutive elements of a row, 0 for single elements
+   */
+  int getElemStride() const
+  {
+    return this->m_is_a_single_elem ? 0 : this->m_num_channels;
+  }
+
+  /**
+   * \brief get the element of a pixel in absolute coordinates
+   * \note the pixel must be inside the rect of the buffer
+   */
+  inline float *getElem(int x, int y)
+  {
+    if (this->m_is_a_single_elem) {
+      return this->m_buffer;
+    }
+    BLI_assert(x >= m_rect.xmin && x < m_rect.xmax && y >= m_rect.ymin && y < m_rect.ymax);
+    return &this->m_buffer[((y - m_rect.ymin) * this->m_width + (x - m_rect.xmin)) *
+                           this->m_num_channels];
+  }
+
   /**
    * \brief after execution the state will be set to available by calling this method
    */
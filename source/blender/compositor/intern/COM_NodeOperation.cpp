@@ -21,6 +21,7 @@
 
 #include "COM_defines.h"
 #include "COM_ExecutionSystem.h"
+#include "COM_ReadBufferOperation.h"
 
 #include "COM_NodeOperation.h" /* own include */
 
@@ -36,6 +37,8 @@ NodeOperation::NodeOperation()
   this->m_height = 0;
   this->m_isResolutionSet = false;
   this->m_openCL = false;
+  this->m_bufferExecution = false;
+  this->m_contentHash = 0;
   this->m_btree = NULL;
 }
 
@@ -134,6 +137,115 @@ void NodeOperation::deinitExecution()
 {
   /* pass */
 }
+void NodeOperation::calculateInputs(const rcti *area,
+                                    std::vector<MemoryBuffer *> &inputs,
+                                    std::vector<MemoryBuffer *> &temporaries)
+{
+  rcti rect = *area;
+  inputs.resize(m_inputs.size(), NULL);
+  for (unsigned int index = 0; index < m_inputs.size(); index++) {
+    NodeOperation *input = this->getInputOperation(index);
+    if (input == NULL) {
+      continue;
+    }
+    if (this->isComplex() && input->isReadBufferOperation() &&
+        !((ReadBufferOperation *)input)->isSingleValue()) {
+      /* Complex operations read their inputs around the area, give them the whole buffer. */
+      inputs[index] = (MemoryBuffer *)input->initializeTileData(&rect);
+    }
+    else {
+      bool owned;
+      inputs[index] = input->calculateArea(area, &owned);
+      if (owned) {
+        temporaries.push_back(inputs[index]);
+      }
+    }
+  }
+}
+
+static void free_temporaries(std::vector<MemoryBuffer *> &temporaries)
+{
+  for (unsigned int index = 0; index < temporaries.size(); index++) {
+    delete temporaries[index];
+  }
+}
+
+void NodeOperation::executeArea(MemoryBuffer *output, const rcti *area)
+{
+  BLI_assert(this->isBufferExecution());
+  std::vector<MemoryBuffer *> inputs;
+  std::vector<MemoryBuffer *> temporaries;
+  rcti rect = *area;
+
+  void *data = NULL;
+  if (this->isComplex()) {
+    /* Lazy initialization of complex operations is done by their tile data. */
+    data = this->initializeTileData(&rect);
+  }
+  calculateInputs(area, inputs, temporaries);
+  executeBuffer(output, area, inputs.data());
+  free_temporaries(temporaries);
+  if (data) {
+    this->deinitializeTileData(&rect, data);
+  }
+}
+
+MemoryBuffer *NodeOperation::calculateArea(const rcti *area, bool *r_owned)
+{
+  const DataType datatype = this->getOutputSocket()->getDataType();
+  float color[4];
+  *r_owned = true;
+
+  if (this->isSetOperation()) {
+    /* Fold constants into a single element. */
+    MemoryBuffer *buffer = new MemoryBuffer(datatype, area, true);
+    this->readSampled(color, area->xmin, area->ymin, COM_PS_NEAREST);
+    memcpy(buffer->getBuffer(), color, sizeof(float) * buffer->get_num_channels());
+    return buffer;
+  }
+
+  if (this->isBufferExecution() && !this->isComplex()) {
+    std::vector<MemoryBuffer *> inputs;
+    std::vector<MemoryBuffer *> temporaries;
+    calculateInputs(area, inputs, temporaries);
+
+    bool is_constant = true;
+    for (unsigned int index = 0; index < inputs.size(); index++) {
+      if (inputs[index] && !inputs[index]->isASingleElem()) {
+        is_constant = false;
+        break;
+      }
+    }
+
+    MemoryBuffer *buffer;
+    if (is_constant) {
+      /* Pixels only depend on the inputs at the same position, so the result is constant too. */
+      rcti elem_area;
+      BLI_rcti_init(&elem_area, area->xmin, area->xmin + 1, area->ymin, area->ymin + 1);
+      buffer = new MemoryBuffer(datatype, area, true);
+      executeBuffer(buffer, &elem_area, inputs.data());
+    }
+    else {
+      buffer = new MemoryBuffer(datatype, area, false);
+      executeBuffer(buffer, area, inputs.data());
+    }
+    free_temporaries(temporaries);
+    return buffer;
+  }
+
+  /* Fall back to reading pixel by pixel. */
+  MemoryBuffer *buffer = new MemoryBuffer(datatype, area, false);
+  const int num_channels = buffer->get_num_channels();
+  for (int y = area->ymin; y < area->ymax; y++) {
+    float *elem = buffer->getElem(area->xmin, y);
+    for (int x = area->xmin; x < area->xmax; x++, elem += num_channels) {
+      this->readSampled(color, x, y, COM_PS_NEAREST);
+      memcpy(elem, color, sizeof(float) * num_channels);
+    }
+  }
+  return buffer;
+}
+
 SocketReader *NodeOperation::getInputSocketReader(unsigned int inputSocketIndex)
 {
   return this->getInputSocket(inputSocketIndex)->getReader();
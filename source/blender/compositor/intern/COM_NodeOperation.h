@@ -24,6 +24,7 @@
 #include <sstream>
 
 extern "C" {
+#include "BLI_sys_types.h"
 #include "BLI_math_color.h"
 #include "BLI_math_vector.h"
 #include "BLI_threads.h"
@@ -105,6 +106,12 @@ class NodeOperation : public SocketReader {
    */
   bool m_openCL;
 
+  /**
+   * \brief can this operation calculate whole areas at once.
+   * \see NodeOperation.executeBuffer
+   */
+  bool m_bufferExecution;
+
   /**
    * \brief mutex reference for very special node initializations
    * \note only use when you really know what you are doing.
@@ -126,6 +133,21 @@ class NodeOperation : public SocketReader {
    */
   bool m_isResolutionSet;
 
+  /**
+   * \brief hash of the type, parameters and inputs of this operation, 0 when it can't be cached
+   * \see ResultCache
+   */
+  uint64_t m_contentHash;
+
+  /**
+   * \brief calculate the inputs of executeBuffer for an area
+   * \param inputs: filled with a buffer per input socket
+   * \param temporaries: filled with the buffers the caller must delete
+   */
+  void calculateInputs(const rcti *area,
+                       std::vector<MemoryBuffer *> &inputs,
+                       std::vector<MemoryBuffer *> &temporaries);
+
  public:
   virtual ~NodeOperation();
 
@@ -248,6 +270,44 @@ class NodeOperation : public SocketReader {
   }
   virtual void deinitExecution();
 
+  /**
+   * \brief calculate an area of the output in bulk, instead of pixel by pixel
+   * \ingroup execution
+   * \note only called when buffer execution is set, see setBufferExecution.
+   *
+   * For simple operations every pixel of the output must only depend on the input pixels at
+   * the same position, the inputs are given as buffers covering the area. For complex operations
+   * the inputs are the whole buffers of their read buffer operations.
+   * Constant inputs are single element buffers, their element stride is 0.
+   * \param output: the buffer to write to, contains the area
+   * \param area: the area to calculate in absolute coordinates
+   * \param inputs: a buffer per input socket
+   */
+  virtual void executeBuffer(MemoryBuffer * /*output*/,
+                             const rcti * /*area*/,
+                             MemoryBuffer ** /*inputs*/)
+  {
+  }
+
+  /**
+   * \brief calculate an area of this operation into output with executeBuffer
+   * \ingroup execution
+   *
+   * The inputs are calculated recursively: operations with buffer execution calculate their area
+   * in bulk, set operations are folded into single elements and the other operations are read
+   * pixel by pixel.
+   * \see WriteBufferOperation.executeRegion
+   */
+  void executeArea(MemoryBuffer *output, const rcti *area);
+
+  /**
+   * \brief calculate an area of the output of this operation as an input of executeBuffer
+   * \param area: the area to calculate in absolute coordinates
+   * \param r_owned: set to true when the caller must delete the returned buffer
+   * \return a buffer containing the area, or a single element when it is constant
+   */
+  virtual MemoryBuffer *calculateArea(const rcti *area, bool *r_owned);
+
   bool isResolutionSet()
   {
     return this->m_isResolutionSet;
@@ -346,6 +406,28 @@ class NodeOperation : public SocketReader {
     return this->m_openCL;
   }
 
+  /**
+   * \brief get the content hash of this operation, 0 when its result can't be cached
+   * \see ResultCache
+   */
+  uint64_t getContentHash() const
+  {
+    return this->m_contentHash;
+  }
+  void setContentHash(uint64_t contentHash)
+  {
+    this->m_contentHash = contentHash;
+  }
+
+  /**
+   * \brief can this NodeOperation calculate whole areas with executeBuffer
+   * \see NodeOperation.executeArea
+   */
+  bool isBufferExecution() const
+  {
+    return this->m_bufferExecution;
+  }
+
   virtual bool isViewerOperation() const
   {
     return false;
@@ -423,6 +505,16 @@ class NodeOperation : public SocketReader {
     this->m_openCL = openCL;
   }
 
+  /**
+   * \brief set if this NodeOperation implements executeBuffer
+   * \note subclasses inherit it, only set it on classes whose executeBuffer matches their
+   * executePixel.
+   */
+  void setBufferExecution(bool bufferExecution)
+  {
+    this->m_bufferExecution = bufferExecution;
+  }
+
   /* allow the DebugInfo class to look at internals */
   friend class DebugInfo;
 
@@ -16,8 +16,21 @@
  * Copyright 2013, Blender Foundation.
  */
 
+#include <typeinfo>
+
+#include "MEM_guardedalloc.h"
+
 extern "C" {
+#include "BLI_hash_mm2a.h"
 #include "BLI_utildefines.h"
+
+#include "BKE_image.h"
+#include "BKE_node.h"
+
+#include "DNA_color_types.h"
+#include "DNA_image_types.h"
+
+#include "RE_pipeline.h"
 }
 
 #include "COM_NodeConverter.h"
@@ -25,6 +38,7 @@ extern "C" {
 #include "COM_Debug.h"
 #include "COM_ExecutionSystem.h"
 #include "COM_Node.h"
+#include "COM_ResultCache.h"
 #include "COM_SocketProxyNode.h"
 
 #include "COM_NodeOperation.h"
@@ -40,7 +54,10 @@ extern "C" {
 #include "COM_NodeOperationBuilder.h" /* own include */
 
 NodeOperationBuilder::NodeOperationBuilder(const CompositorContext *context, bNodeTree *b_nodetree)
-    : m_context(context), m_current_node(NULL), m_active_viewer(NULL)
+    : m_context(context),
+      m_current_node(NULL),
+      m_current_node_operations(0),
+      m_active_viewer(NULL)
 {
   m_graph.from_bNodeTree(*context, b_nodetree);
 }
@@ -58,6 +75,7 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
     Node *node = (Node *)m_graph.nodes()[index];
 
     m_current_node = node;
+    m_current_node_operations = 0;
 
     DebugInfo::node_to_operations(node);
     node->convertToOperations(converter, *m_context);
@@ -109,6 +127,25 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
   /* surround complex ops with read/write buffer */
   add_complex_operation_buffers();
 
+  if (m_context->isResultCacheEnabled()) {
+    /* buffer the operations which were unchanged since the last execution,
+     * hashes are calculated again to include the added buffers */
+    add_content_hashes();
+    add_result_cache_buffers();
+    add_content_hashes();
+
+    /* the fast pass of two pass execution is not used to find unchanged operations */
+    if (!m_context->isFastCalculation()) {
+      std::set<uint64_t> hashes;
+      for (Operations::const_iterator it = m_operations.begin(); it != m_operations.end(); ++it) {
+        if ((*it)->getContentHash() != 0) {
+          hashes.insert((*it)->getContentHash());
+        }
+      }
+      ResultCache::setKnownHashes(hashes);
+    }
+  }
+
   /* links not available from here on */
   /* XXX make m_links a local variable to avoid confusion! */
   m_links.clear();
@@ -128,6 +165,10 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 void NodeOperationBuilder::addOperation(NodeOperation *operation)
 {
   m_operations.push_back(operation);
+
+  if (m_current_node) {
+    m_operation_nodes[operation] = OpNodeIndex(m_current_node, m_current_node_operations++);
+  }
 }
 
 void NodeOperationBuilder::mapInputSocket(NodeInput *node_socket,
@@ -599,6 +640,298 @@ void NodeOperationBuilder::add_complex_operation_buffers()
   }
 }
 
+/* 64 bit hash, made of two 32 bit murmur hashes with different seeds */
+class ContentHasher {
+ private:
+  BLI_HashMurmur2A m_mm2[2];
+
+ public:
+  ContentHasher(uint64_t salt)
+  {
+    BLI_hash_mm2a_init(&m_mm2[0], 0);
+    BLI_hash_mm2a_init(&m_mm2[1], 0x9e3779b9);
+    add(&salt, sizeof(salt));
+  }
+
+  void add(const void *data, size_t len)
+  {
+    BLI_hash_mm2a_add(&m_mm2[0], (const unsigned char *)data, len);
+    BLI_hash_mm2a_add(&m_mm2[1], (const unsigned char *)data, len);
+  }
+  void add_int(int data)
+  {
+    BLI_hash_mm2a_add_int(&m_mm2[0], data);
+    BLI_hash_mm2a_add_int(&m_mm2[1], data);
+  }
+  void add_string(const char *str)
+  {
+    add(str, strlen(str));
+  }
+
+  uint64_t end()
+  {
+    return ((uint64_t)BLI_hash_mm2a_end(&m_mm2[0]) << 32) | BLI_hash_mm2a_end(&m_mm2[1]);
+  }
+};
+
+/* settings of the context used by the operations */
+static uint64_t hash_context(const CompositorContext &context)
+{
+  ContentHasher hasher(0);
+  hasher.add_int(context.getQuality());
+  hasher.add_int(context.isRendering());
+  hasher.add_int(context.isFastCalculation());
+  hasher.add_int(context.getFramenumber());
+  hasher.add_string(context.getViewName() ? context.getViewName() : "");
+
+  Scene *scene = context.getScene();
+  hasher.add(&scene, sizeof(scene));
+
+  const RenderData *rd = context.getRenderData();
+  if (rd) {
+    hasher.add_int(rd->size);
+    hasher.add_int(rd->xsch);
+    hasher.add_int(rd->ysch);
+  }
+
+  const ColorManagedViewSettings *view_settings = context.getViewSettings();
+  if (view_settings) {
+    hasher.add_string(view_settings->view_transform);
+    hasher.add_string(view_settings->look);
+    hasher.add(&view_settings->exposure, sizeof(float));
+    hasher.add(&view_settings->gamma, sizeof(float));
+    hasher.add_int(view_settings->flag);
+  }
+  const ColorManagedDisplaySettings *display_settings = context.getDisplaySettings();
+  if (display_settings) {
+    hasher.add_string(display_settings->display_device);
+  }
+  return hasher.end();
+}
+
+/* curve mappings are hashed without their pointers, which change when the tree is copied */
+static void hash_curve_mapping(ContentHasher &hasher, const CurveMapping *cumap)
+{
+  hasher.add_int(cumap->flag);
+  hasher.add_int(cumap->preset);
+  hasher.add(&cumap->curr, sizeof(cumap->curr));
+  hasher.add(&cumap->clipr, sizeof(cumap->clipr));
+  hasher.add(cumap->black, sizeof(cumap->black));
+  hasher.add(cumap->white, sizeof(cumap->white));
+  hasher.add_int(cumap->tone);
+  for (int i = 0; i < 4; i++) {
+    const CurveMap *cuma = &cumap->cm[i];
+    hasher.add_int(cuma->totpoint);
+    if (cuma->curve) {
+      hasher.add(cuma->curve, sizeof(CurveMapPoint) * cuma->totpoint);
+    }
+  }
+}
+
+/* hash the parameters of a node, false when the result of the node can't be cached */
+static bool hash_node(ContentHasher &hasher, const Node *node, const CompositorContext &context)
+{
+  bNode *b_node = node->getbNode();
+  if (b_node == NULL) {
+    return true;
+  }
+
+  switch (b_node->type) {
+    /* storage contains lists of the selected mattes */
+    case CMP_NODE_CRYPTOMATTE:
+    /* uses the scene camera */
+    case CMP_NODE_DEFOCUS:
+      return false;
+  }
+
+  if (b_node->id) {
+    /* render results get swapped with render slots or replaced by renders that skip compositing,
+     * so the scene alone does not identify the passes */
+    if (GS(b_node->id->name) == ID_SCE && b_node->type == CMP_NODE_R_LAYERS) {
+      hasher.add(&b_node->id, sizeof(ID *));
+      hasher.add_int(RE_GetResultGeneration());
+    }
+    else if (GS(b_node->id->name) == ID_IM && b_node->type == CMP_NODE_IMAGE) {
+      Image *image = (Image *)b_node->id;
+      if (image->source == IMA_SRC_VIEWER || BKE_image_is_dirty(image)) {
+        return false;
+      }
+      hasher.add(&b_node->id, sizeof(ID *));
+
+      /* reloading the image replaces its buffers, possibly at the same address */
+      ImBuf *ibuf = NULL;
+      if (b_node->storage) {
+        ImageUser iuser = *(ImageUser *)b_node->storage;
+        BKE_image_user_frame_calc(image, &iuser, context.getFramenumber());
+        ibuf = BKE_image_acquire_ibuf(image, &iuser, NULL);
+        BKE_image_release_ibuf(image, ibuf, NULL);
+      }
+      hasher.add(&ibuf, sizeof(ibuf));
+      hasher.add_int(BKE_image_buffer_generation());
+    }
+    else {
+      /* other data-blocks can change without the tree being updated */
+      return false;
+    }
+  }
+
+  hasher.add_int(b_node->type);
+  hasher.add_int(b_node->custom1);
+  hasher.add_int(b_node->custom2);
+  hasher.add(&b_node->custom3, sizeof(float));
+  hasher.add(&b_node->custom4, sizeof(float));
+
+  if (b_node->storage) {
+    if (ELEM(b_node->type,
+             CMP_NODE_CURVE_VEC,
+             CMP_NODE_CURVE_RGB,
+             CMP_NODE_TIME,
+             CMP_NODE_HUECORRECT)) {
+      hash_curve_mapping(hasher, (const CurveMapping *)b_node->storage);
+    }
+    else {
+      hasher.add(b_node->storage, MEM_allocN_len(b_node->storage));
+    }
+  }
+
+  for (unsigned int index = 0; index < node->getNumberOfInputSockets(); index++) {
+    bNodeSocket *b_socket = node->getInputSocket(index)->getbNodeSocket();
+    if (b_socket && b_socket->default_value) {
+      hasher.add(b_socket->default_value, MEM_allocN_len(b_socket->default_value));
+    }
+  }
+  for (unsigned int index = 0; index < node->getNumberOfOutputSockets(); index++) {
+    bNodeSocket *b_socket = node->getOutputSocket(index)->getbNodeSocket();
+    if (b_socket && b_socket->default_value) {
+      hasher.add(b_socket->default_value, MEM_allocN_len(b_socket->default_value));
+    }
+  }
+  return true;
+}
+
+typedef std::map<NodeOperation *, uint64_t> ContentHashes;
+
+static uint64_t calc_content_hash(ContentHashes &hashes,
+                                  const NodeOperationBuilder::OpNodeMap &operation_nodes,
+                                  const CompositorContext &context,
+                                  uint64_t salt,
+                                  NodeOperation *op)
+{
+  ContentHashes::const_iterator it = hashes.find(op);
+  if (it != hashes.end()) {
+    return it->second;
+  }
+  /* operations which can't be cached keep a zero hash */
+  hashes[op] = 0;
+
+  ContentHasher hasher(salt);
+  hasher.add_string(typeid(*op).name());
+  hasher.add_int(op->getWidth());
+  hasher.add_int(op->getHeight());
+  if (op->getNumberOfOutputSockets() > 0) {
+    hasher.add_int(op->getOutputSocket()->getDataType());
+  }
+
+  if (op->isReadBufferOperation()) {
+    ReadBufferOperation *read_op = (ReadBufferOperation *)op;
+    WriteBufferOperation *write_op = read_op->getMemoryProxy()->getWriteBufferOperation();
+    uint64_t write_hash = calc_content_hash(hashes, operation_nodes, context, salt, write_op);
+    if (write_hash == 0) {
+      return 0;
+    }
+    hasher.add(&write_hash, sizeof(write_hash));
+  }
+  else if (op->isSetOperation()) {
+    float value[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    op->readSampled(value, 0.0f, 0.0f, COM_PS_NEAREST);
+    hasher.add(value, sizeof(value));
+  }
+
+  NodeOperationBuilder::OpNodeMap::const_iterator node_it = operation_nodes.find(op);
+  if (node_it != operation_nodes.end()) {
+    if (!hash_node(hasher, node_it->second.first, context)) {
+      return 0;
+    }
+    hasher.add_int(node_it->second.second);
+  }
+
+  for (int index = 0; index < op->getNumberOfInputSockets(); index++) {
+    NodeOperationInput *input = op->getInputSocket(index);
+    hasher.add_int(input->getDataType());
+    hasher.add_int(input->getResizeMode());
+    if (!input->isConnected()) {
+      continue;
+    }
+
+    NodeOperationOutput *output = input->getLink();
+    NodeOperation &input_op = output->getOperation();
+    uint64_t input_hash = calc_content_hash(hashes, operation_nodes, context, salt, &input_op);
+    if (input_hash == 0) {
+      return 0;
+    }
+    hasher.add(&input_hash, sizeof(input_hash));
+    for (int i = 0; i < input_op.getNumberOfOutputSockets(); i++) {
+      if (input_op.getOutputSocket(i) == output) {
+        hasher.add_int(i);
+        break;
+      }
+    }
+  }
+
+  uint64_t hash = hasher.end();
+  if (hash == 0) {
+    hash = 1;
+  }
+  hashes[op] = hash;
+  return hash;
+}
+
+void NodeOperationBuilder::add_content_hashes()
+{
+  const uint64_t salt = hash_context(*m_context);
+
+  ContentHashes hashes;
+  for (Operations::const_iterator it = m_operations.begin(); it != m_operations.end(); ++it) {
+    NodeOperation *op = *it;
+    op->setContentHash(calc_content_hash(hashes, m_operation_nodes, *m_context, salt, op));
+  }
+}
+
+void NodeOperationBuilder::add_result_cache_buffers()
+{
+  /* note: operations are cached first, since adding buffers
+   * will invalidate iterators over the main m_operations
+   */
+  Operations ops = m_operations;
+
+  for (Operations::const_iterator it = ops.begin(); it != ops.end(); ++it) {
+    NodeOperation *op = *it;
+    if (op->isReadBufferOperation() || op->isWriteBufferOperation()) {
+      continue;
+    }
+    /* unchanged operations are only buffered where a changed operation uses them */
+    if (op->getContentHash() != 0 && ResultCache::isKnownHash(op->getContentHash())) {
+      continue;
+    }
+
+    for (int index = 0; index < op->getNumberOfInputSockets(); index++) {
+      NodeOperationInput *input = op->getInputSocket(index);
+      if (!input->isConnected()) {
+        continue;
+      }
+      NodeOperation &input_op = input->getLink()->getOperation();
+      if (input_op.isReadBufferOperation() || input_op.isSetOperation() ||
+          input_op.getContentHash() == 0 || !ResultCache::isKnownHash(input_op.getContentHash())) {
+        continue;
+      }
+      if (input_op.getWidth() == 0 || input_op.getHeight() == 0) {
+        continue;
+      }
+      add_input_buffers(op, input);
+    }
+  }
+}
+
 typedef std::set<NodeOperation *> Tags;
 
 static void find_reachable_operations_recursive(Tags &reachable, NodeOperation *op)
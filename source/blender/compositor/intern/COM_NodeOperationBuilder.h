@@ -75,6 +75,10 @@ class NodeOperationBuilder {
   typedef std::vector<NodeOperationInput *> OpInputs;
   typedef std::map<NodeInput *, OpInputs> OpInputInverseMap;
 
+  /** Node and index of creation in this node of an operation */
+  typedef std::pair<Node *, int> OpNodeIndex;
+  typedef std::map<NodeOperation *, OpNodeIndex> OpNodeMap;
+
  private:
   const CompositorContext *m_context;
   NodeGraph m_graph;
@@ -89,6 +93,11 @@ class NodeOperationBuilder {
   OutputSocketMap m_output_map;
 
   Node *m_current_node;
+  /** Number of operations added by the current node */
+  int m_current_node_operations;
+
+  /** Maps operations to the node they are converted from, to hash their parameters */
+  OpNodeMap m_operation_nodes;
 
   /** Operation that will be writing to the viewer image
    *  Only one operation can occupy this place at a time,
@@ -159,6 +168,12 @@ class NodeOperationBuilder {
   void add_input_buffers(NodeOperation *operation, NodeOperationInput *input);
   void add_output_buffers(NodeOperation *operation, NodeOperationOutput *output);
 
+  /** Calculate the content hash of all operations, for the result cache */
+  void add_content_hashes();
+  /** Add read/write buffer operations after unchanged operations used by changed ones,
+   *  so their results can be restored from the result cache */
+  void add_result_cache_buffers();
+
   /** Remove unreachable operations */
   void prune_operations();
 
@@ -0,0 +1,123 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#include <list>
+#include <map>
+#include <string.h>
+
+#include "COM_ResultCache.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_defines.h"
+
+#include "MEM_guardedalloc.h"
+
+/* A copy of a buffer, the most recently used entries are at the front of the list. */
+typedef struct CachedBuffer {
+  uint64_t hash;
+  int width;
+  int height;
+  unsigned int num_channels;
+  size_t size;
+  float *data;
+} CachedBuffer;
+
+typedef std::list<CachedBuffer> CachedBuffers;
+
+static CachedBuffers g_cached_buffers;
+static std::map<uint64_t, CachedBuffers::iterator> g_cached_buffers_map;
+static size_t g_cached_size = 0;
+static std::set<uint64_t> g_known_hashes;
+
+static void cached_buffer_remove(CachedBuffers::iterator it)
+{
+  g_cached_size -= it->size;
+  MEM_freeN(it->data);
+  g_cached_buffers_map.erase(it->hash);
+  g_cached_buffers.erase(it);
+}
+
+bool ResultCache::restore(uint64_t hash, MemoryBuffer *buffer)
+{
+  std::map<uint64_t, CachedBuffers::iterator>::iterator found = g_cached_buffers_map.find(hash);
+  if (found == g_cached_buffers_map.end()) {
+    return false;
+  }
+
+  CachedBuffers::iterator it = found->second;
+  if (it->width != buffer->getWidth() || it->height != buffer->getHeight() ||
+      it->num_channels != buffer->get_num_channels()) {
+    return false;
+  }
+
+  memcpy(buffer->getBuffer(), it->data, it->size);
+  /* Move to the front, as most recently used. */
+  g_cached_buffers.splice(g_cached_buffers.begin(), g_cached_buffers, it);
+  return true;
+}
+
+void ResultCache::store(uint64_t hash, MemoryBuffer *buffer)
+{
+  const size_t size = sizeof(float) * buffer->getWidth() * buffer->getHeight() *
+                      buffer->get_num_channels();
+  if (size == 0 || size > COM_RESULT_CACHE_LIMIT) {
+    return;
+  }
+
+  std::map<uint64_t, CachedBuffers::iterator>::iterator found = g_cached_buffers_map.find(hash);
+  if (found != g_cached_buffers_map.end()) {
+    /* Same content, the buffer was restored. */
+    g_cached_buffers.splice(g_cached_buffers.begin(), g_cached_buffers, found->second);
+    return;
+  }
+
+  /* Free the least recently used buffers to stay under the limit. */
+  while (!g_cached_buffers.empty() && g_cached_size + size > COM_RESULT_CACHE_LIMIT) {
+    cached_buffer_remove(--g_cached_buffers.end());
+  }
+
+  CachedBuffer cached;
+  cached.hash = hash;
+  cached.width = buffer->getWidth();
+  cached.height = buffer->getHeight();
+  cached.num_channels = buffer->get_num_channels();
+  cached.size = size;
+  cached.data = (float *)MEM_mallocN(size, "COM_ResultCache");
+  memcpy(cached.data, buffer->getBuffer(), size);
+
+  g_cached_buffers.push_front(cached);
+  g_cached_buffers_map[hash] = g_cached_buffers.begin();
+  g_cached_size += size;
+}
+
+bool ResultCache::isKnownHash(uint64_t hash)
+{
+  return g_known_hashes.find(hash) != g_known_hashes.end();
+}
+
+void ResultCache::setKnownHashes(const std::set<uint64_t> &hashes)
+{
+  g_known_hashes = hashes;
+}
+
+void ResultCache::clear()
+{
+  while (!g_cached_buffers.empty()) {
+    cached_buffer_remove(g_cached_buffers.begin());
+  }
+  g_known_hashes.clear();
+}
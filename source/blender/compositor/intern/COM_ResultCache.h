@@ -0,0 +1,70 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#ifndef __COM_RESULTCACHE_H__
+#define __COM_RESULTCACHE_H__
+
+#include <set>
+
+#include "BLI_sys_types.h"
+
+class MemoryBuffer;
+
+/**
+ * \brief keeps the buffers of write buffer operations between executions
+ *
+ * Operations get a hash of their content (type, parameters and inputs) when they are built.
+ * Buffers are stored by the hash of their write buffer operation when it is fully calculated,
+ * the next executions restore them instead of calculating the operations again while the hash
+ * does not change. The least recently used buffers are freed above COM_RESULT_CACHE_LIMIT.
+ *
+ * The hashes of the operations of the last execution are kept as well, so the builder can add
+ * buffers between unchanged and changed operations.
+ * \see NodeOperationBuilder.add_result_cache_buffers
+ * \ingroup Memory
+ */
+class ResultCache {
+ public:
+  /**
+   * \brief copy the content of a cached buffer
+   * \return false when no buffer of this hash and size is cached
+   */
+  static bool restore(uint64_t hash, MemoryBuffer *buffer);
+
+  /**
+   * \brief store a copy of a buffer
+   */
+  static void store(uint64_t hash, MemoryBuffer *buffer);
+
+  /**
+   * \brief was an operation with this content hash built by the last execution
+   */
+  static bool isKnownHash(uint64_t hash);
+
+  /**
+   * \brief set the content hashes of the operations of the last execution
+   */
+  static void setKnownHashes(const std::set<uint64_t> &hashes);
+
+  /**
+   * \brief free all the buffers and hashes
+   */
+  static void clear();
+};
+
+#endif
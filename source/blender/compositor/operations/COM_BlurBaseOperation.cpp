@@ -37,6 +37,20 @@ BlurBaseOperation::BlurBaseOperation(DataType data_type) : NodeOperation()
   this->m_sizeavailable = false;
   this->m_extend_bounds = false;
 }
+void BlurBaseOperation::executeBufferConstant(MemoryBuffer *output,
+                                              const rcti *area,
+                                              MemoryBuffer *input)
+{
+  const int num_channels = output->get_num_channels();
+  const float *value = input->getBuffer();
+  for (int y = area->ymin; y < area->ymax; y++) {
+    float *out = output->getElem(area->xmin, y);
+    for (int x = area->xmin; x < area->xmax; x++, out += num_channels) {
+      memcpy(out, value, sizeof(float) * num_channels);
+    }
+  }
+}
+
 void BlurBaseOperation::initExecution()
 {
   this->m_inputProgram = this->getInputSocketReader(0);
@@ -39,6 +39,11 @@ class BlurBaseOperation : public NodeOperation, public QualityStepHelper {
 
   void updateSize();
 
+  /**
+   * Fill an area with the blurred value of a constant input, for executeBuffer.
+   */
+  void executeBufferConstant(MemoryBuffer *output, const rcti *area, MemoryBuffer *input);
+
   /**
    * Cached reference to the inputProgram
    */
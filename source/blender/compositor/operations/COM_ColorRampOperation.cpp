@@ -33,6 +33,7 @@ ColorRampOperation::ColorRampOperation() : NodeOperation()
 
   this->m_inputProgram = NULL;
   this->m_colorBand = NULL;
+  this->setBufferExecution(true);
 }
 void ColorRampOperation::initExecution()
 {
@@ -50,6 +51,23 @@ void ColorRampOperation::executePixelSampled(float output[4],
   BKE_colorband_evaluate(this->m_colorBand, values[0], output);
 }
 
+void ColorRampOperation::executeBuffer(MemoryBuffer *output,
+                                       const rcti *area,
+                                       MemoryBuffer **inputs)
+{
+  const int output_stride = output->getElemStride();
+  const int input_stride = inputs[0]->getElemStride();
+  for (int y = area->ymin; y < area->ymax; y++) {
+    float *out = output->getElem(area->xmin, y);
+    const float *in = inputs[0]->getElem(area->xmin, y);
+    for (int x = area->xmin; x < area->xmax; x++) {
+      BKE_colorband_evaluate(this->m_colorBand, *in, out);
+      out += output_stride;
+      in += input_stride;
+    }
+  }
+}
+
 void ColorRampOperation::deinitExecution()
 {
   this->m_inputProgram = NULL;
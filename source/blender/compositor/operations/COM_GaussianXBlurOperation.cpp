@@ -32,6 +32,7 @@ GaussianXBlurOperation::GaussianXBlurOperation() : BlurBaseOperation(COM_DT_COLO
   this->m_gausstab_sse = NULL;
 #endif
   this->m_filtersize = 0;
+  this->setBufferExecution(true);
 }
 
 void *GaussianXBlurOperation::initializeTileData(rcti * /*rect*/)
@@ -119,6 +120,63 @@ void GaussianXBlurOperation::executePixel(float output[4], int x, int y, void *d
   mul_v4_v4fl(output, color_accum, 1.0f / multiplier_accum);
 }
 
+void GaussianXBlurOperation::executeBuffer(MemoryBuffer *output,
+                                           const rcti *area,
+                                           MemoryBuffer **inputs)
+{
+  MemoryBuffer *input = inputs[0];
+  if (input->isASingleElem()) {
+    executeBufferConstant(output, area, input);
+    return;
+  }
+  if (!BLI_rcti_inside_rcti(input->getRect(), area)) {
+    /* Extended bounds, read the pixels outside of the input one by one. */
+    for (int y = area->ymin; y < area->ymax; y++) {
+      for (int x = area->xmin; x < area->xmax; x++) {
+        GaussianXBlurOperation::executePixel(output->getElem(x, y), x, y, input);
+      }
+    }
+    return;
+  }
+
+  /* Pixels whose filter is entirely inside the input use the same weights, they are accumulated
+   * for a whole row span one weight at a time. Pixels near the borders are calculated one by
+   * one. */
+  const rcti &rect = *input->getRect();
+  const int step = getStep();
+  const int inner_xmin = max_ii(area->xmin, rect.xmin + this->m_filtersize);
+  const int inner_xmax = min_ii(area->xmax, rect.xmax - this->m_filtersize);
+  const int inner_end = max_ii(inner_xmin, inner_xmax);
+  const int inner_len = (inner_end - inner_xmin) * COM_NUM_CHANNELS_COLOR;
+
+  float multiplier_accum = 0.0f;
+  for (int index = 0; index <= this->m_filtersize * 2; index += step) {
+    multiplier_accum += this->m_gausstab[index];
+  }
+  const float multiplier_inv = 1.0f / multiplier_accum;
+
+  for (int y = area->ymin; y < area->ymax; y++) {
+    for (int x = area->xmin; x < min_ii(inner_xmin, area->xmax); x++) {
+      GaussianXBlurOperation::executePixel(output->getElem(x, y), x, y, input);
+    }
+    if (inner_len > 0) {
+      float *out = output->getElem(inner_xmin, y);
+      memset(out, 0, sizeof(float) * inner_len);
+      for (int index = 0; index <= this->m_filtersize * 2; index += step) {
+        const float multiplier = this->m_gausstab[index];
+        const float *in = input->getElem(inner_xmin - this->m_filtersize + index, y);
+        for (int i = 0; i < inner_len; i++) {
+          out[i] += multiplier * in[i];
+        }
+      }
+      mul_vn_fl(out, inner_len, multiplier_inv);
+    }
+    for (int x = max_ii(inner_end, area->xmin); x < area->xmax; x++) {
+      GaussianXBlurOperation::executePixel(output->getElem(x, y), x, y, input);
+    }
+  }
+}
+
 void GaussianXBlurOperation::executeOpenCL(OpenCLDevice *device,
                                            MemoryBuffer *outputMemoryBuffer,
                                            cl_mem clOutputBuffer,
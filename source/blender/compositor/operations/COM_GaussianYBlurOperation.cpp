@@ -32,6 +32,7 @@ GaussianYBlurOperation::GaussianYBlurOperation() : BlurBaseOperation(COM_DT_COLO
   this->m_gausstab_sse = NULL;
 #endif
   this->m_filtersize = 0;
+  this->setBufferExecution(true);
 }
 
 void *GaussianYBlurOperation::initializeTileData(rcti * /*rect*/)
@@ -119,6 +120,50 @@ void GaussianYBlurOperation::executePixel(float output[4], int x, int y, void *d
   mul_v4_v4fl(output, color_accum, 1.0f / multiplier_accum);
 }
 
+void GaussianYBlurOperation::executeBuffer(MemoryBuffer *output,
+                                           const rcti *area,
+                                           MemoryBuffer **inputs)
+{
+  MemoryBuffer *input = inputs[0];
+  if (input->isASingleElem()) {
+    executeBufferConstant(output, area, input);
+    return;
+  }
+  if (!BLI_rcti_inside_rcti(input->getRect(), area)) {
+    /* Extended bounds, read the pixels outside of the input one by one. */
+    for (int y = area->ymin; y < area->ymax; y++) {
+      for (int x = area->xmin; x < area->xmax; x++) {
+        GaussianYBlurOperation::executePixel(output->getElem(x, y), x, y, input);
+      }
+    }
+    return;
+  }
+
+  /* The weights only depend on the row, so whole rows of the inputs are accumulated at once
+   * instead of reading a column for each pixel. */
+  const rcti &rect = *input->getRect();
+  const int step = getStep();
+  const int row_len = BLI_rcti_size_x(area) * COM_NUM_CHANNELS_COLOR;
+
+  for (int y = area->ymin; y < area->ymax; y++) {
+    const int ymin = max_ii(y - this->m_filtersize, rect.ymin);
+    const int ymax = min_ii(y + this->m_filtersize + 1, rect.ymax);
+    float *out = output->getElem(area->xmin, y);
+    float multiplier_accum = 0.0f;
+
+    memset(out, 0, sizeof(float) * row_len);
+    for (int ny = ymin; ny < ymax; ny += step) {
+      const float multiplier = this->m_gausstab[(ny - y) + this->m_filtersize];
+      const float *in = input->getElem(area->xmin, ny);
+      for (int i = 0; i < row_len; i++) {
+        out[i] += multiplier * in[i];
+      }
+      multiplier_accum += multiplier;
+    }
+    mul_vn_fl(out, row_len, 1.0f / multiplier_accum);
+  }
+}
+
 void GaussianYBlurOperation::executeOpenCL(OpenCLDevice *device,
                                            MemoryBuffer *outputMemoryBuffer,
                                            cl_mem clOutputBuffer,
@@ -38,6 +38,8 @@ class GaussianYBlurOperation : public BlurBaseOperation {
    */
   void executePixel(float output[4], int x, int y, void *data);
 
+  void executeBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
+
   void executeOpenCL(OpenCLDevice *device,
                      MemoryBuffer *outputMemoryBuffer,
                      cl_mem clOutputBuffer,
@@ -85,6 +85,13 @@ void MathAddOperation::executePixelSampled(float output[4], float x, float y, Pi
   clampIfNeeded(output);
 }
 
+void MathAddOperation::executeBuffer(MemoryBuffer *output,
+                                     const rcti *area,
+                                     MemoryBuffer **inputs)
+{
+  executeBufferBinary(output, area, inputs, [](const float a, const float b) { return a + b; });
+}
+
 void MathSubtractOperation::executePixelSampled(float output[4],
                                                 float x,
                                                 float y,
@@ -101,6 +108,13 @@ void MathSubtractOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathSubtractOperation::executeBuffer(MemoryBuffer *output,
+                                          const rcti *area,
+                                          MemoryBuffer **inputs)
+{
+  executeBufferBinary(output, area, inputs, [](const float a, const float b) { return a - b; });
+}
+
 void MathMultiplyOperation::executePixelSampled(float output[4],
                                                 float x,
                                                 float y,
@@ -117,6 +131,13 @@ void MathMultiplyOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathMultiplyOperation::executeBuffer(MemoryBuffer *output,
+                                          const rcti *area,
+                                          MemoryBuffer **inputs)
+{
+  executeBufferBinary(output, area, inputs, [](const float a, const float b) { return a * b; });
+}
+
 void MathDivideOperation::executePixelSampled(float output[4],
                                               float x,
                                               float y,
@@ -138,6 +159,16 @@ void MathDivideOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathDivideOperation::executeBuffer(MemoryBuffer *output,
+                                        const rcti *area,
+                                        MemoryBuffer **inputs)
+{
+  executeBufferBinary(output, area, inputs, [](const float a, const float b) {
+    /* We don't want to divide by zero. */
+    return (b == 0.0f) ? 0.0f : a / b;
+  });
+}
+
 void MathSineOperation::executePixelSampled(float output[4],
                                             float x,
                                             float y,
@@ -357,6 +388,15 @@ void MathMinimumOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathMinimumOperation::executeBuffer(MemoryBuffer *output,
+                                         const rcti *area,
+                                         MemoryBuffer **inputs)
+{
+  executeBufferBinary(output, area, inputs, [](const float a, const float b) {
+    return min(a, b);
+  });
+}
+
 void MathMaximumOperation::executePixelSampled(float output[4],
                                                float x,
                                                float y,
@@ -373,6 +413,15 @@ void MathMaximumOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathMaximumOperation::executeBuffer(MemoryBuffer *output,
+                                         const rcti *area,
+                                         MemoryBuffer **inputs)
+{
+  executeBufferBinary(output, area, inputs, [](const float a, const float b) {
+    return max(a, b);
+  });
+}
+
 void MathRoundOperation::executePixelSampled(float output[4],
                                              float x,
                                              float y,
@@ -43,6 +43,36 @@ class MathBaseOperation : public NodeOperation {
 
   void clampIfNeeded(float color[4]);
 
+  /**
+   * Calculate an area of a function of the first two inputs, for executeBuffer.
+   */
+  template<typename Func>
+  void executeBufferBinary(MemoryBuffer *output,
+                           const rcti *area,
+                           MemoryBuffer **inputs,
+                           const Func &func)
+  {
+    const int output_stride = output->getElemStride();
+    const int input1_stride = inputs[0]->getElemStride();
+    const int input2_stride = inputs[1]->getElemStride();
+    const bool use_clamp = this->m_useClamp;
+    for (int y = area->ymin; y < area->ymax; y++) {
+      float *out = output->getElem(area->xmin, y);
+      const float *in1 = inputs[0]->getElem(area->xmin, y);
+      const float *in2 = inputs[1]->getElem(area->xmin, y);
+      for (int x = area->xmin; x < area->xmax; x++) {
+        float value = func(*in1, *in2);
+        if (use_clamp) {
+          CLAMP(value, 0.0f, 1.0f);
+        }
+        *out = value;
+        out += output_stride;
+        in1 += input1_stride;
+        in2 += input2_stride;
+      }
+    }
+  }
+
  public:
   /**
    * the inner loop of this program
@@ -74,29 +104,37 @@ class MathAddOperation : public MathBaseOperation {
  public:
   MathAddOperation() : MathBaseOperation()
   {
+    this->setBufferExecution(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 class MathSubtractOperation : public MathBaseOperation {
  public:
   MathSubtractOperation() : MathBaseOperation()
   {
+    this->setBufferExecution(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 class MathMultiplyOperation : public MathBaseOperation {
  public:
   MathMultiplyOperation() : MathBaseOperation()
   {
+    this->setBufferExecution(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 class MathDivideOperation : public MathBaseOperation {
  public:
   MathDivideOperation() : MathBaseOperation()
   {
+    this->setBufferExecution(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 class MathSineOperation : public MathBaseOperation {
  public:
@@ -181,15 +219,19 @@ class MathMinimumOperation : public MathBaseOperation {
  public:
   MathMinimumOperation() : MathBaseOperation()
   {
+    this->setBufferExecution(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 class MathMaximumOperation : public MathBaseOperation {
  public:
   MathMaximumOperation() : MathBaseOperation()
   {
+    this->setBufferExecution(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 class MathRoundOperation : public MathBaseOperation {
  public:
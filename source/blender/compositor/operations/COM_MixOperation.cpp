@@ -101,7 +101,7 @@ void MixBaseOperation::deinitExecution()
 
 MixAddOperation::MixAddOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setBufferExecution(true);
 }
 
 void MixAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -126,11 +126,27 @@ void MixAddOperation::executePixelSampled(float output[4], float x, float y, Pix
   clampIfNeeded(output);
 }
 
+void MixAddOperation::executeBuffer(MemoryBuffer *output,
+                                    const rcti *area,
+                                    MemoryBuffer **inputs)
+{
+  executeBufferBlend(
+      output,
+      area,
+      inputs,
+      [](float *output, const float value, const float *color1, const float *color2) {
+        output[0] = color1[0] + value * color2[0];
+        output[1] = color1[1] + value * color2[1];
+        output[2] = color1[2] + value * color2[2];
+        output[3] = color1[3];
+      });
+}
+
 /* ******** Mix Blend Operation ******** */
 
 MixBlendOperation::MixBlendOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setBufferExecution(true);
 }
 
 void MixBlendOperation::executePixelSampled(float output[4],
@@ -160,6 +176,23 @@ void MixBlendOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixBlendOperation::executeBuffer(MemoryBuffer *output,
+                                      const rcti *area,
+                                      MemoryBuffer **inputs)
+{
+  executeBufferBlend(
+      output,
+      area,
+      inputs,
+      [](float *output, const float value, const float *color1, const float *color2) {
+        const float valuem = 1.0f - value;
+        output[0] = valuem * color1[0] + value * color2[0];
+        output[1] = valuem * color1[1] + value * color2[1];
+        output[2] = valuem * color1[2] + value * color2[2];
+        output[3] = color1[3];
+      });
+}
+
 /* ******** Mix Burn Operation ******** */
 
 MixColorBurnOperation::MixColorBurnOperation() : MixBaseOperation()
@@ -678,7 +711,7 @@ void MixLinearLightOperation::executePixelSampled(float output[4],
 
 MixMultiplyOperation::MixMultiplyOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setBufferExecution(true);
 }
 
 void MixMultiplyOperation::executePixelSampled(float output[4],
@@ -707,6 +740,23 @@ void MixMultiplyOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixMultiplyOperation::executeBuffer(MemoryBuffer *output,
+                                         const rcti *area,
+                                         MemoryBuffer **inputs)
+{
+  executeBufferBlend(
+      output,
+      area,
+      inputs,
+      [](float *output, const float value, const float *color1, const float *color2) {
+        const float valuem = 1.0f - value;
+        output[0] = color1[0] * (valuem + value * color2[0]);
+        output[1] = color1[1] * (valuem + value * color2[1]);
+        output[2] = color1[2] * (valuem + value * color2[2]);
+        output[3] = color1[3];
+      });
+}
+
 /* ******** Mix Ovelray Operation ******** */
 
 MixOverlayOperation::MixOverlayOperation() : MixBaseOperation()
@@ -883,7 +933,7 @@ void MixSoftLightOperation::executePixelSampled(float output[4],
 
 MixSubtractOperation::MixSubtractOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setBufferExecution(true);
 }
 
 void MixSubtractOperation::executePixelSampled(float output[4],
@@ -911,6 +961,22 @@ void MixSubtractOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixSubtractOperation::executeBuffer(MemoryBuffer *output,
+                                         const rcti *area,
+                                         MemoryBuffer **inputs)
+{
+  executeBufferBlend(
+      output,
+      area,
+      inputs,
+      [](float *output, const float value, const float *color1, const float *color2) {
+        output[0] = color1[0] - value * color2[0];
+        output[1] = color1[1] - value * color2[1];
+        output[2] = color1[2] - value * color2[2];
+        output[3] = color1[3];
+      });
+}
+
 /* ******** Mix Value Operation ******** */
 
 MixValueOperation::MixValueOperation() : MixBaseOperation()
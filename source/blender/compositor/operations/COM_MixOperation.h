@@ -46,6 +46,39 @@ class MixBaseOperation : public NodeOperation {
     }
   }
 
+  /**
+   * Calculate an area of a blend function, for executeBuffer.
+   * The function gets the output, the mix factor and both colors of a pixel, the factor is
+   * already multiplied by the alpha of the second color when needed.
+   */
+  template<typename Func>
+  void executeBufferBlend(MemoryBuffer *output,
+                          const rcti *area,
+                          MemoryBuffer **inputs,
+                          const Func &func)
+  {
+    const int output_stride = output->getElemStride();
+    const int value_stride = inputs[0]->getElemStride();
+    const int color1_stride = inputs[1]->getElemStride();
+    const int color2_stride = inputs[2]->getElemStride();
+    const bool use_alpha = this->m_valueAlphaMultiply;
+    for (int y = area->ymin; y < area->ymax; y++) {
+      float *out = output->getElem(area->xmin, y);
+      const float *value = inputs[0]->getElem(area->xmin, y);
+      const float *color1 = inputs[1]->getElem(area->xmin, y);
+      const float *color2 = inputs[2]->getElem(area->xmin, y);
+      for (int x = area->xmin; x < area->xmax; x++) {
+        const float factor = use_alpha ? *value * color2[3] : *value;
+        func(out, factor, color1, color2);
+        clampIfNeeded(out);
+        out += output_stride;
+        value += value_stride;
+        color1 += color1_stride;
+        color2 += color2_stride;
+      }
+    }
+  }
+
  public:
   /**
    * Default constructor
@@ -87,12 +120,14 @@ class MixAddOperation : public MixBaseOperation {
  public:
   MixAddOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MixBlendOperation : public MixBaseOperation {
  public:
   MixBlendOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MixColorBurnOperation : public MixBaseOperation {
@@ -159,6 +194,7 @@ class MixMultiplyOperation : public MixBaseOperation {
  public:
   MixMultiplyOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MixOverlayOperation : public MixBaseOperation {
@@ -189,6 +225,7 @@ class MixSubtractOperation : public MixBaseOperation {
  public:
   MixSubtractOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeBuffer(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class MixValueOperation : public MixBaseOperation {
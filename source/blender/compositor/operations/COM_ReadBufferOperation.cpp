@@ -127,6 +127,23 @@ void ReadBufferOperation::readResolutionFromWriteBuffer()
   }
 }
 
+MemoryBuffer *ReadBufferOperation::calculateArea(const rcti *area, bool *r_owned)
+{
+  if (m_single_value) {
+    MemoryBuffer *buffer = new MemoryBuffer(this->getOutputSocket()->getDataType(), area, true);
+    m_buffer->read(buffer->getBuffer(), 0, 0);
+    *r_owned = true;
+    return buffer;
+  }
+  if (BLI_rcti_inside_rcti(m_buffer->getRect(), area)) {
+    /* Pixels are read directly from the buffer. */
+    *r_owned = false;
+    return m_buffer;
+  }
+  /* Pixels outside of the buffer are cleared by the pixel reads. */
+  return NodeOperation::calculateArea(area, r_owned);
+}
+
 void ReadBufferOperation::updateMemoryBuffer()
 {
   this->m_buffer = this->getMemoryProxy()->getBuffer();
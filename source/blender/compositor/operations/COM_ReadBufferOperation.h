@@ -55,6 +55,11 @@ class ReadBufferOperation : public NodeOperation {
   {
     return true;
   }
+  bool isSingleValue() const
+  {
+    return this->m_single_value;
+  }
+  MemoryBuffer *calculateArea(const rcti *area, bool *r_owned);
   void setOffset(unsigned int offset)
   {
     this->m_offset = offset;
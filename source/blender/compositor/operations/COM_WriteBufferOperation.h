@@ -29,6 +29,7 @@
 class WriteBufferOperation : public NodeOperation {
   MemoryProxy *m_memoryProxy;
   bool m_single_value; /* single value stored in buffer */
+  bool m_useBufferExecution; /* calculate areas in bulk when the input supports it */
   NodeOperation *m_input;
 
  public:
@@ -47,6 +48,10 @@ class WriteBufferOperation : public NodeOperation {
   {
     return m_single_value;
   }
+  void setUseBufferExecution(bool useBufferExecution)
+  {
+    this->m_useBufferExecution = useBufferExecution;
+  }
 
   void executeRegion(rcti *rect, unsigned int tileNumber);
   void initExecution();
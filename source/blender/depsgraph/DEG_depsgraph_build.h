@@ -81,6 +81,22 @@ void DEG_graph_build_from_ids(struct Depsgraph *graph,
                               struct ID **ids,
                               const int num_ids);
 
+/* Incremental update of relations after objects were added to or removed from the view layer of
+ * the graph, the view layer bases must be synchronized already. Only the nodes and relations of
+ * these objects and of the data-blocks they use are built or freed, the rest of the graph is kept.
+ *
+ * Returns false when the change can not be applied incrementally, relations of the graph are then
+ * tagged for a full update. With --debug-depsgraph-build the result is compared with a graph built
+ * from scratch. */
+bool DEG_graph_relations_add_ids(struct Depsgraph *graph,
+                                 struct Main *bmain,
+                                 struct ID **ids,
+                                 const int num_ids);
+bool DEG_graph_relations_remove_ids(struct Depsgraph *graph,
+                                    struct Main *bmain,
+                                    struct ID **ids,
+                                    const int num_ids);
+
 /* Tag relations from the given graph for update. */
 void DEG_graph_tag_relations_update(struct Depsgraph *graph);
 
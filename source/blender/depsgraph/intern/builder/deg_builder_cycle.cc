@@ -179,6 +179,10 @@ void solve_cycles(CyclesSolverState *state)
     const int num_visited = get_node_num_visited_children(node);
     for (int i = num_visited; i < node->outlinks.size(); i++) {
       Relation *rel = node->outlinks[i];
+      if (rel->flag & RELATION_FLAG_CYCLIC) {
+        /* Cycle was solved by the build preceding an incremental update. */
+        continue;
+      }
       if (rel->to->type == NodeType::OPERATION) {
         OperationNode *to = (OperationNode *)rel->to;
         eCyclicCheckVisitedState to_state = get_node_visited_state(to);
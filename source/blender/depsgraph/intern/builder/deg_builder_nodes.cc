@@ -375,6 +375,42 @@ void DepsgraphNodeBuilder::end_build()
   }
 }
 
+void DepsgraphNodeBuilder::begin_incremental_build(Scene *scene, ViewLayer *view_layer)
+{
+  /* There are no copy-on-write versions to re-use, existing ID nodes keep theirs. */
+  id_info_hash_ = BLI_ghash_ptr_new("Depsgraph id hash");
+  for (IDNode *id_node : graph_->id_nodes) {
+    /* Same as what a full build carries over from the previous state, so finalization only tags
+     * the IDs whose state is changed by the new nodes. */
+    id_node->previously_visible_components_mask = id_node->visible_components_mask;
+    id_node->previous_eval_flags = id_node->eval_flags;
+    id_node->previous_customdata_masks = id_node->customdata_masks;
+    built_map_.tagBuild(id_node->id_orig);
+  }
+  /* Same context as build_view_layer(). */
+  view_layer_index_ = 0;
+  scene_ = scene;
+  view_layer_ = view_layer;
+}
+
+void DepsgraphNodeBuilder::build_view_layer_bases_incremental()
+{
+  int base_index = 0;
+  LISTBASE_FOREACH (Base *, base, &view_layer_->object_bases) {
+    if (!need_pull_base_into_graph(base)) {
+      continue;
+    }
+    Object *object = base->object;
+    if (built_map_.checkIsBuilt(object)) {
+      build_object_flags(base_index, object, DEG_ID_LINKED_DIRECTLY);
+    }
+    else {
+      build_object(base_index, object, DEG_ID_LINKED_DIRECTLY, true);
+    }
+    base_index++;
+  }
+}
+
 void DepsgraphNodeBuilder::build_id(ID *id)
 {
   if (id == nullptr) {
@@ -643,17 +679,25 @@ void DepsgraphNodeBuilder::build_object_flags(int base_index,
   Scene *scene_cow = get_cow_datablock(scene_);
   Object *object_cow = get_cow_datablock(object);
   const bool is_from_set = (linked_state == DEG_ID_LINKED_VIA_SET);
+  DepsEvalOperationCb eval_base_flags = function_bind(BKE_object_eval_eval_base_flags,
+                                                      _1,
+                                                      scene_cow,
+                                                      view_layer_index_,
+                                                      object_cow,
+                                                      base_index,
+                                                      is_from_set);
+  /* Incremental builds update the base index of objects which are already in the graph. */
+  OperationNode *op_node = find_operation_node(
+      &object->id, NodeType::OBJECT_FROM_LAYER, OperationCode::OBJECT_BASE_FLAGS);
+  if (op_node != nullptr) {
+    op_node->evaluate = eval_base_flags;
+    return;
+  }
   /* TODO(sergey): Is this really best component to be used? */
   add_operation_node(&object->id,
                      NodeType::OBJECT_FROM_LAYER,
                      OperationCode::OBJECT_BASE_FLAGS,
-                     function_bind(BKE_object_eval_eval_base_flags,
-                                   _1,
-                                   scene_cow,
-                                   view_layer_index_,
-                                   object_cow,
-                                   base_index,
-                                   is_from_set));
+                     eval_base_flags);
 }
 
 void DepsgraphNodeBuilder::build_object_proxy_from(Object *object, bool is_visible)
@@ -98,6 +98,13 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   virtual void begin_build();
   virtual void end_build();
 
+  /* Incremental build: the nodes which are already in the graph are kept, only the IDs which are
+   * not in the graph yet are built. */
+  virtual void begin_incremental_build(Scene *scene, ViewLayer *view_layer);
+  /* Build objects of the view layer bases which are not in the graph yet, and update the base
+   * index of the others since it is changed by added and removed bases. */
+  virtual void build_view_layer_bases_incremental();
+
   IDNode *add_id_node(ID *id);
   IDNode *find_id_node(ID *id);
   TimeSourceNode *add_time_source();
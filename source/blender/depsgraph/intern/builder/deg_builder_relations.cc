@@ -481,6 +481,25 @@ void DepsgraphRelationBuilder::begin_build()
 {
 }
 
+void DepsgraphRelationBuilder::begin_incremental_build(Scene *scene, const int num_built_id_nodes)
+{
+  BLI_assert(num_built_id_nodes <= (int)graph_->id_nodes.size());
+  for (int i = 0; i < num_built_id_nodes; i++) {
+    built_map_.tagBuild(graph_->id_nodes[i]->id_orig);
+  }
+  /* Same context as build_view_layer(). */
+  scene_ = scene;
+}
+
+void DepsgraphRelationBuilder::build_view_layer_bases_incremental(ViewLayer *view_layer)
+{
+  LISTBASE_FOREACH (Base *, base, &view_layer->object_bases) {
+    if (need_pull_base_into_graph(base) && !built_map_.checkIsBuilt(base->object)) {
+      build_object(base, base->object);
+    }
+  }
+}
+
 void DepsgraphRelationBuilder::build_id(ID *id)
 {
   if (id == nullptr) {
@@ -161,6 +161,12 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
 
   void begin_build();
 
+  /* Incremental build: the relations of the first `num_built_id_nodes` ID nodes of the graph are
+   * kept, only the IDs added to the graph after them are built. */
+  void begin_incremental_build(Scene *scene, int num_built_id_nodes);
+  /* Build relations of the objects of view layer bases which were not built yet. */
+  void build_view_layer_bases_incremental(ViewLayer *view_layer);
+
   template<typename KeyFrom, typename KeyTo>
   Relation *add_relation(const KeyFrom &key_from,
                          const KeyTo &key_to,
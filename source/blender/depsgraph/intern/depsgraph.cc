@@ -70,6 +70,7 @@ Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluati
     : time_source(nullptr),
       need_update(true),
       need_update_time(false),
+      is_update_state_clean(false),
       bmain(bmain),
       scene(scene),
       view_layer(view_layer),
@@ -176,6 +177,66 @@ void Depsgraph::clear_id_nodes()
   clear_physics_relations(this);
 }
 
+void Depsgraph::remove_id_nodes(const set<IDNode *> &removed_id_nodes)
+{
+  auto is_removed_operation = [&removed_id_nodes](const OperationNode *op_node) {
+    return removed_id_nodes.find(op_node->owner->owner) != removed_id_nodes.end();
+  };
+  vector<OperationNode *> removed_operations;
+  for (IDNode *id_node : removed_id_nodes) {
+    GHASH_FOREACH_BEGIN (ComponentNode *, comp_node, id_node->components) {
+      /* Only finalized components are expected, their operations are in the vector. */
+      BLI_assert(comp_node->operations_map == nullptr);
+      for (OperationNode *op_node : comp_node->operations) {
+        removed_operations.push_back(op_node);
+      }
+    }
+    GHASH_FOREACH_END();
+  }
+  /* Free relations between removed operations and outgoing ones first, the remaining incoming
+   * relations all come from nodes which are kept. */
+  for (OperationNode *op_node : removed_operations) {
+    for (Relation *rel : op_node->outlinks) {
+      remove_from_vector(&rel->to->inlinks, rel);
+      OBJECT_GUARDED_DELETE(rel, Relation);
+    }
+    op_node->outlinks.clear();
+  }
+  for (OperationNode *op_node : removed_operations) {
+    for (Relation *rel : op_node->inlinks) {
+      remove_from_vector(&rel->from->outlinks, rel);
+      OBJECT_GUARDED_DELETE(rel, Relation);
+    }
+    op_node->inlinks.clear();
+    BLI_gset_remove(entry_tags, op_node, nullptr);
+  }
+  operations.erase(std::remove_if(operations.begin(), operations.end(), is_removed_operation),
+                   operations.end());
+  updated_operations.erase(
+      std::remove_if(updated_operations.begin(), updated_operations.end(), is_removed_operation),
+      updated_operations.end());
+  /* Flags of the kept nodes are not known to be clear anymore. */
+  is_update_state_clean = false;
+  auto is_removed_id_node = [&removed_id_nodes](const IDNode *id_node) {
+    return removed_id_nodes.find(const_cast<IDNode *>(id_node)) != removed_id_nodes.end();
+  };
+  id_nodes.erase(std::remove_if(id_nodes.begin(), id_nodes.end(), is_removed_id_node),
+                 id_nodes.end());
+  updated_id_nodes.erase(
+      std::remove_if(updated_id_nodes.begin(), updated_id_nodes.end(), is_removed_id_node),
+      updated_id_nodes.end());
+  /* Free copy-on-write data-blocks in the same order as clear_id_nodes(). */
+  for (IDNode *id_node : removed_id_nodes) {
+    BLI_ghash_remove(id_hash, id_node->id_orig, nullptr, nullptr);
+    if (GS(id_node->id_orig->name) != ID_PA) {
+      id_node->destroy();
+    }
+  }
+  for (IDNode *id_node : removed_id_nodes) {
+    OBJECT_GUARDED_DELETE(id_node, IDNode);
+  }
+}
+
 /* Add new relation between two nodes */
 Relation *Depsgraph::add_new_relation(Node *from, Node *to, const char *description, int flags)
 {
@@ -239,6 +300,9 @@ void Depsgraph::add_entry_tag(OperationNode *node)
 void Depsgraph::clear_all_nodes()
 {
   clear_id_nodes();
+  updated_operations.clear();
+  updated_id_nodes.clear();
+  is_update_state_clean = false;
   if (time_source != nullptr) {
     OBJECT_GUARDED_DELETE(time_source, TimeSourceNode);
     time_source = nullptr;
@@ -73,6 +73,9 @@ struct Depsgraph {
   IDNode *add_id_node(ID *id, ID *id_cow_hint = nullptr);
   void clear_id_nodes();
   void clear_id_nodes_conditional(const std::function<bool(ID_Type id_type)> &filter);
+  /* Remove ID nodes from a built graph, together with their operations and all relations from
+   * and to them. */
+  void remove_id_nodes(const set<IDNode *> &removed_id_nodes);
 
   /* Add new relationship between two nodes. */
   Relation *add_new_relation(Node *from, Node *to, const char *description, int flags = 0);
@@ -125,6 +128,17 @@ struct Depsgraph {
    * scene frame changes, so then when dependency graph becomes visible it is on a proper state. */
   bool need_update_time;
 
+  /* Operations tagged for update since the tags were last cleared, and ID nodes modified by the
+   * last flush. The flush, evaluation and tags clearing only visit these nodes, so their cost is
+   * proportional to the number of changes instead of the graph size. */
+  OperationNodes updated_operations;
+  IDDepsNodes updated_id_nodes;
+
+  /* True when the nodes outside of the updated sets have their evaluation flags cleared. Other
+   * traversals using the same flags and graph builds reset it, the next flush then clears the
+   * flags of all nodes. */
+  bool is_update_state_clean;
+
   /* Convenience Data ................... */
 
   /* XXX: should be collected after building (if actually needed?) */
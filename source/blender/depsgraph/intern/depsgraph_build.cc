@@ -34,10 +34,15 @@
 
 extern "C" {
 #include "DNA_cachefile_types.h"
+#include "DNA_collection_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_force_types.h"
 #include "DNA_object_types.h"
 #include "DNA_scene_types.h"
 
+#include "BKE_collection.h"
 #include "BKE_main.h"
+#include "BKE_modifier.h"
 #include "BKE_scene.h"
 } /* extern "C" */
 
@@ -507,3 +512,380 @@ void DEG_relations_tag_update(Main *bmain)
     DEG_graph_tag_relations_update(reinterpret_cast<Depsgraph *>(depsgraph));
   }
 }
+
+/* ************************* */
+/* Incremental Relations API */
+
+/* Adding or removing objects only builds or frees the nodes and relations of these objects and of
+ * the data-blocks they use, the rest of the graph is kept. Changes which affect relations of other
+ * IDs are not handled incrementally:
+ *
+ * - Objects of instanced collections, which have relations to their instancers.
+ * - Colliders, force fields and rigid bodies, which are in the physics relations of others.
+ * - Objects which are used by other IDs of the graph, when they are removed.
+ *
+ * For those the graph is tagged for a full rebuild of its relations instead. */
+
+namespace DEG {
+namespace {
+
+bool object_affects_physics_relations(Object *object)
+{
+  if (object->pd != nullptr && object->pd->forcefield != PFIELD_NULL) {
+    return true;
+  }
+  if (modifiers_findByType(object, eModifierType_Collision) != nullptr) {
+    return true;
+  }
+  return (object->rigidbody_object != nullptr || object->rigidbody_constraint != nullptr);
+}
+
+bool object_in_instanced_collection(const Depsgraph *graph, Object *object)
+{
+  for (IDNode *id_node : graph->id_nodes) {
+    if (GS(id_node->id_orig->name) != ID_GR || !id_node->is_collection_fully_expanded) {
+      continue;
+    }
+    if (BKE_collection_has_object_recursive((Collection *)id_node->id_orig, object)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool object_supports_incremental_update(const Depsgraph *graph, Object *object)
+{
+  if (object == graph->scene->camera) {
+    return false;
+  }
+  if (object_affects_physics_relations(object)) {
+    return false;
+  }
+  return !object_in_instanced_collection(graph, object);
+}
+
+/* Data-blocks which are only in the graph when used by another ID. */
+bool is_dependency_id_type(const ID_Type id_type)
+{
+  switch (id_type) {
+    case ID_OB:
+    case ID_ME:
+    case ID_CU:
+    case ID_MB:
+    case ID_LT:
+    case ID_LA:
+    case ID_CA:
+    case ID_AR:
+    case ID_GD:
+    case ID_SPK:
+    case ID_LP:
+    case ID_KE:
+    case ID_MA:
+    case ID_TE:
+    case ID_IM:
+    case ID_NT:
+    case ID_AC:
+    case ID_PA:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/* Data-blocks which the view layer builder adds for all of main database. */
+bool is_main_database_id_type(const ID_Type id_type)
+{
+  return ELEM(id_type, ID_CF, ID_MSK, ID_MC);
+}
+
+/* Check whether all relations from operations of the ID node lead to the given ID nodes. */
+bool id_node_only_used_by(IDNode *id_node, const set<IDNode *> &users)
+{
+  GHASH_FOREACH_BEGIN (ComponentNode *, comp_node, id_node->components) {
+    for (OperationNode *op_node : comp_node->operations) {
+      for (Relation *rel : op_node->outlinks) {
+        if (rel->to->type != NodeType::OPERATION) {
+          continue;
+        }
+        IDNode *to_id_node = ((OperationNode *)rel->to)->owner->owner;
+        if (to_id_node != id_node && users.find(to_id_node) == users.end()) {
+          return false;
+        }
+      }
+    }
+  }
+  GHASH_FOREACH_END();
+  return true;
+}
+
+/* Extend the set of removed ID nodes with the data-blocks which are only used by them. Returns
+ * false when a data-block could still be pulled into the graph by something else. */
+bool collect_unused_dependencies(set<IDNode *> &removed_id_nodes)
+{
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    vector<IDNode *> dependencies;
+    for (IDNode *id_node : removed_id_nodes) {
+      GHASH_FOREACH_BEGIN (ComponentNode *, comp_node, id_node->components) {
+        for (OperationNode *op_node : comp_node->operations) {
+          for (Relation *rel : op_node->inlinks) {
+            if (rel->from->type != NodeType::OPERATION) {
+              continue;
+            }
+            IDNode *from_id_node = ((OperationNode *)rel->from)->owner->owner;
+            if (removed_id_nodes.find(from_id_node) == removed_id_nodes.end()) {
+              dependencies.push_back(from_id_node);
+            }
+          }
+        }
+      }
+      GHASH_FOREACH_END();
+    }
+    for (IDNode *id_node : dependencies) {
+      if (removed_id_nodes.find(id_node) != removed_id_nodes.end()) {
+        continue;
+      }
+      if (id_node->has_base || id_node->linked_state != DEG_ID_LINKED_INDIRECTLY) {
+        continue;
+      }
+      if (!id_node_only_used_by(id_node, removed_id_nodes)) {
+        continue;
+      }
+      const ID_Type id_type = GS(id_node->id_orig->name);
+      if (is_main_database_id_type(id_type)) {
+        continue;
+      }
+      if (!is_dependency_id_type(id_type)) {
+        return false;
+      }
+      removed_id_nodes.insert(id_node);
+      changed = true;
+    }
+  }
+  return true;
+}
+
+/* Base flags of the scene copy are used by all objects with a base, same as the tag done for a
+ * full relations update. */
+void graph_tag_view_layer_update(Depsgraph *graph)
+{
+  IDNode *id_node = graph->find_id_node(&graph->scene->id);
+  if (id_node != nullptr) {
+    id_node->tag_update(graph, DEG_UPDATE_SOURCE_RELATIONS);
+  }
+}
+
+bool graph_add_objects(Depsgraph *graph, Main *bmain, ID **ids, const int num_ids)
+{
+  Scene *scene = graph->scene;
+  ViewLayer *view_layer = graph->view_layer;
+  if (graph->is_render_pipeline_depsgraph || scene->set != nullptr) {
+    return false;
+  }
+  set<ID *> added_ids;
+  for (int i = 0; i < num_ids; i++) {
+    ID *id = ids[i];
+    if (GS(id->name) != ID_OB) {
+      return false;
+    }
+    IDNode *id_node = graph->find_id_node(id);
+    if (id_node != nullptr) {
+      if (!id_node->has_base) {
+        /* Object used by other IDs of the graph now has a base. */
+        return false;
+      }
+      continue;
+    }
+    if (!object_supports_incremental_update(graph, (Object *)id)) {
+      return false;
+    }
+    added_ids.insert(id);
+  }
+
+  DepsgraphBuilderCache builder_cache;
+  DepsgraphNodeBuilder node_builder(bmain, graph, &builder_cache);
+  /* Bases must only differ from the graph by the added objects. */
+  int num_kept_bases = 0;
+  LISTBASE_FOREACH (Base *, base, &view_layer->object_bases) {
+    if (!node_builder.need_pull_base_into_graph(base)) {
+      continue;
+    }
+    IDNode *id_node = graph->find_id_node(&base->object->id);
+    if (id_node == nullptr) {
+      if (added_ids.find(&base->object->id) == added_ids.end()) {
+        return false;
+      }
+    }
+    else if (!id_node->has_base) {
+      return false;
+    }
+    else {
+      num_kept_bases++;
+    }
+  }
+  for (IDNode *id_node : graph->id_nodes) {
+    if (id_node->has_base) {
+      num_kept_bases--;
+    }
+  }
+  if (num_kept_bases != 0) {
+    return false;
+  }
+
+  const int num_id_nodes = graph->id_nodes.size();
+  node_builder.begin_incremental_build(scene, view_layer);
+  node_builder.build_view_layer_bases_incremental();
+  node_builder.end_build();
+  DepsgraphRelationBuilder relation_builder(bmain, graph, &builder_cache);
+  relation_builder.begin_incremental_build(scene, num_id_nodes);
+  relation_builder.build_view_layer_bases_incremental(view_layer);
+  for (int i = num_id_nodes; i < (int)graph->id_nodes.size(); i++) {
+    relation_builder.build_copy_on_write_relations(graph->id_nodes[i]);
+    relation_builder.build_driver_relations(graph->id_nodes[i]);
+  }
+  graph_build_finalize_common(graph, bmain);
+  /* Finalization uses evaluation flags of all operations, same state as after a full build. */
+  graph->is_update_state_clean = false;
+  graph_tag_view_layer_update(graph);
+  return true;
+}
+
+bool graph_remove_objects(Depsgraph *graph, Main *bmain, ID **ids, const int num_ids)
+{
+  Scene *scene = graph->scene;
+  ViewLayer *view_layer = graph->view_layer;
+  if (graph->is_render_pipeline_depsgraph || scene->set != nullptr) {
+    return false;
+  }
+  set<IDNode *> removed_id_nodes;
+  for (int i = 0; i < num_ids; i++) {
+    ID *id = ids[i];
+    if (GS(id->name) != ID_OB) {
+      return false;
+    }
+    IDNode *id_node = graph->find_id_node(id);
+    if (id_node == nullptr) {
+      continue;
+    }
+    if (!id_node->has_base || !object_supports_incremental_update(graph, (Object *)id)) {
+      return false;
+    }
+    removed_id_nodes.insert(id_node);
+  }
+
+  DepsgraphBuilderCache builder_cache;
+  DepsgraphNodeBuilder node_builder(bmain, graph, &builder_cache);
+  /* Bases must only differ from the graph by the removed objects. */
+  int num_kept_bases = 0;
+  LISTBASE_FOREACH (Base *, base, &view_layer->object_bases) {
+    if (!node_builder.need_pull_base_into_graph(base)) {
+      continue;
+    }
+    IDNode *id_node = graph->find_id_node(&base->object->id);
+    if (id_node == nullptr || !id_node->has_base ||
+        removed_id_nodes.find(id_node) != removed_id_nodes.end()) {
+      return false;
+    }
+    num_kept_bases++;
+  }
+  int num_base_id_nodes = 0;
+  for (IDNode *id_node : graph->id_nodes) {
+    if (id_node->has_base) {
+      num_base_id_nodes++;
+    }
+  }
+  if (num_kept_bases + (int)removed_id_nodes.size() != num_base_id_nodes) {
+    return false;
+  }
+  if (removed_id_nodes.empty()) {
+    return true;
+  }
+
+  /* A full build keeps objects used by other IDs, linked indirectly. */
+  for (IDNode *id_node : removed_id_nodes) {
+    if (!id_node_only_used_by(id_node, removed_id_nodes)) {
+      return false;
+    }
+  }
+  if (!collect_unused_dependencies(removed_id_nodes)) {
+    return false;
+  }
+
+  graph->remove_id_nodes(removed_id_nodes);
+  /* Update base index of the kept objects. */
+  node_builder.begin_incremental_build(scene, view_layer);
+  node_builder.build_view_layer_bases_incremental();
+  node_builder.end_build();
+  graph_tag_view_layer_update(graph);
+  return true;
+}
+
+/* Compare with a graph built from scratch, tag relations for a full update on mismatch. */
+bool graph_validate_incremental_update(::Depsgraph *graph, Main *bmain)
+{
+  Depsgraph *deg_graph = reinterpret_cast<Depsgraph *>(graph);
+  ::Depsgraph *full_graph = DEG_graph_new(
+      bmain, deg_graph->scene, deg_graph->view_layer, deg_graph->mode);
+  DEG_graph_build_from_view_layer(full_graph, bmain, deg_graph->scene, deg_graph->view_layer);
+  const bool valid = DEG_debug_compare(full_graph, graph);
+  DEG_graph_free(full_graph);
+  if (!valid) {
+    fprintf(stderr, "ERROR! Incremental relations update does not match a full build.\n");
+    DEG_graph_tag_relations_update(graph);
+  }
+  return valid;
+}
+
+}  // namespace
+}  // namespace DEG
+
+/* Add the nodes and relations of objects added to the view layer of the graph. */
+bool DEG_graph_relations_add_ids(Depsgraph *graph, Main *bmain, ID **ids, const int num_ids)
+{
+  DEG::Depsgraph *deg_graph = reinterpret_cast<DEG::Depsgraph *>(graph);
+  if (deg_graph->need_update) {
+    /* Relations are rebuilt anyway. */
+    return false;
+  }
+  double start_time = 0.0;
+  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
+    start_time = PIL_check_seconds_timer();
+  }
+  if (!DEG::graph_add_objects(deg_graph, bmain, ids, num_ids)) {
+    DEG_graph_tag_relations_update(graph);
+    return false;
+  }
+  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
+    printf("Depsgraph relations added in %f seconds.\n", PIL_check_seconds_timer() - start_time);
+  }
+  if (G.debug & G_DEBUG_DEPSGRAPH_BUILD) {
+    return DEG::graph_validate_incremental_update(graph, bmain);
+  }
+  return true;
+}
+
+/* Free the nodes and relations of objects removed from the view layer of the graph. */
+bool DEG_graph_relations_remove_ids(Depsgraph *graph, Main *bmain, ID **ids, const int num_ids)
+{
+  DEG::Depsgraph *deg_graph = reinterpret_cast<DEG::Depsgraph *>(graph);
+  if (deg_graph->need_update) {
+    /* Relations are rebuilt anyway. */
+    return false;
+  }
+  double start_time = 0.0;
+  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
+    start_time = PIL_check_seconds_timer();
+  }
+  if (!DEG::graph_remove_objects(deg_graph, bmain, ids, num_ids)) {
+    DEG_graph_tag_relations_update(graph);
+    return false;
+  }
+  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
+    printf("Depsgraph relations removed in %f seconds.\n", PIL_check_seconds_timer() - start_time);
+  }
+  if (G.debug & G_DEBUG_DEPSGRAPH_BUILD) {
+    return DEG::graph_validate_incremental_update(graph, bmain);
+  }
+  return true;
+}
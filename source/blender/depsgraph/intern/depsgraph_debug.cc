@@ -25,6 +25,7 @@
 
 #include "BLI_utildefines.h"
 #include "BLI_ghash.h"
+#include "BLI_string.h"
 
 extern "C" {
 #include "DNA_scene_types.h"
@@ -43,6 +44,7 @@ extern "C" {
 #include "intern/debug/deg_debug.h"
 #include "intern/node/deg_node_component.h"
 #include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
 #include "intern/node/deg_node_time.h"
 
 void DEG_debug_flags_set(Depsgraph *depsgraph, int flags)
@@ -69,22 +71,56 @@ const char *DEG_debug_name_get(struct Depsgraph *depsgraph)
   return deg_graph->debug.name.c_str();
 }
 
+namespace DEG {
+namespace {
+
+/* Identifier of a node which is the same in graphs built for the same original data-blocks. */
+string debug_compare_node_identifier(const Node *node)
+{
+  if (node->type != NodeType::OPERATION) {
+    return node->identifier();
+  }
+  const OperationNode *op_node = static_cast<const OperationNode *>(node);
+  char id_orig[24];
+  BLI_snprintf(id_orig, sizeof(id_orig), "%p", op_node->owner->owner->id_orig);
+  return string(id_orig) + "/" + to_string(static_cast<int>(op_node->owner->type)) + "/" +
+         op_node->full_identifier() + "/" + to_string(op_node->name_tag);
+}
+
+void debug_compare_graph_identifiers(const Depsgraph *graph,
+                                     std::multiset<string> *operations,
+                                     std::multiset<string> *relations)
+{
+  for (OperationNode *op_node : graph->operations) {
+    const string op_identifier = debug_compare_node_identifier(op_node);
+    operations->insert(op_identifier);
+    for (Relation *rel : op_node->inlinks) {
+      relations->insert(debug_compare_node_identifier(rel->from) + " -> " + op_identifier + " (" +
+                        rel->name + ")");
+    }
+  }
+}
+
+}  // namespace
+}  // namespace DEG
+
 bool DEG_debug_compare(const struct Depsgraph *graph1, const struct Depsgraph *graph2)
 {
   BLI_assert(graph1 != nullptr);
   BLI_assert(graph2 != nullptr);
   const DEG::Depsgraph *deg_graph1 = reinterpret_cast<const DEG::Depsgraph *>(graph1);
   const DEG::Depsgraph *deg_graph2 = reinterpret_cast<const DEG::Depsgraph *>(graph2);
-  if (deg_graph1->operations.size() != deg_graph2->operations.size()) {
+  if (deg_graph1->id_nodes.size() != deg_graph2->id_nodes.size() ||
+      deg_graph1->operations.size() != deg_graph2->operations.size()) {
     return false;
   }
-  /* TODO(sergey): Currently we only do real stupid check,
-   * which is fast but which isn't 100% reliable.
-   *
-   * Would be cool to make it more robust, but it's good enough
-   * for now. Also, proper graph check is actually NP-complex
-   * problem. */
-  return true;
+  /* Operations and relations are compared by identifiers, independently of their order. Flags of
+   * relations are ignored: cycles might be solved by cutting a different relation. */
+  std::multiset<std::string> operations1, operations2;
+  std::multiset<std::string> relations1, relations2;
+  DEG::debug_compare_graph_identifiers(deg_graph1, &operations1, &relations1);
+  DEG::debug_compare_graph_identifiers(deg_graph2, &operations2, &relations2);
+  return operations1 == operations2 && relations1 == relations2;
 }
 
 bool DEG_debug_graph_relations_validate(Depsgraph *graph,
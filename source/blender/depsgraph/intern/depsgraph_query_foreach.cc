@@ -60,6 +60,8 @@ typedef void (*DEGForeachOperation)(OperationNode *op_node, void *user_data);
 
 void deg_foreach_clear_flags(const Depsgraph *graph)
 {
+  /* The flags are shared with the update flush, it will need to clear them again. */
+  const_cast<Depsgraph *>(graph)->is_update_state_clean = false;
   for (OperationNode *op_node : graph->operations) {
     op_node->scheduled = false;
     op_node->owner->custom_flags = 0;
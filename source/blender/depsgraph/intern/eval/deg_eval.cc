@@ -176,7 +176,14 @@ void calculate_pending_parents_for_node(OperationNode *node)
 
 void calculate_pending_parents(Depsgraph *graph)
 {
-  for (OperationNode *node : graph->operations) {
+  /* Operations which are not tagged for update are never scheduled, only their scheduled flag
+   * needs to be clear, which is the case unless another traversal used it. */
+  if (!graph->is_update_state_clean) {
+    for (OperationNode *node : graph->operations) {
+      node->scheduled = false;
+    }
+  }
+  for (OperationNode *node : graph->updated_operations) {
     calculate_pending_parents_for_node(node);
   }
 }
@@ -186,8 +193,8 @@ void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph)
   const bool do_stats = state->do_stats;
   calculate_pending_parents(graph);
   /* Clear tags and other things which needs to be clear. */
-  for (OperationNode *node : graph->operations) {
-    if (do_stats) {
+  if (do_stats) {
+    for (OperationNode *node : graph->operations) {
       node->stats.reset_current();
     }
   }
@@ -285,7 +292,8 @@ void schedule_graph(DepsgraphEvalState *state,
                     ScheduleFunction *schedule_function,
                     ScheduleFunctionArgs... schedule_function_args)
 {
-  for (OperationNode *node : state->graph->operations) {
+  /* Only the operations tagged for update are evaluated, start from them. */
+  for (OperationNode *node : state->graph->updated_operations) {
     schedule_node(state, node, false, -1, schedule_function, schedule_function_args...);
   }
 }
@@ -88,30 +88,55 @@ typedef std::deque<OperationNode *> FlushQueue;
 
 namespace {
 
-void flush_init_id_node_func(void *__restrict data_v,
-                             const int i,
-                             const TaskParallelTLS *__restrict /*tls*/)
+BLI_INLINE void flush_reset_id_node(IDNode *id_node)
 {
-  Depsgraph *graph = (Depsgraph *)data_v;
-  IDNode *id_node = graph->id_nodes[i];
   id_node->custom_flags = ID_STATE_NONE;
   GHASH_FOREACH_BEGIN (ComponentNode *, comp_node, id_node->components)
     comp_node->custom_flags = COMPONENT_STATE_NONE;
   GHASH_FOREACH_END();
 }
 
+void flush_init_id_node_func(void *__restrict data_v,
+                             const int i,
+                             const TaskParallelTLS *__restrict /*tls*/)
+{
+  Depsgraph *graph = (Depsgraph *)data_v;
+  flush_reset_id_node(graph->id_nodes[i]);
+}
+
 BLI_INLINE void flush_prepare(Depsgraph *graph)
 {
-  for (OperationNode *node : graph->operations) {
-    node->scheduled = false;
+  if (graph->is_update_state_clean) {
+    /* Only nodes of a previous flush which was not followed by an evaluation can be flagged. */
+    for (OperationNode *node : graph->updated_operations) {
+      node->scheduled = false;
+    }
+    for (IDNode *id_node : graph->updated_id_nodes) {
+      flush_reset_id_node(id_node);
+    }
   }
+  else {
+    for (OperationNode *node : graph->operations) {
+      node->scheduled = false;
+    }
 
-  {
     const int num_id_nodes = graph->id_nodes.size();
     TaskParallelSettings settings;
     BLI_parallel_range_settings_defaults(&settings);
     settings.min_iter_per_thread = 1024;
     BLI_task_parallel_range(0, num_id_nodes, graph, flush_init_id_node_func, &settings);
+
+    graph->is_update_state_clean = true;
+  }
+  graph->updated_id_nodes.clear();
+}
+
+/* Tag operation as required for update, and keep track of it for the evaluation. */
+BLI_INLINE void flush_tag_operation(Depsgraph *graph, OperationNode *op_node)
+{
+  if ((op_node->flag & DEPSOP_FLAG_NEEDS_UPDATE) == 0) {
+    op_node->flag |= DEPSOP_FLAG_NEEDS_UPDATE;
+    graph->updated_operations.push_back(op_node);
   }
 }
 
@@ -128,13 +153,17 @@ BLI_INLINE void flush_schedule_entrypoints(Depsgraph *graph, FlushQueue *queue)
   GSET_FOREACH_END();
 }
 
-BLI_INLINE void flush_handle_id_node(IDNode *id_node)
+BLI_INLINE void flush_handle_id_node(Depsgraph *graph, IDNode *id_node)
 {
-  id_node->custom_flags = ID_STATE_MODIFIED;
+  if (id_node->custom_flags != ID_STATE_MODIFIED) {
+    id_node->custom_flags = ID_STATE_MODIFIED;
+    graph->updated_id_nodes.push_back(id_node);
+  }
 }
 
 /* TODO(sergey): We can reduce number of arguments here. */
-BLI_INLINE void flush_handle_component_node(IDNode *id_node,
+BLI_INLINE void flush_handle_component_node(Depsgraph *graph,
+                                            IDNode *id_node,
                                             ComponentNode *comp_node,
                                             FlushQueue *queue)
 {
@@ -150,7 +179,7 @@ BLI_INLINE void flush_handle_component_node(IDNode *id_node,
   if (comp_node->type != NodeType::PARTICLE_SETTINGS &&
       comp_node->type != NodeType::PARTICLE_SYSTEM) {
     for (OperationNode *op : comp_node->operations) {
-      op->flag |= DEPSOP_FLAG_NEEDS_UPDATE;
+      flush_tag_operation(graph, op);
     }
   }
   /* when some target changes bone, we might need to re-run the
@@ -222,10 +251,7 @@ void flush_engine_data_update(ID *id)
 /* NOTE: It will also accumulate flags from changed components. */
 void flush_editors_id_update(Depsgraph *graph, const DEGEditorUpdateContext *update_ctx)
 {
-  for (IDNode *id_node : graph->id_nodes) {
-    if (id_node->custom_flags != ID_STATE_MODIFIED) {
-      continue;
-    }
+  for (IDNode *id_node : graph->updated_id_nodes) {
     DEG_graph_id_type_tag(reinterpret_cast<::Depsgraph *>(graph), GS(id_node->id_orig->name));
     /* TODO(sergey): Do we need to pass original or evaluated ID here? */
     ID *id_orig = id_node->id_orig;
@@ -299,10 +325,7 @@ void invalidate_tagged_evaluated_geometry(ID *id)
 void invalidate_tagged_evaluated_data(Depsgraph *graph)
 {
 #ifdef INVALIDATE_ON_FLUSH
-  for (IDNode *id_node : graph->id_nodes) {
-    if (id_node->custom_flags != ID_STATE_MODIFIED) {
-      continue;
-    }
+  for (IDNode *id_node : graph->updated_id_nodes) {
     ID *id_cow = id_node->id_cow;
     if (!deg_copy_on_write_is_expanded(id_cow)) {
       continue;
@@ -367,12 +390,12 @@ void deg_graph_flush_updates(Main *bmain, Depsgraph *graph)
     queue.pop_front();
     while (op_node != nullptr) {
       /* Tag operation as required for update. */
-      op_node->flag |= DEPSOP_FLAG_NEEDS_UPDATE;
+      flush_tag_operation(graph, op_node);
       /* Inform corresponding ID and component nodes about the change. */
       ComponentNode *comp_node = op_node->owner;
       IDNode *id_node = comp_node->owner;
-      flush_handle_id_node(id_node);
-      flush_handle_component_node(id_node, comp_node, &queue);
+      flush_handle_id_node(graph, id_node);
+      flush_handle_component_node(graph, id_node, comp_node, &queue);
       /* Flush to nodes along links. */
       op_node = flush_schedule_children(op_node, &queue);
     }
@@ -387,11 +410,17 @@ void deg_graph_flush_updates(Main *bmain, Depsgraph *graph)
 /* Clear tags from all operation nodes. */
 void deg_graph_clear_tags(Depsgraph *graph)
 {
-  /* Go over all operation nodes, clearing tags. */
-  for (OperationNode *node : graph->operations) {
+  /* Only the updated operations can be tagged, clearing them leaves all the nodes clear. */
+  for (OperationNode *node : graph->updated_operations) {
     node->flag &= ~(DEPSOP_FLAG_DIRECTLY_MODIFIED | DEPSOP_FLAG_NEEDS_UPDATE |
                     DEPSOP_FLAG_USER_MODIFIED);
+    node->scheduled = false;
+  }
+  for (IDNode *id_node : graph->updated_id_nodes) {
+    flush_reset_id_node(id_node);
   }
+  graph->updated_operations.clear();
+  graph->updated_id_nodes.clear();
   /* Clear any entry tags which haven't been flushed. */
   BLI_gset_clear(graph->entry_tags, nullptr);
 }
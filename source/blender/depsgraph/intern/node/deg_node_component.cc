@@ -203,8 +203,14 @@ OperationNode *ComponentNode::add_operation(const DepsEvalOperationCb &op,
     op_node = (OperationNode *)factory->create_node(this->owner->id_orig, "", name);
 
     /* register opnode in this component's operation set */
-    OperationIDKey *key = OBJECT_GUARDED_NEW(OperationIDKey, opcode, name, name_tag);
-    BLI_ghash_insert(operations_map, key, op_node);
+    if (operations_map != nullptr) {
+      OperationIDKey *key = OBJECT_GUARDED_NEW(OperationIDKey, opcode, name, name_tag);
+      BLI_ghash_insert(operations_map, key, op_node);
+    }
+    else {
+      /* Component was finalized by a previous build, happens in incremental builds. */
+      operations.push_back(op_node);
+    }
 
     /* set backlink */
     op_node->owner = this;
@@ -314,6 +320,10 @@ OperationNode *ComponentNode::get_exit_operation()
 
 void ComponentNode::finalize_build(Depsgraph * /*graph*/)
 {
+  if (operations_map == nullptr) {
+    /* Already finalized by a previous build. */
+    return;
+  }
   operations.reserve(BLI_ghash_len(operations_map));
   GHASH_FOREACH_BEGIN (OperationNode *, op_node, operations_map) {
     operations.push_back(op_node);
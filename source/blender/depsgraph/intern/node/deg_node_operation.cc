@@ -224,6 +224,7 @@ void OperationNode::tag_update(Depsgraph *graph, eUpdateSource source)
 {
   if ((flag & DEPSOP_FLAG_NEEDS_UPDATE) == 0) {
     graph->add_entry_tag(this);
+    graph->updated_operations.push_back(this);
   }
   /* Tag for update, but also note that this was the source of an update. */
   flag |= (DEPSOP_FLAG_NEEDS_UPDATE | DEPSOP_FLAG_DIRECTLY_MODIFIED);
@@ -440,6 +440,23 @@ struct ImBuf *IMB_onehalf(struct ImBuf *ibuf1);
  */
 bool IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy);
 
+typedef enum IMB_ResampleFilter {
+  /** Box when shrinking, triangle when enlarging, used by #IMB_scaleImBuf. */
+  IMB_RESAMPLE_AUTO = 0,
+  IMB_RESAMPLE_BOX = 1,
+  IMB_RESAMPLE_TRIANGLE = 2,
+  IMB_RESAMPLE_LANCZOS3 = 3,
+} IMB_ResampleFilter;
+
+/**
+ *
+ * \attention Defined in scaling.c
+ */
+bool IMB_resampleImBuf(struct ImBuf *ibuf,
+                       unsigned int newx,
+                       unsigned int newy,
+                       IMB_ResampleFilter filter);
+
 /**
  *
  * \attention Defined in scaling.c
@@ -505,6 +522,17 @@ void IMB_buffer_byte_from_float(unsigned char *rect_to,
                                 int height,
                                 int stride_to,
                                 int stride_from);
+void IMB_buffer_byte_from_float_threaded(unsigned char *rect_to,
+                                         const float *rect_from,
+                                         int channels_from,
+                                         float dither,
+                                         int profile_to,
+                                         int profile_from,
+                                         bool predivide,
+                                         int width,
+                                         int height,
+                                         int stride_to,
+                                         int stride_from);
 void IMB_buffer_byte_from_float_mask(unsigned char *rect_to,
                                      const float *rect_from,
                                      int channels_from,
@@ -524,6 +552,15 @@ void IMB_buffer_float_from_byte(float *rect_to,
                                 int height,
                                 int stride_to,
                                 int stride_from);
+void IMB_buffer_float_from_byte_threaded(float *rect_to,
+                                         const unsigned char *rect_from,
+                                         int profile_to,
+                                         int profile_from,
+                                         bool predivide,
+                                         int width,
+                                         int height,
+                                         int stride_to,
+                                         int stride_from);
 void IMB_buffer_float_from_float(float *rect_to,
                                  const float *rect_from,
                                  int channels_from,
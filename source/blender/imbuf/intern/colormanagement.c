@@ -2066,18 +2066,19 @@ void IMB_colormanagement_transform_from_byte_threaded(float *float_buffer,
   }
   if (STREQ(from_colorspace, to_colorspace)) {
     /* Because this function always takes a byte buffer and returns a float buffer, it must
-     * always do byte-to-float conversion of some kind. To avoid threading overhead
-     * IMB_buffer_float_from_byte is used when color spaces are identical. See T51002.
+     * always do byte-to-float conversion of some kind. To avoid the overhead of the color
+     * processor threads IMB_buffer_float_from_byte is used when color spaces are identical.
+     * See T51002.
      */
-    IMB_buffer_float_from_byte(float_buffer,
-                               byte_buffer,
-                               IB_PROFILE_SRGB,
-                               IB_PROFILE_SRGB,
-                               false,
-                               width,
-                               height,
-                               width,
-                               width);
+    IMB_buffer_float_from_byte_threaded(float_buffer,
+                                        byte_buffer,
+                                        IB_PROFILE_SRGB,
+                                        IB_PROFILE_SRGB,
+                                        false,
+                                        width,
+                                        height,
+                                        width,
+                                        width);
     IMB_premultiply_rect_float(float_buffer, 4, width, height);
     return;
   }
@@ -2631,17 +2632,17 @@ void IMB_colormanagement_buffer_make_display_space(
   processor_transform_apply_threaded(
       NULL, display_buffer_float, width, height, channels, cm_processor, true, false);
 
-  IMB_buffer_byte_from_float(display_buffer,
-                             display_buffer_float,
-                             channels,
-                             dither,
-                             IB_PROFILE_SRGB,
-                             IB_PROFILE_SRGB,
-                             true,
-                             width,
-                             height,
-                             width,
-                             width);
+  IMB_buffer_byte_from_float_threaded(display_buffer,
+                                      display_buffer_float,
+                                      channels,
+                                      dither,
+                                      IB_PROFILE_SRGB,
+                                      IB_PROFILE_SRGB,
+                                      true,
+                                      width,
+                                      height,
+                                      width,
+                                      width);
 
   MEM_freeN(display_buffer_float);
   IMB_colormanagement_processor_free(cm_processor);
@@ -2779,17 +2780,17 @@ void IMB_display_buffer_transform_apply(unsigned char *display_buffer,
 
   IMB_colormanagement_processor_free(cm_processor);
 
-  IMB_buffer_byte_from_float(display_buffer,
-                             buffer,
-                             channels,
-                             0.0f,
-                             IB_PROFILE_SRGB,
-                             IB_PROFILE_SRGB,
-                             false,
-                             width,
-                             height,
-                             width,
-                             width);
+  IMB_buffer_byte_from_float_threaded(display_buffer,
+                                      buffer,
+                                      channels,
+                                      0.0f,
+                                      IB_PROFILE_SRGB,
+                                      IB_PROFILE_SRGB,
+                                      false,
+                                      width,
+                                      height,
+                                      width,
+                                      width);
 
   MEM_freeN(buffer);
 }
@@ -35,6 +35,10 @@
 
 #include "MEM_guardedalloc.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 /************************* Floyd-Steinberg dithering *************************/
 
 typedef struct DitherContext {
@@ -96,30 +100,117 @@ MINLINE void float_to_byte_dither_v4(
   b[3] = unit_float_to_uchar_clamp(f[3]);
 }
 
+/* Row kernels for the most common conversions, without color space conversion and dithering.
+ * The results are the same as the per pixel functions used for the remaining pixels. */
+
+#ifdef __SSE2__
+MINLINE __m128 premul_to_straight_sse2(__m128 premul)
+{
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 rgb_mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+  const __m128 alpha = _mm_shuffle_ps(premul, premul, _MM_SHUFFLE(3, 3, 3, 3));
+  /* same as premul_to_straight_v4_v4, alpha of 0 and 1 are copied */
+  const __m128 mask = _mm_and_ps(_mm_and_ps(_mm_cmpneq_ps(alpha, zero), _mm_cmpneq_ps(alpha, one)),
+                                 rgb_mask);
+  const __m128 straight = _mm_mul_ps(premul, _mm_div_ps(one, alpha));
+  return _mm_or_ps(_mm_and_ps(mask, straight), _mm_andnot_ps(mask, premul));
+}
+
+MINLINE __m128i float_to_int_clamp_sse2(__m128 value)
+{
+  /* same rounding as unit_float_to_uchar_clamp */
+  value = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+  return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+}
+#endif /* __SSE2__ */
+
+static void float_to_byte_row_v4(uchar *to, const float *from, int width, bool predivide)
+{
+  int x = 0;
+
+#ifdef __SSE2__
+  for (; x + 4 <= width; x += 4, from += 16, to += 16) {
+    __m128 p0 = _mm_loadu_ps(from);
+    __m128 p1 = _mm_loadu_ps(from + 4);
+    __m128 p2 = _mm_loadu_ps(from + 8);
+    __m128 p3 = _mm_loadu_ps(from + 12);
+    if (predivide) {
+      p0 = premul_to_straight_sse2(p0);
+      p1 = premul_to_straight_sse2(p1);
+      p2 = premul_to_straight_sse2(p2);
+      p3 = premul_to_straight_sse2(p3);
+    }
+    const __m128i lo = _mm_packs_epi32(float_to_int_clamp_sse2(p0), float_to_int_clamp_sse2(p1));
+    const __m128i hi = _mm_packs_epi32(float_to_int_clamp_sse2(p2), float_to_int_clamp_sse2(p3));
+    _mm_storeu_si128((__m128i *)to, _mm_packus_epi16(lo, hi));
+  }
+#endif
+
+  if (predivide) {
+    float straight[4];
+    for (; x < width; x++, from += 4, to += 4) {
+      premul_to_straight_v4_v4(straight, from);
+      rgba_float_to_uchar(to, straight);
+    }
+  }
+  else {
+    for (; x < width; x++, from += 4, to += 4) {
+      rgba_float_to_uchar(to, from);
+    }
+  }
+}
+
+static void byte_to_float_row_v4(float *to, const uchar *from, int width)
+{
+  int x = 0;
+
+#ifdef __SSE2__
+  const __m128i zero = _mm_setzero_si128();
+  const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+  for (; x + 4 <= width; x += 4, from += 16, to += 16) {
+    const __m128i bytes = _mm_loadu_si128((const __m128i *)from);
+    const __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+    const __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+    _mm_storeu_ps(to, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+    _mm_storeu_ps(to + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+    _mm_storeu_ps(to + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+    _mm_storeu_ps(to + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+  }
+#endif
+
+  for (; x < width; x++, from += 4, to += 4) {
+    rgba_uchar_to_float(to, from);
+  }
+}
+
 /* Test if colorspace conversions of pixels in buffer need to take into account alpha. */
 bool IMB_alpha_affects_rgb(const ImBuf *ibuf)
 {
   return (ibuf->flags & IB_alphamode_channel_packed) == 0;
 }
 
-/* float to byte pixels, output 4-channel RGBA */
-void IMB_buffer_byte_from_float(uchar *rect_to,
-                                const float *rect_from,
-                                int channels_from,
-                                float dither,
-                                int profile_to,
-                                int profile_from,
-                                bool predivide,
-                                int width,
-                                int height,
-                                int stride_to,
-                                int stride_from)
+/* float to byte pixels, output 4-channel RGBA.
+ * Scanlines start at start_y in a buffer of total_height scanlines, for dithering. */
+static void imb_buffer_byte_from_float_ex(uchar *rect_to,
+                                          const float *rect_from,
+                                          int channels_from,
+                                          float dither,
+                                          int profile_to,
+                                          int profile_from,
+                                          bool predivide,
+                                          int width,
+                                          int height,
+                                          int stride_to,
+                                          int stride_from,
+                                          int start_y,
+                                          int total_height)
 {
   float tmp[4];
   int x, y;
   DitherContext *di = NULL;
   float inv_width = 1.0f / width;
-  float inv_height = 1.0f / height;
+  float inv_height = 1.0f / total_height;
 
   /* we need valid profiles */
   BLI_assert(profile_to != IB_PROFILE_NONE);
@@ -130,7 +221,7 @@ void IMB_buffer_byte_from_float(uchar *rect_to,
   }
 
   for (y = 0; y < height; y++) {
-    float t = y * inv_height;
+    float t = (start_y + y) * inv_height;
 
     if (channels_from == 1) {
       /* single channel input */
@@ -190,16 +281,8 @@ void IMB_buffer_byte_from_float(uchar *rect_to,
             float_to_byte_dither_v4(to, from, di, (float)x * inv_width, t);
           }
         }
-        else if (predivide) {
-          for (x = 0; x < width; x++, from += 4, to += 4) {
-            premul_to_straight_v4_v4(straight, from);
-            rgba_float_to_uchar(to, straight);
-          }
-        }
         else {
-          for (x = 0; x < width; x++, from += 4, to += 4) {
-            rgba_float_to_uchar(to, from);
-          }
+          float_to_byte_row_v4(to, from, width, predivide);
         }
       }
       else if (profile_to == IB_PROFILE_SRGB) {
@@ -269,6 +352,112 @@ void IMB_buffer_byte_from_float(uchar *rect_to,
   }
 }
 
+/* float to byte pixels, output 4-channel RGBA */
+void IMB_buffer_byte_from_float(uchar *rect_to,
+                                const float *rect_from,
+                                int channels_from,
+                                float dither,
+                                int profile_to,
+                                int profile_from,
+                                bool predivide,
+                                int width,
+                                int height,
+                                int stride_to,
+                                int stride_from)
+{
+  imb_buffer_byte_from_float_ex(rect_to,
+                                rect_from,
+                                channels_from,
+                                dither,
+                                profile_to,
+                                profile_from,
+                                predivide,
+                                width,
+                                height,
+                                stride_to,
+                                stride_from,
+                                0,
+                                height);
+}
+
+typedef struct FloatToByteThreadData {
+  uchar *rect_to;
+  const float *rect_from;
+  int channels_from;
+  float dither;
+  int profile_to;
+  int profile_from;
+  bool predivide;
+  int width;
+  int height;
+  int stride_to;
+  int stride_from;
+} FloatToByteThreadData;
+
+static void imb_buffer_byte_from_float_thread_do(void *data_v,
+                                                 int start_scanline,
+                                                 int num_scanlines)
+{
+  FloatToByteThreadData *data = (FloatToByteThreadData *)data_v;
+  size_t offset_from = ((size_t)start_scanline) * data->stride_from * data->channels_from;
+  size_t offset_to = ((size_t)start_scanline) * data->stride_to * 4;
+  imb_buffer_byte_from_float_ex(data->rect_to + offset_to,
+                                data->rect_from + offset_from,
+                                data->channels_from,
+                                data->dither,
+                                data->profile_to,
+                                data->profile_from,
+                                data->predivide,
+                                data->width,
+                                num_scanlines,
+                                data->stride_to,
+                                data->stride_from,
+                                start_scanline,
+                                data->height);
+}
+
+void IMB_buffer_byte_from_float_threaded(uchar *rect_to,
+                                         const float *rect_from,
+                                         int channels_from,
+                                         float dither,
+                                         int profile_to,
+                                         int profile_from,
+                                         bool predivide,
+                                         int width,
+                                         int height,
+                                         int stride_to,
+                                         int stride_from)
+{
+  if (((size_t)width) * height < 64 * 64) {
+    IMB_buffer_byte_from_float(rect_to,
+                               rect_from,
+                               channels_from,
+                               dither,
+                               profile_to,
+                               profile_from,
+                               predivide,
+                               width,
+                               height,
+                               stride_to,
+                               stride_from);
+  }
+  else {
+    FloatToByteThreadData data;
+    data.rect_to = rect_to;
+    data.rect_from = rect_from;
+    data.channels_from = channels_from;
+    data.dither = dither;
+    data.profile_to = profile_to;
+    data.profile_from = profile_from;
+    data.predivide = predivide;
+    data.width = width;
+    data.height = height;
+    data.stride_to = stride_to;
+    data.stride_from = stride_from;
+    IMB_processor_apply_threaded_scanlines(height, imb_buffer_byte_from_float_thread_do, &data);
+  }
+}
+
 /* float to byte pixels, output 4-channel RGBA */
 void IMB_buffer_byte_from_float_mask(uchar *rect_to,
                                      const float *rect_from,
@@ -385,9 +574,7 @@ void IMB_buffer_float_from_byte(float *rect_to,
 
     if (profile_to == profile_from) {
       /* no color space conversion */
-      for (x = 0; x < width; x++, from += 4, to += 4) {
-        rgba_uchar_to_float(to, from);
-      }
+      byte_to_float_row_v4(to, from, width);
     }
     else if (profile_to == IB_PROFILE_LINEAR_RGB) {
       /* convert sRGB to linear */
@@ -420,6 +607,70 @@ void IMB_buffer_float_from_byte(float *rect_to,
   }
 }
 
+typedef struct ByteToFloatThreadData {
+  float *rect_to;
+  const uchar *rect_from;
+  int profile_to;
+  int profile_from;
+  bool predivide;
+  int width;
+  int stride_to;
+  int stride_from;
+} ByteToFloatThreadData;
+
+static void imb_buffer_float_from_byte_thread_do(void *data_v,
+                                                 int start_scanline,
+                                                 int num_scanlines)
+{
+  ByteToFloatThreadData *data = (ByteToFloatThreadData *)data_v;
+  size_t offset_from = ((size_t)start_scanline) * data->stride_from * 4;
+  size_t offset_to = ((size_t)start_scanline) * data->stride_to * 4;
+  IMB_buffer_float_from_byte(data->rect_to + offset_to,
+                             data->rect_from + offset_from,
+                             data->profile_to,
+                             data->profile_from,
+                             data->predivide,
+                             data->width,
+                             num_scanlines,
+                             data->stride_to,
+                             data->stride_from);
+}
+
+void IMB_buffer_float_from_byte_threaded(float *rect_to,
+                                         const uchar *rect_from,
+                                         int profile_to,
+                                         int profile_from,
+                                         bool predivide,
+                                         int width,
+                                         int height,
+                                         int stride_to,
+                                         int stride_from)
+{
+  if (((size_t)width) * height < 64 * 64) {
+    IMB_buffer_float_from_byte(rect_to,
+                               rect_from,
+                               profile_to,
+                               profile_from,
+                               predivide,
+                               width,
+                               height,
+                               stride_to,
+                               stride_from);
+  }
+  else {
+    ByteToFloatThreadData data;
+    data.rect_to = rect_to;
+    data.rect_from = rect_from;
+    data.profile_to = profile_to;
+    data.profile_from = profile_from;
+    data.predivide = predivide;
+    data.width = width;
+    data.stride_to = stride_to;
+    data.stride_from = stride_from;
+    IMB_processor_apply_threaded_scanlines(height, imb_buffer_float_from_byte_thread_do, &data);
+  }
+}
+
 /* float to float pixels, output 4-channel RGBA */
 void IMB_buffer_float_from_float(float *rect_to,
                                  const float *rect_from,
@@ -743,23 +994,18 @@ void IMB_rect_from_float(ImBuf *ibuf)
                                 ibuf->rect_colorspace->name,
                                 predivide);
 
-  /* convert from float's premul alpha to byte's straight alpha */
-  if (IMB_alpha_affects_rgb(ibuf)) {
-    IMB_unpremultiply_rect_float(buffer, ibuf->channels, ibuf->x, ibuf->y);
-  }
-
-  /* convert float to byte */
-  IMB_buffer_byte_from_float((unsigned char *)ibuf->rect,
-                             buffer,
-                             ibuf->channels,
-                             ibuf->dither,
-                             IB_PROFILE_SRGB,
-                             IB_PROFILE_SRGB,
-                             false,
-                             ibuf->x,
-                             ibuf->y,
-                             ibuf->x,
-                             ibuf->x);
+  /* convert float to byte, and from float's premul alpha to byte's straight alpha */
+  IMB_buffer_byte_from_float_threaded((unsigned char *)ibuf->rect,
+                                      buffer,
+                                      ibuf->channels,
+                                      ibuf->dither,
+                                      IB_PROFILE_SRGB,
+                                      IB_PROFILE_SRGB,
+                                      predivide,
+                                      ibuf->x,
+                                      ibuf->y,
+                                      ibuf->x,
+                                      ibuf->x);
 
   MEM_freeN(buffer);
 
@@ -796,15 +1042,15 @@ void IMB_float_from_rect(ImBuf *ibuf)
   }
 
   /* first, create float buffer in non-linear space */
-  IMB_buffer_float_from_byte(rect_float,
-                             (unsigned char *)ibuf->rect,
-                             IB_PROFILE_SRGB,
-                             IB_PROFILE_SRGB,
-                             false,
-                             ibuf->x,
-                             ibuf->y,
-                             ibuf->x,
-                             ibuf->x);
+  IMB_buffer_float_from_byte_threaded(rect_float,
+                                      (unsigned char *)ibuf->rect,
+                                      IB_PROFILE_SRGB,
+                                      IB_PROFILE_SRGB,
+                                      false,
+                                      ibuf->x,
+                                      ibuf->y,
+                                      ibuf->x,
+                                      ibuf->x);
 
   /* then make float be in linear space */
   IMB_colormanagement_colorspace_to_scene_linear(
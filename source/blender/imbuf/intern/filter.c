@@ -33,6 +33,10 @@
 
 #include "imbuf.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 static void filtrow(unsigned char *point, int x)
 {
   unsigned int c1, c2, c3, error;
@@ -667,19 +671,29 @@ void IMB_premultiply_rect(unsigned int *rect, char planes, int w, int h)
 
 void IMB_premultiply_rect_float(float *rect_float, int channels, int w, int h)
 {
-  float val, *cp;
-  int x, y;
+  float *cp;
+  size_t i, num_pixels = ((size_t)w) * h;
 
   if (channels == 4) {
     cp = rect_float;
-    for (y = 0; y < h; y++) {
-      for (x = 0; x < w; x++, cp += 4) {
-        val = cp[3];
-        cp[0] = cp[0] * val;
-        cp[1] = cp[1] * val;
-        cp[2] = cp[2] * val;
-      }
+#ifdef __SSE2__
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 rgb_mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    for (i = 0; i < num_pixels; i++, cp += 4) {
+      const __m128 color = _mm_loadu_ps(cp);
+      const __m128 alpha = _mm_shuffle_ps(color, color, _MM_SHUFFLE(3, 3, 3, 3));
+      /* multiply the alpha by one */
+      const __m128 mul = _mm_or_ps(_mm_and_ps(rgb_mask, alpha), _mm_andnot_ps(rgb_mask, one));
+      _mm_storeu_ps(cp, _mm_mul_ps(color, mul));
+    }
+#else
+    for (i = 0; i < num_pixels; i++, cp += 4) {
+      const float val = cp[3];
+      cp[0] = cp[0] * val;
+      cp[1] = cp[1] * val;
+      cp[2] = cp[2] * val;
     }
+#endif
   }
 }
 
@@ -729,19 +743,32 @@ void IMB_unpremultiply_rect(unsigned int *rect, char planes, int w, int h)
 
 void IMB_unpremultiply_rect_float(float *rect_float, int channels, int w, int h)
 {
-  float val, *fp;
-  int x, y;
+  float *fp;
+  size_t i, num_pixels = ((size_t)w) * h;
 
   if (channels == 4) {
     fp = rect_float;
-    for (y = 0; y < h; y++) {
-      for (x = 0; x < w; x++, fp += 4) {
-        val = fp[3] != 0.0f ? 1.0f / fp[3] : 1.0f;
-        fp[0] = fp[0] * val;
-        fp[1] = fp[1] * val;
-        fp[2] = fp[2] * val;
-      }
+#ifdef __SSE2__
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 rgb_mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    for (i = 0; i < num_pixels; i++, fp += 4) {
+      const __m128 color = _mm_loadu_ps(fp);
+      const __m128 alpha = _mm_shuffle_ps(color, color, _MM_SHUFFLE(3, 3, 3, 3));
+      /* divide by one for the alpha and zero alpha pixels */
+      const __m128 mask = _mm_and_ps(rgb_mask, _mm_cmpneq_ps(alpha, zero));
+      const __m128 mul = _mm_or_ps(_mm_and_ps(mask, _mm_div_ps(one, alpha)),
+                                   _mm_andnot_ps(mask, one));
+      _mm_storeu_ps(fp, _mm_mul_ps(color, mul));
+    }
+#else
+    for (i = 0; i < num_pixels; i++, fp += 4) {
+      const float val = fp[3] != 0.0f ? 1.0f / fp[3] : 1.0f;
+      fp[0] = fp[0] * val;
+      fp[1] = fp[1] * val;
+      fp[2] = fp[2] * val;
     }
+#endif
   }
 }
 
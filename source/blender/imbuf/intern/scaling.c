@@ -23,6 +23,7 @@
  */
 
 #include "BLI_utildefines.h"
+#include "BLI_math_base.h"
 #include "BLI_math_color.h"
 #include "BLI_math_interp.h"
 #include "MEM_guardedalloc.h"
@@ -35,6 +36,10 @@
 
 #include "BLI_sys_types.h"  // for intptr_t support
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 static void imb_half_x_no_alloc(struct ImBuf *ibuf2, struct ImBuf *ibuf1)
 {
   uchar *p1, *_p1, *dest;
@@ -371,33 +376,25 @@ MINLINE void premul_ushort_to_straight_uchar(unsigned char *result, const unsign
 }
 
 /* result in ibuf2, scaling should be done correctly */
-void imb_onehalf_no_alloc(struct ImBuf *ibuf2, struct ImBuf *ibuf1)
+typedef struct OneHalfThreadData {
+  struct ImBuf *ibuf2;
+  struct ImBuf *ibuf1;
+  bool do_rect;
+  bool do_float;
+} OneHalfThreadData;
+
+/* Halve scanlines [start_y, start_y + num_y) of ibuf2, both dimensions of ibuf1 are at least 2. */
+static void imb_onehalf_scanlines(
+    struct ImBuf *ibuf2, struct ImBuf *ibuf1, bool do_rect, bool do_float, int start_y, int num_y)
 {
   int x, y;
-  const short do_rect = (ibuf1->rect != NULL);
-  const short do_float = (ibuf1->rect_float != NULL) && (ibuf2->rect_float != NULL);
-
-  if (do_rect && (ibuf2->rect == NULL)) {
-    imb_addrectImBuf(ibuf2);
-  }
-
-  if (ibuf1->x <= 1) {
-    imb_half_y_no_alloc(ibuf2, ibuf1);
-    return;
-  }
-  if (ibuf1->y <= 1) {
-    imb_half_x_no_alloc(ibuf2, ibuf1);
-    return;
-  }
 
   if (do_rect) {
-    unsigned char *cp1, *cp2, *dest;
-
-    cp1 = (unsigned char *)ibuf1->rect;
-    dest = (unsigned char *)ibuf2->rect;
+    for (y = start_y; y < start_y + num_y; y++) {
+      const unsigned char *cp1 = (unsigned char *)ibuf1->rect + ((size_t)ibuf1->x) * y * 2 * 4;
+      const unsigned char *cp2 = cp1 + (ibuf1->x << 2);
+      unsigned char *dest = (unsigned char *)ibuf2->rect + ((size_t)ibuf2->x) * y * 4;
 
-    for (y = ibuf2->y; y > 0; y--) {
-      cp2 = cp1 + (ibuf1->x << 2);
       for (x = ibuf2->x; x > 0; x--) {
         unsigned short p1i[8], p2i[8], desti[4];
 
@@ -417,37 +414,74 @@ void imb_onehalf_no_alloc(struct ImBuf *ibuf2, struct ImBuf *ibuf1)
         cp2 += 8;
         dest += 4;
       }
-      cp1 = cp2;
-      if (ibuf1->x & 1) {
-        cp1 += 4;
-      }
     }
   }
 
   if (do_float) {
-    float *p1f, *p2f, *destf;
+    for (y = start_y; y < start_y + num_y; y++) {
+      const float *p1f = ibuf1->rect_float + ((size_t)ibuf1->x) * y * 2 * 4;
+      const float *p2f = p1f + (ibuf1->x << 2);
+      float *destf = ibuf2->rect_float + ((size_t)ibuf2->x) * y * 4;
 
-    p1f = ibuf1->rect_float;
-    destf = ibuf2->rect_float;
-    for (y = ibuf2->y; y > 0; y--) {
-      p2f = p1f + (ibuf1->x << 2);
       for (x = ibuf2->x; x > 0; x--) {
+#ifdef __SSE2__
+        /* same order of additions as the scalar version */
+        __m128 sum = _mm_add_ps(_mm_loadu_ps(p1f), _mm_loadu_ps(p2f));
+        sum = _mm_add_ps(sum, _mm_loadu_ps(p1f + 4));
+        sum = _mm_add_ps(sum, _mm_loadu_ps(p2f + 4));
+        _mm_storeu_ps(destf, _mm_mul_ps(sum, _mm_set1_ps(0.25f)));
+#else
         destf[0] = 0.25f * (p1f[0] + p2f[0] + p1f[4] + p2f[4]);
         destf[1] = 0.25f * (p1f[1] + p2f[1] + p1f[5] + p2f[5]);
         destf[2] = 0.25f * (p1f[2] + p2f[2] + p1f[6] + p2f[6]);
         destf[3] = 0.25f * (p1f[3] + p2f[3] + p1f[7] + p2f[7]);
+#endif
         p1f += 8;
         p2f += 8;
         destf += 4;
       }
-      p1f = p2f;
-      if (ibuf1->x & 1) {
-        p1f += 4;
-      }
     }
   }
 }
 
+static void imb_onehalf_thread_do(void *data_v, int start_scanline, int num_scanlines)
+{
+  OneHalfThreadData *data = (OneHalfThreadData *)data_v;
+  imb_onehalf_scanlines(
+      data->ibuf2, data->ibuf1, data->do_rect, data->do_float, start_scanline, num_scanlines);
+}
+
+void imb_onehalf_no_alloc(struct ImBuf *ibuf2, struct ImBuf *ibuf1)
+{
+  const bool do_rect = (ibuf1->rect != NULL);
+  const bool do_float = (ibuf1->rect_float != NULL) && (ibuf2->rect_float != NULL);
+
+  if (do_rect && (ibuf2->rect == NULL)) {
+    imb_addrectImBuf(ibuf2);
+  }
+
+  if (ibuf1->x <= 1) {
+    imb_half_y_no_alloc(ibuf2, ibuf1);
+    return;
+  }
+  if (ibuf1->y <= 1) {
+    imb_half_x_no_alloc(ibuf2, ibuf1);
+    return;
+  }
+
+  if (((size_t)ibuf2->x) * ibuf2->y < 64 * 64) {
+    imb_onehalf_scanlines(ibuf2, ibuf1, do_rect, do_float, 0, ibuf2->y);
+  }
+  else {
+    OneHalfThreadData data;
+    data.ibuf2 = ibuf2;
+    data.ibuf1 = ibuf1;
+    data.do_rect = do_rect;
+    data.do_float = do_float;
+    IMB_processor_apply_threaded_scanlines(ibuf2->y, imb_onehalf_thread_do, &data);
+  }
+}
+
 ImBuf *IMB_onehalf(struct ImBuf *ibuf1)
 {
   struct ImBuf *ibuf2;
@@ -906,718 +940,369 @@ static bool q_scale_linear_interpolation(struct ImBuf *ibuf, int newx, int newy)
   return true;
 }
 
-static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
+static void scalefast_Z_ImBuf(ImBuf *ibuf, int newx, int newy)
 {
-  const int do_rect = (ibuf->rect != NULL);
-  const int do_float = (ibuf->rect_float != NULL);
-  const size_t rect_size = ibuf->x * ibuf->y * 4;
-
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
+  int *zbuf, *newzbuf, *_newzbuf = NULL;
+  float *zbuf_float, *newzbuf_float, *_newzbuf_float = NULL;
   int x, y;
+  int ofsx, ofsy, stepx, stepy;
 
-  rectf = _newrectf = newrectf = NULL;
-  rect = _newrect = newrect = NULL;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
-
-  if (!do_rect && !do_float) {
-    return (ibuf);
-  }
-
-  if (do_rect) {
-    _newrect = MEM_mallocN(newx * ibuf->y * sizeof(uchar) * 4, "scaledownx");
-    if (_newrect == NULL) {
-      return (ibuf);
+  if (ibuf->zbuf) {
+    _newzbuf = MEM_mallocN(newx * newy * sizeof(int), __func__);
+    if (_newzbuf == NULL) {
+      IMB_freezbufImBuf(ibuf);
     }
   }
-  if (do_float) {
-    _newrectf = MEM_mallocN(newx * ibuf->y * sizeof(float) * 4, "scaledownxf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return (ibuf);
+
+  if (ibuf->zbuf_float) {
+    _newzbuf_float = MEM_mallocN((size_t)newx * newy * sizeof(float), __func__);
+    if (_newzbuf_float == NULL) {
+      IMB_freezbuffloatImBuf(ibuf);
     }
   }
 
-  add = (ibuf->x - 0.01) / newx;
-
-  if (do_rect) {
-    rect = (uchar *)ibuf->rect;
-    newrect = _newrect;
-  }
-  if (do_float) {
-    rectf = ibuf->rect_float;
-    newrectf = _newrectf;
+  if (!_newzbuf && !_newzbuf_float) {
+    return;
   }
 
-  for (y = ibuf->y; y > 0; y--) {
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-    for (x = newx; x > 0; x--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
-      }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
-      }
+  stepx = (65536.0 * (ibuf->x - 1.0) / (newx - 1.0)) + 0.5;
+  stepy = (65536.0 * (ibuf->y - 1.0) / (newy - 1.0)) + 0.5;
+  ofsy = 32768;
 
-      sample += add;
-
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += 4;
-        }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += 4;
-        }
-      }
+  newzbuf = _newzbuf;
+  newzbuf_float = _newzbuf_float;
 
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += 4;
-
-        newrect[0] = ((nval[0] + sample * val[0]) / add + 0.5f);
-        newrect[1] = ((nval[1] + sample * val[1]) / add + 0.5f);
-        newrect[2] = ((nval[2] + sample * val[2]) / add + 0.5f);
-        newrect[3] = ((nval[3] + sample * val[3]) / add + 0.5f);
-
-        newrect += 4;
+  for (y = newy; y > 0; y--, ofsy += stepy) {
+    if (newzbuf) {
+      zbuf = ibuf->zbuf;
+      zbuf += (ofsy >> 16) * ibuf->x;
+      ofsx = 32768;
+      for (x = newx; x > 0; x--, ofsx += stepx) {
+        *newzbuf++ = zbuf[ofsx >> 16];
       }
-      if (do_float) {
-
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += 4;
-
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
+    }
 
-        newrectf += 4;
+    if (newzbuf_float) {
+      zbuf_float = ibuf->zbuf_float;
+      zbuf_float += (ofsy >> 16) * ibuf->x;
+      ofsx = 32768;
+      for (x = newx; x > 0; x--, ofsx += stepx) {
+        *newzbuf_float++ = zbuf_float[ofsx >> 16];
       }
-
-      sample -= 1.0f;
     }
   }
 
-  if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-    BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug [#26502] */
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
-  }
-  if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-    BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug [#26502] */
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = _newrectf;
+  if (_newzbuf) {
+    IMB_freezbufImBuf(ibuf);
+    ibuf->mall |= IB_zbuf;
+    ibuf->zbuf = _newzbuf;
   }
-  (void)rect_size; /* UNUSED in release builds */
 
-  ibuf->x = newx;
-  return (ibuf);
+  if (_newzbuf_float) {
+    IMB_freezbuffloatImBuf(ibuf);
+    ibuf->mall |= IB_zbuffloat;
+    ibuf->zbuf_float = _newzbuf_float;
+  }
 }
 
-static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
-{
-  const int do_rect = (ibuf->rect != NULL);
-  const int do_float = (ibuf->rect_float != NULL);
-  const size_t rect_size = ibuf->x * ibuf->y * 4;
-
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
-  int x, y, skipx;
-
-  rectf = _newrectf = newrectf = NULL;
-  rect = _newrect = newrect = NULL;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
+/* ******** filtered resampling ******** */
 
-  if (!do_rect && !do_float) {
-    return (ibuf);
-  }
+/* Contributions of the source pixels to the destination pixels, along one axis. */
+typedef struct ResampleWeights {
+  /* First source pixel and number of source pixels of each destination pixel. */
+  int *first;
+  int *count;
+  /* max_count weights per destination pixel, normalized. */
+  float *weights;
+  int max_count;
+} ResampleWeights;
 
-  if (do_rect) {
-    _newrect = MEM_mallocN(newy * ibuf->x * sizeof(uchar) * 4, "scaledowny");
-    if (_newrect == NULL) {
-      return (ibuf);
-    }
-  }
-  if (do_float) {
-    _newrectf = MEM_mallocN(newy * ibuf->x * sizeof(float) * 4, "scaledownyf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return (ibuf);
-    }
+static float resample_filter_radius(IMB_ResampleFilter filter)
+{
+  switch (filter) {
+    case IMB_RESAMPLE_LANCZOS3:
+      return 3.0f;
+    case IMB_RESAMPLE_TRIANGLE:
+      return 1.0f;
+    default:
+      return 0.5f;
   }
+}
 
-  add = (ibuf->y - 0.01) / newy;
-  skipx = 4 * ibuf->x;
-
-  for (x = skipx - 4; x >= 0; x -= 4) {
-    if (do_rect) {
-      rect = ((uchar *)ibuf->rect) + x;
-      newrect = _newrect + x;
-    }
-    if (do_float) {
-      rectf = ibuf->rect_float + x;
-      newrectf = _newrectf + x;
-    }
-
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-    for (y = newy; y > 0; y--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
-      }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
-      }
-
-      sample += add;
-
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += skipx;
-        }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += skipx;
-        }
-      }
-
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += skipx;
-
-        newrect[0] = ((nval[0] + sample * val[0]) / add + 0.5f);
-        newrect[1] = ((nval[1] + sample * val[1]) / add + 0.5f);
-        newrect[2] = ((nval[2] + sample * val[2]) / add + 0.5f);
-        newrect[3] = ((nval[3] + sample * val[3]) / add + 0.5f);
-
-        newrect += skipx;
+static float resample_filter_eval(IMB_ResampleFilter filter, float x)
+{
+  x = fabsf(x);
+  switch (filter) {
+    case IMB_RESAMPLE_LANCZOS3:
+      if (x < 1e-6f) {
+        return 1.0f;
       }
-      if (do_float) {
-
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += skipx;
-
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
-
-        newrectf += skipx;
+      if (x >= 3.0f) {
+        return 0.0f;
       }
-
-      sample -= 1.0f;
-    }
-  }
-
-  if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-    BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug [#26502] */
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
-  }
-  if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-    BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug [#26502] */
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
+      x *= (float)M_PI;
+      return 3.0f * sinf(x) * sinf(x / 3.0f) / (x * x);
+    case IMB_RESAMPLE_TRIANGLE:
+      return max_ff(1.0f - x, 0.0f);
+    default:
+      return (x <= 0.5f) ? 1.0f : 0.0f;
   }
-  (void)rect_size; /* UNUSED in release builds */
-
-  ibuf->y = newy;
-  return (ibuf);
 }
 
-static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
+static void resample_weights_init(ResampleWeights *rw,
+                                  int src_size,
+                                  int dst_size,
+                                  IMB_ResampleFilter filter)
 {
-  uchar *rect, *_newrect = NULL, *newrect;
-  float *rectf, *_newrectf = NULL, *newrectf;
-  float sample, add;
-  float val_a, nval_a, diff_a;
-  float val_b, nval_b, diff_b;
-  float val_g, nval_g, diff_g;
-  float val_r, nval_r, diff_r;
-  float val_af, nval_af, diff_af;
-  float val_bf, nval_bf, diff_bf;
-  float val_gf, nval_gf, diff_gf;
-  float val_rf, nval_rf, diff_rf;
-  int x, y;
-  bool do_rect = false, do_float = false;
-
-  val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-  val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-  val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-  val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-  if (ibuf == NULL) {
-    return (NULL);
-  }
-  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
-    return (ibuf);
-  }
+  const float scale = (float)src_size / dst_size;
+  /* The filter is stretched when shrinking, so all source pixels contribute. */
+  const float filter_scale = max_ff(scale, 1.0f);
 
-  if (ibuf->rect) {
-    do_rect = true;
-    _newrect = MEM_mallocN(newx * ibuf->y * sizeof(int), "scaleupx");
-    if (_newrect == NULL) {
-      return (ibuf);
-    }
+  if (filter == IMB_RESAMPLE_AUTO) {
+    filter = (dst_size < src_size) ? IMB_RESAMPLE_BOX : IMB_RESAMPLE_TRIANGLE;
   }
-  if (ibuf->rect_float) {
-    do_float = true;
-    _newrectf = MEM_mallocN(newx * ibuf->y * sizeof(float) * 4, "scaleupxf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return (ibuf);
-    }
-  }
-
-  add = (ibuf->x - 1.001) / (newx - 1.0);
 
-  rect = (uchar *)ibuf->rect;
-  rectf = (float *)ibuf->rect_float;
-  newrect = _newrect;
-  newrectf = _newrectf;
+  const float support = resample_filter_radius(filter) * filter_scale;
 
-  for (y = ibuf->y; y > 0; y--) {
+  rw->max_count = (src_size == dst_size) ? 1 : (int)ceilf(support * 2.0f) + 2;
+  rw->first = MEM_mallocN(sizeof(int) * dst_size, "resample weights first");
+  rw->count = MEM_mallocN(sizeof(int) * dst_size, "resample weights count");
+  rw->weights = MEM_mallocN(sizeof(float) * dst_size * rw->max_count, "resample weights");
 
-    sample = 0;
+  for (int i = 0; i < dst_size; i++) {
+    float *weights = rw->weights + ((size_t)i) * rw->max_count;
 
-    if (do_rect) {
-      val_a = rect[0];
-      nval_a = rect[4];
-      diff_a = nval_a - val_a;
-      val_a += 0.5f;
-
-      val_b = rect[1];
-      nval_b = rect[5];
-      diff_b = nval_b - val_b;
-      val_b += 0.5f;
-
-      val_g = rect[2];
-      nval_g = rect[6];
-      diff_g = nval_g - val_g;
-      val_g += 0.5f;
-
-      val_r = rect[3];
-      nval_r = rect[7];
-      diff_r = nval_r - val_r;
-      val_r += 0.5f;
-
-      rect += 8;
+    if (src_size == dst_size) {
+      rw->first[i] = i;
+      rw->count[i] = 1;
+      weights[0] = 1.0f;
+      continue;
     }
-    if (do_float) {
-      val_af = rectf[0];
-      nval_af = rectf[4];
-      diff_af = nval_af - val_af;
-
-      val_bf = rectf[1];
-      nval_bf = rectf[5];
-      diff_bf = nval_bf - val_bf;
 
-      val_gf = rectf[2];
-      nval_gf = rectf[6];
-      diff_gf = nval_gf - val_gf;
-
-      val_rf = rectf[3];
-      nval_rf = rectf[7];
-      diff_rf = nval_rf - val_rf;
-
-      rectf += 8;
-    }
-    for (x = newx; x > 0; x--) {
-      if (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          val_a = nval_a;
-          nval_a = rect[0];
-          diff_a = nval_a - val_a;
-          val_a += 0.5f;
-
-          val_b = nval_b;
-          nval_b = rect[1];
-          diff_b = nval_b - val_b;
-          val_b += 0.5f;
-
-          val_g = nval_g;
-          nval_g = rect[2];
-          diff_g = nval_g - val_g;
-          val_g += 0.5f;
-
-          val_r = nval_r;
-          nval_r = rect[3];
-          diff_r = nval_r - val_r;
-          val_r += 0.5f;
-          rect += 4;
-        }
-        if (do_float) {
-          val_af = nval_af;
-          nval_af = rectf[0];
-          diff_af = nval_af - val_af;
-
-          val_bf = nval_bf;
-          nval_bf = rectf[1];
-          diff_bf = nval_bf - val_bf;
-
-          val_gf = nval_gf;
-          nval_gf = rectf[2];
-          diff_gf = nval_gf - val_gf;
-
-          val_rf = nval_rf;
-          nval_rf = rectf[3];
-          diff_rf = nval_rf - val_rf;
-          rectf += 4;
-        }
+    /* Source pixel j covers [j, j + 1]. */
+    const float center = (i + 0.5f) * scale;
+    const int start = max_ii((int)floorf(center - support), 0);
+    const int end = min_ii((int)ceilf(center + support), src_size);
+    float total = 0.0f;
+
+    for (int j = start; j < end; j++) {
+      float weight;
+      if (filter == IMB_RESAMPLE_BOX) {
+        /* Coverage of the source pixel, averages the area of the destination pixel. */
+        weight = max_ff(min_ff(j + 1.0f, center + support) - max_ff((float)j, center - support),
+                        0.0f);
       }
-      if (do_rect) {
-        newrect[0] = val_a + sample * diff_a;
-        newrect[1] = val_b + sample * diff_b;
-        newrect[2] = val_g + sample * diff_g;
-        newrect[3] = val_r + sample * diff_r;
-        newrect += 4;
+      else {
+        weight = resample_filter_eval(filter, (j + 0.5f - center) / filter_scale);
       }
-      if (do_float) {
-        newrectf[0] = val_af + sample * diff_af;
-        newrectf[1] = val_bf + sample * diff_bf;
-        newrectf[2] = val_gf + sample * diff_gf;
-        newrectf[3] = val_rf + sample * diff_rf;
-        newrectf += 4;
-      }
-      sample += add;
+      weights[j - start] = weight;
+      total += weight;
     }
-  }
 
-  if (do_rect) {
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
-  }
-  if (do_float) {
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
+    rw->first[i] = start;
+    rw->count[i] = end - start;
+    if (total != 0.0f) {
+      /* Pixels outside of the image are ignored instead of darkening the borders. */
+      for (int j = 0; j < end - start; j++) {
+        weights[j] /= total;
+      }
+    }
+    else {
+      rw->first[i] = min_ii((int)center, src_size - 1);
+      rw->count[i] = 1;
+      weights[0] = 1.0f;
+    }
   }
-
-  ibuf->x = newx;
-  return (ibuf);
 }
 
-static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
+static void resample_weights_free(ResampleWeights *rw)
 {
-  uchar *rect, *_newrect = NULL, *newrect;
-  float *rectf, *_newrectf = NULL, *newrectf;
-  float sample, add;
-  float val_a, nval_a, diff_a;
-  float val_b, nval_b, diff_b;
-  float val_g, nval_g, diff_g;
-  float val_r, nval_r, diff_r;
-  float val_af, nval_af, diff_af;
-  float val_bf, nval_bf, diff_bf;
-  float val_gf, nval_gf, diff_gf;
-  float val_rf, nval_rf, diff_rf;
-  int x, y, skipx;
-  bool do_rect = false, do_float = false;
-
-  val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-  val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-  val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-  val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-  if (ibuf == NULL) {
-    return (NULL);
-  }
-  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
-    return (ibuf);
-  }
+  MEM_freeN(rw->first);
+  MEM_freeN(rw->count);
+  MEM_freeN(rw->weights);
+}
 
-  if (ibuf->rect) {
-    do_rect = true;
-    _newrect = MEM_mallocN(ibuf->x * newy * sizeof(int), "scaleupy");
-    if (_newrect == NULL) {
-      return (ibuf);
-    }
-  }
-  if (ibuf->rect_float) {
-    do_float = true;
-    _newrectf = MEM_mallocN(ibuf->x * newy * sizeof(float) * 4, "scaleupyf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
+typedef struct ResampleData {
+  const ResampleWeights *weights_x;
+  const ResampleWeights *weights_y;
+  int channels;
+  int src_width;
+  int dst_width;
+  /* Source, byte or float. */
+  const unsigned char *src_byte;
+  const float *src_float;
+  /* Result of the horizontal pass, dst_width * src_height. */
+  float *tmp;
+  /* Destination, byte or float. */
+  unsigned char *dst_byte;
+  float *dst_float;
+} ResampleData;
+
+/* Horizontal pass of a row. */
+static void resample_row_x(const ResampleWeights *rw,
+                           float *dst,
+                           const float *src,
+                           int dst_width,
+                           int channels)
+{
+  for (int x = 0; x < dst_width; x++, dst += channels) {
+    const float *weights = rw->weights + ((size_t)x) * rw->max_count;
+    const float *p = src + ((size_t)rw->first[x]) * channels;
+    const int count = rw->count[x];
+
+#ifdef __SSE2__
+    if (channels == 4) {
+      __m128 sum = _mm_setzero_ps();
+      for (int i = 0; i < count; i++, p += 4) {
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(p), _mm_set1_ps(weights[i])));
       }
-      return (ibuf);
-    }
-  }
-
-  add = (ibuf->y - 1.001) / (newy - 1.0);
-  skipx = 4 * ibuf->x;
-
-  rect = (uchar *)ibuf->rect;
-  rectf = (float *)ibuf->rect_float;
-  newrect = _newrect;
-  newrectf = _newrectf;
-
-  for (x = ibuf->x; x > 0; x--) {
-
-    sample = 0;
-    if (do_rect) {
-      rect = ((uchar *)ibuf->rect) + 4 * (x - 1);
-      newrect = _newrect + 4 * (x - 1);
-
-      val_a = rect[0];
-      nval_a = rect[skipx];
-      diff_a = nval_a - val_a;
-      val_a += 0.5f;
-
-      val_b = rect[1];
-      nval_b = rect[skipx + 1];
-      diff_b = nval_b - val_b;
-      val_b += 0.5f;
-
-      val_g = rect[2];
-      nval_g = rect[skipx + 2];
-      diff_g = nval_g - val_g;
-      val_g += 0.5f;
-
-      val_r = rect[3];
-      nval_r = rect[skipx + 3];
-      diff_r = nval_r - val_r;
-      val_r += 0.5f;
-
-      rect += 2 * skipx;
+      _mm_storeu_ps(dst, sum);
+      continue;
     }
-    if (do_float) {
-      rectf = ibuf->rect_float + 4 * (x - 1);
-      newrectf = _newrectf + 4 * (x - 1);
-
-      val_af = rectf[0];
-      nval_af = rectf[skipx];
-      diff_af = nval_af - val_af;
-
-      val_bf = rectf[1];
-      nval_bf = rectf[skipx + 1];
-      diff_bf = nval_bf - val_bf;
-
-      val_gf = rectf[2];
-      nval_gf = rectf[skipx + 2];
-      diff_gf = nval_gf - val_gf;
-
-      val_rf = rectf[3];
-      nval_rf = rectf[skipx + 3];
-      diff_rf = nval_rf - val_rf;
+#endif
 
-      rectf += 2 * skipx;
+    for (int c = 0; c < channels; c++) {
+      dst[c] = 0.0f;
     }
-
-    for (y = newy; y > 0; y--) {
-      if (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          val_a = nval_a;
-          nval_a = rect[0];
-          diff_a = nval_a - val_a;
-          val_a += 0.5f;
-
-          val_b = nval_b;
-          nval_b = rect[1];
-          diff_b = nval_b - val_b;
-          val_b += 0.5f;
-
-          val_g = nval_g;
-          nval_g = rect[2];
-          diff_g = nval_g - val_g;
-          val_g += 0.5f;
-
-          val_r = nval_r;
-          nval_r = rect[3];
-          diff_r = nval_r - val_r;
-          val_r += 0.5f;
-          rect += skipx;
-        }
-        if (do_float) {
-          val_af = nval_af;
-          nval_af = rectf[0];
-          diff_af = nval_af - val_af;
-
-          val_bf = nval_bf;
-          nval_bf = rectf[1];
-          diff_bf = nval_bf - val_bf;
-
-          val_gf = nval_gf;
-          nval_gf = rectf[2];
-          diff_gf = nval_gf - val_gf;
-
-          val_rf = nval_rf;
-          nval_rf = rectf[3];
-          diff_rf = nval_rf - val_rf;
-          rectf += skipx;
-        }
-      }
-      if (do_rect) {
-        newrect[0] = val_a + sample * diff_a;
-        newrect[1] = val_b + sample * diff_b;
-        newrect[2] = val_g + sample * diff_g;
-        newrect[3] = val_r + sample * diff_r;
-        newrect += skipx;
+    for (int i = 0; i < count; i++, p += channels) {
+      for (int c = 0; c < channels; c++) {
+        dst[c] += p[c] * weights[i];
       }
-      if (do_float) {
-        newrectf[0] = val_af + sample * diff_af;
-        newrectf[1] = val_bf + sample * diff_bf;
-        newrectf[2] = val_gf + sample * diff_gf;
-        newrectf[3] = val_rf + sample * diff_rf;
-        newrectf += skipx;
-      }
-      sample += add;
     }
   }
-
-  if (do_rect) {
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
-  }
-  if (do_float) {
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
-  }
-
-  ibuf->y = newy;
-  return (ibuf);
 }
 
-static void scalefast_Z_ImBuf(ImBuf *ibuf, int newx, int newy)
+/* Vertical pass of a row, num_values is the number of floats of a row. */
+static void resample_row_y(const ResampleWeights *rw,
+                           float *dst,
+                           const float *src,
+                           int y,
+                           int num_values)
 {
-  int *zbuf, *newzbuf, *_newzbuf = NULL;
-  float *zbuf_float, *newzbuf_float, *_newzbuf_float = NULL;
-  int x, y;
-  int ofsx, ofsy, stepx, stepy;
+  const float *weights = rw->weights + ((size_t)y) * rw->max_count;
+  const float *rows = src + ((size_t)rw->first[y]) * num_values;
+  const int count = rw->count[y];
+  int i = 0;
+
+#ifdef __SSE2__
+  for (; i + 4 <= num_values; i += 4) {
+    __m128 sum = _mm_setzero_ps();
+    const float *p = rows + i;
+    for (int j = 0; j < count; j++, p += num_values) {
+      sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(p), _mm_set1_ps(weights[j])));
+    }
+    _mm_storeu_ps(dst + i, sum);
+  }
+#endif
 
-  if (ibuf->zbuf) {
-    _newzbuf = MEM_mallocN(newx * newy * sizeof(int), __func__);
-    if (_newzbuf == NULL) {
-      IMB_freezbufImBuf(ibuf);
+  for (; i < num_values; i++) {
+    float sum = 0.0f;
+    const float *p = rows + i;
+    for (int j = 0; j < count; j++, p += num_values) {
+      sum += *p * weights[j];
     }
+    dst[i] = sum;
   }
+}
 
-  if (ibuf->zbuf_float) {
-    _newzbuf_float = MEM_mallocN((size_t)newx * newy * sizeof(float), __func__);
-    if (_newzbuf_float == NULL) {
-      IMB_freezbuffloatImBuf(ibuf);
+static void resample_x_thread_do(void *data_v, int start_scanline, int num_scanlines)
+{
+  ResampleData *data = (ResampleData *)data_v;
+  const int channels = data->channels;
+  const size_t src_row_len = ((size_t)data->src_width) * channels;
+  const size_t dst_row_len = ((size_t)data->dst_width) * channels;
+  float *row = NULL;
+
+  if (data->src_byte) {
+    row = MEM_mallocN(sizeof(float) * src_row_len, "resample row");
+  }
+
+  for (int y = start_scanline; y < start_scanline + num_scanlines; y++) {
+    const float *src;
+    if (data->src_byte) {
+      const unsigned char *src_byte = data->src_byte + src_row_len * y;
+      for (size_t i = 0; i < src_row_len; i++) {
+        row[i] = (float)src_byte[i];
+      }
+      src = row;
+    }
+    else {
+      src = data->src_float + src_row_len * y;
     }
+    resample_row_x(data->weights_x, data->tmp + dst_row_len * y, src, data->dst_width, channels);
   }
 
-  if (!_newzbuf && !_newzbuf_float) {
-    return;
+  if (row) {
+    MEM_freeN(row);
   }
+}
 
-  stepx = (65536.0 * (ibuf->x - 1.0) / (newx - 1.0)) + 0.5;
-  stepy = (65536.0 * (ibuf->y - 1.0) / (newy - 1.0)) + 0.5;
-  ofsy = 32768;
+static void resample_y_thread_do(void *data_v, int start_scanline, int num_scanlines)
+{
+  ResampleData *data = (ResampleData *)data_v;
+  const int row_len = data->dst_width * data->channels;
+  float *row = NULL;
 
-  newzbuf = _newzbuf;
-  newzbuf_float = _newzbuf_float;
+  if (data->dst_byte) {
+    row = MEM_mallocN(sizeof(float) * row_len, "resample row");
+  }
 
-  for (y = newy; y > 0; y--, ofsy += stepy) {
-    if (newzbuf) {
-      zbuf = ibuf->zbuf;
-      zbuf += (ofsy >> 16) * ibuf->x;
-      ofsx = 32768;
-      for (x = newx; x > 0; x--, ofsx += stepx) {
-        *newzbuf++ = zbuf[ofsx >> 16];
+  for (int y = start_scanline; y < start_scanline + num_scanlines; y++) {
+    if (data->dst_byte) {
+      unsigned char *dst_byte = data->dst_byte + ((size_t)row_len) * y;
+      resample_row_y(data->weights_y, row, data->tmp, y, row_len);
+      for (int i = 0; i < row_len; i++) {
+        /* Lanczos overshoots. */
+        dst_byte[i] = (unsigned char)(clamp_f(row[i], 0.0f, 255.0f) + 0.5f);
       }
     }
-
-    if (newzbuf_float) {
-      zbuf_float = ibuf->zbuf_float;
-      zbuf_float += (ofsy >> 16) * ibuf->x;
-      ofsx = 32768;
-      for (x = newx; x > 0; x--, ofsx += stepx) {
-        *newzbuf_float++ = zbuf_float[ofsx >> 16];
-      }
+    else {
+      resample_row_y(
+          data->weights_y, data->dst_float + ((size_t)row_len) * y, data->tmp, y, row_len);
     }
   }
 
-  if (_newzbuf) {
-    IMB_freezbufImBuf(ibuf);
-    ibuf->mall |= IB_zbuf;
-    ibuf->zbuf = _newzbuf;
+  if (row) {
+    MEM_freeN(row);
   }
+}
 
-  if (_newzbuf_float) {
-    IMB_freezbuffloatImBuf(ibuf);
-    ibuf->mall |= IB_zbuffloat;
-    ibuf->zbuf_float = _newzbuf_float;
+static void resample_apply_scanlines(int total_scanlines,
+                                     int width,
+                                     ScanlineThreadFunc do_thread,
+                                     ResampleData *data)
+{
+  if (((size_t)width) * total_scanlines < 64 * 64) {
+    do_thread(data, 0, total_scanlines);
+  }
+  else {
+    IMB_processor_apply_threaded_scanlines(total_scanlines, do_thread, data);
   }
 }
 
+static void resample_buffer(ResampleData *data, int src_height, int dst_height)
+{
+  data->tmp = MEM_mallocN(sizeof(float) * data->dst_width * src_height * data->channels,
+                          "resample tmp");
+  resample_apply_scanlines(src_height, data->dst_width, resample_x_thread_do, data);
+  resample_apply_scanlines(dst_height, data->dst_width, resample_y_thread_do, data);
+  MEM_freeN(data->tmp);
+  data->tmp = NULL;
+}
+
 /**
+ * Resample with a separable filter, the rows of both passes are processed on all threads.
+ * A size of zero keeps the current size of that axis.
  * Return true if \a ibuf is modified.
  */
-bool IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy)
+bool IMB_resampleImBuf(struct ImBuf *ibuf,
+                       unsigned int newx,
+                       unsigned int newy,
+                       IMB_ResampleFilter filter)
 {
+  ResampleWeights weights_x, weights_y;
+  ResampleData data = {NULL};
+
   if (ibuf == NULL) {
     return false;
   }
@@ -1625,34 +1310,75 @@ bool IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy)
     return false;
   }
 
+  if (newx == 0) {
+    newx = ibuf->x;
+  }
+  if (newy == 0) {
+    newy = ibuf->y;
+  }
   if (newx == ibuf->x && newy == ibuf->y) {
     return false;
   }
 
-  /* Scale-up / scale-down functions below change ibuf->x and ibuf->y
-   * so we first scale the Z-buffer (if any). */
   scalefast_Z_ImBuf(ibuf, newx, newy);
 
+  resample_weights_init(&weights_x, ibuf->x, newx, filter);
+  resample_weights_init(&weights_y, ibuf->y, newy, filter);
+  data.weights_x = &weights_x;
+  data.weights_y = &weights_y;
+  data.src_width = ibuf->x;
+  data.dst_width = newx;
+
+  if (ibuf->rect) {
+    unsigned char *rect = MEM_mallocN(((size_t)newx) * newy * 4, "resampled byte buffer");
+    data.channels = 4;
+    data.src_byte = (unsigned char *)ibuf->rect;
+    data.src_float = NULL;
+    data.dst_byte = rect;
+    data.dst_float = NULL;
+    resample_buffer(&data, ibuf->y, newy);
+
+    imb_freerectImBuf(ibuf);
+    ibuf->mall |= IB_rect;
+    ibuf->rect = (unsigned int *)rect;
+  }
+
+  if (ibuf->rect_float) {
+    float *rect_float = MEM_mallocN(sizeof(float) * newx * newy * ibuf->channels,
+                                    "resampled float buffer");
+    data.channels = ibuf->channels;
+    data.src_byte = NULL;
+    data.src_float = ibuf->rect_float;
+    data.dst_byte = NULL;
+    data.dst_float = rect_float;
+    resample_buffer(&data, ibuf->y, newy);
+
+    imb_freerectfloatImBuf(ibuf);
+    ibuf->mall |= IB_rectfloat;
+    ibuf->rect_float = rect_float;
+  }
+
+  resample_weights_free(&weights_x);
+  resample_weights_free(&weights_y);
+
+  ibuf->x = newx;
+  ibuf->y = newy;
+  return true;
+}
+
+/**
+ * Return true if \a ibuf is modified.
+ */
+bool IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy)
+{
   /* try to scale common cases in a fast way */
   /* disabled, quality loss is unacceptable, see report #18609  (ton) */
   if (0 && q_scale_linear_interpolation(ibuf, newx, newy)) {
     return true;
   }
 
-  if (newx && (newx < ibuf->x)) {
-    scaledownx(ibuf, newx);
-  }
-  if (newy && (newy < ibuf->y)) {
-    scaledowny(ibuf, newy);
-  }
-  if (newx && (newx > ibuf->x)) {
-    scaleupx(ibuf, newx);
-  }
-  if (newy && (newy > ibuf->y)) {
-    scaleupy(ibuf, newy);
-  }
-
-  return true;
+  /* Area average when shrinking and linear interpolation when enlarging. */
+  return IMB_resampleImBuf(ibuf, newx, newy, IMB_RESAMPLE_AUTO);
 }
 
 struct imbufRGBA {
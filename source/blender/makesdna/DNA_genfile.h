@@ -29,6 +29,9 @@
 
 struct SDNA;
 
+/* Conversion of the structs of an SDNA to the current one, see #DNA_reconstruct_info_create. */
+typedef struct DNA_ReconstructInfo DNA_ReconstructInfo;
+
 /**
  * DNAstr contains the prebuilt SDNA structure defining the layouts of the types
  * used by this version of Blender. It is defined in a file dna.c, which is
@@ -94,12 +97,14 @@ int DNA_struct_find_nr_ex(const struct SDNA *sdna, const char *str, unsigned int
 int DNA_struct_find_nr(const struct SDNA *sdna, const char *str);
 void DNA_struct_switch_endian(const struct SDNA *oldsdna, int oldSDNAnr, char *data);
 const char *DNA_struct_get_compareflags(const struct SDNA *sdna, const struct SDNA *newsdna);
-void *DNA_struct_reconstruct(const struct SDNA *newsdna,
-                             const struct SDNA *oldsdna,
-                             const char *compflags,
-                             int oldSDNAnr,
+struct DNA_ReconstructInfo *DNA_reconstruct_info_create(const struct SDNA *oldsdna,
+                                                        const struct SDNA *newsdna,
+                                                        const char *compflags);
+void DNA_reconstruct_info_free(struct DNA_ReconstructInfo *reconstruct_info);
+void *DNA_struct_reconstruct(const struct DNA_ReconstructInfo *reconstruct_info,
+                             int old_struct_nr,
                              int blocks,
-                             const void *data);
+                             const void *old_blocks);
 
 int DNA_elem_offset(struct SDNA *sdna, const char *stype, const char *vartype, const char *name);
 
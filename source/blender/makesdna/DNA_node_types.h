@@ -511,6 +511,8 @@ typedef struct bNodeTree {
 
 /* tree is localized copy, free when deleting node groups */
 /* #define NTREE_IS_LOCALIZED           (1 << 5) */
+#define NTREE_COM_BUFFER_EXECUTION (1 << 6) /* calculate areas of operations in bulk */
+#define NTREE_COM_RESULT_CACHE (1 << 7)     /* keep unchanged buffers between executions */
 
 /* ntree->update */
 typedef enum eNodeTreeUpdate {
@@ -178,6 +178,13 @@ typedef struct Object_Runtime {
 
   /** Runtime grease pencil drawing data */
   struct GpencilBatchCache *gpencil_cache;
+
+  /**
+   * Instances replacing the instanced collection duplis, set by the game engine.
+   * Only used on the original object.
+   */
+  struct DupliInstances *dupli_instances;
+
   /** Runtime grease pencil total layers used for evaluated data created by modifiers */
   int gpencil_tot_layers;
   char _pad4[4];
@@ -749,6 +756,7 @@ enum {
   OB_LOCK_RIGID_BODY_X_ROT_AXIS   = 1 << 5,
   OB_LOCK_RIGID_BODY_Y_ROT_AXIS   = 1 << 6,
   OB_LOCK_RIGID_BODY_Z_ROT_AXIS   = 1 << 7,
+  OB_STATIC_INSTANCES             = 1 << 8,
 
 /*	OB_LIFE     = OB_PROP | OB_DYNAMIC | OB_ACTOR | OB_MAINACTOR | OB_CHILD, */
 };
@@ -879,7 +879,8 @@ typedef struct GameData {
 	short raster_storage;
 	float levelHeight;
 	float deactivationtime, lineardeactthreshold, angulardeactthreshold;
-	int _pad;
+	/* Frame step poses are rounded to when shared between armatures, 0 shares exact frames only. */
+	float poseCacheFrameStep;
 
     /* Scene LoD */
     short lodflag, _pad2;
@@ -943,6 +944,11 @@ typedef struct GameData {
 #define GAME_USE_UNDO			            (1 << 19)
 #define GAME_USE_UI_ANTI_FLICKER			(1 << 20)
 #define GAME_USE_VIEWPORT_RENDER      (1 << 21)
+#define GAME_RESAMPLE_ACTIONS				(1 << 22)
+#define GAME_USE_POSE_CACHE					(1 << 23)
+#define GAME_FLAT_SCENEGRAPH				(1 << 24)
+#define GAME_USE_PROXIMITY_QUERIES			(1 << 25)
+#define GAME_EVENT_DRIVEN_SENSORS			(1 << 26)
 /* Note: GameData.flag is now an int (max 32 flags). A short could only take 16 flags */
 
 /* GameData.playerflag */
@@ -796,33 +796,27 @@ static eSDNA_Type sdna_type_nr(const char *dna_type)
 
 /**
  * Converts a value of one primitive type to another.
- * Note there is no optimization for the case where otype and ctype are the same:
+ * Note there is no optimization for the case where old_type and new_type are the same:
  * assumption is that caller will handle this case.
  *
- * \param ctype: Name of type to convert to
- * \param otype: Name of type to convert from
- * \param name_array_len: Result of #DNA_elem_array_size for this element.
+ * \param new_type: Type to convert to.
+ * \param old_type: Type to convert from.
+ * \param array_len: Number of elements to convert.
  * \param curdata: Where to put converted data
- * \param olddata: Data of type otype to convert
+ * \param olddata: Data of type old_type to convert
  */
-static void cast_elem(
-    const char *ctype, const char *otype, int name_array_len, char *curdata, const char *olddata)
+static void cast_primitive(const eSDNA_Type new_type,
+                           const eSDNA_Type old_type,
+                           int array_len,
+                           char *curdata,
+                           const char *olddata)
 {
   double val = 0.0;
-  int curlen = 1, oldlen = 1;
-
-  eSDNA_Type ctypenr, otypenr;
-
-  if ((otypenr = sdna_type_nr(otype)) == -1 || (ctypenr = sdna_type_nr(ctype)) == -1) {
-    return;
-  }
+  const int oldlen = DNA_elem_type_size(old_type);
+  const int curlen = DNA_elem_type_size(new_type);
 
-  /* define lengths */
-  oldlen = DNA_elem_type_size(otypenr);
-  curlen = DNA_elem_type_size(ctypenr);
-
-  while (name_array_len > 0) {
-    switch (otypenr) {
+  while (array_len > 0) {
+    switch (old_type) {
       case SDNA_TYPE_CHAR:
         val = *olddata;
         break;
@@ -852,7 +846,7 @@ static void cast_elem(
         break;
     }
 
-    switch (ctypenr) {
+    switch (new_type) {
       case SDNA_TYPE_CHAR:
         *curdata = val;
         break;
@@ -869,13 +863,13 @@ static void cast_elem(
         *((int *)curdata) = val;
         break;
       case SDNA_TYPE_FLOAT:
-        if (otypenr < 2) {
+        if (old_type < 2) {
           val /= 255;
         }
         *((float *)curdata) = val;
         break;
       case SDNA_TYPE_DOUBLE:
-        if (otypenr < 2) {
+        if (old_type < 2) {
           val /= 255;
         }
         *((double *)curdata) = val;
@@ -890,7 +884,7 @@ static void cast_elem(
 
     olddata += oldlen;
     curdata += curlen;
-    name_array_len--;
+    array_len--;
   }
 }
 
@@ -1077,42 +1071,75 @@ static const char *find_elem(const SDNA *sdna,
   return NULL;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Struct Reconstruction
+ *
+ * The conversion of a struct from the file SDNA to the current SDNA is computed once for
+ * each struct as a list of steps, so converting the blocks doesn't look up the members by
+ * name anymore. The steps are only read while converting, blocks can be converted on threads.
+ * \{ */
+
+typedef enum eReconstructStepType {
+  RECONSTRUCT_STEP_MEMCPY,
+  RECONSTRUCT_STEP_CAST_PRIMITIVE,
+  RECONSTRUCT_STEP_CAST_POINTER,
+  RECONSTRUCT_STEP_SUBSTRUCT,
+} eReconstructStepType;
+
+typedef struct ReconstructStep {
+  eReconstructStepType type;
+  int old_offset;
+  int new_offset;
+  union {
+    struct {
+      int size;
+      /* The string was truncated, its last copied byte is set to zero. */
+      bool terminate_string;
+    } copy;
+    struct {
+      int array_len;
+      eSDNA_Type old_type;
+      eSDNA_Type new_type;
+    } cast_primitive;
+    struct {
+      int array_len;
+    } cast_pointer;
+    struct {
+      int array_len;
+      int old_struct_nr;
+      int old_size;
+      int new_size;
+    } substruct;
+  } data;
+} ReconstructStep;
+
+struct DNA_ReconstructInfo {
+  const SDNA *oldsdna;
+  const SDNA *newsdna;
+  const char *compflags;
+
+  /* Steps of each struct of oldsdna, only set for the structs which are not equal. */
+  int *step_counts;
+  ReconstructStep **steps;
+};
+
 /**
- * Converts the contents of a single field of a struct, of a non-struct type,
- * from oldsdna to newsdna format.
+ * Finds the member of the old struct a non-struct member of the new struct is read from:
+ * either the names are equal or, for arrays, the names without their array part are.
  *
- * \param newsdna: SDNA of current Blender
- * \param oldsdna: SDNA of Blender that saved file
- * \param type: current field type name
- * \param new_name_nr: current field name number.
- * \param curdata: put field data converted to newsdna here
- * \param old: pointer to struct info in oldsdna
- * \param olddata: struct contents laid out according to oldsdna
+ * \param old_struct: Pointer to struct information in oldsdna.
+ * \param name: Current member name.
+ * \param r_old_offset: Offset of the member in the old struct.
+ * \return The old member information or NULL when it doesn't exist.
  */
-static void reconstruct_elem(const SDNA *newsdna,
-                             const SDNA *oldsdna,
-                             const char *type,
-                             const int new_name_nr,
-                             char *curdata,
-                             const short *old,
-                             const char *olddata)
+static const short *find_old_member_elem(const SDNA *oldsdna,
+                                         const short *old_struct,
+                                         const char *name,
+                                         int *r_old_offset)
 {
-  /* rules: test for NAME:
-   *      - name equal:
-   *          - cast type
-   *      - name partially equal (array differs)
-   *          - type equal: memcpy
-   *          - type cast (per element).
-   * (nzc 2-4-2001 I want the 'unsigned' bit to be parsed as well. Where
-   * can I force this?)
-   */
-  int a, elemcount, len, countpos, mul;
-  const char *otype, *oname, *cp;
-
-  /* is 'name' an array? */
-  const char *name = newsdna->names[new_name_nr];
-  cp = name;
-  countpos = 0;
+  /* Length of the name without its array part, zero when the name is not an array. */
+  int countpos = 0;
+  const char *cp = name;
   while (*cp && *cp != '[') {
     cp++;
     countpos++;
@@ -1121,183 +1148,275 @@ static void reconstruct_elem(const SDNA *newsdna,
     countpos = 0;
   }
 
-  /* in old is the old struct */
-  elemcount = old[1];
-  old += 2;
-  for (a = 0; a < elemcount; a++, old += 2) {
-    const int old_name_nr = old[1];
-    otype = oldsdna->types[old[0]];
-    oname = oldsdna->names[old[1]];
-    len = DNA_elem_size_nr(oldsdna, old[0], old[1]);
-
-    if (strcmp(name, oname) == 0) { /* name equal */
-
-      if (ispointer(name)) { /* pointer of functionpointer afhandelen */
-        cast_pointer(newsdna->pointer_size,
-                     oldsdna->pointer_size,
-                     newsdna->names_array_len[new_name_nr],
-                     curdata,
-                     olddata);
-      }
-      else if (strcmp(type, otype) == 0) { /* type equal */
-        memcpy(curdata, olddata, len);
-      }
-      else {
-        cast_elem(type, otype, newsdna->names_array_len[new_name_nr], curdata, olddata);
-      }
-
-      return;
+  const int elemcount = old_struct[1];
+  const short *old = old_struct + 2;
+  int old_offset = 0;
+  for (int a = 0; a < elemcount; a++, old += 2) {
+    const char *oname = oldsdna->names[old[1]];
+    if (STREQ(name, oname) ||
+        (countpos != 0 && oname[countpos] == '[' && STREQLEN(name, oname, countpos))) {
+      *r_old_offset = old_offset;
+      return old;
     }
-    else if (countpos != 0) { /* name is an array */
-
-      if (oname[countpos] == '[' && strncmp(name, oname, countpos) == 0) { /* basis equal */
-        const int new_name_array_len = newsdna->names_array_len[new_name_nr];
-        const int old_name_array_len = oldsdna->names_array_len[old_name_nr];
-        const int min_name_array_len = MIN2(new_name_array_len, old_name_array_len);
-
-        if (ispointer(name)) { /* handle pointer or functionpointer */
-          cast_pointer(
-              newsdna->pointer_size, oldsdna->pointer_size, min_name_array_len, curdata, olddata);
-        }
-        else if (strcmp(type, otype) == 0) { /* type equal */
-          /* size of single old array element */
-          mul = len / old_name_array_len;
-          /* smaller of sizes of old and new arrays */
-          mul *= min_name_array_len;
-
-          memcpy(curdata, olddata, mul);
+    old_offset += DNA_elem_size_nr(oldsdna, old[0], old[1]);
+  }
+  return NULL;
+}
 
-          if (old_name_array_len > new_name_array_len && strcmp(type, "char") == 0) {
-            /* string had to be truncated, ensure it's still null-terminated */
-            curdata[mul - 1] = '\0';
-          }
-        }
-        else {
-          cast_elem(type, otype, min_name_array_len, curdata, olddata);
-        }
-        return;
+/**
+ * Finds the member of the old struct a struct member of the new struct is read from,
+ * the names without their array part and the types must be equal.
+ */
+static const short *find_old_member_struct(const SDNA *oldsdna,
+                                           const short *old_struct,
+                                           const char *type,
+                                           const char *name,
+                                           int *r_old_offset)
+{
+  const int elemcount = old_struct[1];
+  const short *old = old_struct + 2;
+  int old_offset = 0;
+  for (int a = 0; a < elemcount; a++, old += 2) {
+    if (elem_strcmp(name, oldsdna->names[old[1]]) == 0) {
+      if (STREQ(type, oldsdna->types[old[0]])) {
+        *r_old_offset = old_offset;
+        return old;
       }
+      return NULL;
     }
-    olddata += len;
+    old_offset += DNA_elem_size_nr(oldsdna, old[0], old[1]);
   }
+  return NULL;
 }
 
 /**
- * Converts the contents of an entire struct from oldsdna to newsdna format.
- *
- * \param newsdna: SDNA of current Blender
- * \param oldsdna: SDNA of Blender that saved file
- * \param compflags:
- *
- * Result from DNA_struct_get_compareflags to avoid needless conversions.
- * \param oldSDNAnr: Index of old struct definition in oldsdna
- * \param data: Struct contents laid out according to oldsdna
- * \param curSDNAnr: Index of current struct definition in newsdna
- * \param cur: Where to put converted struct contents
+ * Computes the step reading a non-struct member of the new struct,
+ * return false when the member is not read from the old struct.
  */
-static void reconstruct_struct(const SDNA *newsdna,
-                               const SDNA *oldsdna,
-                               const char *compflags,
-
-                               int oldSDNAnr,
-                               const char *data,
-                               int curSDNAnr,
-                               char *cur)
+static bool init_reconstruct_step_for_elem(const SDNA *oldsdna,
+                                           const SDNA *newsdna,
+                                           const short *old_struct,
+                                           const short *new_member,
+                                           ReconstructStep *r_step)
 {
-  /* Recursive!
-   * Per element from cur_struct, read data from old_struct.
-   * If element is a struct, call recursive.
-   */
-  int a, elemcount, elen, eleno, mul, mulo, firststructtypenr;
-  const short *spo, *spc, *sppo;
-  const char *type;
-  const char *cpo;
-  char *cpc;
-  const char *name;
+  const char *type = newsdna->types[new_member[0]];
+  const char *name = newsdna->names[new_member[1]];
 
-  unsigned int oldsdna_index_last = UINT_MAX;
-  unsigned int cursdna_index_last = UINT_MAX;
+  const short *old_member = find_old_member_elem(oldsdna, old_struct, name, &r_step->old_offset);
+  if (old_member == NULL) {
+    return false;
+  }
 
-  if (oldSDNAnr == -1) {
-    return;
+  const char *otype = oldsdna->types[old_member[0]];
+  const int new_array_len = newsdna->names_array_len[new_member[1]];
+  const int old_array_len = oldsdna->names_array_len[old_member[1]];
+  const int old_len = DNA_elem_size_nr(oldsdna, old_member[0], old_member[1]);
+  /* Only the first elements of arrays of different length are read. */
+  const bool name_equal = STREQ(name, oldsdna->names[old_member[1]]);
+  const int array_len = name_equal ? new_array_len : MIN2(new_array_len, old_array_len);
+
+  if (ispointer(name)) {
+    if (newsdna->pointer_size == oldsdna->pointer_size) {
+      r_step->type = RECONSTRUCT_STEP_MEMCPY;
+      r_step->data.copy.size = newsdna->pointer_size * array_len;
+      r_step->data.copy.terminate_string = false;
+    }
+    else {
+      r_step->type = RECONSTRUCT_STEP_CAST_POINTER;
+      r_step->data.cast_pointer.array_len = array_len;
+    }
   }
-  if (curSDNAnr == -1) {
-    return;
+  else if (STREQ(type, otype)) {
+    r_step->type = RECONSTRUCT_STEP_MEMCPY;
+    if (name_equal) {
+      r_step->data.copy.size = old_len;
+      r_step->data.copy.terminate_string = false;
+    }
+    else {
+      r_step->data.copy.size = (old_len / old_array_len) * array_len;
+      /* A string had to be truncated, ensure it's still null-terminated. */
+      r_step->data.copy.terminate_string = (old_array_len > new_array_len) && STREQ(type, "char");
+    }
+  }
+  else {
+    const eSDNA_Type old_type = sdna_type_nr(otype);
+    const eSDNA_Type new_type = sdna_type_nr(type);
+    if (old_type == -1 || new_type == -1) {
+      return false;
+    }
+    r_step->type = RECONSTRUCT_STEP_CAST_PRIMITIVE;
+    r_step->data.cast_primitive.array_len = array_len;
+    r_step->data.cast_primitive.old_type = old_type;
+    r_step->data.cast_primitive.new_type = new_type;
   }
+  return true;
+}
 
-  if (compflags[oldSDNAnr] == SDNA_CMP_EQUAL) {
-    /* if recursive: test for equal */
-    spo = oldsdna->structs[oldSDNAnr];
-    elen = oldsdna->types_size[spo[0]];
-    memcpy(cur, data, elen);
+/**
+ * Computes the step reading a struct member of the new struct,
+ * return false when the member is not read from the old struct.
+ */
+static bool init_reconstruct_step_for_struct(const SDNA *oldsdna,
+                                             const SDNA *newsdna,
+                                             const char *compflags,
+                                             const short *old_struct,
+                                             const short *new_member,
+                                             ReconstructStep *r_step)
+{
+  const char *type = newsdna->types[new_member[0]];
+  const char *name = newsdna->names[new_member[1]];
 
-    return;
+  const short *old_member = find_old_member_struct(
+      oldsdna, old_struct, type, name, &r_step->old_offset);
+  if (old_member == NULL) {
+    return false;
   }
 
-  firststructtypenr = *(newsdna->structs[0]);
-
-  spo = oldsdna->structs[oldSDNAnr];
-  spc = newsdna->structs[curSDNAnr];
+  const int old_struct_nr = DNA_struct_find_nr(oldsdna, type);
+  const int new_struct_nr = DNA_struct_find_nr(newsdna, type);
+  if (old_struct_nr == -1 || new_struct_nr == -1) {
+    return false;
+  }
 
-  elemcount = spc[1];
+  const int old_size = oldsdna->types_size[oldsdna->structs[old_struct_nr][0]];
+  const int new_size = newsdna->types_size[newsdna->structs[new_struct_nr][0]];
+  const int array_len = MIN2(newsdna->names_array_len[new_member[1]],
+                             oldsdna->names_array_len[old_member[1]]);
 
-  spc += 2;
-  cpc = cur;
-  for (a = 0; a < elemcount; a++, spc += 2) { /* convert each field */
-    type = newsdna->types[spc[0]];
-    name = newsdna->names[spc[1]];
+  if (compflags[old_struct_nr] == SDNA_CMP_EQUAL) {
+    r_step->type = RECONSTRUCT_STEP_MEMCPY;
+    r_step->data.copy.size = old_size * array_len;
+    r_step->data.copy.terminate_string = false;
+  }
+  else {
+    r_step->type = RECONSTRUCT_STEP_SUBSTRUCT;
+    r_step->data.substruct.array_len = array_len;
+    r_step->data.substruct.old_struct_nr = old_struct_nr;
+    r_step->data.substruct.old_size = old_size;
+    r_step->data.substruct.new_size = new_size;
+  }
+  return true;
+}
 
-    elen = DNA_elem_size_nr(newsdna, spc[0], spc[1]);
+/**
+ * Computes the steps converting a struct from oldsdna to newsdna,
+ * members which are only in the new struct are left zeroed.
+ */
+static ReconstructStep *create_reconstruct_steps(const SDNA *oldsdna,
+                                                 const SDNA *newsdna,
+                                                 const char *compflags,
+                                                 int old_struct_nr,
+                                                 int new_struct_nr,
+                                                 int *r_step_count)
+{
+  const short *old_struct = oldsdna->structs[old_struct_nr];
+  const short *new_struct = newsdna->structs[new_struct_nr];
+  const int firststructtypenr = *(newsdna->structs[0]);
+  const int elemcount = new_struct[1];
+
+  ReconstructStep *steps = MEM_malloc_arrayN(
+      MAX2(elemcount, 1), sizeof(*steps), "ReconstructStep");
+  int step_count = 0;
+
+  const short *new_member = new_struct + 2;
+  int new_offset = 0;
+  for (int a = 0; a < elemcount; a++, new_member += 2) {
+    const char *name = newsdna->names[new_member[1]];
+    const int new_len = DNA_elem_size_nr(newsdna, new_member[0], new_member[1]);
+    ReconstructStep *step = &steps[step_count];
+    bool has_step;
 
     /* Skip pad bytes which must start with '_pad', see makesdna.c 'is_name_legal'.
      * for exact rules. Note that if we fail to skip a pad byte it's harmless,
      * this just avoids unnecessary reconstruction. */
     if (name[0] == '_' || (name[0] == '*' && name[1] == '_')) {
-      cpc += elen;
+      has_step = false;
+    }
+    else if (new_member[0] >= firststructtypenr && !ispointer(name)) {
+      has_step = init_reconstruct_step_for_struct(
+          oldsdna, newsdna, compflags, old_struct, new_member, step);
+    }
+    else {
+      has_step = init_reconstruct_step_for_elem(oldsdna, newsdna, old_struct, new_member, step);
     }
-    else if (spc[0] >= firststructtypenr && !ispointer(name)) {
-      /* struct field type */
-
-      /* where does the old struct data start (and is there an old one?) */
-      cpo = (char *)find_elem(oldsdna, type, name, spo, data, &sppo);
-
-      if (cpo) {
-        oldSDNAnr = DNA_struct_find_nr_ex(oldsdna, type, &oldsdna_index_last);
-        curSDNAnr = DNA_struct_find_nr_ex(newsdna, type, &cursdna_index_last);
-
-        /* array! */
-        mul = newsdna->names_array_len[spc[1]];
-        mulo = oldsdna->names_array_len[sppo[1]];
-
-        eleno = DNA_elem_size_nr(oldsdna, sppo[0], sppo[1]);
-
-        elen /= mul;
-        eleno /= mulo;
 
-        while (mul--) {
-          reconstruct_struct(newsdna, oldsdna, compflags, oldSDNAnr, cpo, curSDNAnr, cpc);
-          cpo += eleno;
-          cpc += elen;
-
-          /* new struct array larger than old */
-          mulo--;
-          if (mulo <= 0) {
-            break;
-          }
-        }
+    if (has_step) {
+      step->new_offset = new_offset;
+
+      /* Merge copies of consecutive members. */
+      ReconstructStep *prev = (step_count > 0) ? &steps[step_count - 1] : NULL;
+      if (prev && step->type == RECONSTRUCT_STEP_MEMCPY && prev->type == step->type &&
+          !prev->data.copy.terminate_string &&
+          prev->old_offset + prev->data.copy.size == step->old_offset &&
+          prev->new_offset + prev->data.copy.size == step->new_offset) {
+        prev->data.copy.size += step->data.copy.size;
+        prev->data.copy.terminate_string = step->data.copy.terminate_string;
       }
       else {
-        cpc += elen; /* skip field no longer present */
+        step_count++;
       }
     }
-    else {
-      /* non-struct field type */
-      reconstruct_elem(newsdna, oldsdna, type, spc[1], cpc, spo, data);
-      cpc += elen;
+    new_offset += new_len;
+  }
+
+  *r_step_count = step_count;
+  return steps;
+}
+
+/**
+ * Converts the contents of a struct from oldsdna to newsdna format.
+ *
+ * \param old_struct_nr: Index of old struct definition in oldsdna
+ * \param olddata: Struct contents laid out according to oldsdna
+ * \param newdata: Where to put converted struct contents
+ */
+static void reconstruct_struct(const DNA_ReconstructInfo *reconstruct_info,
+                               int old_struct_nr,
+                               const char *olddata,
+                               char *newdata)
+{
+  const ReconstructStep *steps = reconstruct_info->steps[old_struct_nr];
+  const int step_count = reconstruct_info->step_counts[old_struct_nr];
+
+  for (int a = 0; a < step_count; a++) {
+    const ReconstructStep *step = &steps[a];
+    const char *cpo = olddata + step->old_offset;
+    char *cpc = newdata + step->new_offset;
+
+    switch (step->type) {
+      case RECONSTRUCT_STEP_MEMCPY:
+        memcpy(cpc, cpo, step->data.copy.size);
+        if (step->data.copy.terminate_string) {
+          cpc[step->data.copy.size - 1] = '\0';
+        }
+        break;
+      case RECONSTRUCT_STEP_CAST_PRIMITIVE:
+        cast_primitive(step->data.cast_primitive.new_type,
+                       step->data.cast_primitive.old_type,
+                       step->data.cast_primitive.array_len,
+                       cpc,
+                       cpo);
+        break;
+      case RECONSTRUCT_STEP_CAST_POINTER:
+        cast_pointer(reconstruct_info->newsdna->pointer_size,
+                     reconstruct_info->oldsdna->pointer_size,
+                     step->data.cast_pointer.array_len,
+                     cpc,
+                     cpo);
+        break;
+      case RECONSTRUCT_STEP_SUBSTRUCT:
+        for (int i = 0; i < step->data.substruct.array_len; i++) {
+          reconstruct_struct(reconstruct_info, step->data.substruct.old_struct_nr, cpo, cpc);
+          cpo += step->data.substruct.old_size;
+          cpc += step->data.substruct.new_size;
+        }
+        break;
     }
   }
 }
 
+/** \} */
+
 /**
  * Does endian swapping on the fields of a struct value.
  *
@@ -1392,54 +1511,100 @@ void DNA_struct_switch_endian(const SDNA *oldsdna, int oldSDNAnr, char *data)
 }
 
 /**
- * \param newsdna: SDNA of current Blender
- * \param oldsdna: SDNA of Blender that saved file
- * \param compflags:
+ * Computes the conversion of all the structs of oldsdna which are not equal in newsdna.
  *
- * Result from DNA_struct_get_compareflags to avoid needless conversions
- * \param oldSDNAnr: Index of struct info within oldsdna
+ * \param compflags: Result from #DNA_struct_get_compareflags, it must outlive the result.
+ */
+DNA_ReconstructInfo *DNA_reconstruct_info_create(const SDNA *oldsdna,
+                                                 const SDNA *newsdna,
+                                                 const char *compflags)
+{
+  DNA_ReconstructInfo *reconstruct_info = MEM_callocN(sizeof(*reconstruct_info), __func__);
+  reconstruct_info->oldsdna = oldsdna;
+  reconstruct_info->newsdna = newsdna;
+  reconstruct_info->compflags = compflags;
+  reconstruct_info->step_counts = MEM_calloc_arrayN(
+      oldsdna->structs_len, sizeof(*reconstruct_info->step_counts), __func__);
+  reconstruct_info->steps = MEM_calloc_arrayN(
+      oldsdna->structs_len, sizeof(*reconstruct_info->steps), __func__);
+
+  for (int old_struct_nr = 0; old_struct_nr < oldsdna->structs_len; old_struct_nr++) {
+    if (compflags[old_struct_nr] != SDNA_CMP_NOT_EQUAL) {
+      continue;
+    }
+    const char *type = oldsdna->types[oldsdna->structs[old_struct_nr][0]];
+    const int new_struct_nr = DNA_struct_find_nr(newsdna, type);
+    BLI_assert(new_struct_nr != -1);
+    reconstruct_info->steps[old_struct_nr] = create_reconstruct_steps(
+        oldsdna,
+        newsdna,
+        compflags,
+        old_struct_nr,
+        new_struct_nr,
+        &reconstruct_info->step_counts[old_struct_nr]);
+  }
+
+  return reconstruct_info;
+}
+
+void DNA_reconstruct_info_free(DNA_ReconstructInfo *reconstruct_info)
+{
+  for (int old_struct_nr = 0; old_struct_nr < reconstruct_info->oldsdna->structs_len;
+       old_struct_nr++) {
+    if (reconstruct_info->steps[old_struct_nr]) {
+      MEM_freeN(reconstruct_info->steps[old_struct_nr]);
+    }
+  }
+  MEM_freeN(reconstruct_info->steps);
+  MEM_freeN(reconstruct_info->step_counts);
+  MEM_freeN(reconstruct_info);
+}
+
+/**
+ * \param reconstruct_info: Result from #DNA_reconstruct_info_create,
+ * only read so blocks can be reconstructed from multiple threads.
+ * \param old_struct_nr: Index of struct info within oldsdna
  * \param blocks: The number of array elements
- * \param data: Array of struct data
+ * \param old_blocks: Array of struct data
  * \return An allocated reconstructed struct
  */
-void *DNA_struct_reconstruct(const SDNA *newsdna,
-                             const SDNA *oldsdna,
-                             const char *compflags,
-                             int oldSDNAnr,
+void *DNA_struct_reconstruct(const DNA_ReconstructInfo *reconstruct_info,
+                             int old_struct_nr,
                              int blocks,
-                             const void *data)
+                             const void *old_blocks)
 {
-  int a, curSDNAnr, curlen = 0, oldlen;
-  const short *spo, *spc;
-  char *cur, *cpc;
-  const char *cpo;
-  const char *type;
-
-  /* oldSDNAnr == structnr, we're looking for the corresponding 'cur' number */
-  spo = oldsdna->structs[oldSDNAnr];
-  type = oldsdna->types[spo[0]];
-  oldlen = oldsdna->types_size[spo[0]];
-  curSDNAnr = DNA_struct_find_nr(newsdna, type);
-
-  /* init data and alloc */
-  if (curSDNAnr != -1) {
-    spc = newsdna->structs[curSDNAnr];
-    curlen = newsdna->types_size[spc[0]];
-  }
-  if (curlen == 0) {
+  const SDNA *oldsdna = reconstruct_info->oldsdna;
+  const SDNA *newsdna = reconstruct_info->newsdna;
+
+  /* old_struct_nr == structnr, we're looking for the corresponding 'cur' number */
+  const short *old_struct = oldsdna->structs[old_struct_nr];
+  const char *type = oldsdna->types[old_struct[0]];
+  const int old_size = oldsdna->types_size[old_struct[0]];
+  const int new_struct_nr = DNA_struct_find_nr(newsdna, type);
+
+  if (new_struct_nr == -1) {
     return NULL;
   }
+  const int new_size = newsdna->types_size[newsdna->structs[new_struct_nr][0]];
+  if (new_size == 0) {
+    return NULL;
+  }
+
+  char *new_blocks = MEM_callocN(blocks * new_size, "reconstruct");
+  if (reconstruct_info->compflags[old_struct_nr] == SDNA_CMP_EQUAL) {
+    memcpy(new_blocks, old_blocks, blocks * old_size);
+    return new_blocks;
+  }
 
-  cur = MEM_callocN(blocks * curlen, "reconstruct");
-  cpc = cur;
-  cpo = data;
-  for (a = 0; a < blocks; a++) {
-    reconstruct_struct(newsdna, oldsdna, compflags, oldSDNAnr, cpo, curSDNAnr, cpc);
-    cpc += curlen;
-    cpo += oldlen;
+  const char *cpo = old_blocks;
+  char *cpc = new_blocks;
+  for (int a = 0; a < blocks; a++) {
+    reconstruct_struct(reconstruct_info, old_struct_nr, cpo, cpc);
+    cpc += new_size;
+    cpo += old_size;
   }
 
-  return cur;
+  return new_blocks;
 }
 
 /**
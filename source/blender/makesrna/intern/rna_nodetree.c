@@ -9446,6 +9446,20 @@ static void rna_def_composite_nodetree(BlenderRNA *brna)
   RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_GROUPNODE_BUFFER);
   RNA_def_property_ui_text(prop, "Buffer Groups", "Enable buffering of group nodes");
 
+  prop = RNA_def_property(srna, "use_buffer_execution", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_BUFFER_EXECUTION);
+  RNA_def_property_ui_text(prop,
+                           "Buffer Execution",
+                           "Calculate supported nodes on whole tiles at once instead of pixel by "
+                           "pixel");
+
+  prop = RNA_def_property(srna, "use_result_cache", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_RESULT_CACHE);
+  RNA_def_property_ui_text(prop,
+                           "Cache Results",
+                           "Keep the buffers of unchanged nodes between executions, to only "
+                           "recalculate the edited nodes");
+
   prop = RNA_def_property(srna, "use_two_pass", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_TWO_PASS);
   RNA_def_property_ui_text(prop,
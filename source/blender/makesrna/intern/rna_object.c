@@ -2539,6 +2539,13 @@ static void rna_def_object_game_settings(BlenderRNA *brna)
   RNA_def_property_boolean_negative_sdna(prop, NULL, "gameflag2", OB_NEVER_DO_ACTIVITY_CULLING);
   RNA_def_property_ui_text(prop, "Lock Z Rotation Axis", "Disable simulation of angular motion along the Z axis");
 
+  prop = RNA_def_property(srna, "use_static_instances", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "gameflag2", OB_STATIC_INSTANCES);
+  RNA_def_property_ui_text(prop,
+                           "Static Instances",
+                           "Draw the instanced collection as static instances shared with the "
+                           "other instancers of the collection, without game objects per instance");
+
   prop = RNA_def_property(srna, "use_material_physics_fh", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, NULL, "gameflag", OB_DO_FH);
   RNA_def_property_ui_text(prop, "Use Material Force Field", "React to force field physics settings in materials");
@@ -5361,6 +5361,44 @@ static void rna_def_scene_game_data(BlenderRNA *brna)
                            "Restrict the number of animation updates to the animation FPS (this is "
                            "better for performance, but can cause issues with smooth playback)");
 
+  prop = RNA_def_property(srna, "use_action_resampling", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", GAME_RESAMPLE_ACTIONS);
+  RNA_def_property_ui_text(prop, "Resample Actions",
+                           "Resample armature actions at the logic tic rate when the game starts "
+                           "(faster evaluation, but keys between samples are interpolated linearly)");
+
+  prop = RNA_def_property(srna, "use_pose_cache", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", GAME_USE_POSE_CACHE);
+  RNA_def_property_ui_text(prop, "Share Poses",
+                           "Evaluate armatures playing the same actions at the same frames only "
+                           "once per frame (bones modified outside of the actions are overwritten)");
+
+  prop = RNA_def_property(srna, "pose_cache_frame_step", PROP_FLOAT, PROP_NONE);
+  RNA_def_property_float_sdna(prop, NULL, "poseCacheFrameStep");
+  RNA_def_property_range(prop, 0.0f, 10.0f);
+  RNA_def_property_ui_range(prop, 0.0f, 2.0f, 10, 2);
+  RNA_def_property_ui_text(prop, "Pose Frame Step",
+                           "Round the action frames to this step before sharing poses, more "
+                           "armatures share a pose with a larger step (0 to share exact frames only)");
+
+  prop = RNA_def_property(srna, "use_flat_scenegraph", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", GAME_FLAT_SCENEGRAPH);
+  RNA_def_property_ui_text(prop, "Flat Scene Graph Update",
+                           "Update object transforms level by level over the whole hierarchy, "
+                           "updating large levels in parallel");
+
+  prop = RNA_def_property(srna, "use_proximity_queries", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", GAME_USE_PROXIMITY_QUERIES);
+  RNA_def_property_ui_text(prop, "Proximity Queries",
+                           "Evaluate Near and Radar sensors against the bounding boxes of actors "
+                           "in a spatial hash instead of creating a physics object per sensor");
+
+  prop = RNA_def_property(srna, "use_event_driven_sensors", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", GAME_EVENT_DRIVEN_SENSORS);
+  RNA_def_property_ui_text(prop, "Event Driven Sensors",
+                           "Only evaluate Always and Property sensors when a property changes, "
+                           "their controller links change or their pulse is due");
+
   /* materials */
   prop = RNA_def_property(srna, "material_mode", PROP_ENUM, PROP_NONE);
   RNA_def_property_enum_sdna(prop, NULL, "matmode");
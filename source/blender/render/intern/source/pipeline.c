@@ -397,6 +397,7 @@ void RE_SwapResult(Render *re, RenderResult **rr)
   /* for keeping render buffers */
   if (re) {
     SWAP(RenderResult *, re->result, *rr);
+    render_result_tag_changed();
   }
 }
 
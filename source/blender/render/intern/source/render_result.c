@@ -28,6 +28,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "BLI_utildefines.h"
 #include "BLI_ghash.h"
 #include "BLI_listbase.h"
@@ -81,12 +83,28 @@ static void render_result_views_free(RenderResult *res)
   res->have_combined = false;
 }
 
+/* Incremented when render results are created, modified or freed, so their address together
+ * with it identifies their content. */
+static uint32_t render_result_generation = 0;
+
+void render_result_tag_changed(void)
+{
+  atomic_add_and_fetch_uint32(&render_result_generation, 1);
+}
+
+unsigned int RE_GetResultGeneration(void)
+{
+  return atomic_fetch_and_add_uint32(&render_result_generation, 0);
+}
+
 void render_result_free(RenderResult *res)
 {
   if (res == NULL) {
     return;
   }
 
+  render_result_tag_changed();
+
   while (res->layers.first) {
     RenderLayer *rl = res->layers.first;
 
@@ -303,6 +321,7 @@ RenderResult *render_result_new(Render *re,
   }
 
   rr = MEM_callocN(sizeof(RenderResult), "new render result");
+  render_result_tag_changed();
   rr->rectx = rectx;
   rr->recty = recty;
   rr->renrect.xmin = 0;
@@ -750,6 +769,7 @@ RenderResult *render_result_new_from_exr(
   RenderResult *rr = MEM_callocN(sizeof(RenderResult), __func__);
   RenderLayer *rl;
   RenderPass *rpass;
+  render_result_tag_changed();
   const char *to_colorspace = IMB_colormanagement_role_colorspace_name_get(
       COLOR_ROLE_SCENE_LINEAR);
 
@@ -864,6 +884,8 @@ void render_result_merge(RenderResult *rr, RenderResult *rrpart)
   RenderLayer *rl, *rlp;
   RenderPass *rpass, *rpassp;
 
+  render_result_tag_changed();
+
   for (rl = rr->layers.first; rl; rl = rl->next) {
     rlp = RE_GetRenderLayer(rrpart, rl->name);
     if (rlp) {
@@ -1676,6 +1698,7 @@ static RenderView *duplicate_render_view(RenderView *rview)
 RenderResult *RE_DuplicateRenderResult(RenderResult *rr)
 {
   RenderResult *new_rr = MEM_mallocN(sizeof(RenderResult), "new duplicated render result");
+  render_result_tag_changed();
   *new_rr = *rr;
   new_rr->next = new_rr->prev = NULL;
   new_rr->layers.first = new_rr->layers.last = NULL;
@@ -1413,6 +1413,7 @@ static bool wm_file_write(bContext *C, const char *filepath, int fileflags, Repo
     }
 
     SET_FLAG_FROM_TEST(G.fileflags, fileflags & G_FILE_COMPRESS, G_FILE_COMPRESS);
+    SET_FLAG_FROM_TEST(G.fileflags, fileflags & G_FILE_COMPRESS_BLOCKS, G_FILE_COMPRESS_BLOCKS);
     SET_FLAG_FROM_TEST(G.fileflags, fileflags & G_FILE_AUTOPLAY, G_FILE_AUTOPLAY);
 
     /* prevent background mode scripts from clobbering history */
@@ -2547,6 +2548,11 @@ static void save_set_compress(wmOperator *op)
       RNA_property_boolean_set(op->ptr, prop, (U.flag & USER_FILECOMPRESS) != 0);
     }
   }
+
+  prop = RNA_struct_find_property(op->ptr, "compress_blocks");
+  if (!RNA_property_is_set(op->ptr, prop)) {
+    RNA_property_boolean_set(op->ptr, prop, (G.fileflags & G_FILE_COMPRESS_BLOCKS) != 0);
+  }
 }
 
 static void save_set_filepath(bContext *C, wmOperator *op)
@@ -2604,6 +2610,8 @@ static int wm_save_as_mainfile_exec(bContext *C, wmOperator *op)
 
   /* set compression flag */
   SET_FLAG_FROM_TEST(fileflags, RNA_boolean_get(op->ptr, "compress"), G_FILE_COMPRESS);
+  SET_FLAG_FROM_TEST(
+      fileflags, RNA_boolean_get(op->ptr, "compress_blocks"), G_FILE_COMPRESS_BLOCKS);
   SET_FLAG_FROM_TEST(fileflags, RNA_boolean_get(op->ptr, "relative_remap"), G_FILE_RELATIVE_REMAP);
   SET_FLAG_FROM_TEST(
       fileflags,
@@ -2668,6 +2676,12 @@ void WM_OT_save_as_mainfile(wmOperatorType *ot)
                                  FILE_DEFAULTDISPLAY,
                                  FILE_SORT_ALPHA);
   RNA_def_boolean(ot->srna, "compress", false, "Compress", "Write compressed .blend file");
+  RNA_def_boolean(ot->srna,
+                  "compress_blocks",
+                  false,
+                  "Block Compression",
+                  "Compress in independent blocks using all threads, faster to save and load "
+                  "but not readable by other versions");
   RNA_def_boolean(ot->srna,
                   "relative_remap",
                   true,
@@ -2740,6 +2754,12 @@ void WM_OT_save_mainfile(wmOperatorType *ot)
                                  FILE_DEFAULTDISPLAY,
                                  FILE_SORT_ALPHA);
   RNA_def_boolean(ot->srna, "compress", false, "Compress", "Write compressed .blend file");
+  RNA_def_boolean(ot->srna,
+                  "compress_blocks",
+                  false,
+                  "Block Compression",
+                  "Compress in independent blocks using all threads, faster to save and load "
+                  "but not readable by other versions");
   RNA_def_boolean(ot->srna,
                   "relative_remap",
                   false,
@@ -234,8 +234,10 @@ bool BL_ActionActuator::Update(double curtime)
 	{
 		CValue* oldprop = obj->GetProperty(m_framepropname);
 		CValue* newval = new CFloatValue(obj->GetActionFrame(m_layer));
-		if (oldprop)
+		if (oldprop) {
 			oldprop->SetValue(newval);
+			obj->WakePropertySensors();
+		}
 		else
 			obj->SetProperty(m_framepropname, newval);
 
@@ -0,0 +1,288 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Converter/BL_ActionData.cpp
+ *  \ingroup bgeconv
+ */
+
+#include "BL_ActionData.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#  include "BLI_utildefines.h"
+#  include "BLI_string.h"
+#  include "BKE_action.h"
+#  include "BKE_animsys.h"
+#  include "BKE_fcurve.h"
+#  include "DNA_action_types.h"
+#  include "DNA_anim_types.h"
+#  include "DNA_object_types.h"
+#  include "RNA_access.h"
+}
+
+static const struct {
+	const char *name;
+	BL_ActionData::TransformSlot slot;
+	unsigned short size;
+} transformProperties[] = {
+	{"location", BL_ActionData::SLOT_LOCATION, 3},
+	{"rotation_quaternion", BL_ActionData::SLOT_ROTATION_QUATERNION, 4},
+	{"rotation_euler", BL_ActionData::SLOT_ROTATION_EULER, 3},
+	{"rotation_axis_angle", BL_ActionData::SLOT_ROTATION_AXIS_ANGLE, 4},
+	{"scale", BL_ActionData::SLOT_SCALE, 3}
+};
+
+static std::atomic<unsigned int> actionDataCounter(0);
+
+/** Split a RNA path of the form pose.bones["name"].property.
+ * Return false if the path doesn't target a pose channel transform.
+ */
+static bool parse_pose_path(const char *path, std::string& r_channel, BL_ActionData::TransformSlot& r_slot, unsigned short& r_size)
+{
+	static const char prefix[] = "pose.bones[";
+	if (strncmp(path, prefix, sizeof(prefix) - 1) != 0) {
+		return false;
+	}
+
+	const char *end = strstr(path, "\"].");
+	if (!end) {
+		return false;
+	}
+
+	const char *property = end + 3;
+	for (const auto& info : transformProperties) {
+		if (STREQ(property, info.name)) {
+			char *name = BLI_str_quoted_substrN(path, prefix);
+			r_channel = name;
+			MEM_freeN(name);
+
+			r_slot = info.slot;
+			r_size = info.size;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static float *get_slot_pointer(bPoseChannel *pchan, BL_ActionData::TransformSlot slot, unsigned short index)
+{
+	switch (slot) {
+		case BL_ActionData::SLOT_LOCATION:
+			return &pchan->loc[index];
+		case BL_ActionData::SLOT_ROTATION_QUATERNION:
+			return &pchan->quat[index];
+		case BL_ActionData::SLOT_ROTATION_EULER:
+			return &pchan->eul[index];
+		case BL_ActionData::SLOT_ROTATION_AXIS_ANGLE:
+			// RNA stores the angle first, followed by the axis.
+			return (index == 0) ? &pchan->rotAngle : &pchan->rotAxis[index - 1];
+		case BL_ActionData::SLOT_SCALE:
+			return &pchan->size[index];
+		case BL_ActionData::SLOT_MAX:
+			break;
+	}
+
+	return nullptr;
+}
+
+BL_ActionData::Binding::Binding()
+	:m_data(nullptr),
+	m_dataId(0)
+{
+}
+
+BL_ActionData::BL_ActionData(bAction *action)
+	:m_action(action),
+	m_id(++actionDataCounter),
+	m_sampleStart(0.0f),
+	m_sampleStep(0.0f),
+	m_numSamples(0)
+{
+	for (FCurve *fcu = (FCurve *)action->curves.first; fcu; fcu = fcu->next) {
+		// Same skipping rules than animsys_evaluate_action.
+		if ((fcu->grp && (fcu->grp->flag & AGRP_MUTED)) || (fcu->flag & (FCURVE_MUTED | FCURVE_DISABLED)) ||
+			BKE_fcurve_is_empty(fcu) || !fcu->rna_path)
+		{
+			continue;
+		}
+
+		std::string name;
+		TransformSlot slot;
+		unsigned short size;
+		if (fcu->driver || !parse_pose_path(fcu->rna_path, name, slot, size) ||
+			fcu->array_index < 0 || fcu->array_index >= size)
+		{
+			m_genericTracks.push_back(fcu);
+			continue;
+		}
+
+		const std::vector<std::string>::iterator it = std::find(m_channelNames.begin(), m_channelNames.end(), name);
+		const unsigned int channel = it - m_channelNames.begin();
+		if (it == m_channelNames.end()) {
+			m_channelNames.push_back(name);
+		}
+
+		m_tracks.push_back({fcu, channel, slot, (unsigned short)fcu->array_index});
+	}
+
+	/* Keep the tracks of a same channel together, this way the evaluation writes
+	 * to the pose channels in order. The stable sort preserves the action order
+	 * of the curves writing to the same value. */
+	std::stable_sort(m_tracks.begin(), m_tracks.end(), [](const Track& a, const Track& b) {
+		return a.m_channel < b.m_channel;
+	});
+}
+
+BL_ActionData::~BL_ActionData()
+{
+}
+
+bAction *BL_ActionData::GetAction() const
+{
+	return m_action;
+}
+
+void BL_ActionData::Resample(float step)
+{
+	m_samples.clear();
+	m_numSamples = 0;
+	m_sampleStep = step;
+
+	if (step <= 0.0f || m_tracks.empty()) {
+		return;
+	}
+
+	float start;
+	float end;
+	calc_action_range(m_action, &start, &end, false);
+
+	m_sampleStart = start;
+	m_numSamples = (unsigned int)std::ceil((end - start) / step) + 1;
+	m_samples.resize(m_tracks.size() * m_numSamples);
+
+	for (unsigned int i = 0, size = m_tracks.size(); i < size; ++i) {
+		FCurve *fcu = m_tracks[i].m_fcurve;
+		float *samples = &m_samples[i * m_numSamples];
+		for (unsigned int j = 0; j < m_numSamples; ++j) {
+			samples[j] = evaluate_fcurve(fcu, start + step * j);
+		}
+	}
+}
+
+bool BL_ActionData::IsResampled() const
+{
+	return (m_numSamples > 0);
+}
+
+float BL_ActionData::SampleTrack(unsigned int index, float frame) const
+{
+	const float pos = (frame - m_sampleStart) / m_sampleStep;
+	// Outside of the sampled range the curve extrapolation is used.
+	if (pos < 0.0f || pos > (float)(m_numSamples - 1)) {
+		return evaluate_fcurve(m_tracks[index].m_fcurve, frame);
+	}
+
+	const float *samples = &m_samples[index * m_numSamples];
+	const unsigned int first = std::min((unsigned int)pos, m_numSamples - 1);
+	const unsigned int second = std::min(first + 1, m_numSamples - 1);
+	const float fac = pos - (float)first;
+
+	return samples[first] + (samples[second] - samples[first]) * fac;
+}
+
+void BL_ActionData::Bind(Object *ob, BL_ActionData::Binding& binding) const
+{
+	binding.m_data = this;
+	binding.m_dataId = m_id;
+	binding.m_destinations.resize(m_tracks.size());
+	binding.m_settings.resize(m_genericTracks.size());
+
+	std::vector<bPoseChannel *> channels(m_channelNames.size(), nullptr);
+	if (ob->pose) {
+		for (unsigned int i = 0, size = m_channelNames.size(); i < size; ++i) {
+			channels[i] = BKE_pose_channel_find_name(ob->pose, m_channelNames[i].c_str());
+		}
+	}
+
+	for (unsigned int i = 0, size = m_tracks.size(); i < size; ++i) {
+		const Track& track = m_tracks[i];
+		bPoseChannel *pchan = channels[track.m_channel];
+		binding.m_destinations[i] = pchan ? get_slot_pointer(pchan, track.m_slot, track.m_index) : nullptr;
+	}
+
+	PointerRNA ptrrna;
+	RNA_id_pointer_create(&ob->id, &ptrrna);
+	for (unsigned int i = 0, size = m_genericTracks.size(); i < size; ++i) {
+		FCurve *fcu = m_genericTracks[i];
+		std::pair<PathResolvedRNA, bool>& setting = binding.m_settings[i];
+		setting.second = BKE_animsys_store_rna_setting(&ptrrna, fcu->rna_path, fcu->array_index, &setting.first);
+	}
+}
+
+bool BL_ActionData::IsBound(const BL_ActionData::Binding& binding) const
+{
+	return (binding.m_data == this && binding.m_dataId == m_id);
+}
+
+void BL_ActionData::Evaluate(BL_ActionData::Binding& binding, float frame) const
+{
+	BLI_assert(IsBound(binding));
+
+	float *const *destinations = binding.m_destinations.data();
+	const Track *tracks = m_tracks.data();
+	if (IsResampled()) {
+		for (unsigned int i = 0, size = m_tracks.size(); i < size; ++i) {
+			if (destinations[i]) {
+				*destinations[i] = SampleTrack(i, frame);
+			}
+		}
+	}
+	else {
+		for (unsigned int i = 0, size = m_tracks.size(); i < size; ++i) {
+			if (destinations[i]) {
+				*destinations[i] = evaluate_fcurve(tracks[i].m_fcurve, frame);
+			}
+		}
+	}
+
+	EvaluateGeneric(binding, frame);
+}
+
+void BL_ActionData::EvaluateGeneric(BL_ActionData::Binding& binding, float frame) const
+{
+	BLI_assert(IsBound(binding));
+
+	for (unsigned int i = 0, size = m_genericTracks.size(); i < size; ++i) {
+		std::pair<PathResolvedRNA, bool>& setting = binding.m_settings[i];
+		if (setting.second) {
+			const float value = calculate_fcurve(&setting.first, m_genericTracks[i], frame);
+			BKE_animsys_write_rna_setting(&setting.first, value);
+		}
+	}
+}
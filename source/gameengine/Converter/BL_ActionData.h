@@ -0,0 +1,127 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file BL_ActionData.h
+ *  \ingroup bgeconv
+ */
+
+#ifndef __BL_ACTIONDATA_H__
+#define __BL_ACTIONDATA_H__
+
+#include <string>
+#include <vector>
+
+#include "RNA_types.h"
+
+struct bAction;
+struct FCurve;
+struct Object;
+
+/** Action compiled at conversion time into flat tracks.
+ * F-Curves animating pose channel transforms are grouped per channel and written
+ * through plain float pointers, the remaining F-Curves keep a resolved RNA path.
+ * Evaluation is then a loop over contiguous arrays without any RNA path lookup.
+ */
+class BL_ActionData
+{
+public:
+	/// Pose channel transform slots a compiled track can write to.
+	enum TransformSlot
+	{
+		SLOT_LOCATION = 0,
+		SLOT_ROTATION_QUATERNION,
+		SLOT_ROTATION_EULER,
+		SLOT_ROTATION_AXIS_ANGLE,
+		SLOT_SCALE,
+		SLOT_MAX
+	};
+
+	/** Destinations of the tracks of an action for one armature object.
+	 * A binding is only valid while the pose channels of the object are not rebuilt.
+	 */
+	struct Binding
+	{
+		const BL_ActionData *m_data;
+		/// Identifier of m_data, a freed action data can be reallocated at the same address.
+		unsigned int m_dataId;
+		/// Destination of each pose track, nullptr when the channel doesn't exist.
+		std::vector<float *> m_destinations;
+		/// Resolved RNA setting of each generic track, the boolean is false for invalid paths.
+		std::vector<std::pair<PathResolvedRNA, bool> > m_settings;
+
+		Binding();
+	};
+
+private:
+	struct Track
+	{
+		FCurve *m_fcurve;
+		/// Index of the pose channel in m_channelNames.
+		unsigned int m_channel;
+		TransformSlot m_slot;
+		unsigned short m_index;
+	};
+
+	bAction *m_action;
+	/// Unique identifier among all the action data ever allocated.
+	const unsigned int m_id;
+
+	/// Names of the pose channels animated by the action.
+	std::vector<std::string> m_channelNames;
+	/// Pose transform tracks, ordered by channel.
+	std::vector<Track> m_tracks;
+	/// F-Curves not animating a pose transform (custom properties, bbone...), evaluated through RNA.
+	std::vector<FCurve *> m_genericTracks;
+
+	/// Resampled values of the pose tracks, track major, empty when not resampled.
+	std::vector<float> m_samples;
+	float m_sampleStart;
+	float m_sampleStep;
+	unsigned int m_numSamples;
+
+	float SampleTrack(unsigned int index, float frame) const;
+
+public:
+	BL_ActionData(bAction *action);
+	~BL_ActionData();
+
+	bAction *GetAction() const;
+
+	/** Resample all the pose tracks at a fixed frame step.
+	 * Frames inside the action range are then interpolated linearly between samples
+	 * instead of evaluating the F-Curves.
+	 * \param step The frame step, a step of zero disables resampling.
+	 */
+	void Resample(float step);
+	bool IsResampled() const;
+
+	/// Resolve the destination of every track for an armature object.
+	void Bind(Object *ob, Binding& binding) const;
+	/// Return true if the binding was resolved by this action data.
+	bool IsBound(const Binding& binding) const;
+	/// Write the action values at the given frame through a binding.
+	void Evaluate(Binding& binding, float frame) const;
+	/// Write only the values of the F-Curves not animating a pose transform.
+	void EvaluateGeneric(Binding& binding, float frame) const;
+};
+
+#endif  // __BL_ACTIONDATA_H__
@@ -39,10 +39,8 @@
 #include "BKE_global.h"
 #include "BKE_constraint.h"
 #include "DNA_armature_types.h"
-#include "RNA_access.h"
 
 extern "C" {
-#  include "BKE_animsys.h"
 #  include "BKE_main.h"
 #  include "BKE_layer.h"
 #  include "BKE_lib_id.h"
@@ -145,69 +143,6 @@ static void game_copy_pose(bPose **dst, bPose *src, int copy_constraint)
 	*dst = out;
 }
 
-// Only allowed for Poses with identical channels.
-static void game_blend_poses(bPose *dst, bPose *src, float srcweight, short mode)
-{
-	float dstweight;
-
-	if (mode == BL_Action::ACT_BLEND_BLEND) {
-		dstweight = 1.0f - srcweight;
-	}
-	else if (mode == BL_Action::ACT_BLEND_ADD) {
-		dstweight = 1.0f;
-	}
-	else {
-		dstweight = 1.0f;
-	}
-
-	bPoseChannel *schan = (bPoseChannel *)src->chanbase.first;
-	for (bPoseChannel *dchan = (bPoseChannel *)dst->chanbase.first; dchan; dchan = (bPoseChannel *)dchan->next, schan = (bPoseChannel *)schan->next) {
-		// always blend on all channels since we don't know which one has been set
-		/* quat interpolation done separate */
-		if (schan->rotmode == ROT_MODE_QUAT) {
-			float dquat[4], squat[4];
-
-			copy_qt_qt(dquat, dchan->quat);
-			copy_qt_qt(squat, schan->quat);
-			// Normalize quaternions so that interpolation/multiplication result is correct.
-			normalize_qt(dquat);
-			normalize_qt(squat);
-
-			if (mode == BL_Action::ACT_BLEND_BLEND) {
-				interp_qt_qtqt(dchan->quat, dquat, squat, srcweight);
-			}
-			else {
-				pow_qt_fl_normalized(squat, srcweight);
-				mul_qt_qtqt(dchan->quat, dquat, squat);
-			}
-
-			normalize_qt(dchan->quat);
-		}
-
-		for (unsigned short i = 0; i < 3; i++) {
-			/* blending for loc and scale are pretty self-explanatory... */
-			dchan->loc[i] = (dchan->loc[i] * dstweight) + (schan->loc[i] * srcweight);
-			dchan->size[i] = 1.0f + ((dchan->size[i] - 1.0f) * dstweight) + ((schan->size[i] - 1.0f) * srcweight);
-
-			/* euler-rotation interpolation done here instead... */
-			// FIXME: are these results decent?
-			if (schan->rotmode) {
-				dchan->eul[i] = (dchan->eul[i] * dstweight) + (schan->eul[i] * srcweight);
-			}
-		}
-		for (bConstraint *dcon = (bConstraint *)dchan->constraints.first, *scon = (bConstraint *)schan->constraints.first;
-		     dcon && scon;
-		     dcon = dcon->next, scon = scon->next)
-		{
-			/* no 'add' option for constraint blending */
-			dcon->enforce = dcon->enforce * (1.0f - srcweight) + scon->enforce * srcweight;
-		}
-	}
-
-	/* this pose is now in src time */
-	dst->ctime = src->ctime;
-}
-
 BL_ArmatureObject::BL_ArmatureObject(void *sgReplicationInfo,
                                      SG_Callbacks callbacks,
                                      Object *armature,
@@ -234,6 +169,8 @@ BL_ArmatureObject::BL_ArmatureObject(void *sgReplicationInfo,
 	// need this to get iTaSC working ok in the BGE
 	//m_pose->flag |= POSE_GAME_ENGINE;
 	memcpy(m_obmat, m_objArma->obmat, sizeof(m_obmat));
+
+	InitChannelArrays();
 }
 
 BL_ArmatureObject::~BL_ArmatureObject()
@@ -250,6 +187,23 @@ BL_ArmatureObject::~BL_ArmatureObject()
 	//}
 }
 
+void BL_ArmatureObject::InitChannelArrays()
+{
+	m_channelArray.clear();
+	m_constraintArray.clear();
+
+	if (!m_pose) {
+		return;
+	}
+
+	for (bPoseChannel *pchan = (bPoseChannel *)m_pose->chanbase.first; pchan; pchan = pchan->next) {
+		m_channelArray.push_back(pchan);
+		for (bConstraint *con = (bConstraint *)pchan->constraints.first; con; con = con->next) {
+			m_constraintArray.push_back(con);
+		}
+	}
+}
+
 void BL_ArmatureObject::LoadConstraints(KX_BlenderSceneConverter& converter)
 {
 	// first delete any existing constraint (should not have any)
@@ -395,6 +349,8 @@ void BL_ArmatureObject::ProcessReplica()
 
 	m_objArma = m_pBlenderObject;
 	m_pose = m_objArma->pose;
+
+	InitChannelArrays();
 }
 
 int BL_ArmatureObject::GetGameObjectType() const
@@ -463,19 +419,94 @@ void BL_ArmatureObject::SetPose(bPose *pose)
 	m_lastapplyframe = -1.0;
 }
 
-void BL_ArmatureObject::SetPoseByAction(bAction *action, float localtime)
+void BL_ArmatureObject::SetPose(const BL_PoseTransforms& pose)
 {
-	Object *arm = GetArmatureObject();
+	BLI_assert(pose.m_channels.size() == m_channelArray.size());
 
-	PointerRNA ptrrna;
-	RNA_id_pointer_create(&arm->id, &ptrrna);
+	const BL_PoseTransforms::Channel *schan = pose.m_channels.data();
+	for (bPoseChannel *pchan : m_channelArray) {
+		copy_v3_v3(pchan->loc, schan->m_loc);
+		copy_v3_v3(pchan->size, schan->m_size);
+		copy_v3_v3(pchan->eul, schan->m_eul);
+		copy_qt_qt(pchan->quat, schan->m_quat);
+		copy_v3_v3(pchan->rotAxis, schan->m_rotAxis);
+		pchan->rotAngle = schan->m_rotAngle;
+		++schan;
+	}
+
+	for (unsigned int i = 0, size = m_constraintArray.size(); i < size; ++i) {
+		m_constraintArray[i]->enforce = pose.m_constraintInfluences[i];
+	}
 
-	animsys_evaluate_action(&ptrrna, action, localtime, false);
+	m_lastapplyframe = -1.0;
+}
+
+void BL_ArmatureObject::BindAction(const BL_ActionData& data, BL_ActionData::Binding& binding)
+{
+	data.Bind(m_objArma, binding);
 }
 
-void BL_ArmatureObject::BlendInPose(bPose *blend_pose, float weight, short mode)
+void BL_ArmatureObject::SetPoseByAction(const BL_ActionData& data, BL_ActionData::Binding& binding, float localtime)
 {
-	game_blend_poses(m_pose, blend_pose, weight, mode);
+	data.Evaluate(binding, localtime);
+}
+
+// Only allowed for poses with identical channels.
+void BL_ArmatureObject::BlendInPose(const BL_PoseTransforms& blend_pose, float weight, short mode)
+{
+	const float srcweight = weight;
+	// Only the blend mode reduces the weight of the current pose.
+	const float dstweight = (mode == BL_Action::ACT_BLEND_BLEND) ? 1.0f - srcweight : 1.0f;
+
+	BLI_assert(blend_pose.m_channels.size() == m_channelArray.size());
+
+	const BL_PoseTransforms::Channel *schan = blend_pose.m_channels.data();
+	bPoseChannel *const *channels = m_channelArray.data();
+	for (unsigned int i = 0, size = m_channelArray.size(); i < size; ++i, ++schan) {
+		bPoseChannel *dchan = channels[i];
+		// always blend on all channels since we don't know which one has been set
+		/* quat interpolation done separate */
+		if (schan->m_rotmode == ROT_MODE_QUAT) {
+			float dquat[4], squat[4];
+
+			copy_qt_qt(dquat, dchan->quat);
+			copy_qt_qt(squat, schan->m_quat);
+			// Normalize quaternions so that interpolation/multiplication result is correct.
+			normalize_qt(dquat);
+			normalize_qt(squat);
+
+			if (mode == BL_Action::ACT_BLEND_BLEND) {
+				interp_qt_qtqt(dchan->quat, dquat, squat, srcweight);
+			}
+			else {
+				pow_qt_fl_normalized(squat, srcweight);
+				mul_qt_qtqt(dchan->quat, dquat, squat);
+			}
+
+			normalize_qt(dchan->quat);
+		}
+
+		for (unsigned short j = 0; j < 3; j++) {
+			/* blending for loc and scale are pretty self-explanatory... */
+			dchan->loc[j] = (dchan->loc[j] * dstweight) + (schan->m_loc[j] * srcweight);
+			dchan->size[j] = 1.0f + ((dchan->size[j] - 1.0f) * dstweight) + ((schan->m_size[j] - 1.0f) * srcweight);
+
+			/* euler-rotation interpolation done here instead... */
+			// FIXME: are these results decent?
+			if (schan->m_rotmode) {
+				dchan->eul[j] = (dchan->eul[j] * dstweight) + (schan->m_eul[j] * srcweight);
+			}
+		}
+	}
+
+	BLI_assert(blend_pose.m_constraintInfluences.size() == m_constraintArray.size());
+
+	const float *influences = blend_pose.m_constraintInfluences.data();
+	for (unsigned int i = 0, size = m_constraintArray.size(); i < size; ++i) {
+		bConstraint *dcon = m_constraintArray[i];
+		/* no 'add' option for constraint blending */
+		dcon->enforce = dcon->enforce * (1.0f - srcweight) + influences[i] * srcweight;
+	}
 }
 
 bool BL_ArmatureObject::UpdateTimestep(double curtime)
@@ -539,6 +570,28 @@ void BL_ArmatureObject::GetPose(bPose **pose)
 	}
 }
 
+void BL_ArmatureObject::GetPose(BL_PoseTransforms& pose) const
+{
+	pose.m_channels.resize(m_channelArray.size());
+	pose.m_constraintInfluences.resize(m_constraintArray.size());
+
+	BL_PoseTransforms::Channel *dchan = pose.m_channels.data();
+	for (const bPoseChannel *pchan : m_channelArray) {
+		copy_v3_v3(dchan->m_loc, pchan->loc);
+		copy_v3_v3(dchan->m_size, pchan->size);
+		copy_v3_v3(dchan->m_eul, pchan->eul);
+		copy_qt_qt(dchan->m_quat, pchan->quat);
+		copy_v3_v3(dchan->m_rotAxis, pchan->rotAxis);
+		dchan->m_rotAngle = pchan->rotAngle;
+		dchan->m_rotmode = pchan->rotmode;
+		++dchan;
+	}
+
+	for (unsigned int i = 0, size = m_constraintArray.size(); i < size; ++i) {
+		pose.m_constraintInfluences[i] = m_constraintArray[i]->enforce;
+	}
+}
+
 bPose *BL_ArmatureObject::GetOrigPose()
 {
 	return m_pose;
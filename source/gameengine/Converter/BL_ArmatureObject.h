@@ -35,6 +35,8 @@
 #include "KX_GameObject.h"
 #include "BL_ArmatureConstraint.h"
 #include "BL_ArmatureChannel.h"
+#include "BL_ActionData.h"
+#include "BL_PoseTransforms.h"
 
 struct bArmature;
 struct Bone;
@@ -58,6 +60,10 @@ protected:
 	Object *m_origObjArma;
 	bPose *m_pose;
 	bPose *m_armpose;
+	/// Pose channels of m_pose in list order, used for the pose blending.
+	std::vector<bPoseChannel *> m_channelArray;
+	/// Constraints of all the pose channels in m_pose, in channel order.
+	std::vector<bConstraint *> m_constraintArray;
 	// Need for BKE_pose_where_is.
 	Scene *m_scene;
 	double m_lastframe;
@@ -73,6 +79,8 @@ protected:
 
 	double m_lastapplyframe;
 
+	void InitChannelArrays();
+
 public:
 	BL_ArmatureObject(void *sgReplicationInfo,
 	                  SG_Callbacks callbacks,
@@ -91,12 +99,18 @@ public:
 	double GetLastFrame();
 
 	void GetPose(bPose **pose);
+	/// Copy the pose channel transforms into a flat buffer.
+	void GetPose(BL_PoseTransforms& pose) const;
 	void SetPose(bPose *pose);
+	/// Copy a flat buffer into the pose channel transforms.
+	void SetPose(const BL_PoseTransforms& pose);
 	/// Never edit this, only for accessing names.
 	bPose *GetOrigPose();
 	void ApplyPose();
-	void SetPoseByAction(bAction *action, float localtime);
-	void BlendInPose(bPose *blend_pose, float weight, short mode);
+	/// Bind the tracks of a compiled action to the pose channels.
+	void BindAction(const BL_ActionData& data, BL_ActionData::Binding& binding);
+	void SetPoseByAction(const BL_ActionData& data, BL_ActionData::Binding& binding, float localtime);
+	void BlendInPose(const BL_PoseTransforms& blend_pose, float weight, short mode);
 	void RestorePose();
 
 	bool UpdateTimestep(double curtime);
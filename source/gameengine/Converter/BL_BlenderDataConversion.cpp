@@ -106,6 +106,7 @@
 
 #include "KX_KetsjiEngine.h"
 #include "KX_BlenderSceneConverter.h"
+#include "BL_ActionData.h"
 
 #include "KX_Globals.h"
 #include "KX_PyConstraintBinding.h"
@@ -1314,11 +1315,17 @@ void BL_ConvertBlenderObjects(struct Main* maggie,
 	
 	CListValue<KX_GameObject> *logicbrick_conversionlist = new CListValue<KX_GameObject>();
 
-	// Convert actions to actionmap
+	// Convert actions to actionmap and compile them for the armature evaluation.
+	const float actionSampleStep = ketsjiEngine->GetFlag(KX_KetsjiEngine::RESAMPLE_ACTIONS) ?
+		(float)(ketsjiEngine->GetAnimFrameRate() / ketsjiEngine->GetTicRate()) : 0.0f;
 	bAction *curAct;
 	for (curAct = (bAction*)maggie->actions.first; curAct; curAct=(bAction*)curAct->id.next)
 	{
 		logicmgr->RegisterActionName(curAct->id.name + 2, curAct);
+
+		BL_ActionData *actionData = new BL_ActionData(curAct);
+		actionData->Resample(actionSampleStep);
+		converter.RegisterActionData(actionData, curAct);
 	}
 
 	blenderSceneSetBackground(blenderscene);
@@ -0,0 +1,53 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file BL_PoseTransforms.h
+ *  \ingroup bgeconv
+ */
+
+#ifndef __BL_POSETRANSFORMS_H__
+#define __BL_POSETRANSFORMS_H__
+
+#include <vector>
+
+/** Snapshot of the pose channel transforms of an armature, stored contiguously
+ * in the pose channel order. Used to blend poses without walking the pose channel lists.
+ */
+struct BL_PoseTransforms
+{
+	struct Channel
+	{
+		float m_loc[3];
+		float m_size[3];
+		float m_eul[3];
+		float m_quat[4];
+		float m_rotAxis[3];
+		float m_rotAngle;
+		short m_rotmode;
+	};
+
+	std::vector<Channel> m_channels;
+	/// Influence of every pose channel constraint, in the pose channel order.
+	std::vector<float> m_constraintInfluences;
+};
+
+#endif  // __BL_POSETRANSFORMS_H__
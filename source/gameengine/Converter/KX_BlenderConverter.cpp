@@ -42,6 +42,7 @@
 #include "KX_PythonInit.h" // So we can handle adding new text datablocks for Python to import
 #include "KX_LibLoadStatus.h"
 #include "KX_BlenderScalarInterpolator.h"
+#include "BL_ActionData.h"
 #include "KX_BlenderConverter.h"
 #include "KX_BlenderSceneConverter.h"
 #include "BL_BlenderDataConversion.h"
@@ -107,7 +108,11 @@ void KX_BlenderConverter::SceneSlot::Merge(KX_BlenderConverter::SceneSlot& other
 	m_meshobjects.insert(m_meshobjects.begin(),
 						 std::make_move_iterator(other.m_meshobjects.begin()),
 						 std::make_move_iterator(other.m_meshobjects.end()));
+	m_actionData.insert(m_actionData.begin(),
+						std::make_move_iterator(other.m_actionData.begin()),
+						std::make_move_iterator(other.m_actionData.end()));
 	m_actionToInterp.insert(other.m_actionToInterp.begin(), other.m_actionToInterp.end());
+	m_actionToData.insert(other.m_actionToData.begin(), other.m_actionToData.end());
 }
 
 void KX_BlenderConverter::SceneSlot::Merge(const KX_BlenderSceneConverter& converter)
@@ -118,6 +123,10 @@ void KX_BlenderConverter::SceneSlot::Merge(const KX_BlenderSceneConverter& conve
 	for (RAS_MeshObject *meshobj : converter.m_meshobjects) {
 		m_meshobjects.emplace_back(meshobj);
 	}
+	for (BL_ActionData *data : converter.m_actions) {
+		m_actionData.emplace_back(data);
+		m_actionToData[data->GetAction()] = data;
+	}
 }
 
 KX_BlenderConverter::KX_BlenderConverter(Main *maggie, KX_KetsjiEngine *engine)
@@ -286,6 +295,32 @@ BL_InterpolatorList *KX_BlenderConverter::FindInterpolatorList(KX_Scene *scene,
 	return m_sceneSlots[scene].m_actionToInterp[for_act];
 }
 
+void KX_BlenderConverter::RegisterActionData(KX_Scene *scene, BL_ActionData *data, bAction *for_act)
+{
+	SceneSlot& sceneSlot = m_sceneSlots[scene];
+	sceneSlot.m_actionData.emplace_back(data);
+	sceneSlot.m_actionToData[for_act] = data;
+}
+
+BL_ActionData *KX_BlenderConverter::FindActionData(KX_Scene *scene, bAction *for_act)
+{
+	return m_sceneSlots[scene].m_actionToData[for_act];
+}
+
+BL_ActionData *KX_BlenderConverter::GetActionData(KX_Scene *scene, bAction *for_act)
+{
+	BL_ActionData *data = FindActionData(scene, for_act);
+	if (!data) {
+		data = new BL_ActionData(for_act);
+		if (m_ketsjiEngine->GetFlag(KX_KetsjiEngine::RESAMPLE_ACTIONS)) {
+			data->Resample((float)(m_ketsjiEngine->GetAnimFrameRate() / m_ketsjiEngine->GetTicRate()));
+		}
+		RegisterActionData(scene, data, for_act);
+	}
+
+	return data;
+}
+
 Main *KX_BlenderConverter::CreateMainDynamic(const std::string& path)
 {
 	Main *maggie = BKE_main_new();
@@ -711,6 +746,17 @@ bool KX_BlenderConverter::FreeBlendFile(Main *maggie)
 			}
 		}
 
+		for (UniquePtrList<BL_ActionData>::iterator it = sceneSlot.m_actionData.begin(); it != sceneSlot.m_actionData.end(); ) {
+			bAction *action = (*it)->GetAction();
+			if (IS_TAGGED(action)) {
+				sceneSlot.m_actionToData.erase(action);
+				it = sceneSlot.m_actionData.erase(it);
+			}
+			else {
+				++it;
+			}
+		}
+
 		for (UniquePtrList<RAS_MeshObject>::iterator it =  sceneSlot.m_meshobjects.begin(); it !=  sceneSlot.m_meshobjects.end(); ) {
 			RAS_MeshObject *mesh = (*it).get();
 			if (IS_TAGGED(mesh->GetOrigMesh())) {
@@ -40,6 +40,7 @@
 #  include "RAS_MeshObject.h"
 
 #  include "KX_BlenderScalarInterpolator.h"
+#  include "BL_ActionData.h"
 #endif
 
 #include "CM_Thread.h"
@@ -50,6 +51,7 @@ class KX_KetsjiEngine;
 class KX_LibLoadStatus;
 class KX_BlenderMaterial;
 class BL_InterpolatorList;
+class BL_ActionData;
 class SCA_IActuator;
 class SCA_IController;
 class RAS_MeshObject;
@@ -77,8 +79,10 @@ private:
 		UniquePtrList<KX_BlenderMaterial> m_materials;
 		UniquePtrList<RAS_MeshObject> m_meshobjects;
 		UniquePtrList<BL_InterpolatorList> m_interpolators;
+		UniquePtrList<BL_ActionData> m_actionData;
 
 		std::map<bAction *, BL_InterpolatorList *> m_actionToInterp;
+		std::map<bAction *, BL_ActionData *> m_actionToData;
 
 		SceneSlot();
 		SceneSlot(const KX_BlenderSceneConverter& converter);
@@ -121,6 +125,11 @@ public:
 	void RegisterInterpolatorList(KX_Scene *scene, BL_InterpolatorList *interpolator, bAction *for_act);
 	BL_InterpolatorList *FindInterpolatorList(KX_Scene *scene, bAction *for_act);
 
+	void RegisterActionData(KX_Scene *scene, BL_ActionData *data, bAction *for_act);
+	BL_ActionData *FindActionData(KX_Scene *scene, bAction *for_act);
+	/// Return the compiled action, compile it if it was not done at conversion (e.g for libloaded actions).
+	BL_ActionData *GetActionData(KX_Scene *scene, bAction *for_act);
+
 	Scene *GetBlenderSceneForName(const std::string& name);
 	CListValue<CStringValue> *GetInactiveSceneNames();
 
@@ -85,6 +85,17 @@ KX_BlenderMaterial *KX_BlenderSceneConverter::FindMaterial(Material *mat)
 	return m_map_mesh_to_polyaterial[mat];
 }
 
+void KX_BlenderSceneConverter::RegisterActionData(BL_ActionData *data, bAction *for_action)
+{
+	m_map_action_to_actiondata[for_action] = data;
+	m_actions.push_back(data);
+}
+
+BL_ActionData *KX_BlenderSceneConverter::FindActionData(bAction *for_action)
+{
+	return m_map_action_to_actiondata[for_action];
+}
+
 void KX_BlenderSceneConverter::RegisterGameActuator(SCA_IActuator *act, bActuator *for_actuator)
 {
 	m_map_blender_to_gameactuator[for_actuator] = act;
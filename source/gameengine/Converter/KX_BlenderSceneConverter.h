@@ -45,12 +45,14 @@ class KX_BlenderConverter;
 class KX_GameObject;
 class KX_Scene;
 class KX_LibLoadStatus;
+class BL_ActionData;
 struct Main;
 struct BlendHandle;
 struct Object;
 struct Scene;
 struct Mesh;
 struct Material;
+struct bAction;
 struct bActuator;
 struct bController;
 
@@ -61,10 +63,12 @@ class KX_BlenderSceneConverter
 private:
 	std::vector<KX_BlenderMaterial *> m_materials;
 	std::vector<RAS_MeshObject *> m_meshobjects;
+	std::vector<BL_ActionData *> m_actions;
 
 	std::map<Object *, KX_GameObject *> m_map_blender_to_gameobject;
 	std::map<Mesh *, RAS_MeshObject *> m_map_mesh_to_gamemesh;
 	std::map<Material *, KX_BlenderMaterial *> m_map_mesh_to_polyaterial;
+	std::map<bAction *, BL_ActionData *> m_map_action_to_actiondata;
 	std::map<bActuator *, SCA_IActuator *> m_map_blender_to_gameactuator;
 	std::map<bController *, SCA_IController *> m_map_blender_to_gamecontroller;
 
@@ -85,6 +89,9 @@ public:
 	void RegisterMaterial(KX_BlenderMaterial *blmat, Material *mat);
 	KX_BlenderMaterial *FindMaterial(Material *mat);
 
+	void RegisterActionData(BL_ActionData *data, bAction *for_action);
+	BL_ActionData *FindActionData(bAction *for_action);
+
 	void RegisterGameActuator(SCA_IActuator *act, bActuator *for_actuator);
 	SCA_IActuator *FindGameActuator(bActuator *for_actuator);
 
@@ -225,7 +225,9 @@ void BL_ConvertSensors(struct Object* blenderobject,
 						float radius = blendernearsensor->dist;
 						const MT_Vector3& wpos = gameobj->NodeGetWorldPosition();
 						bool bFindMaterial = false;
-						PHY_IPhysicsController* physCtrl = kxscene->GetPhysicsEnvironment()->CreateSphereController(radius,wpos);
+						// The proximity manager replaces the physics object when enabled.
+						PHY_IPhysicsController* physCtrl = kxscene->GetProximityManager() ? nullptr :
+							kxscene->GetPhysicsEnvironment()->CreateSphereController(radius,wpos);
 
 						//will be done in KX_CollisionEventManager::RegisterSensor()
 						//if (isInActiveLayer)
@@ -451,7 +453,8 @@ void BL_ConvertSensors(struct Object* blenderobject,
 						MT_Scalar largemargin = 0.0;
 
 						bool bFindMaterial = false;
-						PHY_IPhysicsController* ctrl = kxscene->GetPhysicsEnvironment()->CreateConeController((float)coneradius, (float)coneheight);
+						PHY_IPhysicsController* ctrl = kxscene->GetProximityManager() ? nullptr :
+							kxscene->GetPhysicsEnvironment()->CreateConeController((float)coneradius, (float)coneheight);
 
 						gamesensor = new SCA_RadarSensor(
 							eventmgr,
@@ -97,6 +97,12 @@ bool SCA_AlwaysSensor::Evaluate()
 	return result;
 }
 
+bool SCA_AlwaysSensor::CanSleep()
+{
+	// Only the pulses trigger the controllers after the first evaluation.
+	return !m_alwaysresult;
+}
+
 #ifdef WITH_PYTHON
 
 /* ------------------------------------------------------------------------- */
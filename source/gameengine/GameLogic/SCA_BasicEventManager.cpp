@@ -38,8 +38,10 @@
 #include "SCA_LogicManager.h"
 #include "SCA_ISensor.h"
 
-SCA_BasicEventManager::SCA_BasicEventManager(class SCA_LogicManager* logicmgr)
-	: SCA_EventManager(logicmgr, BASIC_EVENTMGR)
+SCA_BasicEventManager::SCA_BasicEventManager(class SCA_LogicManager* logicmgr, bool eventDriven)
+	: SCA_EventManager(logicmgr, BASIC_EVENTMGR),
+	m_eventDriven(eventDriven),
+	m_frame(0)
 {
 }
 
@@ -49,8 +51,124 @@ SCA_BasicEventManager::~SCA_BasicEventManager()
 
 void SCA_BasicEventManager::NextFrame()
 {
-	for (SCA_ISensor *sensor : m_sensors) {
+	if (!m_eventDriven) {
+		for (SCA_ISensor *sensor : m_sensors) {
+			sensor->Activate(m_logicmgr);
+		}
+		return;
+	}
+
+	++m_frame;
+
+	// Wake up the sensors sending a pulse this frame.
+	while (!m_timers.empty() && m_timers.begin()->first <= m_frame) {
+		SCA_ISensor *sensor = m_timers.begin()->second;
+		m_timers.erase(m_timers.begin());
+		sensor->m_wakeFrame = 0;
+		WakeSensor(sensor);
+	}
+
+	/* The sensors woken up by the controllers and actuators of this frame are evaluated
+	 * on the next frame, as they would be when all the sensors are polled. */
+	m_activeSensors.swap(m_awakeSensors);
+	m_awakeSensors.clear();
+
+	for (SCA_ISensor *sensor : m_activeSensors) {
+		if (sensor->m_sleepFrame != 0) {
+			sensor->SkipTicks(m_frame - sensor->m_sleepFrame - 1);
+			sensor->m_sleepFrame = 0;
+		}
+
 		sensor->Activate(m_logicmgr);
+
+		if (sensor->IsIdle()) {
+			SleepSensor(sensor);
+		}
+		else {
+			m_awakeSensors.push_back(sensor);
+		}
+	}
+
+	m_activeSensors.clear();
+}
+
+bool SCA_BasicEventManager::RegisterSensor(SCA_ISensor *sensor)
+{
+	if (!SCA_EventManager::RegisterSensor(sensor)) {
+		return false;
+	}
+
+	if (m_eventDriven) {
+		sensor->m_sleeping = false;
+		sensor->m_sleepFrame = 0;
+		m_awakeSensors.push_back(sensor);
+	}
+
+	return true;
+}
+
+bool SCA_BasicEventManager::RemoveSensor(SCA_ISensor *sensor)
+{
+	if (!SCA_EventManager::RemoveSensor(sensor)) {
+		return false;
 	}
+
+	if (m_eventDriven) {
+		if (sensor->m_sleeping) {
+			RemoveTimer(sensor);
+			sensor->m_sleeping = false;
+			sensor->m_sleepFrame = 0;
+		}
+		else {
+			std::vector<SCA_ISensor *>::iterator it = std::find(m_awakeSensors.begin(), m_awakeSensors.end(), sensor);
+			if (it != m_awakeSensors.end()) {
+				m_awakeSensors.erase(it);
+			}
+		}
+	}
+
+	return true;
+}
+
+void SCA_BasicEventManager::WakeSensor(SCA_ISensor *sensor)
+{
+	if (!sensor->m_sleeping) {
+		return;
+	}
+
+	RemoveTimer(sensor);
+	sensor->m_sleeping = false;
+	m_awakeSensors.push_back(sensor);
+}
+
+void SCA_BasicEventManager::SleepSensor(SCA_ISensor *sensor)
+{
+	sensor->m_sleeping = true;
+	// The pulse ticks don't change while the sensor is suspended.
+	sensor->m_sleepFrame = sensor->IsSuspended() ? 0 : m_frame;
+
+	const int ticks = sensor->GetPulseTicks();
+	if (ticks > 0) {
+		sensor->m_wakeFrame = m_frame + ticks;
+		m_timers.emplace(sensor->m_wakeFrame, sensor);
+	}
+}
+
+void SCA_BasicEventManager::RemoveTimer(SCA_ISensor *sensor)
+{
+	if (sensor->m_wakeFrame == 0) {
+		return;
+	}
+
+	const std::pair<std::multimap<unsigned int, SCA_ISensor *>::iterator,
+		std::multimap<unsigned int, SCA_ISensor *>::iterator> range = m_timers.equal_range(sensor->m_wakeFrame);
+	for (std::multimap<unsigned int, SCA_ISensor *>::iterator it = range.first; it != range.second; ++it) {
+		if (it->second == sensor) {
+			m_timers.erase(it);
+			break;
+		}
+	}
+
+	sensor->m_wakeFrame = 0;
 }
 
@@ -37,13 +37,40 @@
 
 #include "SCA_EventManager.h"
 
+#include <map>
+
+/** Manager evaluating the sensors without dedicated events.
+ *
+ * In event driven mode only the awake sensors are evaluated. A sensor which can't
+ * trigger any controller until one of its inputs changes is put to sleep after its
+ * evaluation, it is woken up by its inputs (property change, new controller link,
+ * resume) or by its pulse timer. The pulse ticks of the frames spent sleeping are
+ * counted when the sensor is evaluated again.
+ */
 class SCA_BasicEventManager : public SCA_EventManager
 {
+private:
+	bool m_eventDriven;
+	/// Number of evaluated frames, starting at 1.
+	unsigned int m_frame;
+	/// Sensors evaluated in the next frame.
+	std::vector<SCA_ISensor *> m_awakeSensors;
+	/// Sensors evaluated in the current frame.
+	std::vector<SCA_ISensor *> m_activeSensors;
+	/// Sleeping sensors sorted by pulse timer frame.
+	std::multimap<unsigned int, SCA_ISensor *> m_timers;
+
+	void SleepSensor(SCA_ISensor *sensor);
+	void RemoveTimer(SCA_ISensor *sensor);
+
 public:
-	SCA_BasicEventManager(class SCA_LogicManager* logicmgr);
+	SCA_BasicEventManager(class SCA_LogicManager* logicmgr, bool eventDriven = false);
 	~SCA_BasicEventManager();
 
 	virtual void NextFrame();
+	virtual bool RegisterSensor(SCA_ISensor *sensor);
+	virtual bool RemoveSensor(SCA_ISensor *sensor);
+	virtual void WakeSensor(SCA_ISensor *sensor);
 };
 
 #endif  /* __SCA_BASICEVENTMANAGER_H__ */
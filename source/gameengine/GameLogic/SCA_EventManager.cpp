@@ -69,6 +69,10 @@ bool SCA_EventManager::RemoveSensor(class SCA_ISensor* sensor)
 	return false;
 }
 
+void SCA_EventManager::WakeSensor(class SCA_ISensor* sensor)
+{
+}
+
 void SCA_EventManager::NextFrame(double curtime, double fixedtime)
 {
 	NextFrame();
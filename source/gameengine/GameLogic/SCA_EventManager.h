@@ -70,6 +70,8 @@ public:
 	virtual void    UpdateFrame();
 	virtual void	EndFrame();
 	virtual bool	RegisterSensor(class SCA_ISensor* sensor);
+	/// Evaluate again a sleeping sensor, only managers putting sensors to sleep implement it.
+	virtual void	WakeSensor(class SCA_ISensor* sensor);
 	int		GetType();
 	//SG_DList &GetSensors() { return m_sensors; }
 
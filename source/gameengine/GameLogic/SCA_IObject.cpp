@@ -277,6 +277,30 @@ void SCA_IObject::ResumeSensors(void)
 	}
 }
 
+void SCA_IObject::WakePropertySensors()
+{
+	for (SCA_ISensor *sensor : m_sensors) {
+		if (sensor->IsSleeping() && sensor->HasPropertyInput()) {
+			sensor->Wake();
+		}
+	}
+}
+
+void SCA_IObject::SetProperty(const std::string& name, CValue *ioProperty)
+{
+	CValue::SetProperty(name, ioProperty);
+	WakePropertySensors();
+}
+
+bool SCA_IObject::RemoveProperty(const std::string& inName)
+{
+	const bool removed = CValue::RemoveProperty(inName);
+	if (removed) {
+		WakePropertySensors();
+	}
+	return removed;
+}
+
 void SCA_IObject::SetState(unsigned int state)
 {
 	unsigned int tmpstate;
@@ -183,6 +183,15 @@ public:
 	 */
 	void ResumeSensors(void);
 
+	/**
+	 * Wake up the sleeping sensors depending on the properties,
+	 * must be called when a property value is changed in place.
+	 */
+	void WakePropertySensors();
+
+	virtual void SetProperty(const std::string& name, CValue *ioProperty);
+	virtual bool RemoveProperty(const std::string& inName);
+
 	/**
 	 * Set init state
 	 */
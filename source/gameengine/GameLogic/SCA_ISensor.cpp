@@ -60,7 +60,10 @@ SCA_ISensor::SCA_ISensor(SCA_IObject *gameobj, SCA_EventManager *eventmgr)
 	m_suspended(false),
 	m_links(0),
 	m_state(false),
-	m_prev_state(false)
+	m_prev_state(false),
+	m_sleeping(false),
+	m_sleepFrame(0),
+	m_wakeFrame(0)
 {
 }
 
@@ -72,6 +75,9 @@ void SCA_ISensor::ProcessReplica()
 {
 	SCA_ILogicBrick::ProcessReplica();
 	m_linkedcontrollers.clear();
+	m_sleeping = false;
+	m_sleepFrame = 0;
+	m_wakeFrame = 0;
 }
 
 bool SCA_ISensor::IsPositiveTrigger()
@@ -123,6 +129,8 @@ SCA_ISensor::sensortype SCA_ISensor::GetSensorType()
 void SCA_ISensor::Suspend()
 {
 	m_suspended = true;
+	// Stop counting the pulse ticks.
+	Wake();
 }
 
 bool SCA_ISensor::IsSuspended()
@@ -133,6 +141,7 @@ bool SCA_ISensor::IsSuspended()
 void SCA_ISensor::Resume()
 {
 	m_suspended = false;
+	Wake();
 }
 
 bool SCA_ISensor::GetState()
@@ -165,6 +174,10 @@ void SCA_ISensor::IncLink()
 	if (!m_links++) {
 		RegisterToManager();
 	}
+	else {
+		// A level sensor triggers the controllers just activated.
+		Wake();
+	}
 }
 
 bool SCA_ISensor::IsNoLink() const
@@ -177,6 +190,78 @@ void SCA_ISensor::Init()
 	CM_LogicBrickError(this, "sensor " << m_name << " has no init function, please report this bug to Blender.org");
 }
 
+bool SCA_ISensor::CanSleep()
+{
+	return false;
+}
+
+bool SCA_ISensor::HasPropertyInput()
+{
+	return false;
+}
+
+bool SCA_ISensor::IsIdle()
+{
+#ifdef WITH_PYTHON
+	// A script holding the sensor can change its settings at any time.
+	if (m_proxy) {
+		return false;
+	}
+#endif  // WITH_PYTHON
+
+	if (m_suspended) {
+		return true;
+	}
+	// In tap mode a negative pulse always follows a positive pulse.
+	if (m_tap && m_state) {
+		return false;
+	}
+
+	return CanSleep();
+}
+
+int SCA_ISensor::GetPulseTicks() const
+{
+	if (m_suspended) {
+		return 0;
+	}
+	if (m_pos_pulsemode && m_state) {
+		return m_skipped_ticks + 1 - m_pos_ticks;
+	}
+	if (m_neg_pulsemode && !m_tap && !m_state) {
+		return m_skipped_ticks + 1 - m_neg_ticks;
+	}
+	return 0;
+}
+
+void SCA_ISensor::SkipTicks(int ticks)
+{
+	if (ticks <= 0) {
+		return;
+	}
+
+	// Same as the non triggering frames in Activate.
+	m_prev_state = m_state;
+	if (m_pos_pulsemode) {
+		m_pos_ticks = (m_pos_ticks + ticks) % (m_skipped_ticks + 1);
+	}
+	if (m_neg_pulsemode && !m_tap) {
+		m_neg_ticks = (m_neg_ticks + ticks) % (m_skipped_ticks + 1);
+	}
+}
+
+void SCA_ISensor::Wake()
+{
+	if (m_sleeping) {
+		m_eventmgr->WakeSensor(this);
+	}
+}
+
+bool SCA_ISensor::IsSleeping() const
+{
+	return m_sleeping;
+}
+
 void SCA_ISensor::DecLink()
 {
 	--m_links;
@@ -48,6 +48,8 @@ class SCA_ISensor : public SCA_ILogicBrick
 {
 	Py_Header
 
+	friend class SCA_BasicEventManager;
+
 protected:
 	SCA_EventManager *m_eventmgr;
 
@@ -90,6 +92,15 @@ protected:
 	/// Previous state (for tap option).
 	bool m_prev_state;
 
+	/// The sensor is not evaluated until it is woken up, see SCA_BasicEventManager.
+	bool m_sleeping;
+
+	/// Frame of the last evaluation before sleeping, 0 if the sleep ticks are not counted.
+	unsigned int m_sleepFrame;
+
+	/// Frame the pulse timer wakes up the sensor, 0 if none.
+	unsigned int m_wakeFrame;
+
 	std::vector<SCA_IController *> m_linkedcontrollers;
 
 public:
@@ -116,6 +127,24 @@ public:
 	virtual bool IsPositiveTrigger();
 	virtual void Init();
 
+	/** Return true when Evaluate() returns false and IsPositiveTrigger() is unchanged
+	 * until one of the sensor inputs wakes it up. Such a sensor is not evaluated by an
+	 * event driven manager while nothing changes.
+	 */
+	virtual bool CanSleep();
+	/// Return true if a property change of the parent object must wake up the sensor.
+	virtual bool HasPropertyInput();
+
+	/// Return true if the sensor can't trigger any controller until woken up or its pulse timer expires.
+	bool IsIdle();
+	/// Number of frames until the next pulse triggers the controllers, 0 if none.
+	int GetPulseTicks() const;
+	/// Account for the ticks the sensor was not evaluated while sleeping.
+	void SkipTicks(int ticks);
+	/// Evaluate a sleeping sensor again from the next frame.
+	void Wake();
+	bool IsSleeping() const;
+
 	virtual CValue *GetReplica() = 0;
 
 	/** Set parameters for the pulsing behavior.
@@ -37,6 +37,7 @@
 #include "SCA_LogicManager.h"
 #include "KX_GameObject.h"
 #include "KX_CollisionEventManager.h"
+#include "KX_ProximityManager.h"
 #include "KX_Scene.h" // needed to create a replica
 #include "PHY_IPhysicsEnvironment.h"
 #include "PHY_IPhysicsController.h"
@@ -222,27 +223,75 @@ bool	SCA_NearSensor::NewHandleCollision(void *obj1, void *obj2, const PHY_CollDa
 	
 	// Add the same check as in SCA_ISensor::Activate(), 
 	// we don't want to record collision when the sensor is not active.
-	if (m_links && !m_suspended &&
+	if (IsProximityActive() &&
 		gameobj /* done in BroadPhaseFilterCollision() && (gameobj != parent)*/)
 	{
-		if (!m_colliders->SearchValue(gameobj))
-			m_colliders->Add(CM_AddRef(gameobj));
 		// only take valid colliders
 		// These checks are done already in BroadPhaseFilterCollision()
-		//if (client_info->m_type == KX_ClientObjectInfo::ACTOR)
-		//{
-		//	if ((m_touchedpropname.size() == 0) || 
-		//		(gameobj->GetProperty(m_touchedpropname)))
-		//	{
-				m_bTriggered = true;
-				m_hitObject = gameobj;
-		//	}
-		//}
+		AddCollider(gameobj);
 	}
 	
 	return false; // was DT_CONTINUE; but this was defined in Sumo as false
 }
 
+void SCA_NearSensor::AddCollider(KX_GameObject *gameobj)
+{
+	if (!m_colliders->SearchValue(gameobj))
+		m_colliders->Add(CM_AddRef(gameobj));
+
+	m_bTriggered = true;
+	m_hitObject = gameobj;
+}
+
+void SCA_NearSensor::RegisterSumo(KX_CollisionEventManager *collisionman)
+{
+	KX_ProximityManager *proximityManager = collisionman->GetProximityManager();
+	// Sensors created without physics controller are queried by the proximity manager.
+	if (!m_physCtrl && proximityManager) {
+		proximityManager->AddSensor(this);
+	}
+	else {
+		SCA_CollisionSensor::RegisterSumo(collisionman);
+	}
+}
+
+void SCA_NearSensor::UnregisterSumo(KX_CollisionEventManager *collisionman)
+{
+	KX_ProximityManager *proximityManager = collisionman->GetProximityManager();
+	if (!m_physCtrl && proximityManager) {
+		proximityManager->RemoveSensor(this);
+	}
+	else {
+		SCA_CollisionSensor::UnregisterSumo(collisionman);
+	}
+}
+
+void SCA_NearSensor::GetProximityShape(ProximityShape& shape)
+{
+	// Same radius than SetPhysCtrlRadius.
+	shape.m_origin = static_cast<KX_GameObject *>(GetParent())->NodeGetWorldPosition();
+	shape.m_axis = MT_Vector3(0.0f, 0.0f, 1.0f);
+	shape.m_radius = m_bLastTriggered ? m_ResetMargin : m_Margin;
+	shape.m_height = 0.0f;
+	shape.m_cone = false;
+}
+
+bool SCA_NearSensor::IsProximityActive() const
+{
+	return (m_links && !m_suspended);
+}
+
+int SCA_NearSensor::GetProximitySkippedTicks() const
+{
+	// Without pulses the sensor reacts at every frame.
+	return (m_pos_pulsemode || m_neg_pulsemode) ? m_skipped_ticks : 0;
+}
+
+const std::string& SCA_NearSensor::GetTouchedPropertyName() const
+{
+	return m_touchedpropname;
+}
+
 #ifdef WITH_PYTHON
 
 /* ------------------------------------------------------------------------- */
@@ -35,6 +35,7 @@
 
 #include "SCA_CollisionSensor.h"
 #include "KX_ClientObjectInfo.h"
+#include "MT_Vector3.h"
 
 class KX_Scene;
 class PHY_CollData;
@@ -48,6 +49,19 @@ protected:
 
 	KX_ClientObjectInfo*	m_client_info;
 public:
+	/// Volume tested by the proximity manager when the sensor doesn't use a physics controller.
+	struct ProximityShape
+	{
+		/// Sphere center or cone apex.
+		MT_Vector3 m_origin;
+		/// Normalized cone direction, from the apex to the base.
+		MT_Vector3 m_axis;
+		/// Sphere radius or cone base radius.
+		float m_radius;
+		float m_height;
+		bool m_cone;
+	};
+
 	SCA_NearSensor(class SCA_EventManager* eventmgr,
 	              class KX_GameObject* gameobj,
 	              float margin,
@@ -79,6 +93,19 @@ public:
 	virtual bool	BroadPhaseSensorFilterCollision(void* obj1,void* obj2) { return false; }
 	virtual sensortype GetSensorType() { return ST_NEAR; }
 
+	virtual void RegisterSumo(KX_CollisionEventManager *collisionman);
+	virtual void UnregisterSumo(KX_CollisionEventManager *collisionman);
+
+	/// Compute the volume detecting objects, used only by the proximity manager.
+	virtual void GetProximityShape(ProximityShape& shape);
+	/// Return true if the sensor is evaluated and records colliders.
+	bool IsProximityActive() const;
+	/// Number of frames the proximity results can be reused, from the pulse frequency.
+	int GetProximitySkippedTicks() const;
+	const std::string& GetTouchedPropertyName() const;
+	/// Record an object detected in the sensor volume.
+	void AddCollider(KX_GameObject *gameobj);
+
 #ifdef WITH_PYTHON
 
 	/* --------------------------------------------------------------------- */
@@ -80,6 +80,7 @@ bool SCA_PropertyActuator::Update()
 			if (oldprop)
 			{
 				oldprop->SetValue(newval);
+				GetParent()->WakePropertySensors();
 			}
 			newval->Release();
 		}
@@ -184,7 +185,10 @@ bool SCA_PropertyActuator::Update()
 
 		userexpr->Release();
 	}
-	
+
+	// The properties may have been changed in place.
+	GetParent()->WakePropertySensors();
+
 	return result;
 }
 
@@ -120,6 +120,23 @@ bool SCA_PropertySensor::Evaluate()
 	return (reset) ? true : false;
 }
 
+bool SCA_PropertySensor::CanSleep()
+{
+	// An expression can use any identifier.
+	if (m_checktype == KX_PROPSENSOR_EXPRESSION) {
+		return false;
+	}
+
+	// Timer properties are changed every frame without notifying the object.
+	CValue *prop = GetParent()->GetProperty(m_checkpropname);
+	return !(prop && prop->GetProperty("timer"));
+}
+
+bool SCA_PropertySensor::HasPropertyInput()
+{
+	return true;
+}
+
 
 bool	SCA_PropertySensor::CheckPropertyCondition()
 {
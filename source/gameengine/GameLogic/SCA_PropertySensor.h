@@ -78,6 +78,8 @@ public:
 
 	virtual bool Evaluate();
 	virtual bool	IsPositiveTrigger();
+	virtual bool	CanSleep();
+	virtual bool	HasPropertyInput();
 	virtual CValue*		FindIdentifier(const std::string& identifiername);
 
 #ifdef WITH_PYTHON
@@ -169,6 +169,16 @@ void SCA_RadarSensor::SynchronizeTransform()
 
 }
 
+void SCA_RadarSensor::GetProximityShape(ProximityShape& shape)
+{
+	// The cone apex is the object position, m_cone_target is the center of the base.
+	shape.m_origin = ((KX_GameObject*)GetParent())->NodeGetWorldPosition();
+	shape.m_axis = (MT_Vector3(m_cone_target) - shape.m_origin).safe_normalized();
+	shape.m_radius = m_coneradius;
+	shape.m_height = m_coneheight;
+	shape.m_cone = true;
+}
+
 /* ------------------------------------------------------------------------- */
 /* Python Functions															 */
 /* ------------------------------------------------------------------------- */
@@ -77,6 +77,7 @@ public:
 	virtual ~SCA_RadarSensor();
 	virtual void SynchronizeTransform();
 	virtual CValue* GetReplica();
+	virtual void GetProximityShape(ProximityShape& shape);
 
 	/* --------------------------------------------------------------------- */
 	/* Python interface ---------------------------------------------------- */
@@ -247,6 +247,7 @@ bool SCA_RandomActuator::Update()
 	CValue *prop = GetParent()->GetProperty(m_propname);
 	if (prop) {
 		prop->SetValue(tmpval);
+		GetParent()->WakePropertySensors();
 	}
 	tmpval->Release();
 
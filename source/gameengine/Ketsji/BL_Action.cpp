@@ -73,8 +73,7 @@ extern "C" {
 
 BL_Action::BL_Action(class KX_GameObject* gameobj):
     m_action(nullptr),
-    m_blendpose(nullptr),
-    m_blendinpose(nullptr),
+    m_actionData(nullptr),
     m_obj(gameobj),
     m_startframe(0.f),
     m_endframe(0.f),
@@ -97,10 +96,6 @@ BL_Action::BL_Action(class KX_GameObject* gameobj):
 
 BL_Action::~BL_Action()
 {
-  if (m_blendpose)
-    BKE_pose_free(m_blendpose);
-  if (m_blendinpose)
-    BKE_pose_free(m_blendinpose);
   ClearControllerList();
 
   Object *ob = m_obj->GetBlenderObject();
@@ -226,7 +221,14 @@ bool BL_Action::Play(const std::string& name,
   if (m_obj->GetGameObjectType() == SCA_IObject::OBJ_ARMATURE)
   {
     BL_ArmatureObject *obj = (BL_ArmatureObject*)m_obj;
-    obj->GetPose(&m_blendinpose);
+    obj->GetPose(m_blendinpose);
+
+    // Bind the compiled action tracks to the pose channels only when the action data changes,
+    // compare identifiers as a freed action data can be reallocated at the same address.
+    m_actionData = KX_GetActiveEngine()->GetConverter()->GetActionData(kxscene, m_action);
+    if (!m_actionData->IsBound(m_actionBinding)) {
+      obj->BindAction(*m_actionData, m_actionBinding);
+    }
   }
   else
   {
@@ -346,12 +348,19 @@ void BL_Action::BlendShape(Key* key, float srcweight, std::vector<float>& blends
 }
 
 void BL_Action::Update(float curtime, bool applyToObject)
+{
+  if (UpdateTime(curtime, applyToObject)) {
+    Apply(curtime, m_localframe);
+  }
+}
+
+bool BL_Action::UpdateTime(float curtime, bool applyToObject)
 {
   /* Don't bother if we're done with the animation and if the animation was already applied to the object.
    * of if the animation made a double update for the same time and that it was applied to the object.
    */
   if ((m_done || m_prevUpdate == curtime) && m_appliedToObject) {
-    return;
+    return false;
   }
   m_prevUpdate = curtime;
 
@@ -394,27 +403,69 @@ void BL_Action::Update(float curtime, bool applyToObject)
   m_appliedToObject = applyToObject;
   // In case of culled armatures (doesn't requesting to transform the object) we only manages time.
   if (!applyToObject) {
-    return;
+    return false;
   }
 
   m_requestIpo = true;
 
+  return true;
+}
+
+bool BL_Action::IsPoseShareable() const
+{
+  // A blend in depends on the pose of the object when the action started.
+  if (m_blendin && m_blendframe < m_blendin) {
+    return false;
+  }
+  // A weighted layer blends with the previous pose of the object.
+  return (m_layer_weight <= 0.0f);
+}
+
+BL_PoseCache::Layer BL_Action::GetPoseCacheLayer(const BL_PoseCache& cache) const
+{
+  return {m_action, cache.QuantizeFrame(m_localframe), m_layer_weight, m_blendmode};
+}
+
+void BL_Action::ApplyGenericTracks(float frame)
+{
+  m_actionData->EvaluateGeneric(m_actionBinding, frame);
+}
+
+void BL_Action::ApplySharedPose(float curtime, const BL_PoseTransforms& pose)
+{
+  KX_Scene *scene = m_obj->GetScene();
+  curtime -= (float)scene->GetSuspendedDelta();
+
+  Object *ob = m_obj->GetBlenderObject();
+  DEG_id_tag_update(&ob->id, ID_RECALC_TRANSFORM);
+  scene->ResetTaaSamples();
+
+  BL_ArmatureObject *obj = (BL_ArmatureObject *)m_obj;
+  obj->SetPose(pose);
+  obj->UpdateTimestep(curtime);
+}
+
+void BL_Action::Apply(float curtime, float frame)
+{
+  KX_Scene *scene = m_obj->GetScene();
+  curtime -= (float)scene->GetSuspendedDelta();
+
   Object *ob = m_obj->GetBlenderObject();  // eevee
 
   if (m_obj->GetGameObjectType() == SCA_IObject::OBJ_ARMATURE) {
     DEG_id_tag_update(&ob->id, ID_RECALC_TRANSFORM);
 
-    //BKE_object_where_is_calc_time(depsgraph, sc, ob, m_localframe);
+    //BKE_object_where_is_calc_time(depsgraph, sc, ob, frame);
 
     scene->ResetTaaSamples();
 
     BL_ArmatureObject *obj = (BL_ArmatureObject *)m_obj;
 
     if (m_layer_weight >= 0)
-      obj->GetPose(&m_blendpose);
+      obj->GetPose(m_blendpose);
 
     // Extract the pose from the action
-    obj->SetPoseByAction(m_action, m_localframe);
+    obj->SetPoseByAction(*m_actionData, m_actionBinding, frame);
 
     // Handle blending between armature actions
     if (m_blendin && m_blendframe < m_blendin) {
@@ -448,7 +499,7 @@ void BL_Action::Update(float curtime, bool applyToObject)
         DEG_id_tag_update(&ob->id, ID_RECALC_GEOMETRY);
         PointerRNA ptrrna;
         RNA_id_pointer_create(&ob->id, &ptrrna);
-        animsys_evaluate_action(&ptrrna, m_action, m_localframe, false);
+        animsys_evaluate_action(&ptrrna, m_action, frame, false);
         scene->ResetTaaSamples();
         break;
       }
@@ -463,7 +514,7 @@ void BL_Action::Update(float curtime, bool applyToObject)
           DEG_id_tag_update(&ob->id, ID_RECALC_TRANSFORM);
           PointerRNA ptrrna;
           RNA_id_pointer_create(&ob->id, &ptrrna);
-          animsys_evaluate_action(&ptrrna, m_action, m_localframe, false);
+          animsys_evaluate_action(&ptrrna, m_action, frame, false);
           scene->ResetTaaSamples();
           break;
         }
@@ -482,7 +533,7 @@ void BL_Action::Update(float curtime, bool applyToObject)
             DEG_id_tag_update(&ma->id, ID_RECALC_SHADING);
             PointerRNA ptrrna;
             RNA_id_pointer_create(&node_tree->id, &ptrrna);
-            animsys_evaluate_action(&ptrrna, m_action, m_localframe, false);
+            animsys_evaluate_action(&ptrrna, m_action, frame, false);
             scene->ResetTaaSamples();
             break;
           }
@@ -499,7 +550,7 @@ void BL_Action::Update(float curtime, bool applyToObject)
 
         PointerRNA ptrrna;
         RNA_id_pointer_create(&key->id, &ptrrna);
-        animsys_evaluate_action(&ptrrna, m_action, m_localframe, false);
+        animsys_evaluate_action(&ptrrna, m_action, frame, false);
 
         // Handle blending between shape actions
         if (m_blendin && m_blendframe < m_blendin) {
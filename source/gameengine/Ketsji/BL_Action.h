@@ -30,13 +30,20 @@
 #include <string>
 #include <vector>
 
+#include "BL_ActionData.h"
+#include "BL_PoseCache.h"
+#include "BL_PoseTransforms.h"
+
 class BL_Action
 {
 private:
 
 	struct bAction* m_action;
-	struct bPose* m_blendpose;
-	struct bPose* m_blendinpose;
+	/// The compiled action and its binding to the armature pose channels.
+	BL_ActionData *m_actionData;
+	BL_ActionData::Binding m_actionBinding;
+	BL_PoseTransforms m_blendpose;
+	BL_PoseTransforms m_blendinpose;
 	std::vector<class SG_Controller*> m_sg_contr_list;
 	class KX_GameObject* m_obj;
 	std::vector<float>	m_blendshape;
@@ -110,6 +117,23 @@ public:
 	 * else it only manages action's' time/end.
 	 */
 	void Update(float curtime, bool applyToObject);
+	/**
+	 * Update the action's frame and end.
+	 * \return True when the action must be applied to the object.
+	 */
+	bool UpdateTime(float curtime, bool applyToObject);
+	/**
+	 * Apply the action to the object.
+	 * \param frame The action frame to evaluate.
+	 */
+	void Apply(float curtime, float frame);
+	/// Return true if the pose produced by this action only depends on the pose cache layer.
+	bool IsPoseShareable() const;
+	BL_PoseCache::Layer GetPoseCacheLayer(const BL_PoseCache& cache) const;
+	/// Apply an armature pose computed for another object with the same actions.
+	void ApplySharedPose(float curtime, const BL_PoseTransforms& pose);
+	/// Evaluate the F-Curves of the action not animating the pose, they are never shared.
+	void ApplyGenericTracks(float frame);
 	/**
 	 * Update object IPOs (note: not thread-safe!)
 	 */
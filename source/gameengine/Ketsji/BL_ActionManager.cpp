@@ -26,6 +26,8 @@
 
 #include "BL_Action.h"
 #include "BL_ActionManager.h"
+#include "BL_ArmatureObject.h"
+#include "KX_Scene.h"
 #include "DNA_ID.h"
 
 #define IS_TAGGED(_id) ((_id) && (((ID *)_id)->tag & LIB_TAG_DOIT))
@@ -142,11 +144,68 @@ bool BL_ActionManager::IsActionDone(short layer)
 
 void BL_ActionManager::Update(float curtime, bool applyToObject)
 {
-	for (const auto& pair : m_layers) {
-		pair.second->Update(curtime, applyToObject);
+	BL_PoseCache *cache = m_obj->GetScene()->GetPoseCache();
+	if (cache && applyToObject && m_obj->GetGameObjectType() == SCA_IObject::OBJ_ARMATURE) {
+		UpdateSharedPose(curtime, *cache);
+	}
+	else {
+		for (const auto& pair : m_layers) {
+			pair.second->Update(curtime, applyToObject);
+		}
 	}
 
 	for (const auto& pair : m_layers) {
 		pair.second->UpdateIPOs();
 	}
 }
+
+void BL_ActionManager::UpdateSharedPose(float curtime, BL_PoseCache& cache)
+{
+	/* The pose only depends on the actions and frames when the first layer overrides the
+	 * previous pose and every layer is applied in this update. */
+	bool shareable = (!m_layers.empty() && m_layers.begin()->first == 0);
+
+	m_appliedLayers.clear();
+	for (const auto& pair : m_layers) {
+		BL_Action *action = pair.second;
+		if (action->UpdateTime(curtime, true)) {
+			m_appliedLayers.push_back(action);
+			shareable = shareable && action->IsPoseShareable();
+		}
+		else {
+			shareable = false;
+		}
+	}
+
+	if (!shareable) {
+		for (BL_Action *action : m_appliedLayers) {
+			action->Apply(curtime, action->GetFrame());
+		}
+		return;
+	}
+
+	BL_ArmatureObject *armature = static_cast<BL_ArmatureObject *>(m_obj);
+
+	m_poseKey.m_armature = armature->GetArmature();
+	m_poseKey.m_layers.clear();
+	for (BL_Action *action : m_appliedLayers) {
+		m_poseKey.m_layers.push_back(action->GetPoseCacheLayer(cache));
+	}
+
+	const BL_PoseTransforms *pose = cache.Find(m_poseKey);
+	if (pose) {
+		// Only the pose is shared, the other animated properties belong to this object.
+		for (unsigned short i = 0, size = m_appliedLayers.size(); i < size; ++i) {
+			m_appliedLayers[i]->ApplyGenericTracks(m_poseKey.m_layers[i].m_frame);
+		}
+		m_appliedLayers.front()->ApplySharedPose(curtime, *pose);
+		return;
+	}
+
+	for (unsigned short i = 0, size = m_appliedLayers.size(); i < size; ++i) {
+		m_appliedLayers[i]->Apply(curtime, m_poseKey.m_layers[i].m_frame);
+	}
+
+	armature->GetPose(m_sharedPose);
+	cache.Insert(m_poseKey, m_sharedPose);
+}
@@ -28,6 +28,9 @@
 #define __BL_ACTIONMANAGER_H__
 
 #include <map>
+#include <vector>
+
+#include "BL_PoseCache.h"
 
 // Currently, we use the max value of a short.
 // We should switch to unsigned short; doesn't make sense to support negative layers.
@@ -47,11 +50,24 @@ private:
 	class KX_GameObject* m_obj;
 	BL_ActionMap 		 m_layers;
 
+	/// Layers to apply in the current update, used by UpdateSharedPose.
+	std::vector<BL_Action *> m_appliedLayers;
+	/// Pose cache key of the current update.
+	BL_PoseCache::Key m_poseKey;
+	/// Pose stored into the cache after an evaluation.
+	BL_PoseTransforms m_sharedPose;
+
 	/**
 	 * Check if an action exists
 	 */
 	BL_Action* GetAction(short layer);
 
+	/**
+	 * Update the armature actions, reusing the pose of an armature already
+	 * evaluated with the same actions and frames in the current update.
+	 */
+	void UpdateSharedPose(float curtime, BL_PoseCache& cache);
+
 public:
 	BL_ActionManager(class KX_GameObject* obj);
 	~BL_ActionManager();
@@ -0,0 +1,85 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file BL_PoseCache.cpp
+ *  \ingroup ketsji
+ */
+
+#include "BL_PoseCache.h"
+
+#include <cmath>
+
+bool BL_PoseCache::Layer::operator==(const Layer& other) const
+{
+	return (m_action == other.m_action && m_frame == other.m_frame &&
+	        m_weight == other.m_weight && m_blendMode == other.m_blendMode);
+}
+
+bool BL_PoseCache::Key::operator==(const Key& other) const
+{
+	return (m_armature == other.m_armature && m_layers == other.m_layers);
+}
+
+size_t BL_PoseCache::KeyHash::operator()(const Key& key) const
+{
+	size_t hash = std::hash<const void *>()(key.m_armature);
+	for (const Layer& layer : key.m_layers) {
+		hash ^= std::hash<const void *>()(layer.m_action) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		hash ^= std::hash<float>()(layer.m_frame) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	}
+
+	return hash;
+}
+
+BL_PoseCache::BL_PoseCache(float frameStep)
+	:m_frameStep(frameStep)
+{
+}
+
+BL_PoseCache::~BL_PoseCache()
+{
+}
+
+float BL_PoseCache::QuantizeFrame(float frame) const
+{
+	if (m_frameStep <= 0.0f) {
+		return frame;
+	}
+
+	return std::floor(frame / m_frameStep + 0.5f) * m_frameStep;
+}
+
+const BL_PoseTransforms *BL_PoseCache::Find(const Key& key) const
+{
+	const std::unordered_map<Key, BL_PoseTransforms, KeyHash>::const_iterator it = m_poses.find(key);
+	return (it != m_poses.end()) ? &it->second : nullptr;
+}
+
+void BL_PoseCache::Insert(const Key& key, const BL_PoseTransforms& pose)
+{
+	m_poses[key] = pose;
+}
+
+void BL_PoseCache::Clear()
+{
+	m_poses.clear();
+}
@@ -0,0 +1,93 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file BL_PoseCache.h
+ *  \ingroup ketsji
+ */
+
+#ifndef __BL_POSECACHE_H__
+#define __BL_POSECACHE_H__
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "BL_PoseTransforms.h"
+
+struct bAction;
+struct bArmature;
+
+/**
+ * BL_PoseCache stores the poses evaluated from actions during an animation update,
+ * so that armatures sharing the same armature data, actions and frames evaluate
+ * their pose only once. The cache is cleared before every animation update.
+ */
+class BL_PoseCache
+{
+public:
+	/// Evaluation state of an action layer.
+	struct Layer
+	{
+		bAction *m_action;
+		float m_frame;
+		float m_weight;
+		short m_blendMode;
+
+		bool operator==(const Layer& other) const;
+	};
+
+	/// Identify all the inputs of a pose evaluation.
+	struct Key
+	{
+		const bArmature *m_armature;
+		std::vector<Layer> m_layers;
+
+		bool operator==(const Key& other) const;
+	};
+
+private:
+	struct KeyHash
+	{
+		size_t operator()(const Key& key) const;
+	};
+
+	std::unordered_map<Key, BL_PoseTransforms, KeyHash> m_poses;
+
+	/// Frame step used to quantize action frames, zero to disable quantization.
+	float m_frameStep;
+
+public:
+	BL_PoseCache(float frameStep);
+	~BL_PoseCache();
+
+	/// Return the frame used to evaluate an action at a given frame.
+	float QuantizeFrame(float frame) const;
+
+	/// Return the pose stored for a key or nullptr.
+	const BL_PoseTransforms *Find(const Key& key) const;
+	void Insert(const Key& key, const BL_PoseTransforms& pose);
+
+	/// Remove all the stored poses, called before each animation update.
+	void Clear();
+};
+
+#endif  // __BL_POSECACHE_H__
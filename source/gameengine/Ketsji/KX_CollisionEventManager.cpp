@@ -35,14 +35,17 @@
 #include "SCA_CollisionSensor.h"
 #include "KX_GameObject.h"
 #include "KX_CollisionContactPoints.h"
+#include "KX_ProximityManager.h"
 #include "PHY_IPhysicsEnvironment.h"
 #include "PHY_IPhysicsController.h"
 
 
 KX_CollisionEventManager::KX_CollisionEventManager(class SCA_LogicManager *logicmgr,
-                                                   PHY_IPhysicsEnvironment *physEnv)
+                                                   PHY_IPhysicsEnvironment *physEnv,
+                                                   KX_ProximityManager *proximityManager)
 	:SCA_EventManager(logicmgr, TOUCH_EVENTMGR),
-	m_physEnv(physEnv)
+	m_physEnv(physEnv),
+	m_proximityManager(proximityManager)
 {
 	m_physEnv->AddCollisionCallback(PHY_OBJECT_RESPONSE, KX_CollisionEventManager::newCollisionResponse, this);
 	m_physEnv->AddCollisionCallback(PHY_SENSOR_RESPONSE, KX_CollisionEventManager::newCollisionResponse, this);
@@ -57,10 +60,57 @@ KX_CollisionEventManager::~KX_CollisionEventManager()
 
 void KX_CollisionEventManager::RemoveNewCollisions()
 {
-	for (std::set<NewCollision>::iterator it = m_newCollisions.begin(), end = m_newCollisions.end(); it != end; ++it) {
-		delete it->colldata;
+	for (const NewCollision& collision : m_newCollisions) {
+		delete collision.colldata;
 	}
 	m_newCollisions.clear();
+	m_collisionPairs.clear();
+}
+
+short KX_CollisionEventManager::GetCollisionInterest(PHY_IPhysicsController *ctrl1, PHY_IPhysicsController *ctrl2)
+{
+	KX_ClientObjectInfo *info1 = static_cast<KX_ClientObjectInfo *>(ctrl1->GetNewClientInfo());
+	KX_ClientObjectInfo *info2 = static_cast<KX_ClientObjectInfo *>(ctrl2->GetNewClientInfo());
+
+	short interest = 0;
+	if (info1 && !info1->m_sensors.empty()) {
+		interest |= INTEREST_FIRST_SENSORS;
+	}
+	if (info2 && !info2->m_sensors.empty()) {
+		interest |= INTEREST_SECOND_SENSORS;
+	}
+
+	// The python callbacks receive the other object.
+	KX_GameObject *gameobj1 = KX_GameObject::GetClientObject(info1);
+	KX_GameObject *gameobj2 = KX_GameObject::GetClientObject(info2);
+	if (gameobj1 && gameobj2) {
+		if (gameobj1->HasCollisionCallbacks()) {
+			interest |= INTEREST_FIRST_CALLBACKS;
+		}
+		if (gameobj2->HasCollisionCallbacks()) {
+			interest |= INTEREST_SECOND_CALLBACKS;
+		}
+	}
+
+	return interest;
+}
+
+short KX_CollisionEventManager::SwapCollisionInterest(short interest)
+{
+	short swapped = 0;
+	if (interest & INTEREST_FIRST_SENSORS) {
+		swapped |= INTEREST_SECOND_SENSORS;
+	}
+	if (interest & INTEREST_SECOND_SENSORS) {
+		swapped |= INTEREST_FIRST_SENSORS;
+	}
+	if (interest & INTEREST_FIRST_CALLBACKS) {
+		swapped |= INTEREST_SECOND_CALLBACKS;
+	}
+	if (interest & INTEREST_SECOND_CALLBACKS) {
+		swapped |= INTEREST_FIRST_CALLBACKS;
+	}
+	return swapped;
 }
 
 bool KX_CollisionEventManager::NewHandleCollision(void *object1, void *object2, const PHY_CollData *coll_data)
@@ -68,7 +118,28 @@ bool KX_CollisionEventManager::NewHandleCollision(void *object1, void *object2,
 	PHY_IPhysicsController *obj1 = static_cast<PHY_IPhysicsController *>(object1);
 	PHY_IPhysicsController *obj2 = static_cast<PHY_IPhysicsController *>(object2);
 
-	m_newCollisions.insert(NewCollision(obj1, obj2, coll_data));
+	/* The interest is computed for the first collision of a pair and shared by its other manifolds.
+	 * It is stored in the order of the pair, the sides are swapped when the collision is reversed. */
+	const CollisionPair pair(obj1, obj2);
+	const std::pair<std::unordered_map<CollisionPair, short, CollisionPairHash>::iterator, bool> result =
+		m_collisionPairs.emplace(pair, 0);
+	if (result.second) {
+		result.first->second = GetCollisionInterest(pair.first, pair.second);
+	}
+
+	const short interest = (obj1 == pair.first) ? result.first->second : SwapCollisionInterest(result.first->second);
+	if (interest == 0) {
+		delete coll_data;
+		return false;
+	}
+
+	NewCollision collision;
+	collision.first = obj1;
+	collision.second = obj2;
+	collision.colldata = coll_data;
+	collision.interest = interest;
+	collision.firstOfPair = result.second;
+	m_newCollisions.push_back(collision);
 
 	return false;
 }
@@ -194,39 +265,43 @@ void KX_CollisionEventManager::NextFrame()
         static_cast<SCA_CollisionSensor *>(sensor)->SynchronizeTransform();
 	}
 
-	for (std::set<NewCollision>::iterator cit = m_newCollisions.begin(); cit != m_newCollisions.end(); ++cit) {
-		// Controllers
-		PHY_IPhysicsController *ctrl1 = (*cit).first;
-		PHY_IPhysicsController *ctrl2 = (*cit).second;
-		// Sensor iterator
-		std::list<SCA_ISensor *>::iterator sit;
-
-		// First client info
-		KX_ClientObjectInfo *client_info = static_cast<KX_ClientObjectInfo *>(ctrl1->GetNewClientInfo());
-		// First gameobject
-		KX_GameObject *kxObj1 = KX_GameObject::GetClientObject(client_info);
-		// Invoke sensor response for each object
-		if (client_info) {
-			for (sit = client_info->m_sensors.begin(); sit != client_info->m_sensors.end(); ++sit) {
-				static_cast<SCA_CollisionSensor *>(*sit)->NewHandleCollision(ctrl1, ctrl2, nullptr);
+	for (const NewCollision& collision : m_newCollisions) {
+		PHY_IPhysicsController *ctrl1 = collision.first;
+		PHY_IPhysicsController *ctrl2 = collision.second;
+		KX_ClientObjectInfo *client_info1 = static_cast<KX_ClientObjectInfo *>(ctrl1->GetNewClientInfo());
+		KX_ClientObjectInfo *client_info2 = static_cast<KX_ClientObjectInfo *>(ctrl2->GetNewClientInfo());
+
+		// Invoke sensor response for each object, the sensors only record the colliding object.
+		if (collision.firstOfPair) {
+			if (collision.interest & INTEREST_FIRST_SENSORS) {
+				for (SCA_ISensor *sensor : client_info1->m_sensors) {
+					static_cast<SCA_CollisionSensor *>(sensor)->NewHandleCollision(ctrl1, ctrl2, nullptr);
+				}
+			}
+			if (collision.interest & INTEREST_SECOND_SENSORS) {
+				for (SCA_ISensor *sensor : client_info2->m_sensors) {
+					static_cast<SCA_CollisionSensor *>(sensor)->NewHandleCollision(ctrl2, ctrl1, nullptr);
+				}
 			}
 		}
 
-		// Second client info
-		client_info = static_cast<KX_ClientObjectInfo *>(ctrl2->GetNewClientInfo());
-		// Second gameobject
-		KX_GameObject *kxObj2 = KX_GameObject::GetClientObject(client_info);
-		if (client_info) {
-			for (sit = client_info->m_sensors.begin(); sit != client_info->m_sensors.end(); ++sit) {
-				static_cast<SCA_CollisionSensor *>(*sit)->NewHandleCollision(ctrl2, ctrl1, nullptr);
+		// Run python callbacks, the contact points are only exposed to the objects using them.
+		if (collision.interest & (INTEREST_FIRST_CALLBACKS | INTEREST_SECOND_CALLBACKS)) {
+			KX_GameObject *kxObj1 = KX_GameObject::GetClientObject(client_info1);
+			KX_GameObject *kxObj2 = KX_GameObject::GetClientObject(client_info2);
+			if (collision.interest & INTEREST_FIRST_CALLBACKS) {
+				KX_CollisionContactPointList contactPointList(collision.colldata, true);
+				kxObj1->RunCollisionCallbacks(kxObj2, contactPointList);
+			}
+			if (collision.interest & INTEREST_SECOND_CALLBACKS) {
+				KX_CollisionContactPointList contactPointList(collision.colldata, false);
+				kxObj2->RunCollisionCallbacks(kxObj1, contactPointList);
 			}
 		}
-		// Run python callbacks
-		const PHY_CollData *colldata = cit->colldata;
-		KX_CollisionContactPointList contactPointList0 = KX_CollisionContactPointList(colldata, true);
-		KX_CollisionContactPointList contactPointList1 = KX_CollisionContactPointList(colldata, false);
-		kxObj1->RunCollisionCallbacks(kxObj2, contactPointList0);
-		kxObj2->RunCollisionCallbacks(kxObj1, contactPointList1);
+	}
+
+	if (m_proximityManager) {
+		m_proximityManager->Update();
 	}
 
 	for (SCA_ISensor *sensor : m_sensors) {
@@ -236,30 +311,27 @@ void KX_CollisionEventManager::NextFrame()
 	RemoveNewCollisions();
 }
 
-KX_CollisionEventManager::NewCollision::NewCollision(PHY_IPhysicsController *first,
-                                                     PHY_IPhysicsController *second,
-                                                     const PHY_CollData *colldata)
-	:first(first),
-	second(second),
-	colldata(colldata)
+KX_CollisionEventManager::CollisionPair::CollisionPair(PHY_IPhysicsController *ctrl1, PHY_IPhysicsController *ctrl2)
 {
+	// The pair is unordered, the physics can report both orders.
+	if (ctrl1 < ctrl2) {
+		first = ctrl1;
+		second = ctrl2;
+	}
+	else {
+		first = ctrl2;
+		second = ctrl1;
+	}
 }
 
-KX_CollisionEventManager::NewCollision::NewCollision(const NewCollision &to_copy)
-	:first(to_copy.first),
-	second(to_copy.second),
-	colldata(to_copy.colldata)
+bool KX_CollisionEventManager::CollisionPair::operator==(const CollisionPair& other) const
 {
+	return (first == other.first && second == other.second);
 }
 
-bool KX_CollisionEventManager::NewCollision::operator<(const NewCollision &other) const
+size_t KX_CollisionEventManager::CollisionPairHash::operator()(const CollisionPair& pair) const
 {
-	//see strict weak ordering: https://support.microsoft.com/en-us/kb/949171
-	if (first == other.first) {
-		if (second == other.second) {
-			return colldata < other.colldata;
-		}
-		return second < other.second;
-	}
-	return first < other.first;
+	const size_t hash1 = std::hash<PHY_IPhysicsController *>()(pair.first);
+	const size_t hash2 = std::hash<PHY_IPhysicsController *>()(pair.second);
+	return hash1 ^ (hash2 + 0x9e3779b9 + (hash1 << 6) + (hash1 >> 2));
 }
@@ -38,40 +38,65 @@
 #include "KX_GameObject.h"
 
 #include <vector>
-#include <set>
+#include <unordered_map>
 
 class SCA_ISensor;
 class PHY_IPhysicsEnvironment;
+class KX_ProximityManager;
 
 class KX_CollisionEventManager : public SCA_EventManager
 {
+	/// Which side of a collision receives it.
+	enum CollisionInterest {
+		INTEREST_FIRST_SENSORS = (1 << 0),
+		INTEREST_SECOND_SENSORS = (1 << 1),
+		INTEREST_FIRST_CALLBACKS = (1 << 2),
+		INTEREST_SECOND_CALLBACKS = (1 << 3)
+	};
+
 	/**
-	 * Contains two colliding objects and the first contact point.
+	 * Contains two colliding objects and the contact points of one of their manifolds.
+	 * The colldata is owned by the event manager and freed at the end of the frame.
 	 */
-	class NewCollision
+	struct NewCollision
 	{
-	public:
 		PHY_IPhysicsController *first;
 		PHY_IPhysicsController *second;
 		const PHY_CollData *colldata;
+		/// Combination of CollisionInterest, computed once per pair.
+		short interest;
+		/// The sensors are called once per pair, only by its first collision.
+		bool firstOfPair;
+	};
+
+	/// Unordered pair of physics controllers.
+	struct CollisionPair
+	{
+		PHY_IPhysicsController *first;
+		PHY_IPhysicsController *second;
 
-		/**
-		 * Creates a copy of the given PHY_CollData; freeing that copy should be done by the owner of
-		 * the NewCollision object.
-		 *
-		 * This allows us to efficiently store NewCollision objects in a std::set without creating more
-		 * copies of colldata, as the NewCollision copy constructor reuses the pointer and doesn't clone
-		 * it again. */
-		NewCollision(PHY_IPhysicsController *first,
-		             PHY_IPhysicsController *second,
-		             const PHY_CollData *colldata);
-		NewCollision(const NewCollision &to_copy);
-		bool operator<(const NewCollision &other) const;
+		CollisionPair(PHY_IPhysicsController *ctrl1, PHY_IPhysicsController *ctrl2);
+		bool operator==(const CollisionPair& other) const;
+	};
+
+	struct CollisionPairHash
+	{
+		size_t operator()(const CollisionPair& pair) const;
 	};
 
 	PHY_IPhysicsEnvironment *m_physEnv;
+	/// Proximity queries of the near and radar sensors without physics controller, owned by the scene.
+	KX_ProximityManager *m_proximityManager;
 
-	std::set<NewCollision> m_newCollisions;
+	/// Collisions of the frame in the order they were reported.
+	std::vector<NewCollision> m_newCollisions;
+	/// Interest of each pair collided during the frame, in the order of the pair.
+	std::unordered_map<CollisionPair, short, CollisionPairHash> m_collisionPairs;
+
+	/// Return the interest of the sides of a collision, zero if nobody uses it.
+	static short GetCollisionInterest(PHY_IPhysicsController *ctrl1, PHY_IPhysicsController *ctrl2);
+	/// Exchange the interests of the first and second sides.
+	static short SwapCollisionInterest(short interest);
 
 	static bool newCollisionResponse(void *client_data,
 	                                 void *object1,
@@ -90,7 +115,8 @@ class KX_CollisionEventManager : public SCA_EventManager
 
 public:
 	KX_CollisionEventManager(class SCA_LogicManager *logicmgr,
-	                         PHY_IPhysicsEnvironment *physEnv);
+	                         PHY_IPhysicsEnvironment *physEnv,
+	                         KX_ProximityManager *proximityManager);
 	virtual ~KX_CollisionEventManager();
 	virtual void NextFrame();
 	virtual void EndFrame();
@@ -105,6 +131,10 @@ public:
 	{
 		return m_physEnv;
 	}
+	KX_ProximityManager *GetProximityManager()
+	{
+		return m_proximityManager;
+	}
 };
 
 #endif  // __KX_TOUCHEVENTMANAGER_H__
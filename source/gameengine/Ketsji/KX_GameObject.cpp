@@ -1630,6 +1630,16 @@ void KX_GameObject::RegisterCollisionCallbacks()
       pe->AddSensor(spc);
   }
 }
+
+bool KX_GameObject::HasCollisionCallbacks() const
+{
+#ifdef WITH_PYTHON
+  return (m_collisionCallbacks && PyList_GET_SIZE(m_collisionCallbacks) != 0);
+#else
+  return false;
+#endif
+}
+
 void KX_GameObject::RunCollisionCallbacks(KX_GameObject *collider,
                                           KX_CollisionContactPointList &contactPointList)
 {
@@ -2208,29 +2218,31 @@ PyObject *KX_GameObject::PyReinstancePhysicsMesh(PyObject *args)
   RAS_MeshObject *mesh = nullptr;
   SCA_LogicManager *logicmgr = GetScene()->GetLogicManager();
   int dupli = 0;
+  int deferred = 0;
 
   PyObject *gameobj_py = nullptr;
   PyObject *mesh_py = nullptr;
 
-  if (!PyArg_ParseTuple(args, "|OOi:reinstancePhysicsMesh", &gameobj_py, &mesh_py, &dupli) ||
+  if (!PyArg_ParseTuple(
+          args, "|OOii:reinstancePhysicsMesh", &gameobj_py, &mesh_py, &dupli, &deferred) ||
       (gameobj_py && !ConvertPythonToGameObject(
                          logicmgr,
                          gameobj_py,
                          &gameobj,
                          true,
-                         "gameOb.reinstancePhysicsMesh(obj, mesh, dupli): KX_GameObject")) ||
+                         "gameOb.reinstancePhysicsMesh(obj, mesh, dupli, deferred): KX_GameObject")) ||
       (mesh_py &&
        !ConvertPythonToMesh(logicmgr,
                             mesh_py,
                             &mesh,
                             true,
-                            "gameOb.reinstancePhysicsMesh(obj, mesh, dupli): KX_GameObject"))) {
+                            "gameOb.reinstancePhysicsMesh(obj, mesh, dupli, deferred): KX_GameObject"))) {
     return nullptr;
   }
 
   /* gameobj and mesh can be nullptr */
   if (GetPhysicsController() &&
-      GetPhysicsController()->ReinstancePhysicsShape(gameobj, mesh, dupli))
+      GetPhysicsController()->ReinstancePhysicsShape(gameobj, mesh, dupli, deferred))
     Py_RETURN_TRUE;
 
   Py_RETURN_FALSE;
@@ -2359,8 +2371,10 @@ static int Map_SetItem(PyObject *self_v, PyObject *key, PyObject *val)
       if (vallie) {
         CValue *oldprop = self->GetProperty(attr_str);
 
-        if (oldprop)
+        if (oldprop) {
           oldprop->SetValue(vallie);
+          self->WakePropertySensors();
+        }
         else
           self->SetProperty(attr_str, vallie);
 
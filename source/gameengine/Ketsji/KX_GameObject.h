@@ -820,6 +820,8 @@ public:
 	void RegisterCollisionCallbacks();
 	void UnregisterCollisionCallbacks();
 	void RunCollisionCallbacks(KX_GameObject *collider, KX_CollisionContactPointList& contactPointList);
+	/// Return true if python collision callbacks are set.
+	bool HasCollisionCallbacks() const;
 	/**
 	 * Stop making progress
 	 */
@@ -99,7 +99,9 @@ public:
 		/// Automatic add debug properties to the debug list.
 		AUTO_ADD_DEBUG_PROPERTIES = (1 << 6),
 		/// Use override camera?
-		CAMERA_OVERRIDE = (1 << 7)
+		CAMERA_OVERRIDE = (1 << 7),
+		/// Resample the armature actions at the logic tic rate?
+		RESAMPLE_ACTIONS = (1 << 8)
 	};
 
 private:
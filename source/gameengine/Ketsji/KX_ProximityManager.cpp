@@ -0,0 +1,372 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Ketsji/KX_ProximityManager.cpp
+ *  \ingroup ketsji
+ */
+
+#include "KX_ProximityManager.h"
+#include "KX_GameObject.h"
+#include "KX_Scene.h"
+#include "KX_ClientObjectInfo.h"
+#include "EXP_ListValue.h"
+
+#include "PHY_IPhysicsController.h"
+
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+/// Minimum number of queries to run them in parallel.
+static const int parallelQueryThreshold = 64;
+/// Maximum number of cells visited by a query before testing all the entries instead.
+static const int maxQueryCells = 4096;
+
+static bool sphere_intersect_aabb(const MT_Vector3& center, float radius, const MT_Vector3& min, const MT_Vector3& max)
+{
+	float dist = 0.0f;
+	for (unsigned short i = 0; i < 3; ++i) {
+		const float v = center[i];
+		if (v < min[i]) {
+			dist += (min[i] - v) * (min[i] - v);
+		}
+		else if (v > max[i]) {
+			dist += (v - max[i]) * (v - max[i]);
+		}
+	}
+
+	return (dist <= radius * radius);
+}
+
+/// Conservative test of the bounding sphere of the box against the cone.
+static bool cone_intersect_aabb(const SCA_NearSensor::ProximityShape& cone, const MT_Vector3& min, const MT_Vector3& max)
+{
+	if (cone.m_height <= 0.0f) {
+		return false;
+	}
+
+	const MT_Vector3 center = (min + max) * 0.5f;
+	const float radius = (max - min).length() * 0.5f;
+
+	const MT_Vector3 vec = center - cone.m_origin;
+	const float along = vec.dot(cone.m_axis);
+	if (along < -radius || along > cone.m_height + radius) {
+		return false;
+	}
+
+	const float tan = cone.m_radius / cone.m_height;
+	const float cos = cone.m_height / std::sqrt(cone.m_height * cone.m_height + cone.m_radius * cone.m_radius);
+	const float axisDist = std::sqrt(std::max(vec.length2() - along * along, 0.0f));
+
+	return ((axisDist - along * tan) * cos <= radius);
+}
+
+static bool shape_intersect_aabb(const SCA_NearSensor::ProximityShape& shape, const MT_Vector3& min, const MT_Vector3& max)
+{
+	if (shape.m_cone) {
+		return cone_intersect_aabb(shape, min, max);
+	}
+	return sphere_intersect_aabb(shape.m_origin, shape.m_radius, min, max);
+}
+
+KX_ProximityManager::KX_ProximityManager(KX_Scene *scene)
+	:m_scene(scene),
+	m_numIndices(0),
+	m_cellSize(1.0f)
+{
+}
+
+KX_ProximityManager::~KX_ProximityManager()
+{
+}
+
+void KX_ProximityManager::AddSensor(SCA_NearSensor *sensor)
+{
+	Query query;
+	query.m_sensor = sensor;
+	query.m_index = 0;
+	query.m_ticks = 0;
+	query.m_scheduled = false;
+	m_queries.push_back(query);
+}
+
+void KX_ProximityManager::RemoveSensor(SCA_NearSensor *sensor)
+{
+	for (unsigned int i = 0, size = m_queries.size(); i < size; ++i) {
+		if (m_queries[i].m_sensor == sensor) {
+			std::swap(m_queries[i], m_queries.back());
+			m_queries.pop_back();
+			break;
+		}
+	}
+}
+
+void KX_ProximityManager::RemoveObject(KX_GameObject *gameobj)
+{
+	for (Query& query : m_queries) {
+		std::vector<KX_GameObject *>& hits = query.m_hits;
+		hits.erase(std::remove(hits.begin(), hits.end(), gameobj), hits.end());
+	}
+}
+
+unsigned long long KX_ProximityManager::GetCellKey(int x, int y, int z) const
+{
+	// Pack 21 bits per axis, wrapping cells only produce extra candidates.
+	const unsigned long long mask = (1 << 21) - 1;
+	return (((unsigned long long)x & mask) << 42) | (((unsigned long long)y & mask) << 21) | ((unsigned long long)z & mask);
+}
+
+void KX_ProximityManager::BuildIndices()
+{
+	for (unsigned int i = 0; i < m_numIndices; ++i) {
+		Index& index = m_indices[i];
+		index.m_entries.clear();
+		index.m_keys.clear();
+		index.m_cells.clear();
+		index.m_largeEntries.clear();
+		index.m_maxExtent = 0.0f;
+	}
+	m_numIndices = 0;
+
+	// One index per distinct property filter, the cells are sized from the average query reach.
+	float reach = 0.0f;
+	unsigned int numScheduled = 0;
+	for (Query& query : m_queries) {
+		if (!query.m_scheduled) {
+			continue;
+		}
+
+		const std::string& property = query.m_sensor->GetTouchedPropertyName();
+		unsigned int i = 0;
+		while (i < m_numIndices && m_indices[i].m_property != property) {
+			++i;
+		}
+		if (i == m_numIndices) {
+			if (m_indices.size() <= i) {
+				m_indices.resize(i + 1);
+			}
+			m_indices[i].m_property = property;
+			m_indices[i].m_maxExtent = 0.0f;
+			++m_numIndices;
+		}
+		query.m_index = i;
+
+		reach += query.m_shape.m_cone ? std::max(query.m_shape.m_height, query.m_shape.m_radius) : query.m_shape.m_radius;
+		++numScheduled;
+	}
+
+	if (numScheduled == 0) {
+		return;
+	}
+
+	m_cellSize = std::max(reach / numScheduled, 1.0f);
+
+	for (KX_GameObject *gameobj : *m_scene->GetObjectList()) {
+		// Same filtering than SCA_NearSensor::BroadPhaseFilterCollision.
+		KX_ClientObjectInfo *info = gameobj->getClientInfo();
+		PHY_IPhysicsController *ctrl = gameobj->GetPhysicsController();
+		if (!info || info->m_type != KX_ClientObjectInfo::ACTOR || !ctrl || ctrl->IsPhysicsSuspended()) {
+			continue;
+		}
+
+		bool hasBounds = false;
+		Entry entry;
+		entry.m_object = gameobj;
+
+		for (unsigned int i = 0; i < m_numIndices; ++i) {
+			Index& index = m_indices[i];
+			if (!index.m_property.empty() && !gameobj->GetProperty(index.m_property)) {
+				continue;
+			}
+
+			if (!hasBounds) {
+				ctrl->GetAabb(entry.m_min, entry.m_max);
+				hasBounds = true;
+			}
+
+			const MT_Vector3 extent = (entry.m_max - entry.m_min) * 0.5f;
+			const float maxExtent = std::max(extent[0], std::max(extent[1], extent[2]));
+			if (maxExtent > m_cellSize) {
+				index.m_largeEntries.push_back(entry);
+				continue;
+			}
+
+			const MT_Vector3 center = (entry.m_min + entry.m_max) * 0.5f;
+			index.m_keys.push_back(GetCellKey((int)std::floor(center[0] / m_cellSize),
+			                                  (int)std::floor(center[1] / m_cellSize),
+			                                  (int)std::floor(center[2] / m_cellSize)));
+			index.m_entries.push_back(entry);
+			index.m_maxExtent = std::max(index.m_maxExtent, maxExtent);
+		}
+	}
+
+	// Sort the entries by cell to store a range per cell.
+	std::vector<unsigned int> order;
+	std::vector<Entry> sorted;
+	for (unsigned int i = 0; i < m_numIndices; ++i) {
+		Index& index = m_indices[i];
+		const unsigned int size = index.m_entries.size();
+
+		order.resize(size);
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&index](unsigned int a, unsigned int b) {
+			return index.m_keys[a] < index.m_keys[b];
+		});
+
+		sorted.resize(size);
+		for (unsigned int j = 0; j < size; ++j) {
+			sorted[j] = index.m_entries[order[j]];
+		}
+		index.m_entries.swap(sorted);
+
+		for (unsigned int j = 0; j < size;) {
+			const unsigned long long key = index.m_keys[order[j]];
+			unsigned int end = j + 1;
+			while (end < size && index.m_keys[order[end]] == key) {
+				++end;
+			}
+			index.m_cells[key] = std::make_pair(j, end);
+			j = end;
+		}
+	}
+}
+
+void KX_ProximityManager::QueryIndex(Query& query) const
+{
+	const Index& index = m_indices[query.m_index];
+	const SCA_NearSensor::ProximityShape& shape = query.m_shape;
+	KX_GameObject *parent = static_cast<KX_GameObject *>(query.m_sensor->GetParent());
+
+	query.m_hits.clear();
+
+	MT_Vector3 min;
+	MT_Vector3 max;
+	if (shape.m_cone) {
+		const MT_Vector3 base = shape.m_origin + shape.m_axis * shape.m_height;
+		for (unsigned short i = 0; i < 3; ++i) {
+			min[i] = std::min(shape.m_origin[i], base[i]) - shape.m_radius;
+			max[i] = std::max(shape.m_origin[i], base[i]) + shape.m_radius;
+		}
+	}
+	else {
+		const MT_Vector3 radius(shape.m_radius, shape.m_radius, shape.m_radius);
+		min = shape.m_origin - radius;
+		max = shape.m_origin + radius;
+	}
+
+	// Entries are hashed by their center, extend the query by their size.
+	const MT_Vector3 extent(index.m_maxExtent, index.m_maxExtent, index.m_maxExtent);
+	min -= extent;
+	max += extent;
+
+	int cellMin[3];
+	int cellMax[3];
+	long long numCells = 1;
+	for (unsigned short i = 0; i < 3; ++i) {
+		cellMin[i] = (int)std::floor(min[i] / m_cellSize);
+		cellMax[i] = (int)std::floor(max[i] / m_cellSize);
+		numCells *= (cellMax[i] - cellMin[i] + 1);
+	}
+
+	const auto testEntry = [&query, &shape, parent](const Entry& entry) {
+		if (entry.m_object != parent && shape_intersect_aabb(shape, entry.m_min, entry.m_max)) {
+			query.m_hits.push_back(entry.m_object);
+		}
+	};
+
+	if (numCells > maxQueryCells || numCells > (long long)index.m_entries.size()) {
+		for (const Entry& entry : index.m_entries) {
+			testEntry(entry);
+		}
+	}
+	else {
+		for (int x = cellMin[0]; x <= cellMax[0]; ++x) {
+			for (int y = cellMin[1]; y <= cellMax[1]; ++y) {
+				for (int z = cellMin[2]; z <= cellMax[2]; ++z) {
+					const auto it = index.m_cells.find(GetCellKey(x, y, z));
+					if (it == index.m_cells.end()) {
+						continue;
+					}
+					for (unsigned int i = it->second.first; i < it->second.second; ++i) {
+						testEntry(index.m_entries[i]);
+					}
+				}
+			}
+		}
+	}
+
+	for (const Entry& entry : index.m_largeEntries) {
+		testEntry(entry);
+	}
+}
+
+void KX_ProximityManager::QueryTask(void *__restrict userdata, const int index, const TaskParallelTLS *__restrict UNUSED(tls))
+{
+	KX_ProximityManager *manager = (KX_ProximityManager *)userdata;
+	Query& query = manager->m_queries[index];
+	if (query.m_scheduled) {
+		manager->QueryIndex(query);
+	}
+}
+
+void KX_ProximityManager::Update()
+{
+	for (Query& query : m_queries) {
+		SCA_NearSensor *sensor = query.m_sensor;
+		if (!sensor->IsProximityActive()) {
+			query.m_scheduled = false;
+			query.m_ticks = 0;
+			query.m_hits.clear();
+			continue;
+		}
+
+		// Sensors pulsing at a lower frequency reuse their previous results between pulses.
+		query.m_scheduled = (query.m_ticks <= 0);
+		if (query.m_scheduled) {
+			query.m_ticks = sensor->GetProximitySkippedTicks();
+			sensor->GetProximityShape(query.m_shape);
+		}
+		else {
+			--query.m_ticks;
+		}
+	}
+
+	BuildIndices();
+
+	if (m_numIndices > 0) {
+		TaskParallelSettings settings;
+		BLI_parallel_range_settings_defaults(&settings);
+		settings.use_threading = ((int)m_queries.size() >= parallelQueryThreshold);
+
+		BLI_task_parallel_range(0, m_queries.size(), this, QueryTask, &settings);
+	}
+
+	// Colliders are reference counted, they are added in the main thread.
+	for (Query& query : m_queries) {
+		for (KX_GameObject *gameobj : query.m_hits) {
+			query.m_sensor->AddCollider(gameobj);
+		}
+	}
+}
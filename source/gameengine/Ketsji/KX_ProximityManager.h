@@ -0,0 +1,114 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file KX_ProximityManager.h
+ *  \ingroup ketsji
+ */
+
+#ifndef __KX_PROXIMITYMANAGER_H__
+#define __KX_PROXIMITYMANAGER_H__
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "SCA_NearSensor.h"
+#include "MT_Vector3.h"
+
+class KX_GameObject;
+class KX_Scene;
+
+/**
+ * KX_ProximityManager evaluates the near and radar sensors without physics objects.
+ *
+ * Every frame the actor objects are stored in a spatial hash, one per distinct property
+ * filter used by the sensors, so the property is tested once per object instead of once
+ * per sensor and object pair. The sensor volumes are then tested in parallel against the
+ * hashed bounding boxes and the results are given to the sensors in the main thread.
+ */
+class KX_ProximityManager
+{
+public:
+	/// Object bounds stored in a spatial hash.
+	struct Entry
+	{
+		KX_GameObject *m_object;
+		MT_Vector3 m_min;
+		MT_Vector3 m_max;
+	};
+
+	/// Spatial hash of the actors owning a property.
+	struct Index
+	{
+		std::string m_property;
+		/// Entries sorted by cell.
+		std::vector<Entry> m_entries;
+		std::vector<unsigned long long> m_keys;
+		/// Range of m_entries of each cell.
+		std::unordered_map<unsigned long long, std::pair<unsigned int, unsigned int> > m_cells;
+		/// Entries larger than a cell, tested by every query.
+		std::vector<Entry> m_largeEntries;
+		/// Maximum half size of the entries stored in cells.
+		float m_maxExtent;
+	};
+
+	/// State of a registered sensor.
+	struct Query
+	{
+		SCA_NearSensor *m_sensor;
+		SCA_NearSensor::ProximityShape m_shape;
+		/// Index used by the query in the current update.
+		unsigned int m_index;
+		/// Frames left until the next query.
+		int m_ticks;
+		bool m_scheduled;
+		/// Objects detected by the last query.
+		std::vector<KX_GameObject *> m_hits;
+	};
+
+private:
+	KX_Scene *m_scene;
+	std::vector<Query> m_queries;
+	std::vector<Index> m_indices;
+	unsigned int m_numIndices;
+	float m_cellSize;
+
+	unsigned long long GetCellKey(int x, int y, int z) const;
+	void BuildIndices();
+	void QueryIndex(Query& query) const;
+
+	static void QueryTask(void *__restrict userdata, const int index, const struct TaskParallelTLS *__restrict tls);
+
+public:
+	KX_ProximityManager(KX_Scene *scene);
+	~KX_ProximityManager();
+
+	void AddSensor(SCA_NearSensor *sensor);
+	void RemoveSensor(SCA_NearSensor *sensor);
+	/// Forget an object removed from the scene.
+	void RemoveObject(KX_GameObject *gameobj);
+
+	/// Query all the registered sensors, called before the sensors are evaluated.
+	void Update();
+};
+
+#endif  // __KX_PROXIMITYMANAGER_H__
@@ -58,28 +58,7 @@ UpdateChildCoordinates(
 ) {
 	BLI_assert(child != nullptr);
 
-	if (!parentUpdated && !child->IsModified())
-		return false;
-
-	parentUpdated = true;
-
-	if (parent==nullptr) { /* Simple case */
-		child->SetWorldFromLocalTransform();
-		child->ClearModified();
-		return true; //false;
-	}
-	else {
-		// the childs world locations which we will update.
-		const MT_Vector3 & p_world_scale = parent->GetWorldScaling();
-		const MT_Vector3 & p_world_pos = parent->GetWorldPosition();
-		const MT_Matrix3x3 & p_world_rotation = parent->GetWorldOrientation();
-
-		child->SetWorldScale(p_world_scale * child->GetLocalScale());
-		child->SetWorldOrientation(p_world_rotation * child->GetLocalOrientation());
-		child->SetWorldPosition(p_world_pos + p_world_scale * (p_world_rotation * child->GetLocalPosition()));
-		child->ClearModified();
-		return true;
-	}
+	return child->ComputeNormalWorldTransforms(parent, parentUpdated);
 }
 
 	SG_ParentRelation *
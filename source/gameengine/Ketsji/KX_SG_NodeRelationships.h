@@ -78,6 +78,16 @@ public :
 	NewCopy(
 	);
 
+	/**
+	 * Method inherited from KX_ParentRelation
+	 */
+
+		bool
+	IsNormalRelation(
+	) {
+		return true;
+	}
+
 	~KX_NormalParentRelation(
 	);
 
@@ -73,6 +73,7 @@
 #include "SCA_IActuator.h"
 #include "SG_Node.h"
 #include "SG_Controller.h"
+#include "SG_TransformHierarchy.h"
 #include "SG_Node.h"
 #include "DNA_scene_types.h"
 #include "DNA_property_types.h"
@@ -88,6 +89,9 @@
 #include "KX_BlenderConverter.h"
 #include "KX_MotionState.h"
 #include "KX_ObstacleSimulation.h"
+#include "KX_ProximityManager.h"
+#include "KX_StaticInstanceSet.h"
+#include "BL_PoseCache.h"
 
 #include "KX_BlenderCanvas.h"
 
@@ -211,7 +215,8 @@ KX_Scene::KX_Scene(SCA_IInputDevice *inputDevice,
   m_mousemgr = new SCA_MouseManager(m_logicmgr, inputDevice);
 
   SCA_ActuatorEventManager *actmgr = new SCA_ActuatorEventManager(m_logicmgr);
-  SCA_BasicEventManager *basicmgr = new SCA_BasicEventManager(m_logicmgr);
+  SCA_BasicEventManager *basicmgr = new SCA_BasicEventManager(
+      m_logicmgr, (scene->gm.flag & GAME_EVENT_DRIVEN_SENSORS) != 0);
 
   m_logicmgr->RegisterEventManager(actmgr);
   m_logicmgr->RegisterEventManager(m_keyboardmgr);
@@ -242,9 +247,30 @@ KX_Scene::KX_Scene(SCA_IInputDevice *inputDevice,
       m_obstacleSimulation = nullptr;
   }
 
+  if (scene->gm.flag & GAME_USE_PROXIMITY_QUERIES) {
+    m_proximityManager = new KX_ProximityManager(this);
+  }
+  else {
+    m_proximityManager = nullptr;
+  }
+
   m_animationPool = BLI_task_pool_create(KX_GetActiveEngine()->GetTaskScheduler(),
                                          &m_animationPoolData);
 
+  if (scene->gm.flag & GAME_FLAT_SCENEGRAPH) {
+    m_transformHierarchy = new SG_TransformHierarchy();
+  }
+  else {
+    m_transformHierarchy = nullptr;
+  }
+
+  if (scene->gm.flag & GAME_USE_POSE_CACHE) {
+    m_poseCache = new BL_PoseCache(scene->gm.poseCacheFrameStep);
+  }
+  else {
+    m_poseCache = nullptr;
+  }
+
   /*************************************************EEVEE
    * INTEGRATION***********************************************************/
   m_staticObjects = {};
@@ -373,6 +399,18 @@ KX_Scene::~KX_Scene()
     BLI_task_pool_free(m_animationPool);
   }
 
+  if (m_poseCache) {
+    delete m_poseCache;
+  }
+
+  if (m_transformHierarchy) {
+    delete m_transformHierarchy;
+  }
+
+  for (KX_StaticInstanceSet *instanceSet : m_staticInstanceSets) {
+    delete instanceSet;
+  }
+
   if (m_objectlist)
     m_objectlist->Release();
 
@@ -406,6 +444,11 @@ KX_Scene::~KX_Scene()
   if (m_logicmgr)
     delete m_logicmgr;
 
+  // Deleted after the logic manager which unregisters the sensors.
+  if (m_proximityManager) {
+    delete m_proximityManager;
+  }
+
   if (m_physicsEnvironment)
     delete m_physicsEnvironment;
 
@@ -712,6 +755,8 @@ void KX_Scene::RenderAfterCameraSetup(KX_Camera *cam, bool is_overlay_pass)
    */
   if (scene->gm.flag & GAME_USE_VIEWPORT_RENDER && ar) {
     if (cam) {
+      /* The static instances are drawn by the viewport too. */
+      UpdateObjectLods(cam);
       DRW_view_set_active(NULL);
 
       InitBlenderContextVariables();
@@ -1194,6 +1239,11 @@ void KX_Scene::DupliGroupRecurse(KX_GameObject *groupobj, int level)
   if (!groupobj->GetSGNode() || !groupobj->IsDupliGroup() || level > MAX_DUPLI_RECUR)
     return;
 
+  if (blgroupobj->gameflag2 & OB_STATIC_INSTANCES) {
+    AddStaticInstances(groupobj);
+    return;
+  }
+
   // we will add one group at a time
   m_logicHierarchicalGameObjects.clear();
   m_map_gameobject_to_replica.clear();
@@ -1322,6 +1372,62 @@ void KX_Scene::DupliGroupRecurse(KX_GameObject *groupobj, int level)
   }
 }
 
+void KX_Scene::AddStaticInstances(KX_GameObject *groupobj)
+{
+  Object *blgroupobj = groupobj->GetBlenderObject();
+  Collection *group = blgroupobj->instance_collection;
+
+  /* Only the top objects with a mesh are instanced, their children, logic and physics are
+   * ignored as the instances are static and have no game object. */
+  std::vector<KX_GameObject *> sources;
+  FOREACH_COLLECTION_OBJECT_RECURSIVE_BEGIN (group, blenderobj) {
+    if (blgroupobj == blenderobj) {
+      continue;
+    }
+
+    KX_GameObject *gameobj = (KX_GameObject *)m_logicmgr->FindGameObjByBlendObj(blenderobj);
+    if (gameobj == nullptr || (blenderobj->lay & group->layer) == 0) {
+      continue;
+    }
+
+    if (gameobj->GetParent() == nullptr && gameobj->GetMeshCount() > 0) {
+      sources.push_back(gameobj);
+    }
+  }
+  FOREACH_COLLECTION_OBJECT_RECURSIVE_END;
+
+  KX_StaticInstanceSet *instanceSet = nullptr;
+  for (KX_StaticInstanceSet *set : m_staticInstanceSets) {
+    if (set->GetCollection() == group) {
+      instanceSet = set;
+      break;
+    }
+  }
+
+  if (!instanceSet) {
+    instanceSet = new KX_StaticInstanceSet(this, group);
+    m_staticInstanceSets.push_back(instanceSet);
+  }
+
+  instanceSet->AddInstancer(groupobj, sources);
+}
+
+void KX_Scene::RemoveStaticInstances(KX_GameObject *groupobj)
+{
+  /* The instance collection can be changed at runtime, so all sets are checked. */
+  for (std::vector<KX_StaticInstanceSet *>::iterator it = m_staticInstanceSets.begin();
+       it != m_staticInstanceSets.end();) {
+    KX_StaticInstanceSet *instanceSet = *it;
+    if (instanceSet->RemoveInstancer(groupobj)) {
+      delete instanceSet;
+      it = m_staticInstanceSets.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+}
+
 KX_GameObject *KX_Scene::AddReplicaObject(KX_GameObject *originalobject,
                                           KX_GameObject *referenceobject,
                                           float lifespan)
@@ -1442,6 +1548,7 @@ void KX_Scene::RemoveDupliGroup(KX_GameObject *gameobj)
     for (KX_GameObject *instance : gameobj->GetInstanceObjects()) {
       DelayedRemoveObject(instance);
     }
+    RemoveStaticInstances(gameobj);
   }
 }
 
@@ -1514,6 +1621,11 @@ bool KX_Scene::NewRemoveObject(KX_GameObject *gameobj)
     }
   }
 
+  // the Blender object of a static instancer may be freed with it, unregister it before
+  if (gameobj->IsDupliGroup()) {
+    RemoveStaticInstances(gameobj);
+  }
+
   // if this object was part of a group, make sure to remove it from that group's instance list
   KX_GameObject *group = gameobj->GetDupliGroupObject();
   if (group)
@@ -1523,6 +1635,10 @@ bool KX_Scene::NewRemoveObject(KX_GameObject *gameobj)
     m_obstacleSimulation->DestroyObstacleForObj(gameobj);
   }
 
+  if (m_proximityManager) {
+    m_proximityManager->RemoveObject(gameobj);
+  }
+
   gameobj->RemoveMeshes();
 
   bool ret = true;
@@ -1800,6 +1916,11 @@ void KX_Scene::UpdateAnimations(double curtime)
 {
   // m_animationPoolData.curtime = curtime;
 
+  // Poses are only shared between objects updated at the same time.
+  if (m_poseCache) {
+    m_poseCache->Clear();
+  }
+
   for (KX_GameObject *gameobj : m_animatedlist) {
     // BLI_task_pool_push(m_animationPool, update_anim_thread_func, gameobj, false,
     // TASK_PRIORITY_LOW);
@@ -1860,8 +1981,13 @@ void KX_Scene::UpdateParents(double curtime)
   // we use the SG dynamic list
   SG_Node *node;
 
-  while ((node = SG_Node::GetNextScheduled(m_sghead)) != nullptr) {
-    node->UpdateWorldData(curtime);
+  if (m_transformHierarchy) {
+    m_transformHierarchy->Update(m_sghead, curtime);
+  }
+  else {
+    while ((node = SG_Node::GetNextScheduled(m_sghead)) != nullptr) {
+      node->UpdateWorldData(curtime);
+    }
   }
 
   // the list must be empty here
@@ -1895,6 +2021,17 @@ void KX_Scene::UpdateObjectLods(KX_Camera *cam /*, const KX_CullingNodeList& nod
   for (KX_GameObject *gameobj : GetObjectList()) {
     gameobj->UpdateLod(cam_pos, 1.0f /*lodfactor*/);
   }
+
+  if (!m_staticInstanceSets.empty()) {
+    Main *bmain = KX_GetActiveEngine()->GetConverter()->GetMain();
+    Scene *scene = GetBlenderScene();
+    ViewLayer *view_layer = BKE_view_layer_default_view(scene);
+    Depsgraph *depsgraph = BKE_scene_get_depsgraph(bmain, scene, view_layer, false);
+
+    for (KX_StaticInstanceSet *instanceSet : m_staticInstanceSets) {
+      instanceSet->Update(depsgraph, cam, 1.0f /*lodfactor*/);
+    }
+  }
 }
 
 void KX_Scene::SetLodHysteresis(bool active)
@@ -1977,7 +2114,8 @@ void KX_Scene::SetPhysicsEnvironment(class PHY_IPhysicsEnvironment *physEnv)
 {
   m_physicsEnvironment = physEnv;
   if (m_physicsEnvironment) {
-    KX_CollisionEventManager *collisionmgr = new KX_CollisionEventManager(m_logicmgr, physEnv);
+    KX_CollisionEventManager *collisionmgr = new KX_CollisionEventManager(
+        m_logicmgr, physEnv, m_proximityManager);
     m_logicmgr->RegisterEventManager(collisionmgr);
   }
 }
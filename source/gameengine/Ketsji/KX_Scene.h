@@ -90,6 +90,10 @@ class btCollisionShape;
 class KX_BlenderSceneConverter;
 struct KX_ClientObjectInfo;
 class KX_ObstacleSimulation;
+class BL_PoseCache;
+class KX_ProximityManager;
+class KX_StaticInstanceSet;
+class SG_TransformHierarchy;
 struct TaskPool;
 
 /*********EEVEE INTEGRATION************/
@@ -177,6 +181,8 @@ protected:
 										// the Dlist is not object that must be updated
 										// the Qlist is for objects that needs to be rescheduled
 										// for updates after udpate is over (slow parent, bone parent)
+	/// Flattened scene graph update, nullptr when nodes are updated recursively.
+	SG_TransformHierarchy *m_transformHierarchy;
 
 	/**
 	 * Various SCA managers used by the scene
@@ -308,9 +314,18 @@ protected:
 
 	KX_ObstacleSimulation* m_obstacleSimulation;
 
+	/// Near and radar sensors queries, nullptr when the sensors use physics objects.
+	KX_ProximityManager *m_proximityManager;
+
 	AnimationPoolData m_animationPoolData;
 	TaskPool *m_animationPool;
 
+	/// Armature poses shared between objects playing the same actions, nullptr when disabled.
+	BL_PoseCache *m_poseCache;
+
+	/// Instances of the collections instanced with static instances.
+	std::vector<KX_StaticInstanceSet *> m_staticInstanceSets;
+
 	/**
 	 * LOD Hysteresis settings
 	 */
@@ -366,6 +381,10 @@ public:
 	static bool KX_ScenegraphRescheduleFunc(SG_Node* node,void* gameobj,void* scene);
 	void UpdateParents(double curtime);
 	void DupliGroupRecurse(KX_GameObject *groupobj, int level);
+	/// Add the collection of a static instancer to its static instance set.
+	void AddStaticInstances(KX_GameObject *groupobj);
+	/// Remove a static instancer and its instances from its set.
+	void RemoveStaticInstances(KX_GameObject *groupobj);
 	bool IsObjectInGroup(KX_GameObject* gameobj)
 	{ 
 		return (m_groupGameObjects.empty() || 
@@ -559,6 +578,10 @@ public:
 
 	KX_ObstacleSimulation* GetObstacleSimulation() { return m_obstacleSimulation; }
 
+	KX_ProximityManager *GetProximityManager() { return m_proximityManager; }
+
+	BL_PoseCache *GetPoseCache() { return m_poseCache; }
+
 	/**  Inherited from CValue -- returns the name of this object. */
 	virtual std::string GetName();
 
@@ -0,0 +1,277 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Ketsji/KX_StaticInstanceSet.cpp
+ *  \ingroup ketsji
+ */
+
+#include "KX_StaticInstanceSet.h"
+#include "KX_Camera.h"
+#include "KX_GameObject.h"
+#include "KX_LodLevel.h"
+#include "KX_LodManager.h"
+#include "KX_Scene.h"
+
+#include "RAS_MeshObject.h"
+
+#include "MT_Transform.h"
+
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+
+extern "C" {
+#include "BKE_object.h"
+#include "DNA_collection_types.h"
+#include "DNA_object_types.h"
+#include "depsgraph/DEG_depsgraph_query.h"
+}
+
+#include <algorithm>
+#include <cmath>
+
+/// Minimum number of instances to cull them in parallel.
+static const int parallelCullThreshold = 1024;
+
+struct CullTaskData
+{
+	KX_StaticInstanceSet::Source *sources;
+	KX_StaticInstanceSet::Instance *instances;
+	unsigned char *visible;
+	KX_Scene *scene;
+	const SG_Frustum *frustum;
+	MT_Vector3 camPos;
+	float lodfactor;
+};
+
+KX_StaticInstanceSet::KX_StaticInstanceSet(KX_Scene *scene, Collection *collection)
+	:m_scene(scene),
+	m_collection(collection),
+	m_boundsValid(false)
+{
+	m_dupliInstances = {nullptr, nullptr, 0};
+	m_emptyInstances = {nullptr, nullptr, 0};
+}
+
+KX_StaticInstanceSet::~KX_StaticInstanceSet()
+{
+	// The instancers are removed from the set before they are freed, only the live ones are left.
+	for (KX_GameObject *instancer : m_instancers) {
+		instancer->GetBlenderObject()->runtime.dupli_instances = nullptr;
+	}
+}
+
+Collection *KX_StaticInstanceSet::GetCollection() const
+{
+	return m_collection;
+}
+
+unsigned int KX_StaticInstanceSet::GetInstanceCount() const
+{
+	return m_instances.size();
+}
+
+unsigned int KX_StaticInstanceSet::GetVisibleCount() const
+{
+	return m_visibleObjects.size();
+}
+
+void KX_StaticInstanceSet::AddInstancer(KX_GameObject *groupobj, const std::vector<KX_GameObject *>& sources)
+{
+	Object *instancer = groupobj->GetBlenderObject();
+	// Only the first instancer draws, the others only give their transform.
+	instancer->runtime.dupli_instances = m_instancers.empty() ? &m_dupliInstances : &m_emptyInstances;
+	m_instancers.push_back(groupobj);
+
+	const MT_Vector3 offset(m_collection->instance_offset);
+	const MT_Vector3& groupPos = groupobj->NodeGetWorldPosition();
+	const MT_Matrix3x3& groupOri = groupobj->NodeGetWorldOrientation();
+	const MT_Vector3& groupScale = groupobj->NodeGetWorldScaling();
+
+	for (KX_GameObject *gameobj : sources) {
+		unsigned int sourceIndex = 0;
+		while (sourceIndex < m_sources.size() && m_sources[sourceIndex].m_object != gameobj) {
+			++sourceIndex;
+		}
+
+		if (sourceIndex == m_sources.size()) {
+			Source source;
+			source.m_object = gameobj;
+			source.m_center = MT_Vector3(0.0f, 0.0f, 0.0f);
+			source.m_radius = -1.0f;
+
+			KX_LodManager *lodManager = gameobj->GetLodManager();
+			if (lodManager && lodManager->GetLevelCount() > 0) {
+				for (unsigned int i = 0, size = lodManager->GetLevelCount(); i < size; ++i) {
+					source.m_lodObjects.push_back(lodManager->GetLevel(i)->GetMesh()->GetOriginalObject());
+				}
+			}
+			else {
+				source.m_lodObjects.push_back(gameobj->GetBlenderObject());
+			}
+
+			m_sources.push_back(source);
+			m_boundsValid = false;
+		}
+
+		// Same transform as the replicas of KX_Scene::DupliGroupRecurse.
+		const MT_Vector3 pos = groupPos + groupScale * (groupOri * (gameobj->NodeGetWorldPosition() - offset));
+		const MT_Matrix3x3 ori = groupOri * gameobj->NodeGetWorldOrientation();
+		const MT_Vector3 scale = groupScale * gameobj->NodeGetWorldScaling();
+		const MT_Transform trans(pos, ori.scaled(scale.x(), scale.y(), scale.z()));
+
+		Instance instance;
+		trans.getValue(&instance.m_mat[0][0]);
+		instance.m_scale = std::max(std::fabs(scale.x()), std::max(std::fabs(scale.y()), std::fabs(scale.z())));
+		instance.m_source = sourceIndex;
+		instance.m_instancer = groupobj;
+		instance.m_lodLevel = 0;
+		m_instances.push_back(instance);
+	}
+}
+
+bool KX_StaticInstanceSet::RemoveInstancer(KX_GameObject *groupobj)
+{
+	std::vector<KX_GameObject *>::iterator it = std::find(m_instancers.begin(), m_instancers.end(), groupobj);
+	if (it == m_instancers.end()) {
+		return m_instancers.empty();
+	}
+
+	const bool drawing = (it == m_instancers.begin());
+	groupobj->GetBlenderObject()->runtime.dupli_instances = nullptr;
+	m_instancers.erase(it);
+
+	m_instances.erase(std::remove_if(m_instances.begin(), m_instances.end(),
+		[groupobj](const Instance& instance) { return instance.m_instancer == groupobj; }),
+		m_instances.end());
+
+	// The visible instances are filled again by the next update.
+	m_visibleObjects.clear();
+	m_visibleMatrices.clear();
+	m_dupliInstances.obs = nullptr;
+	m_dupliInstances.mats = nullptr;
+	m_dupliInstances.len = 0;
+
+	if (drawing && !m_instancers.empty()) {
+		m_instancers.front()->GetBlenderObject()->runtime.dupli_instances = &m_dupliInstances;
+	}
+
+	return m_instancers.empty();
+}
+
+void KX_StaticInstanceSet::UpdateBounds(Depsgraph *depsgraph)
+{
+	for (Source& source : m_sources) {
+		Object *ob_eval = DEG_get_evaluated_object(depsgraph, source.m_object->GetBlenderObject());
+		BoundBox *bb = BKE_object_boundbox_get(ob_eval);
+		if (!bb) {
+			// Never culled.
+			source.m_radius = -1.0f;
+			continue;
+		}
+
+		const MT_Vector3 min(bb->vec[0]);
+		const MT_Vector3 max(bb->vec[6]);
+		source.m_center = (min + max) * 0.5f;
+		source.m_radius = (max - min).length() * 0.5f;
+	}
+
+	m_boundsValid = true;
+}
+
+void KX_StaticInstanceSet::CullTask(void *__restrict userdata, const int index, const TaskParallelTLS *__restrict UNUSED(tls))
+{
+	CullTaskData *data = (CullTaskData *)userdata;
+	Instance& instance = data->instances[index];
+	const Source& source = data->sources[instance.m_source];
+	const float (*mat)[4] = instance.m_mat;
+
+	const MT_Vector3 center(
+		mat[0][0] * source.m_center.x() + mat[1][0] * source.m_center.y() + mat[2][0] * source.m_center.z() + mat[3][0],
+		mat[0][1] * source.m_center.x() + mat[1][1] * source.m_center.y() + mat[2][1] * source.m_center.z() + mat[3][1],
+		mat[0][2] * source.m_center.x() + mat[1][2] * source.m_center.y() + mat[2][2] * source.m_center.z() + mat[3][2]);
+
+	if (data->frustum && source.m_radius >= 0.0f &&
+	    data->frustum->SphereInsideFrustum(center, source.m_radius * instance.m_scale) == SG_Frustum::OUTSIDE)
+	{
+		data->visible[index] = 0;
+		return;
+	}
+
+	data->visible[index] = 1;
+
+	KX_LodManager *lodManager = source.m_object->GetLodManager();
+	if (lodManager && source.m_lodObjects.size() > 1) {
+		const MT_Vector3 pos(mat[3][0], mat[3][1], mat[3][2]);
+		const float distance2 = pos.distance2(data->camPos) * (data->lodfactor * data->lodfactor);
+		KX_LodLevel *lodLevel = lodManager->GetLevel(data->scene, instance.m_lodLevel, distance2);
+		if (lodLevel) {
+			instance.m_lodLevel = lodLevel->GetLevel();
+		}
+	}
+}
+
+void KX_StaticInstanceSet::Update(Depsgraph *depsgraph, KX_Camera *cam, float lodfactor)
+{
+	if (!m_boundsValid) {
+		UpdateBounds(depsgraph);
+	}
+
+	const unsigned int size = m_instances.size();
+	m_visible.resize(size);
+
+	CullTaskData data;
+	data.sources = m_sources.data();
+	data.instances = m_instances.data();
+	data.visible = m_visible.data();
+	data.scene = m_scene;
+	data.frustum = cam->GetFrustumCulling() ? &cam->GetFrustum() : nullptr;
+	data.camPos = cam->NodeGetWorldPosition();
+	data.lodfactor = lodfactor;
+
+	TaskParallelSettings settings;
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.use_threading = ((int)size >= parallelCullThreshold);
+	settings.min_iter_per_thread = parallelCullThreshold / 4;
+
+	BLI_task_parallel_range(0, size, &data, CullTask, &settings);
+
+	m_visibleObjects.clear();
+	m_visibleMatrices.clear();
+	for (unsigned int i = 0; i < size; ++i) {
+		if (!m_visible[i]) {
+			continue;
+		}
+
+		const Instance& instance = m_instances[i];
+		const Source& source = m_sources[instance.m_source];
+		const unsigned short level = std::min((unsigned short)instance.m_lodLevel, (unsigned short)(source.m_lodObjects.size() - 1));
+		m_visibleObjects.push_back(source.m_lodObjects[level]);
+
+		Matrix matrix;
+		std::copy(&instance.m_mat[0][0], &instance.m_mat[0][0] + 16, &matrix.m_mat[0][0]);
+		m_visibleMatrices.push_back(matrix);
+	}
+
+	m_dupliInstances.obs = m_visibleObjects.data();
+	m_dupliInstances.mats = (float (*)[4][4])m_visibleMatrices.data();
+	m_dupliInstances.len = m_visibleObjects.size();
+}
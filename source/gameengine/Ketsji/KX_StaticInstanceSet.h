@@ -0,0 +1,130 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file KX_StaticInstanceSet.h
+ *  \ingroup ketsji
+ */
+
+#ifndef __KX_STATICINSTANCESET_H__
+#define __KX_STATICINSTANCESET_H__
+
+#include <vector>
+
+#include "MT_Vector3.h"
+
+extern "C" {
+#include "BKE_anim.h"
+}
+
+class KX_Camera;
+class KX_GameObject;
+class KX_Scene;
+struct Collection;
+struct Depsgraph;
+struct Object;
+
+/**
+ * KX_StaticInstanceSet draws the static instances of a collection without game objects.
+ *
+ * The collection instancers using static instances share a set, each of them adds a
+ * transform per object of the collection instead of replicating the objects. For each
+ * camera the instances are culled and their level of detail is selected as a batch,
+ * the visible ones are then given to the first instancer as its duplis so they are
+ * drawn by EEVEE as instances of the source objects.
+ */
+class KX_StaticInstanceSet
+{
+public:
+	/// Object of the collection.
+	struct Source
+	{
+		KX_GameObject *m_object;
+		/// Original objects of each lod level, the object itself when it has no lod.
+		std::vector<Object *> m_lodObjects;
+		/// Bounding sphere in object space.
+		MT_Vector3 m_center;
+		float m_radius;
+	};
+
+	struct Instance
+	{
+		float m_mat[4][4];
+		/// Largest scale of the matrix axes, used to transform the bounding sphere.
+		float m_scale;
+		unsigned int m_source;
+		/// Instancer which added the instance.
+		KX_GameObject *m_instancer;
+		/// Lod level selected by the last update.
+		short m_lodLevel;
+	};
+
+	/// Matrix stored in an array given to the duplis generation.
+	struct Matrix
+	{
+		float m_mat[4][4];
+	};
+
+private:
+	KX_Scene *m_scene;
+	Collection *m_collection;
+	std::vector<Source> m_sources;
+	/// Instancers sharing this set, the first one draws the instances.
+	std::vector<KX_GameObject *> m_instancers;
+	std::vector<Instance> m_instances;
+	bool m_boundsValid;
+
+	/// Culling result of each instance.
+	std::vector<unsigned char> m_visible;
+	/// Visible instances given to the duplis generation.
+	std::vector<Object *> m_visibleObjects;
+	std::vector<Matrix> m_visibleMatrices;
+	DupliInstances m_dupliInstances;
+	/// Empty instances set to the other instancers so they don't draw their collection.
+	DupliInstances m_emptyInstances;
+
+	void UpdateBounds(Depsgraph *depsgraph);
+
+	static void CullTask(void *__restrict userdata, const int index, const struct TaskParallelTLS *__restrict tls);
+
+public:
+	KX_StaticInstanceSet(KX_Scene *scene, Collection *collection);
+	~KX_StaticInstanceSet();
+
+	Collection *GetCollection() const;
+	unsigned int GetInstanceCount() const;
+	unsigned int GetVisibleCount() const;
+
+	/** Add the instances of a collection instancer.
+	 * \param groupobj The instancer, its collection must be the set collection.
+	 * \param sources The objects of the collection to instance.
+	 */
+	void AddInstancer(KX_GameObject *groupobj, const std::vector<KX_GameObject *>& sources);
+	/** Remove an instancer and its instances, the next instancer draws the set if it was drawing.
+	 * \return True if the set has no instancer left.
+	 */
+	bool RemoveInstancer(KX_GameObject *groupobj);
+
+	/// Cull the instances and select their lod level for a camera.
+	void Update(Depsgraph *depsgraph, KX_Camera *cam, float lodfactor);
+};
+
+#endif  // __KX_STATICINSTANCESET_H__
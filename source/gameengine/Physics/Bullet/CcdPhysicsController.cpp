@@ -704,6 +704,53 @@ bool CcdPhysicsController::ReplaceControllerShape(btCollisionShape *newShape)
 	return true;
 }
 
+bool CcdPhysicsController::RefitControllerShape()
+{
+	if (!m_collisionShape || GetSoftBody()) {
+		return false;
+	}
+
+	switch (m_collisionShape->getShapeType()) {
+		case SCALED_TRIANGLE_MESH_SHAPE_PROXYTYPE:
+		{
+			btBvhTriangleMeshShape *meshShape = ((btScaledBvhTriangleMeshShape *)m_collisionShape)->getChildShape();
+			if (!meshShape->getOptimizedBvh()) {
+				return false;
+			}
+
+			btVector3 aabbMin, aabbMax;
+			meshShape->getMeshInterface()->calculateAabbBruteForce(aabbMin, aabbMax);
+
+			/* The partial refit keeps the quantization of the tree which is only valid inside the
+			 * initial bounds, the local bounds only grow on full refit so they are always inside.
+			 * It only refits the subtrees overlapping the given box, pass the local bounds so that
+			 * the subtrees outside of a shrunk mesh are refitted too. */
+			const btVector3 localAabbMin = meshShape->getLocalAabbMin();
+			const btVector3 localAabbMax = meshShape->getLocalAabbMax();
+			if (aabbMin.x() >= localAabbMin.x() && aabbMin.y() >= localAabbMin.y() && aabbMin.z() >= localAabbMin.z() &&
+			    aabbMax.x() <= localAabbMax.x() && aabbMax.y() <= localAabbMax.y() && aabbMax.z() <= localAabbMax.z())
+			{
+				meshShape->partialRefitTree(localAabbMin, localAabbMax);
+			}
+			else {
+				meshShape->refitTree(aabbMin, aabbMax);
+			}
+			break;
+		}
+		case GIMPACT_SHAPE_PROXYTYPE:
+		{
+			btGImpactMeshShape *gimpactShape = (btGImpactMeshShape *)m_collisionShape;
+			gimpactShape->postUpdate();
+			gimpactShape->updateBound();
+			break;
+		}
+		default:
+			return false;
+	}
+
+	return true;
+}
+
 CcdPhysicsController::~CcdPhysicsController()
 {
 	//will be reference counted, due to sharing
@@ -1635,6 +1682,16 @@ bool CcdPhysicsController::IsPhysicsSuspended()
 	return !GetPhysicsEnvironment()->IsActiveCcdPhysicsController(this);
 }
 
+void CcdPhysicsController::GetAabb(MT_Vector3& aabbMin, MT_Vector3& aabbMax)
+{
+	btVector3 min;
+	btVector3 max;
+	m_object->getCollisionShape()->getAabb(m_object->getWorldTransform(), min, max);
+
+	aabbMin = ToMoto(min);
+	aabbMax = ToMoto(max);
+}
+
 /* Refresh the physics object from either an object or a mesh.
  * from_gameobj and from_meshobj can be nullptr
  *
@@ -1645,7 +1702,7 @@ bool CcdPhysicsController::IsPhysicsSuspended()
  *
  * Most of the logic behind this is in m_shapeInfo->UpdateMesh(...)
  */
-bool CcdPhysicsController::ReinstancePhysicsShape(KX_GameObject *from_gameobj, RAS_MeshObject *from_meshobj, bool dupli)
+bool CcdPhysicsController::ReinstancePhysicsShape(KX_GameObject *from_gameobj, RAS_MeshObject *from_meshobj, bool dupli, bool deferred)
 {
 	if (m_shapeInfo->m_shapeType != PHY_SHAPE_MESH)
 		return false;
@@ -1653,6 +1710,9 @@ bool CcdPhysicsController::ReinstancePhysicsShape(KX_GameObject *from_gameobj, R
 	if (!from_gameobj && !from_meshobj)
 		from_gameobj = KX_GameObject::GetClientObject((KX_ClientObjectInfo *)GetNewClientInfo());
 
+	// The arrays can't change while a previous shape is built from them.
+	GetPhysicsEnvironment()->FinishShapeBuilds();
+
 	if (dupli && (m_shapeInfo->GetRefCount() > 1)) {
 		CcdShapeConstructionInfo *newShapeInfo = m_shapeInfo->GetReplica();
 		m_shapeInfo->Release();
@@ -1660,10 +1720,12 @@ bool CcdPhysicsController::ReinstancePhysicsShape(KX_GameObject *from_gameobj, R
 	}
 
 	/* updates the arrays used for making the new bullet mesh */
+	m_shapeInfo->BeginMeshUpdate();
 	m_shapeInfo->UpdateMesh(from_gameobj);
+	const bool refit = m_shapeInfo->EndMeshUpdate();
 
-	/* create the new bullet mesh */
-	GetPhysicsEnvironment()->UpdateCcdPhysicsControllerShape(m_shapeInfo);
+	/* refit or create the new bullet mesh */
+	GetPhysicsEnvironment()->UpdateCcdPhysicsControllerShape(m_shapeInfo, refit, deferred);
 
 	return true;
 }
@@ -1673,11 +1735,15 @@ bool CcdPhysicsController::ReinstancePhysicsShape2(RAS_MeshObject *meshobj, Obje
   if (m_shapeInfo->m_shapeType != PHY_SHAPE_MESH)
     return false;
 
+  GetPhysicsEnvironment()->FinishShapeBuilds();
+
   /* updates the arrays used for making the new bullet mesh */
+  m_shapeInfo->BeginMeshUpdate();
   m_shapeInfo->SetMesh2(meshobj, ob, recalcGeom);
+  const bool refit = m_shapeInfo->EndMeshUpdate();
 
-  /* create the new bullet mesh */
-  GetPhysicsEnvironment()->UpdateCcdPhysicsControllerShape(m_shapeInfo);
+  /* refit or create the new bullet mesh */
+  GetPhysicsEnvironment()->UpdateCcdPhysicsControllerShape(m_shapeInfo, refit, false);
 
   return true;
 }
@@ -1795,6 +1861,8 @@ void CcdShapeConstructionInfo::ProcessReplica()
 	m_userData = nullptr;
 	m_meshObject = nullptr;
 	m_triangleIndexVertexArray = nullptr;
+	m_weldedMesh = false;
+	m_retiredMeshes.clear();
 	m_forceReInstance = false;
 	m_shapeProxy = nullptr;
 	m_vertexArray.clear();
@@ -2690,6 +2758,111 @@ bool CcdShapeConstructionInfo::SetProxy(CcdShapeConstructionInfo *shapeInfo)
 	return true;
 }
 
+void CcdShapeConstructionInfo::UpdateMeshInterface(bool useWelding)
+{
+	if (m_triangleIndexVertexArray && !m_forceReInstance) {
+		return;
+	}
+
+	if (m_triangleIndexVertexArray) {
+		delete m_triangleIndexVertexArray;
+	}
+
+	///enable welding, only for the objects that need it (such as soft bodies)
+	if (useWelding && 0.0f != m_weldingThreshold1) {
+		btTriangleMesh *collisionMeshData = new btTriangleMesh(true, false);
+		collisionMeshData->m_weldingThreshold = m_weldingThreshold1;
+		bool removeDuplicateVertices = true;
+		// m_vertexArray not in multiple of 3 anymore, use m_triFaceArray
+		for (unsigned int i = 0; i < m_triFaceArray.size(); i += 3) {
+			btScalar *bt = &m_vertexArray[3 * m_triFaceArray[i]];
+			btVector3 v1(bt[0], bt[1], bt[2]);
+			bt = &m_vertexArray[3 * m_triFaceArray[i + 1]];
+			btVector3 v2(bt[0], bt[1], bt[2]);
+			bt = &m_vertexArray[3 * m_triFaceArray[i + 2]];
+			btVector3 v3(bt[0], bt[1], bt[2]);
+			collisionMeshData->addTriangle(v1, v2, v3, removeDuplicateVertices);
+		}
+		m_triangleIndexVertexArray = collisionMeshData;
+		m_weldedMesh = true;
+	}
+	else {
+		m_triangleIndexVertexArray = new btTriangleIndexVertexArray(
+		    m_polygonIndexArray.size(),
+		    m_triFaceArray.data(),
+		    3 * sizeof(int),
+		    m_vertexArray.size() / 3,
+		    &m_vertexArray[0],
+		    3 * sizeof(btScalar));
+		m_weldedMesh = false;
+	}
+
+	m_forceReInstance = false;
+}
+
+void CcdShapeConstructionInfo::BeginMeshUpdate()
+{
+	if (!m_triangleIndexVertexArray) {
+		return;
+	}
+
+	RetiredMesh *retired = new RetiredMesh();
+	retired->m_meshInterface = m_triangleIndexVertexArray;
+	retired->m_welded = m_weldedMesh;
+
+	/* The Bullet shapes keep using the previous vertices until they are replaced,
+	 * possibly on a worker thread, so the arrays they reference are copied. */
+	if (!m_weldedMesh) {
+		retired->m_vertices.assign(&m_vertexArray[0], &m_vertexArray[0] + m_vertexArray.size());
+		retired->m_indices = m_triFaceArray;
+
+		btIndexedMesh& mesh = m_triangleIndexVertexArray->getIndexedMeshArray()[0];
+		mesh.m_vertexBase = (const unsigned char *)retired->m_vertices.data();
+		mesh.m_triangleIndexBase = (const unsigned char *)retired->m_indices.data();
+	}
+
+	m_retiredMeshes.push_back(retired);
+	m_triangleIndexVertexArray = nullptr;
+	m_weldedMesh = false;
+	m_forceReInstance = false;
+}
+
+bool CcdShapeConstructionInfo::EndMeshUpdate()
+{
+	if (m_retiredMeshes.empty() || m_shapeType != PHY_SHAPE_MESH) {
+		return false;
+	}
+
+	RetiredMesh *retired = m_retiredMeshes.back();
+	if (retired->m_welded || retired->m_vertices.size() != (unsigned int)m_vertexArray.size() ||
+	    retired->m_indices != m_triFaceArray)
+	{
+		return false;
+	}
+
+	// Same topology, the mesh interface references the new vertices in place.
+	btIndexedMesh& mesh = retired->m_meshInterface->getIndexedMeshArray()[0];
+	mesh.m_vertexBase = (const unsigned char *)&m_vertexArray[0];
+	mesh.m_triangleIndexBase = (const unsigned char *)m_triFaceArray.data();
+
+	m_triangleIndexVertexArray = retired->m_meshInterface;
+	m_weldedMesh = false;
+
+	m_retiredMeshes.pop_back();
+	delete retired;
+
+	return true;
+}
+
+void CcdShapeConstructionInfo::FreeRetiredMeshes()
+{
+	for (RetiredMesh *retired : m_retiredMeshes) {
+		delete retired->m_meshInterface;
+		delete retired;
+	}
+	m_retiredMeshes.clear();
+}
+
 btCollisionShape *CcdShapeConstructionInfo::CreateBulletShape(btScalar margin, bool useGimpact, bool useBvh)
 {
 	btCollisionShape *collisionShape = nullptr;
@@ -2741,61 +2914,15 @@ btCollisionShape *CcdShapeConstructionInfo::CreateBulletShape(btScalar margin, b
 			// 9 multiplications/additions and one function call for each triangle that passes the mid phase filtering
 			// One possible optimization is to use directly the btBvhTriangleMeshShape when the scale is 1,1,1
 			// and btScaledBvhTriangleMeshShape otherwise.
-			if (useGimpact) {
-				if (!m_triangleIndexVertexArray || m_forceReInstance) {
-					if (m_triangleIndexVertexArray)
-						delete m_triangleIndexVertexArray;
-
-					m_triangleIndexVertexArray = new btTriangleIndexVertexArray(
-					    m_polygonIndexArray.size(),
-					    m_triFaceArray.data(),
-					    3 * sizeof(int),
-					    m_vertexArray.size() / 3,
-					    &m_vertexArray[0],
-					    3 * sizeof(btScalar));
-					m_forceReInstance = false;
-				}
+			UpdateMeshInterface(!useGimpact);
 
+			if (useGimpact) {
 				btGImpactMeshShape *gimpactShape = new btGImpactMeshShape(m_triangleIndexVertexArray);
 				gimpactShape->setMargin(margin);
 				gimpactShape->updateBound();
 				collisionShape = gimpactShape;
 			}
 			else {
-				if (!m_triangleIndexVertexArray || m_forceReInstance) {
-					///enable welding, only for the objects that need it (such as soft bodies)
-					if (0.0f != m_weldingThreshold1) {
-						btTriangleMesh *collisionMeshData = new btTriangleMesh(true, false);
-						collisionMeshData->m_weldingThreshold = m_weldingThreshold1;
-						bool removeDuplicateVertices = true;
-						// m_vertexArray not in multiple of 3 anymore, use m_triFaceArray
-						for (unsigned int i = 0; i < m_triFaceArray.size(); i += 3) {
-							btScalar *bt = &m_vertexArray[3 * m_triFaceArray[i]];
-							btVector3 v1(bt[0], bt[1], bt[2]);
-							bt = &m_vertexArray[3 * m_triFaceArray[i + 1]];
-							btVector3 v2(bt[0], bt[1], bt[2]);
-							bt = &m_vertexArray[3 * m_triFaceArray[i + 2]];
-							btVector3 v3(bt[0], bt[1], bt[2]);
-							collisionMeshData->addTriangle(v1, v2, v3, removeDuplicateVertices);
-						}
-						m_triangleIndexVertexArray = collisionMeshData;
-					}
-					else {
-						if (m_triangleIndexVertexArray) {
-							delete m_triangleIndexVertexArray;
-						}
-						m_triangleIndexVertexArray = new btTriangleIndexVertexArray(
-						    m_polygonIndexArray.size(),
-						    m_triFaceArray.data(),
-						    3 * sizeof(int),
-						    m_vertexArray.size() / 3,
-						    &m_vertexArray[0],
-						    3 * sizeof(btScalar));
-					}
-
-					m_forceReInstance = false;
-				}
-
 				btBvhTriangleMeshShape *unscaledShape = new btBvhTriangleMeshShape(m_triangleIndexVertexArray, true, useBvh);
 				unscaledShape->setMargin(margin);
 				collisionShape = new btScaledBvhTriangleMeshShape(unscaledShape, btVector3(1.0f, 1.0f, 1.0f));
@@ -2841,6 +2968,7 @@ CcdShapeConstructionInfo::~CcdShapeConstructionInfo()
 
 	if (m_triangleIndexVertexArray)
 		delete m_triangleIndexVertexArray;
+	FreeRetiredMeshes();
 	m_vertexArray.clear();
 	if (m_shapeType == PHY_SHAPE_MESH && m_meshObject != nullptr) {
 		std::map<RAS_MeshObject *, CcdShapeConstructionInfo *>::iterator mit = m_meshShapeMap.find(m_meshObject);
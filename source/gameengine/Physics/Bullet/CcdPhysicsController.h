@@ -82,6 +82,7 @@ public:
 		m_userData(nullptr),
 		m_meshObject(nullptr),
 		m_triangleIndexVertexArray(nullptr),
+		m_weldedMesh(false),
 		m_forceReInstance(false),
 		m_weldingThreshold1(0.0f),
 		m_shapeProxy(nullptr)
@@ -148,6 +149,19 @@ public:
 
 	bool UpdateMesh(class KX_GameObject *gameobj);
 
+	/** Keep the triangle mesh used by the current Bullet shapes before the mesh arrays change,
+	 * it's freed by FreeRetiredMeshes once the shapes are replaced.
+	 */
+	void BeginMeshUpdate();
+	/** Reuse the triangle mesh of the current Bullet shapes when the update preserved the topology.
+	 * \return True if the Bullet shapes can be refitted instead of recreated.
+	 */
+	bool EndMeshUpdate();
+	void FreeRetiredMeshes();
+
+	/// Create the triangle mesh shared by the Bullet shapes if needed.
+	void UpdateMeshInterface(bool useWelding);
+
 	CcdShapeConstructionInfo *GetReplica();
 
 	void ProcessReplica();
@@ -188,11 +202,24 @@ public:
 		m_weldingThreshold1  = threshold * threshold;
 	}
 protected:
+	/// Triangle mesh of the Bullet shapes not yet replaced after a mesh update.
+	struct RetiredMesh
+	{
+		btTriangleIndexVertexArray *m_meshInterface;
+		bool m_welded;
+		/// Copy of the arrays referenced by the mesh interface when it is not welded.
+		std::vector<btScalar> m_vertices;
+		std::vector<int> m_indices;
+	};
+
 	static std::map<RAS_MeshObject *, CcdShapeConstructionInfo *> m_meshShapeMap;
 	/// Keep a pointer to the original mesh
 	RAS_MeshObject *m_meshObject;
 	/// The list of vertexes and indexes for the triangle mesh, shared between Bullet shape.
 	btTriangleIndexVertexArray *m_triangleIndexVertexArray;
+	/// True when m_triangleIndexVertexArray is a welded copy of the arrays.
+	bool m_weldedMesh;
+	std::vector<RetiredMesh *> m_retiredMeshes;
 	/// for compound shapes
 	std::vector<CcdShapeConstructionInfo *> m_shapeArray;
 	///use gimpact for concave dynamic/moving collision detection
@@ -610,6 +637,12 @@ public:
 	 */
 	bool ReplaceControllerShape(btCollisionShape *newShape);
 
+	/**
+	 * Refit the bounding volume hierarchy of the triangle mesh shape to its updated vertices.
+	 * \return False if the shape can't be refitted and must be replaced.
+	 */
+	bool RefitControllerShape();
+
 	virtual ~CcdPhysicsController();
 
 	CcdConstructionInfo& GetConstructionInfo()
@@ -845,12 +878,14 @@ public:
 
 	virtual bool IsPhysicsSuspended();
 
+	virtual void GetAabb(MT_Vector3& aabbMin, MT_Vector3& aabbMax);
+
 	virtual bool IsCompound()
 	{
 		return GetConstructionInfo().m_shapeInfo->m_shapeType == PHY_SHAPE_COMPOUND;
 	}
 
-	virtual bool ReinstancePhysicsShape(KX_GameObject *from_gameobj, RAS_MeshObject *from_meshobj, bool dupli = false);
+	virtual bool ReinstancePhysicsShape(KX_GameObject *from_gameobj, RAS_MeshObject *from_meshobj, bool dupli = false, bool deferred = false);
   virtual bool ReinstancePhysicsShape2(class RAS_MeshObject *mesh, struct Object *ob, bool recalcGeom);
 	virtual void ReplacePhysicsShape(PHY_IPhysicsController *phyctrl);
 
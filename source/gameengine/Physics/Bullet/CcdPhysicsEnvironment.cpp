@@ -76,6 +76,8 @@ void DrawRasterizerLine(const float *from, const float *to, int color);
 
 #include "CM_Message.h"
 
+#include "BLI_task.h"
+
 // This was copied from the old KX_ConvertPhysicsObjects
 #ifdef WIN32
 #ifdef _MSC_VER
@@ -401,7 +403,8 @@ CcdPhysicsEnvironment::CcdPhysicsEnvironment(bool useDbvtCulling, btDispatcher *
 	m_ownPairCache(nullptr),
 	m_filterCallback(nullptr),
 	m_ghostPairCallback(nullptr),
-	m_ownDispatcher(nullptr)
+	m_ownDispatcher(nullptr),
+	m_shapeBuildPool(nullptr)
 {
 	for (int i = 0; i < PHY_NUM_RESPONSE; i++) {
 		m_triggerCallbacks[i] = nullptr;
@@ -565,6 +568,9 @@ void CcdPhysicsEnvironment::RestoreConstraint(CcdPhysicsController *ctrl, btType
 
 bool CcdPhysicsEnvironment::RemoveCcdPhysicsController(CcdPhysicsController *ctrl, bool freeConstraints)
 {
+	// The controller can't be freed while a shape is built for it.
+	FinishShapeBuilds();
+
 	// if the physics controller is already removed we do nothing
 	if (!m_controllers.erase(ctrl)) {
 		return false;
@@ -690,17 +696,113 @@ void CcdPhysicsEnvironment::RemoveCcdGraphicController(CcdGraphicController *ctr
 	}
 }
 
-void CcdPhysicsEnvironment::UpdateCcdPhysicsControllerShape(CcdShapeConstructionInfo *shapeInfo)
+void CcdPhysicsEnvironment::UpdateCcdPhysicsControllerShape(CcdShapeConstructionInfo *shapeInfo, bool refit, bool deferred)
 {
+	bool pending = false;
+
 	for (std::set<CcdPhysicsController *>::iterator it = m_controllers.begin(); it != m_controllers.end(); ++it) {
 		CcdPhysicsController *ctrl = *it;
 
 		if (ctrl->GetShapeInfo() != shapeInfo)
 			continue;
 
+		if (refit && ctrl->RefitControllerShape()) {
+			RefreshCcdPhysicsController(ctrl);
+			continue;
+		}
+
+		const CcdConstructionInfo& cci = ctrl->GetConstructionInfo();
+		if (deferred && !cci.m_bSoft) {
+			// The mesh interface is shared by the builds, create it before on the main thread.
+			shapeInfo->UpdateMeshInterface(!cci.m_bGimpact);
+
+			if (!m_shapeBuildPool) {
+				m_shapeBuildPool = BLI_task_pool_create_background(KX_GetActiveEngine()->GetTaskScheduler(), this);
+			}
+
+			ShapeBuildJob *job = new ShapeBuildJob();
+			job->m_controller = ctrl;
+			job->m_shapeInfo = shapeInfo;
+			job->m_margin = cci.m_margin;
+			job->m_useGimpact = cci.m_bGimpact;
+			job->m_useBvh = !cci.m_bSoft;
+			job->m_shape = nullptr;
+			job->m_done = false;
+			m_shapeBuildJobs.push_back(job);
+
+			BLI_task_pool_push(m_shapeBuildPool, ShapeBuildTask, job, false, TASK_PRIORITY_LOW);
+			pending = true;
+			continue;
+		}
+
 		ctrl->ReplaceControllerShape(nullptr);
 		RefreshCcdPhysicsController(ctrl);
 	}
+
+	// The previous meshes are freed once no shape uses them.
+	if (!pending) {
+		for (ShapeBuildJob *job : m_shapeBuildJobs) {
+			if (job->m_shapeInfo == shapeInfo) {
+				pending = true;
+				break;
+			}
+		}
+	}
+	if (!pending) {
+		shapeInfo->FreeRetiredMeshes();
+	}
+}
+
+void CcdPhysicsEnvironment::ShapeBuildTask(TaskPool *__restrict UNUSED(pool), void *taskdata, int UNUSED(threadid))
+{
+	ShapeBuildJob *job = (ShapeBuildJob *)taskdata;
+	job->m_shape = job->m_shapeInfo->CreateBulletShape(job->m_margin, job->m_useGimpact, job->m_useBvh);
+	job->m_done = true;
+}
+
+void CcdPhysicsEnvironment::UpdateShapeBuilds(bool wait)
+{
+	if (m_shapeBuildJobs.empty()) {
+		return;
+	}
+
+	if (wait) {
+		BLI_task_pool_work_and_wait(m_shapeBuildPool);
+	}
+
+	std::vector<CcdShapeConstructionInfo *> finishedShapeInfos;
+	for (std::vector<ShapeBuildJob *>::iterator it = m_shapeBuildJobs.begin(); it != m_shapeBuildJobs.end();) {
+		ShapeBuildJob *job = *it;
+		if (!job->m_done) {
+			++it;
+			continue;
+		}
+
+		job->m_controller->ReplaceControllerShape(job->m_shape);
+		RefreshCcdPhysicsController(job->m_controller);
+		finishedShapeInfos.push_back(job->m_shapeInfo);
+
+		delete job;
+		it = m_shapeBuildJobs.erase(it);
+	}
+
+	for (CcdShapeConstructionInfo *shapeInfo : finishedShapeInfos) {
+		bool pending = false;
+		for (ShapeBuildJob *job : m_shapeBuildJobs) {
+			if (job->m_shapeInfo == shapeInfo) {
+				pending = true;
+				break;
+			}
+		}
+		if (!pending) {
+			shapeInfo->FreeRetiredMeshes();
+		}
+	}
+}
+
+void CcdPhysicsEnvironment::FinishShapeBuilds()
+{
+	UpdateShapeBuilds(true);
 }
 
 void CcdPhysicsEnvironment::BeginFrame()
@@ -734,6 +836,9 @@ bool CcdPhysicsEnvironment::ProceedDeltaTime(double curTime, float timeStep, flo
 	std::set<CcdPhysicsController *>::iterator it;
 	int i;
 
+	// Give the shapes built since the last step to their controllers.
+	UpdateShapeBuilds(false);
+
 	// Update Bullet global variables.
 	gDeactivationTime = m_deactivationTime;
 	gContactBreakingThreshold = m_contactBreakingThreshold;
@@ -1968,6 +2073,11 @@ void CcdPhysicsEnvironment::MergeEnvironment(PHY_IPhysicsEnvironment *other_env)
 
 CcdPhysicsEnvironment::~CcdPhysicsEnvironment()
 {
+	if (m_shapeBuildPool) {
+		FinishShapeBuilds();
+		BLI_task_pool_free(m_shapeBuildPool);
+	}
+
 	m_wrapperVehicles.clear();
 
 	//m_broadphase->DestroyScene();
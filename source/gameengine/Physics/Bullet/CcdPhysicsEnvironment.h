@@ -30,6 +30,7 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <atomic>
 class CcdGraphicController;
 #include "LinearMath/btVector3.h"
 #include "LinearMath/btTransform.h"
@@ -51,6 +52,7 @@ class btDynamicsWorld;
 class PHY_IVehicle;
 class CcdOverlapFilterCallBack;
 class CcdShapeConstructionInfo;
+struct TaskPool;
 
 /** CcdPhysicsEnvironment is an experimental mainloop for physics simulation using optional continuous collision detection.
  * Physics Environment takes care of stepping the simulation and is a container for physics entities.
@@ -228,8 +230,14 @@ public:
 	 * Call RecreateControllerShape on controllers which use the same shape
 	 * construction info that argument shapeInfo.
 	 * You need to call this function when the shape construction info changed.
+	 * \param refit The mesh topology is unchanged, the existing shapes are refitted in place.
+	 * \param deferred Build the new shapes on a worker thread, the controllers keep
+	 * their previous shape until the build is finished at the beginning of a next step.
 	 */
-	void UpdateCcdPhysicsControllerShape(CcdShapeConstructionInfo *shapeInfo);
+	void UpdateCcdPhysicsControllerShape(CcdShapeConstructionInfo *shapeInfo, bool refit = false, bool deferred = false);
+
+	/// Wait for the shapes built on worker threads and give them to their controllers.
+	void FinishShapeBuilds();
 
 	btBroadphaseInterface *GetBroadphase();
 	btDbvtBroadphase *GetCullingTree()
@@ -296,6 +304,26 @@ protected:
 
 	class btDispatcher *m_ownDispatcher;
 
+	/// Shape built on a worker thread for a controller.
+	struct ShapeBuildJob
+	{
+		CcdPhysicsController *m_controller;
+		CcdShapeConstructionInfo *m_shapeInfo;
+		btScalar m_margin;
+		bool m_useGimpact;
+		bool m_useBvh;
+		btCollisionShape *m_shape;
+		std::atomic<bool> m_done;
+	};
+
+	std::vector<ShapeBuildJob *> m_shapeBuildJobs;
+	/// Task pool of the shape builds, created on first use.
+	TaskPool *m_shapeBuildPool;
+
+	static void ShapeBuildTask(TaskPool *__restrict pool, void *taskdata, int threadid);
+	/// Replace the controllers shape by the built shapes, if wait is true all the builds are waited.
+	void UpdateShapeBuilds(bool wait);
+
 	virtual void ExportFile(const std::string& filename);
 };
 
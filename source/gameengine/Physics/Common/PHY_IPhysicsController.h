@@ -150,7 +150,10 @@ public:
 	virtual bool IsDynamicsSuspended() const = 0;
 	virtual bool IsPhysicsSuspended() = 0;
 
-	virtual bool ReinstancePhysicsShape(KX_GameObject *from_gameobj, RAS_MeshObject *from_meshobj, bool dupli = false) = 0;
+	/// Get the world space bounding box of the collision shape.
+	virtual void GetAabb(MT_Vector3& aabbMin, MT_Vector3& aabbMax) = 0;
+
+	virtual bool ReinstancePhysicsShape(KX_GameObject *from_gameobj, RAS_MeshObject *from_meshobj, bool dupli = false, bool deferred = false) = 0;
   virtual bool ReinstancePhysicsShape2(class RAS_MeshObject *mesh, struct Object *ob, bool recalcGeom) = 0;
 	virtual void ReplacePhysicsShape(PHY_IPhysicsController *phyctrl) = 0;
 
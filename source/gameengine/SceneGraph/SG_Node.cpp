@@ -332,6 +332,13 @@ SG_Node *SG_Node::GetNextRescheduled(SG_QList& head)
 	return result;
 }
 
+void SG_Node::Unschedule()
+{
+	scheduleMutex.Lock();
+	Delink();
+	scheduleMutex.Unlock();
+}
+
 void SG_Node::AddSGController(SG_Controller *cont)
 {
 	m_SGcontrollers.push_back(cont);
@@ -576,6 +583,35 @@ bool SG_Node::ComputeWorldTransforms(const SG_Node *parent, bool& parentUpdated)
 	return m_parent_relation->UpdateChildCoordinates(this, parent, parentUpdated);
 }
 
+bool SG_Node::ComputeNormalWorldTransforms(const SG_Node *parent, bool& parentUpdated)
+{
+	if (!parentUpdated && !m_modified) {
+		return false;
+	}
+
+	parentUpdated = true;
+
+	if (parent) {
+		const MT_Vector3& p_world_scale = parent->m_worldScaling;
+		const MT_Matrix3x3& p_world_rotation = parent->m_worldRotation;
+
+		m_worldScaling = p_world_scale * m_localScaling;
+		m_worldRotation = p_world_rotation * m_localRotation;
+		m_worldPosition = parent->m_worldPosition + p_world_scale * (p_world_rotation * m_localPosition);
+	}
+	else {
+		SetWorldFromLocalTransform();
+	}
+
+	ClearModified();
+	return true;
+}
+
+bool SG_Node::IsUpdateThreadSafe() const
+{
+	return (m_SGcontrollers.empty() && m_parent_relation && m_parent_relation->IsNormalRelation());
+}
+
 const std::shared_ptr<SG_Familly>& SG_Node::GetFamilly() const
 {
 	BLI_assert(m_familly != nullptr);
@@ -217,6 +217,11 @@ public:
 	 */
 	static SG_Node *GetNextRescheduled(SG_QList& head);
 
+	/**
+	 * Remove this node from the schedule list if it was scheduled.
+	 */
+	void Unschedule();
+
 	/**
 	 * Node replication functions.
 	 */
@@ -340,6 +345,17 @@ public:
 	MT_Transform GetLocalTransform() const;
 
 	bool ComputeWorldTransforms(const SG_Node *parent, bool& parentUpdated);
+	/**
+	 * Compute the world transform by combining the parent world transform and
+	 * the local transform, as done by a normal parent relation.
+	 */
+	bool ComputeNormalWorldTransforms(const SG_Node *parent, bool& parentUpdated);
+
+	/**
+	 * Return true if the world transform of this node can be computed in parallel
+	 * of other nodes: without controllers and with a normal parent relation.
+	 */
+	bool IsUpdateThreadSafe() const;
 
 	const std::shared_ptr<SG_Familly>& GetFamilly() const;
 	void SetFamilly(const std::shared_ptr<SG_Familly>& familly);
@@ -349,6 +365,7 @@ public:
 
 protected:
 	friend class SG_Controller;
+	friend class SG_TransformHierarchy;
 	friend class KX_BoneParentRelation;
 	friend class KX_VertexParentRelation;
 	friend class KX_SlowParentRelation;
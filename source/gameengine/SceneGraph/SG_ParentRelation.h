@@ -96,6 +96,15 @@ public:
 		return false;
 	}
 
+	/**
+	 * Normal Parent Relation only combine the parent and child transforms,
+	 * they can be computed without calling UpdateChildCoordinates.
+	 */
+	virtual bool IsNormalRelation()
+	{
+		return false;
+	}
+
 protected:
 	/**
 	 * Protected constructors
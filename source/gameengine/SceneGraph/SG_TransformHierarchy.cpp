@@ -0,0 +1,203 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/SceneGraph/SG_TransformHierarchy.cpp
+ *  \ingroup bgesg
+ */
+
+#include "SG_TransformHierarchy.h"
+#include "SG_Node.h"
+
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+
+#include <algorithm>
+
+/// Minimum number of nodes in a level to update it in parallel.
+static const int parallelUpdateThreshold = 1024;
+
+struct LevelUpdateData
+{
+	SG_TransformHierarchy::Level *level;
+	const SG_TransformHierarchy::Level *parentLevel;
+};
+
+static void update_level_task(void *__restrict userdata, const int index, const TaskParallelTLS *__restrict UNUSED(tls))
+{
+	LevelUpdateData *data = (LevelUpdateData *)userdata;
+	SG_TransformHierarchy::Level& level = *data->level;
+
+	unsigned char& flags = level.m_flags[index];
+	if (flags & SG_TransformHierarchy::NODE_SERIAL) {
+		return;
+	}
+
+	const int parentIndex = level.m_parents[index];
+	bool parentUpdated = (parentIndex != -1) &&
+	                     (data->parentLevel->m_flags[parentIndex] & SG_TransformHierarchy::NODE_PARENT_UPDATED);
+
+	SG_Node *node = level.m_nodes[index];
+	if (node->ComputeNormalWorldTransforms(node->GetSGParent(), parentUpdated)) {
+		flags |= SG_TransformHierarchy::NODE_TRANSFORM_UPDATED;
+	}
+	if (parentUpdated) {
+		flags |= SG_TransformHierarchy::NODE_PARENT_UPDATED;
+	}
+}
+
+SG_TransformHierarchy::SG_TransformHierarchy()
+	:m_numLevels(0)
+{
+}
+
+SG_TransformHierarchy::~SG_TransformHierarchy()
+{
+}
+
+void SG_TransformHierarchy::AddSubtree(SG_Node *root)
+{
+	if (m_levels.empty()) {
+		m_levels.resize(1);
+	}
+	m_numLevels = std::max(m_numLevels, 1u);
+
+	Level& first = m_levels[0];
+	first.m_nodes.push_back(root);
+	first.m_parents.push_back(-1);
+
+	// Breadth first traversal appending the children of the nodes added in the previous level.
+	unsigned int begin = first.m_nodes.size() - 1;
+	unsigned int end = first.m_nodes.size();
+	for (unsigned int depth = 0; begin < end; ++depth) {
+		const unsigned int childDepth = depth + 1;
+		if (m_levels.size() <= childDepth) {
+			m_levels.resize(childDepth + 1);
+		}
+
+		Level& level = m_levels[depth];
+		Level& childLevel = m_levels[childDepth];
+		const unsigned int childBegin = childLevel.m_nodes.size();
+
+		for (unsigned int i = begin; i < end; ++i) {
+			for (SG_Node *child : level.m_nodes[i]->GetSGChildren()) {
+				// The child is updated with its parent, it doesn't need its own update.
+				child->Unschedule();
+				childLevel.m_nodes.push_back(child);
+				childLevel.m_parents.push_back(i);
+			}
+		}
+
+		begin = childBegin;
+		end = childLevel.m_nodes.size();
+		if (begin < end) {
+			m_numLevels = std::max(m_numLevels, childDepth + 1);
+		}
+	}
+}
+
+void SG_TransformHierarchy::UpdateLevel(unsigned int depth, double time)
+{
+	Level& level = m_levels[depth];
+	const Level *parentLevel = (depth > 0) ? &m_levels[depth - 1] : nullptr;
+	const unsigned int size = level.m_nodes.size();
+
+	level.m_flags.resize(size);
+	level.m_serialNodes.clear();
+	for (unsigned int i = 0; i < size; ++i) {
+		if (level.m_nodes[i]->IsUpdateThreadSafe()) {
+			level.m_flags[i] = 0;
+		}
+		else {
+			level.m_flags[i] = NODE_SERIAL;
+			level.m_serialNodes.push_back(i);
+		}
+	}
+
+	if (level.m_serialNodes.size() < size) {
+		LevelUpdateData data = {&level, parentLevel};
+
+		TaskParallelSettings settings;
+		BLI_parallel_range_settings_defaults(&settings);
+		settings.use_threading = ((int)size >= parallelUpdateThreshold);
+		settings.min_iter_per_thread = parallelUpdateThreshold / 4;
+
+		BLI_task_parallel_range(0, size, &data, update_level_task, &settings);
+	}
+
+	// Nodes with controllers or special relations may not be thread safe.
+	for (unsigned int i : level.m_serialNodes) {
+		const int parentIndex = level.m_parents[i];
+		bool parentUpdated = (parentIndex != -1) && (parentLevel->m_flags[parentIndex] & NODE_PARENT_UPDATED);
+
+		SG_Node *node = level.m_nodes[i];
+		if (node->UpdateSpatialData(node->GetSGParent(), time, parentUpdated)) {
+			level.m_flags[i] |= NODE_TRANSFORM_UPDATED;
+		}
+		if (parentUpdated) {
+			level.m_flags[i] |= NODE_PARENT_UPDATED;
+		}
+
+		// Controllers could have scheduled the node again.
+		node->Unschedule();
+	}
+}
+
+void SG_TransformHierarchy::Update(SG_QList& head, double time)
+{
+	for (unsigned int depth = 0; depth < m_numLevels; ++depth) {
+		Level& level = m_levels[depth];
+		level.m_nodes.clear();
+		level.m_parents.clear();
+	}
+	m_numLevels = 0;
+
+	SG_Node *node;
+	while ((node = SG_Node::GetNextScheduled(head)) != nullptr) {
+		/* A node is updated with its ancestors when one of them is still scheduled,
+		 * the already added subtrees are unscheduled so a node is never added twice. */
+		bool ancestorScheduled = false;
+		for (SG_Node *parent = node->GetSGParent(); parent; parent = parent->GetSGParent()) {
+			if (!parent->Empty()) {
+				ancestorScheduled = true;
+				break;
+			}
+		}
+
+		if (!ancestorScheduled) {
+			AddSubtree(node);
+		}
+	}
+
+	for (unsigned int depth = 0; depth < m_numLevels; ++depth) {
+		UpdateLevel(depth, time);
+	}
+
+	// The transform callbacks (physics synchronization) are not thread safe.
+	for (unsigned int depth = 0; depth < m_numLevels; ++depth) {
+		const Level& level = m_levels[depth];
+		for (unsigned int i = 0, size = level.m_nodes.size(); i < size; ++i) {
+			if (level.m_flags[i] & NODE_TRANSFORM_UPDATED) {
+				level.m_nodes[i]->ActivateUpdateTransformCallback();
+			}
+		}
+	}
+}
@@ -0,0 +1,89 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file SG_TransformHierarchy.h
+ *  \ingroup bgesg
+ */
+
+#ifndef __SG_TRANSFORMHIERARCHY_H__
+#define __SG_TRANSFORMHIERARCHY_H__
+
+#include <vector>
+
+class SG_Node;
+class SG_QList;
+
+/**
+ * SG_TransformHierarchy updates the world transforms of the scheduled nodes and
+ * their children level by level instead of recursing into each node.
+ *
+ * The scheduled subtrees are flattened into contiguous arrays sorted by depth. A node
+ * only depends on its parent in the previous level, so all the nodes of a level using
+ * a normal parent relation are updated in parallel. The nodes with controllers or special
+ * parent relations are updated afterward in the main thread, and the transform callbacks
+ * are called once all the levels are updated.
+ */
+class SG_TransformHierarchy
+{
+public:
+	enum NodeFlag {
+		/// The node must be updated in the main thread.
+		NODE_SERIAL = (1 << 0),
+		/// The world transform of the node changed.
+		NODE_TRANSFORM_UPDATED = (1 << 1),
+		/// The children of the node must recompute their world transform.
+		NODE_PARENT_UPDATED = (1 << 2)
+	};
+
+	/// Nodes of a same depth.
+	struct Level
+	{
+		std::vector<SG_Node *> m_nodes;
+		/// Index of the parent node in the previous level, -1 for subtree roots.
+		std::vector<int> m_parents;
+		/// Combination of NodeFlag for each node.
+		std::vector<unsigned char> m_flags;
+		/// Indices of the nodes flagged with NODE_SERIAL.
+		std::vector<unsigned int> m_serialNodes;
+	};
+
+private:
+	/// Levels are kept between updates to reuse their memory.
+	std::vector<Level> m_levels;
+	unsigned int m_numLevels;
+
+	/// Append a scheduled node and all its children to the levels.
+	void AddSubtree(SG_Node *root);
+	void UpdateLevel(unsigned int depth, double time);
+
+public:
+	SG_TransformHierarchy();
+	~SG_TransformHierarchy();
+
+	/**
+	 * Update all the nodes scheduled in head and their children,
+	 * the schedule list is empty after this call.
+	 */
+	void Update(SG_QList& head, double time);
+};
+
+#endif  // __SG_TRANSFORMHIERARCHY_H__
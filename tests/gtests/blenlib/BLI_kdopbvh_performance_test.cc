@@ -0,0 +1,296 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+
+#include "BLI_kdopbvh.h"
+#include "BLI_math.h"
+#include "BLI_threads.h"
+
+#include "PIL_time.h"
+}
+
+#include "stubs/bf_intern_eigen_stubs.h"
+
+#define NUM_RUN_AVERAGED 10
+
+/* Wavy grid of triangles, seen by a grid of rays from a camera above it. */
+#define GRID_RES 512
+#define CAMERA_RES 512
+
+struct RaycastTrisData {
+  float (*verts)[3];
+  int (*tris)[3];
+};
+
+static void raycast_tris_callback(void *userdata,
+                                  int index,
+                                  const BVHTreeRay *ray,
+                                  BVHTreeRayHit *hit)
+{
+  const RaycastTrisData *data = (const RaycastTrisData *)userdata;
+  const int *tri = data->tris[index];
+  float dist;
+
+  if (isect_ray_tri_watertight_v3(ray->origin,
+                                  ray->isect_precalc,
+                                  data->verts[tri[0]],
+                                  data->verts[tri[1]],
+                                  data->verts[tri[2]],
+                                  &dist,
+                                  NULL) &&
+      dist < hit->dist) {
+    hit->index = index;
+    hit->dist = dist;
+    madd_v3_v3v3fl(hit->co, ray->origin, ray->direction, dist);
+  }
+}
+
+/**
+ * Grid of triangles, uneven grids are dense in their center and sparse on their borders,
+ * as scanned or architectural meshes often are.
+ */
+static BVHTree *grid_tree_create(RaycastTrisData *data,
+                                 const int res,
+                                 const bool use_uneven,
+                                 const float height,
+                                 const int build_flag)
+{
+  const int verts_len = (res + 1) * (res + 1);
+  const int tris_len = res * res * 2;
+
+  data->verts = (float(*)[3])MEM_mallocN(sizeof(float[3]) * verts_len, __func__);
+  data->tris = (int(*)[3])MEM_mallocN(sizeof(int[3]) * tris_len, __func__);
+
+  for (int y = 0; y <= res; y++) {
+    for (int x = 0; x <= res; x++) {
+      float *co = data->verts[y * (res + 1) + x];
+      co[0] = (float)x / res * 2.0f - 1.0f;
+      co[1] = (float)y / res * 2.0f - 1.0f;
+      co[2] = height + 0.1f * sinf(co[0] * 10.0f) * cosf(co[1] * 10.0f);
+      if (use_uneven) {
+        co[0] = co[0] * co[0] * co[0];
+        co[1] = co[1] * co[1] * co[1];
+      }
+    }
+  }
+
+  BVHTree *tree = BLI_bvhtree_new_ex(tris_len, 0.0f, 4, 6, build_flag);
+  for (int y = 0, i = 0; y < res; y++) {
+    for (int x = 0; x < res; x++) {
+      const int v = y * (res + 1) + x;
+      const int quad[4] = {v, v + 1, v + res + 2, v + res + 1};
+      ARRAY_SET_ITEMS(data->tris[i], quad[0], quad[1], quad[2]);
+      ARRAY_SET_ITEMS(data->tris[i + 1], quad[0], quad[2], quad[3]);
+      for (int j = 0; j < 2; j++, i++) {
+        float co[3][3];
+        for (int k = 0; k < 3; k++) {
+          copy_v3_v3(co[k], data->verts[data->tris[i][k]]);
+        }
+        BLI_bvhtree_insert(tree, i, co[0], 3);
+      }
+    }
+  }
+  BLI_bvhtree_balance(tree);
+  return tree;
+}
+
+static void grid_tree_data_free(RaycastTrisData *data)
+{
+  MEM_freeN(data->verts);
+  MEM_freeN(data->tris);
+}
+
+static void ray_cast_batch_performance_test(const char *id, const bool use_threading)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  BLI_threadapi_init();
+
+  RaycastTrisData data;
+  BVHTree *tree = grid_tree_create(&data, GRID_RES, false, 0.0f, 0);
+
+  /* Camera rays, consecutive rays are neighbor pixels. */
+  const int rays_len = CAMERA_RES * CAMERA_RES;
+  float(*origins)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * rays_len, __func__);
+  float(*directions)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * rays_len, __func__);
+  for (int y = 0; y < CAMERA_RES; y++) {
+    for (int x = 0; x < CAMERA_RES; x++) {
+      const int i = y * CAMERA_RES + x;
+      ARRAY_SET_ITEMS(origins[i], 0.0f, -1.0f, 2.0f);
+      ARRAY_SET_ITEMS(directions[i],
+                      (float)x / CAMERA_RES * 2.0f - 1.0f,
+                      (float)y / CAMERA_RES * 2.0f,
+                      -2.0f);
+      normalize_v3(directions[i]);
+    }
+  }
+
+  BVHTreeRayHit *hits = (BVHTreeRayHit *)MEM_mallocN(sizeof(*hits) * rays_len, __func__);
+
+  double averaged_timing = 0.0;
+  int hits_len = 0;
+  for (int r = 0; r < NUM_RUN_AVERAGED; r++) {
+    const double init_time = PIL_check_seconds_timer();
+    hits_len = 0;
+    for (int i = 0; i < rays_len; i++) {
+      hits[i].index = -1;
+      hits[i].dist = BVH_RAYCAST_DIST_MAX;
+      if (BLI_bvhtree_ray_cast(
+              tree, origins[i], directions[i], 0.0f, &hits[i], raycast_tris_callback, &data) !=
+          -1) {
+        hits_len++;
+      }
+    }
+    averaged_timing += PIL_check_seconds_timer() - init_time;
+  }
+  printf("\t%s: %d rays (%d hits) one by one done in %fs on average over %d runs\n",
+         id,
+         rays_len,
+         hits_len,
+         averaged_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+
+  averaged_timing = 0.0;
+  for (int r = 0; r < NUM_RUN_AVERAGED; r++) {
+    const double init_time = PIL_check_seconds_timer();
+    for (int i = 0; i < rays_len; i++) {
+      hits[i].index = -1;
+      hits[i].dist = BVH_RAYCAST_DIST_MAX;
+    }
+    const int flag = BVH_RAYCAST_DEFAULT | (use_threading ? BVH_RAYCAST_USE_THREADING : 0);
+    EXPECT_EQ(hits_len,
+              BLI_bvhtree_ray_cast_batch(tree,
+                                         origins,
+                                         directions,
+                                         rays_len,
+                                         0.0f,
+                                         hits,
+                                         raycast_tris_callback,
+                                         &data,
+                                         flag));
+    averaged_timing += PIL_check_seconds_timer() - init_time;
+  }
+  printf("\t%s: %d rays batched done in %fs on average over %d runs\n",
+         id,
+         rays_len,
+         averaged_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+
+  BLI_bvhtree_free(tree);
+  grid_tree_data_free(&data);
+  MEM_freeN(origins);
+  MEM_freeN(directions);
+  MEM_freeN(hits);
+
+  BLI_threadapi_exit();
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(kdopbvh, RayCastBatchNoThread)
+{
+  ray_cast_batch_performance_test("RayCastBatchNoThread", false);
+}
+
+TEST(kdopbvh, RayCastBatch)
+{
+  ray_cast_batch_performance_test("RayCastBatch", true);
+}
+
+/**
+ * Compare the build and query times of trees built with the median split and with the surface
+ * area heuristic, on an uneven grid overlapped by a coarse grid and seen by a camera.
+ */
+static void build_sah_performance_test(const char *id, const int build_flag)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  BLI_threadapi_init();
+
+  RaycastTrisData data, data_other;
+  BVHTree *tree = NULL;
+
+  double averaged_timing = 0.0;
+  for (int r = 0; r < NUM_RUN_AVERAGED; r++) {
+    if (tree) {
+      BLI_bvhtree_free(tree);
+      grid_tree_data_free(&data);
+    }
+    const double init_time = PIL_check_seconds_timer();
+    tree = grid_tree_create(&data, GRID_RES, true, 0.0f, build_flag);
+    averaged_timing += PIL_check_seconds_timer() - init_time;
+  }
+  printf("\t%s: %d triangles built (with insertion) in %fs on average over %d runs\n",
+         id,
+         BLI_bvhtree_get_len(tree),
+         averaged_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+
+  BVHTree *tree_other = grid_tree_create(&data_other, GRID_RES / 8, false, 0.05f, 0);
+  averaged_timing = 0.0;
+  uint overlap_len = 0;
+  for (int r = 0; r < NUM_RUN_AVERAGED; r++) {
+    const double init_time = PIL_check_seconds_timer();
+    BVHTreeOverlap *overlap = BLI_bvhtree_overlap(tree, tree_other, &overlap_len, NULL, NULL);
+    averaged_timing += PIL_check_seconds_timer() - init_time;
+    MEM_SAFE_FREE(overlap);
+  }
+  printf("\t%s: overlap (%u pairs) done in %fs on average over %d runs\n",
+         id,
+         overlap_len,
+         averaged_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+
+  averaged_timing = 0.0;
+  int hits_len = 0;
+  for (int r = 0; r < NUM_RUN_AVERAGED; r++) {
+    const double init_time = PIL_check_seconds_timer();
+    hits_len = 0;
+    for (int y = 0; y < CAMERA_RES; y++) {
+      for (int x = 0; x < CAMERA_RES; x++) {
+        const float origin[3] = {0.0f, -1.0f, 2.0f};
+        float direction[3] = {
+            (float)x / CAMERA_RES * 2.0f - 1.0f, (float)y / CAMERA_RES * 2.0f, -2.0f};
+        normalize_v3(direction);
+        BVHTreeRayHit hit;
+        hit.index = -1;
+        hit.dist = BVH_RAYCAST_DIST_MAX;
+        if (BLI_bvhtree_ray_cast(
+                tree, origin, direction, 0.0f, &hit, raycast_tris_callback, &data) != -1) {
+          hits_len++;
+        }
+      }
+    }
+    averaged_timing += PIL_check_seconds_timer() - init_time;
+  }
+  printf("\t%s: %d rays (%d hits) done in %fs on average over %d runs\n",
+         id,
+         CAMERA_RES * CAMERA_RES,
+         hits_len,
+         averaged_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+
+  BLI_bvhtree_free(tree);
+  BLI_bvhtree_free(tree_other);
+  grid_tree_data_free(&data);
+  grid_tree_data_free(&data_other);
+
+  BLI_threadapi_exit();
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(kdopbvh, BuildMedian)
+{
+  build_sah_performance_test("BuildMedian", 0);
+}
+
+TEST(kdopbvh, BuildSAH)
+{
+  build_sah_performance_test("BuildSAH", BVH_BUILD_SAH);
+}
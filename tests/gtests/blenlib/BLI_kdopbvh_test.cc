@@ -2,7 +2,7 @@
 
 #include "testing/testing.h"
 
-/* TODO: ray intersection, overlap ... etc.*/
+/* TODO: overlap ... etc.*/
 
 #include "MEM_guardedalloc.h"
 
@@ -11,6 +11,7 @@ extern "C" {
 #include "BLI_kdopbvh.h"
 #include "BLI_rand.h"
 #include "BLI_math_vector.h"
+#include "BLI_threads.h"
 }
 
 #include "stubs/bf_intern_eigen_stubs.h"
@@ -70,11 +71,15 @@ static void optimal_check_callback(void *userdata,
  * Note that a small epsilon is added to the BVH nodes bounds, even if we pass in zero.
  * Use rounding to ensure very close nodes don't cause the wrong node to be found as nearest.
  */
-static void find_nearest_points_test(
-    int points_len, float scale, int round, int random_seed, bool optimal = false)
+static void find_nearest_points_test(int points_len,
+                                     float scale,
+                                     int round,
+                                     int random_seed,
+                                     bool optimal = false,
+                                     int build_flag = 0)
 {
   struct RNG *rng = BLI_rng_new(random_seed);
-  BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 8, 8);
+  BVHTree *tree = BLI_bvhtree_new_ex(points_len, 0.0, 8, 8, build_flag);
 
   void *mem = MEM_mallocN(sizeof(float[3]) * points_len, __func__);
   float(*points)[3] = (float(*)[3])mem;
@@ -136,3 +141,249 @@ TEST(kdopbvh, OptimalFindNearest_500)
 {
   find_nearest_points_test(500, 1.0, 1000, 12, true);
 }
+
+TEST(kdopbvh, FindNearestSAH_2)
+{
+  find_nearest_points_test(2, 1.0, 1000, 123, false, BVH_BUILD_SAH);
+}
+TEST(kdopbvh, FindNearestSAH_500)
+{
+  find_nearest_points_test(500, 1.0, 1000, 12, false, BVH_BUILD_SAH);
+}
+TEST(kdopbvh, OptimalFindNearestSAH_500)
+{
+  find_nearest_points_test(500, 1.0, 1000, 12, true, BVH_BUILD_SAH);
+}
+
+struct RaycastSpheresData {
+  float (*points)[3];
+  float radius;
+};
+
+/* Hit spheres centered on the points. */
+static void raycast_spheres_callback(void *userdata,
+                                     int index,
+                                     const BVHTreeRay *ray,
+                                     BVHTreeRayHit *hit)
+{
+  RaycastSpheresData *data = (RaycastSpheresData *)userdata;
+  float dir_to_center[3];
+  sub_v3_v3v3(dir_to_center, data->points[index], ray->origin);
+
+  const float closest = dot_v3v3(dir_to_center, ray->direction);
+  const float dist_sq = len_squared_v3(dir_to_center) - closest * closest;
+  const float radius_sq = data->radius * data->radius;
+  if (dist_sq > radius_sq) {
+    return;
+  }
+
+  const float dist = closest - sqrtf(radius_sq - dist_sq);
+  if (dist >= 0.0f && dist < hit->dist) {
+    hit->index = index;
+    hit->dist = dist;
+    madd_v3_v3v3fl(hit->co, ray->origin, ray->direction, dist);
+  }
+}
+
+/**
+ * Cast the same rays one by one and batched, with coherent rays (a fan of rays from an origin)
+ * and random ones.
+ */
+static void ray_cast_batch_test(
+    int points_len, int rays_len, float ray_radius, int random_seed, int flag)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 4, 6);
+  const float sphere_radius = 0.05f;
+
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+  for (int i = 0; i < points_len; i++) {
+    float bounds[2][3];
+    rng_v3_round(points[i], 3, rng, 1000000, 1.0f);
+    /* Rays with a radius are tested against the points. */
+    const float extent = (ray_radius == 0.0f) ? sphere_radius : 0.0f;
+    copy_v3_v3(bounds[0], points[i]);
+    copy_v3_v3(bounds[1], points[i]);
+    add_v3_fl(bounds[0], -extent);
+    add_v3_fl(bounds[1], extent);
+    BLI_bvhtree_insert(tree, i, bounds[0], 2);
+  }
+  BLI_bvhtree_balance(tree);
+
+  float(*origins)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * rays_len, __func__);
+  float(*directions)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * rays_len, __func__);
+  for (int i = 0; i < rays_len; i++) {
+    if (i < rays_len / 2) {
+      const float origin[3] = {0.0f, 0.0f, -2.0f};
+      copy_v3_v3(origins[i], origin);
+      BLI_rng_get_float_unit_v3(rng, directions[i]);
+      directions[i][2] = fabsf(directions[i][2]) + 1.0f;
+    }
+    else {
+      rng_v3_round(origins[i], 3, rng, 1000000, 2.0f);
+      BLI_rng_get_float_unit_v3(rng, directions[i]);
+    }
+    normalize_v3(directions[i]);
+  }
+  /* Ensure there is a hit. */
+  sub_v3_v3v3(directions[0], points[0], origins[0]);
+  normalize_v3(directions[0]);
+
+  RaycastSpheresData data = {points, sphere_radius};
+  const float radius = (ray_radius == 0.0f) ? 0.0f : sphere_radius;
+
+  BVHTreeRayHit *hits = (BVHTreeRayHit *)MEM_mallocN(sizeof(*hits) * rays_len, __func__);
+  for (int i = 0; i < rays_len; i++) {
+    hits[i].index = -1;
+    hits[i].dist = BVH_RAYCAST_DIST_MAX;
+  }
+  int hits_len = BLI_bvhtree_ray_cast_batch(tree,
+                                            origins,
+                                            directions,
+                                            rays_len,
+                                            radius,
+                                            hits,
+                                            raycast_spheres_callback,
+                                            &data,
+                                            BVH_RAYCAST_DEFAULT | flag);
+
+  int hits_len_expected = 0;
+  for (int i = 0; i < rays_len; i++) {
+    BVHTreeRayHit hit;
+    hit.index = -1;
+    hit.dist = BVH_RAYCAST_DIST_MAX;
+    BLI_bvhtree_ray_cast(
+        tree, origins[i], directions[i], radius, &hit, raycast_spheres_callback, &data);
+    EXPECT_EQ(hit.index, hits[i].index);
+    if (hit.index != -1) {
+      EXPECT_EQ(hit.dist, hits[i].dist);
+      hits_len_expected++;
+    }
+  }
+  EXPECT_EQ(hits_len_expected, hits_len);
+  EXPECT_GT(hits_len, 0);
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(points);
+  MEM_freeN(origins);
+  MEM_freeN(directions);
+  MEM_freeN(hits);
+}
+
+TEST(kdopbvh, RayCastBatch_1)
+{
+  ray_cast_batch_test(1, 3, 0.0f, 1234, 0);
+}
+TEST(kdopbvh, RayCastBatch_500)
+{
+  ray_cast_batch_test(500, 1001, 0.0f, 12, 0);
+}
+TEST(kdopbvh, RayCastBatchRadius_500)
+{
+  ray_cast_batch_test(500, 1001, 0.05f, 123, 0);
+}
+TEST(kdopbvh, RayCastBatchThreaded_500)
+{
+  BLI_threadapi_init();
+  ray_cast_batch_test(500, 10001, 0.0f, 12, BVH_RAYCAST_USE_THREADING);
+  BLI_threadapi_exit();
+}
+
+/* Unevenly distributed boxes, clustered in a few spots and spread along a line. */
+static BVHTree *sah_test_tree_create(
+    int boxes_len, char tree_type, int build_flag, int seed, float (*r_centers)[3] = NULL)
+{
+  struct RNG *rng = BLI_rng_new(seed);
+  BVHTree *tree = BLI_bvhtree_new_ex(boxes_len, 0.0f, tree_type, 6, build_flag);
+  for (int i = 0; i < boxes_len; i++) {
+    float bounds[2][3];
+    rng_v3_round(bounds[0], 3, rng, 1000000, 0.1f);
+    if (i % 3 == 0) {
+      bounds[0][0] = bounds[0][0] * 100.0f;
+    }
+    else {
+      bounds[0][i % 2] += (float)(i % 5);
+    }
+    copy_v3_v3(bounds[1], bounds[0]);
+    add_v3_fl(bounds[1], 0.01f + BLI_rng_get_float(rng) * 0.02f);
+    BLI_bvhtree_insert(tree, i, bounds[0], 2);
+    if (r_centers) {
+      mid_v3_v3v3(r_centers[i], bounds[0], bounds[1]);
+    }
+  }
+  BLI_bvhtree_balance(tree);
+  BLI_rng_free(rng);
+  return tree;
+}
+
+/**
+ * Compare the overlap and ray-cast results of trees built with the surface area heuristic and
+ * with the median split.
+ */
+static void sah_compare_test(int boxes_len, char tree_type, int seed)
+{
+  BLI_threadapi_init();
+
+  float(*centers)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * boxes_len, __func__);
+  BVHTree *tree_sah = sah_test_tree_create(boxes_len, tree_type, BVH_BUILD_SAH, seed, centers);
+  BVHTree *tree_median = sah_test_tree_create(boxes_len, tree_type, 0, seed);
+  BVHTree *tree_other = sah_test_tree_create(boxes_len / 2 + 1, 4, 0, seed + 1);
+
+  uint overlap_sah_len, overlap_median_len;
+  BVHTreeOverlap *overlap_sah = BLI_bvhtree_overlap(
+      tree_sah, tree_other, &overlap_sah_len, NULL, NULL);
+  BVHTreeOverlap *overlap_median = BLI_bvhtree_overlap(
+      tree_median, tree_other, &overlap_median_len, NULL, NULL);
+  EXPECT_EQ(overlap_median_len, overlap_sah_len);
+  EXPECT_GT(overlap_sah_len, 0);
+  MEM_SAFE_FREE(overlap_sah);
+  MEM_SAFE_FREE(overlap_median);
+
+  /* The boxes are hit with a null callback, the nearest box is hit first.
+   * Rays are cast toward random boxes. */
+  struct RNG *rng = BLI_rng_new(seed);
+  int hits_len = 0;
+  for (int i = 0; i < 1000; i++) {
+    float origin[3], direction[3];
+    rng_v3_round(origin, 3, rng, 1000000, 5.0f);
+    sub_v3_v3v3(direction, centers[BLI_rng_get_int(rng) % boxes_len], origin);
+    normalize_v3(direction);
+    BVHTreeRayHit hit_sah, hit_median;
+    hit_sah.index = hit_median.index = -1;
+    hit_sah.dist = hit_median.dist = BVH_RAYCAST_DIST_MAX;
+    BLI_bvhtree_ray_cast(tree_sah, origin, direction, 0.0f, &hit_sah, NULL, NULL);
+    BLI_bvhtree_ray_cast(tree_median, origin, direction, 0.0f, &hit_median, NULL, NULL);
+    EXPECT_EQ(hit_median.index == -1, hit_sah.index == -1);
+    if (hit_sah.index != -1) {
+      EXPECT_FLOAT_EQ(hit_median.dist, hit_sah.dist);
+      hits_len++;
+    }
+  }
+  EXPECT_GT(hits_len, 0);
+  BLI_rng_free(rng);
+  MEM_freeN(centers);
+
+  BLI_bvhtree_free(tree_sah);
+  BLI_bvhtree_free(tree_median);
+  BLI_bvhtree_free(tree_other);
+
+  BLI_threadapi_exit();
+}
+
+TEST(kdopbvh, SAHBinary_500)
+{
+  sah_compare_test(500, 2, 12);
+}
+TEST(kdopbvh, SAHQuad_500)
+{
+  sah_compare_test(500, 4, 123);
+}
+TEST(kdopbvh, SAHOct_20000)
+{
+  sah_compare_test(20000, 8, 1234);
+}
+TEST(kdopbvh, SAHQuad_100000)
+{
+  sah_compare_test(100000, 4, 12);
+}
@@ -0,0 +1,124 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+
+#include "BLI_kdtree.h"
+#include "BLI_math.h"
+#include "BLI_rand.h"
+#include "BLI_threads.h"
+
+#include "PIL_time.h"
+}
+
+#include "stubs/bf_intern_eigen_stubs.h"
+
+#define NUM_RUN_AVERAGED 3
+
+#define POINTS_LEN 1000000
+#define NEAREST_LEN 8
+
+/* Build a tree of random points and query the nearest points of each of them. */
+static void kdtree_batch_performance_test(const char *id, const bool use_range)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  BLI_threadapi_init();
+
+  RNG *rng = BLI_rng_new(0);
+  float(*co)[3] = (float(*)[3])MEM_mallocN(sizeof(*co) * POINTS_LEN, __func__);
+  for (int i = 0; i < POINTS_LEN; i++) {
+    BLI_rng_get_float_unit_v3(rng, co[i]);
+  }
+  BLI_rng_free(rng);
+
+  KDTreeNearest_3d *nearest = (KDTreeNearest_3d *)MEM_mallocN(
+      sizeof(*nearest) * POINTS_LEN * NEAREST_LEN, __func__);
+  int *nearest_len = (int *)MEM_mallocN(sizeof(*nearest_len) * POINTS_LEN, __func__);
+  /* Roughly #NEAREST_LEN points in range on the unit sphere. */
+  const float range = sqrtf(4.0f * NEAREST_LEN / POINTS_LEN);
+
+  KDTree_3d *tree = NULL;
+  double averaged_timing = 0.0;
+  for (int r = 0; r < NUM_RUN_AVERAGED; r++) {
+    BLI_kdtree_3d_free(tree);
+    tree = BLI_kdtree_3d_new(POINTS_LEN);
+    for (int i = 0; i < POINTS_LEN; i++) {
+      BLI_kdtree_3d_insert(tree, i, co[i]);
+    }
+    const double init_time = PIL_check_seconds_timer();
+    BLI_kdtree_3d_balance(tree);
+    averaged_timing += PIL_check_seconds_timer() - init_time;
+  }
+  printf("\t%s: balanced %d points in %fs on average over %d runs\n",
+         id,
+         POINTS_LEN,
+         averaged_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+
+  averaged_timing = 0.0;
+  int found = 0;
+  for (int r = 0; r < NUM_RUN_AVERAGED; r++) {
+    const double init_time = PIL_check_seconds_timer();
+    found = 0;
+    for (int i = 0; i < POINTS_LEN; i++) {
+      if (use_range) {
+        KDTreeNearest_3d *nearest_range = NULL;
+        found += min_ii(BLI_kdtree_3d_range_search(tree, co[i], &nearest_range, range),
+                        NEAREST_LEN);
+        if (nearest_range) {
+          MEM_freeN(nearest_range);
+        }
+      }
+      else {
+        found += BLI_kdtree_3d_find_nearest_n(tree, co[i], nearest, NEAREST_LEN);
+      }
+    }
+    averaged_timing += PIL_check_seconds_timer() - init_time;
+  }
+  printf("\t%s: %d queries one by one done in %fs on average over %d runs\n",
+         id,
+         POINTS_LEN,
+         averaged_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+
+  averaged_timing = 0.0;
+  for (int r = 0; r < NUM_RUN_AVERAGED; r++) {
+    const double init_time = PIL_check_seconds_timer();
+    const int found_batch =
+        use_range ? BLI_kdtree_3d_range_search_batch(
+                        tree, co, POINTS_LEN, range, nearest, nearest_len, NEAREST_LEN) :
+                    BLI_kdtree_3d_find_nearest_n_batch(
+                        tree, co, POINTS_LEN, nearest, nearest_len, NEAREST_LEN);
+    averaged_timing += PIL_check_seconds_timer() - init_time;
+    EXPECT_EQ(found, found_batch);
+  }
+  printf("\t%s: %d queries batched done in %fs on average over %d runs\n",
+         id,
+         POINTS_LEN,
+         averaged_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+
+  BLI_kdtree_3d_free(tree);
+  MEM_freeN(co);
+  MEM_freeN(nearest);
+  MEM_freeN(nearest_len);
+
+  BLI_threadapi_exit();
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(kdtree, FindNearestNBatch)
+{
+  kdtree_batch_performance_test("FindNearestNBatch", false);
+}
+
+TEST(kdtree, RangeSearchBatch)
+{
+  kdtree_batch_performance_test("RangeSearchBatch", true);
+}
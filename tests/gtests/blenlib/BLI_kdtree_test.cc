@@ -0,0 +1,229 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+
+#include "BLI_kdtree.h"
+#include "BLI_math.h"
+#include "BLI_rand.h"
+#include "BLI_threads.h"
+}
+
+#include "stubs/bf_intern_eigen_stubs.h"
+
+/* Overloads of the kd-tree API, so the tests are written once for all dimensions. */
+#define KDTREE_API_DEFINE(dims) \
+  static KDTree_##dims##d *kdtree_new(KDTree_##dims##d * /*tag*/, uint maxsize) \
+  { \
+    return BLI_kdtree_##dims##d_new(maxsize); \
+  } \
+  static void kdtree_free(KDTree_##dims##d *tree) \
+  { \
+    BLI_kdtree_##dims##d_free(tree); \
+  } \
+  static void kdtree_insert(KDTree_##dims##d *tree, int index, const float co[dims]) \
+  { \
+    BLI_kdtree_##dims##d_insert(tree, index, co); \
+  } \
+  static void kdtree_balance(KDTree_##dims##d *tree) \
+  { \
+    BLI_kdtree_##dims##d_balance(tree); \
+  } \
+  static int kdtree_find_nearest(const KDTree_##dims##d *tree, \
+                                 const float co[dims], \
+                                 KDTreeNearest_##dims##d *r_nearest) \
+  { \
+    return BLI_kdtree_##dims##d_find_nearest(tree, co, r_nearest); \
+  } \
+  static int kdtree_find_nearest_n(const KDTree_##dims##d *tree, \
+                                   const float co[dims], \
+                                   KDTreeNearest_##dims##d *r_nearest, \
+                                   uint nearest_len_capacity) \
+  { \
+    return BLI_kdtree_##dims##d_find_nearest_n(tree, co, r_nearest, nearest_len_capacity); \
+  } \
+  static int kdtree_range_search(const KDTree_##dims##d *tree, \
+                                 const float co[dims], \
+                                 KDTreeNearest_##dims##d **r_nearest, \
+                                 float range) \
+  { \
+    return BLI_kdtree_##dims##d_range_search(tree, co, r_nearest, range); \
+  } \
+  static int kdtree_find_nearest_n_batch(const KDTree_##dims##d *tree, \
+                                         const float (*co)[dims], \
+                                         uint co_len, \
+                                         KDTreeNearest_##dims##d *r_nearest, \
+                                         int *r_nearest_len, \
+                                         uint nearest_len_capacity) \
+  { \
+    return BLI_kdtree_##dims##d_find_nearest_n_batch( \
+        tree, co, co_len, r_nearest, r_nearest_len, nearest_len_capacity); \
+  } \
+  static int kdtree_range_search_batch(const KDTree_##dims##d *tree, \
+                                       const float (*co)[dims], \
+                                       uint co_len, \
+                                       float range, \
+                                       KDTreeNearest_##dims##d *r_nearest, \
+                                       int *r_nearest_len, \
+                                       uint nearest_len_capacity) \
+  { \
+    return BLI_kdtree_##dims##d_range_search_batch( \
+        tree, co, co_len, range, r_nearest, r_nearest_len, nearest_len_capacity); \
+  }
+
+KDTREE_API_DEFINE(1)
+KDTREE_API_DEFINE(2)
+KDTREE_API_DEFINE(3)
+KDTREE_API_DEFINE(4)
+
+#undef KDTREE_API_DEFINE
+
+/* -------------------------------------------------------------------- */
+/* Tests */
+
+/**
+ * Compare the batched queries with the single point queries and the tree with a brute force
+ * search. Trees of 10000 points or more are balanced in parallel.
+ */
+template<int Dims, typename Tree, typename Nearest>
+static void kdtree_batch_test(const int points_len,
+                              const int queries_len,
+                              const uint nearest_len_capacity,
+                              const bool use_range,
+                              const float range)
+{
+  BLI_threadapi_init();
+
+  RNG *rng = BLI_rng_new(points_len);
+
+  float(*points)[Dims] = (float(*)[Dims])MEM_mallocN(sizeof(*points) * points_len, __func__);
+  Tree *tree = kdtree_new((Tree *)NULL, points_len);
+  for (int i = 0; i < points_len; i++) {
+    for (int j = 0; j < Dims; j++) {
+      points[i][j] = BLI_rng_get_float(rng);
+    }
+    kdtree_insert(tree, i, points[i]);
+  }
+  kdtree_balance(tree);
+
+  float(*co)[Dims] = (float(*)[Dims])MEM_mallocN(sizeof(*co) * queries_len, __func__);
+  for (int i = 0; i < queries_len; i++) {
+    for (int j = 0; j < Dims; j++) {
+      co[i][j] = BLI_rng_get_float(rng);
+    }
+  }
+
+  Nearest *nearest = (Nearest *)MEM_mallocN(
+      sizeof(*nearest) * queries_len * nearest_len_capacity, __func__);
+  int *nearest_len = (int *)MEM_mallocN(sizeof(*nearest_len) * queries_len, __func__);
+  Nearest *nearest_single = (Nearest *)MEM_mallocN(sizeof(*nearest_single) * nearest_len_capacity,
+                                                   __func__);
+
+  const int found =
+      use_range ? kdtree_range_search_batch(
+                      tree, co, queries_len, range, nearest, nearest_len, nearest_len_capacity) :
+                  kdtree_find_nearest_n_batch(
+                      tree, co, queries_len, nearest, nearest_len, nearest_len_capacity);
+
+  int found_single = 0;
+  for (int i = 0; i < queries_len; i++) {
+    const Nearest *nearest_batch = &nearest[i * nearest_len_capacity];
+    if (use_range) {
+      Nearest *nearest_range = NULL;
+      const int range_len = kdtree_range_search(tree, co[i], &nearest_range, range);
+      /* Only the nearest points are kept when the capacity is exceeded. */
+      const int expect_len = min_ii(range_len, (int)nearest_len_capacity);
+      EXPECT_EQ(expect_len, nearest_len[i]);
+      for (int j = 0; j < min_ii(expect_len, nearest_len[i]); j++) {
+        EXPECT_FLOAT_EQ(nearest_range[j].dist, nearest_batch[j].dist);
+        EXPECT_LE(nearest_batch[j].dist, range);
+      }
+      found_single += expect_len;
+      if (nearest_range) {
+        MEM_freeN(nearest_range);
+      }
+    }
+    else {
+      const int single_len = kdtree_find_nearest_n(
+          tree, co[i], nearest_single, nearest_len_capacity);
+      EXPECT_EQ(single_len, nearest_len[i]);
+      for (int j = 0; j < min_ii(single_len, nearest_len[i]); j++) {
+        EXPECT_EQ(nearest_single[j].index, nearest_batch[j].index);
+        EXPECT_EQ(nearest_single[j].dist, nearest_batch[j].dist);
+      }
+      found_single += single_len;
+    }
+  }
+  EXPECT_EQ(found_single, found);
+
+  for (int i = 0; i < min_ii(queries_len, 16); i++) {
+    float dist_sq_min = FLT_MAX;
+    for (int j = 0; j < points_len; j++) {
+      float dist_sq = 0.0f;
+      for (int k = 0; k < Dims; k++) {
+        dist_sq += SQUARE(co[i][k] - points[j][k]);
+      }
+      dist_sq_min = min_ff(dist_sq_min, dist_sq);
+    }
+    Nearest nearest_tree;
+    EXPECT_NE(-1, kdtree_find_nearest(tree, co[i], &nearest_tree));
+    EXPECT_FLOAT_EQ(sqrtf(dist_sq_min), nearest_tree.dist);
+  }
+
+  kdtree_free(tree);
+  MEM_freeN(points);
+  MEM_freeN(co);
+  MEM_freeN(nearest);
+  MEM_freeN(nearest_len);
+  MEM_freeN(nearest_single);
+  BLI_rng_free(rng);
+
+  BLI_threadapi_exit();
+}
+
+#define KDTREE_BATCH_TEST(dims, points_len, queries_len) \
+  TEST(kdtree, FindNearestNBatch_##dims##d_##points_len) \
+  { \
+    kdtree_batch_test<dims, KDTree_##dims##d, KDTreeNearest_##dims##d>( \
+        points_len, queries_len, 8, false, 0.0f); \
+  } \
+  TEST(kdtree, RangeSearchBatch_##dims##d_##points_len) \
+  { \
+    /* Roughly 8 points in range, some queries exceed the capacity. */ \
+    const float range = powf(8.0f / (points_len), 1.0f / (dims)) * 0.5f; \
+    kdtree_batch_test<dims, KDTree_##dims##d, KDTreeNearest_##dims##d>( \
+        points_len, queries_len, 12, true, range); \
+  }
+
+KDTREE_BATCH_TEST(1, 1, 10)
+KDTREE_BATCH_TEST(2, 1000, 100)
+KDTREE_BATCH_TEST(1, 20000, 1000)
+KDTREE_BATCH_TEST(2, 20000, 1000)
+KDTREE_BATCH_TEST(3, 20000, 1000)
+KDTREE_BATCH_TEST(4, 20000, 1000)
+KDTREE_BATCH_TEST(3, 100000, 10000)
+
+#undef KDTREE_BATCH_TEST
+
+TEST(kdtree, BatchEmpty)
+{
+  KDTree_3d *tree = BLI_kdtree_3d_new(0);
+  BLI_kdtree_3d_balance(tree);
+
+  const float co[2][3] = {{0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}};
+  KDTreeNearest_3d nearest[4];
+  int nearest_len[2] = {-1, -1};
+  EXPECT_EQ(0, BLI_kdtree_3d_find_nearest_n_batch(tree, co, 2, nearest, nearest_len, 2));
+  EXPECT_EQ(0, nearest_len[0]);
+  EXPECT_EQ(0, nearest_len[1]);
+  nearest_len[0] = nearest_len[1] = -1;
+  EXPECT_EQ(0, BLI_kdtree_3d_range_search_batch(tree, co, 2, 1.0f, nearest, nearest_len, 2));
+  EXPECT_EQ(0, nearest_len[0]);
+  EXPECT_EQ(0, nearest_len[1]);
+
+  BLI_kdtree_3d_free(tree);
+}
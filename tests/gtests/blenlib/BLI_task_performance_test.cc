@@ -15,6 +15,7 @@ extern "C" {
 #include "BLI_listbase.h"
 #include "BLI_mempool.h"
 #include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "PIL_time.h"
 }
@@ -296,3 +297,107 @@ TEST(task, ListBaseIter100k)
 {
   task_listbase_test("ListBase parallel iteration - Threaded - 100000 items", 100000, true);
 }
+
+/* *** Task pools, work stealing against the single queue. *** */
+
+#define TASK_SPAWN_DEPTH 14
+
+static void task_pool_light_func(TaskPool *__restrict UNUSED(pool),
+                                 void *taskdata,
+                                 int UNUSED(threadid))
+{
+  const uint index = (uint)POINTER_AS_INT(taskdata);
+  const uint limit = gen_pseudo_random_number(index) / 8;
+  for (uint i = index; i < limit;) {
+    i += gen_pseudo_random_number(i);
+  }
+}
+
+/* Every task spawns two smaller tasks until the maximum depth, like a recursive subdivision. */
+static void task_pool_spawn_func(TaskPool *__restrict pool, void *taskdata, int threadid)
+{
+  const int depth = POINTER_AS_INT(taskdata);
+
+  task_pool_light_func(pool, POINTER_FROM_INT(depth), threadid);
+
+  if (depth < TASK_SPAWN_DEPTH) {
+    for (int i = 0; i < 2; i++) {
+      BLI_task_pool_push_from_thread(pool,
+                                     task_pool_spawn_func,
+                                     POINTER_FROM_INT(depth + 1),
+                                     false,
+                                     TASK_PRIORITY_HIGH,
+                                     threadid);
+    }
+  }
+}
+
+static double task_pool_flat_test_do(TaskScheduler *scheduler, const int num_tasks)
+{
+  double averaged_timing = 0.0;
+  for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+    const double init_time = PIL_check_seconds_timer();
+    TaskPool *pool = BLI_task_pool_create(scheduler, NULL);
+    for (int j = 0; j < num_tasks; j++) {
+      BLI_task_pool_push(
+          pool, task_pool_light_func, POINTER_FROM_INT(j), false, TASK_PRIORITY_HIGH);
+    }
+    BLI_task_pool_work_and_wait(pool);
+    BLI_task_pool_free(pool);
+    averaged_timing += PIL_check_seconds_timer() - init_time;
+  }
+  return averaged_timing / NUM_RUN_AVERAGED;
+}
+
+static double task_pool_spawn_test_do(TaskScheduler *scheduler)
+{
+  double averaged_timing = 0.0;
+  for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+    const double init_time = PIL_check_seconds_timer();
+    TaskPool *pool = BLI_task_pool_create(scheduler, NULL);
+    BLI_task_pool_push(pool, task_pool_spawn_func, POINTER_FROM_INT(0), false, TASK_PRIORITY_HIGH);
+    BLI_task_pool_work_and_wait(pool);
+    BLI_task_pool_free(pool);
+    averaged_timing += PIL_check_seconds_timer() - init_time;
+  }
+  return averaged_timing / NUM_RUN_AVERAGED;
+}
+
+static double task_pool_range_test_do(const int num_items)
+{
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 64;
+
+  double averaged_timing = 0.0;
+  for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+    const double init_time = PIL_check_seconds_timer();
+    BLI_task_parallel_range(0, num_items, NULL, task_parallel_range_func, &settings);
+    averaged_timing += PIL_check_seconds_timer() - init_time;
+  }
+  return averaged_timing / NUM_RUN_AVERAGED;
+}
+
+/* Build task.c without USE_WORK_STEALING to compare with the single queue. */
+TEST(task, Scheduler)
+{
+  printf("\n========== STARTING Task scheduler ==========\n");
+
+  BLI_threadapi_init();
+  TaskScheduler *scheduler = BLI_task_scheduler_get();
+
+  printf("\tFlat pool, 100K tasks: done in %fs on average over %d runs\n",
+         task_pool_flat_test_do(scheduler, 100000),
+         NUM_RUN_AVERAGED);
+  printf("\tRecursive spawn, %d tasks: done in %fs on average over %d runs\n",
+         (1 << (TASK_SPAWN_DEPTH + 1)) - 1,
+         task_pool_spawn_test_do(scheduler),
+         NUM_RUN_AVERAGED);
+  printf("\tRange, 100K items: done in %fs on average over %d runs\n",
+         task_pool_range_test_do(100000),
+         NUM_RUN_AVERAGED);
+
+  BLI_threadapi_exit();
+
+  printf("========== ENDED Task scheduler ==========\n\n");
+}
@@ -0,0 +1,59 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "blendfile_loading_base_test.h"
+
+#include "BLO_readfile.h"
+
+DEFINE_string(read_benchmark_file,
+              "",
+              "Blend file loaded by the read benchmark, relative to the test assets directory. "
+              "Use a file saved by an older Blender version to measure the DNA reconstruction.");
+DEFINE_int32(read_benchmark_iterations, 5, "Number of times the benchmark file is loaded.");
+
+class BlendfileLoadingPerformanceTest : public BlendfileLoadingBaseTest {
+};
+
+TEST_F(BlendfileLoadingPerformanceTest, ReadTimings)
+{
+  if (FLAGS_read_benchmark_file.empty()) {
+    printf("Pass the flag --read-benchmark-file to run the read benchmark.\n");
+    return;
+  }
+
+  BlendFileReadTimings sum = {0};
+  const int iterations = FLAGS_read_benchmark_iterations;
+  for (int i = 0; i < iterations; i++) {
+    if (!blendfile_load(FLAGS_read_benchmark_file.c_str())) {
+      return;
+    }
+    const BlendFileReadTimings &timings = bfile->timings;
+    sum.reconstruct += timings.reconstruct;
+    sum.read_blocks += timings.read_blocks;
+    sum.versioning += timings.versioning;
+    sum.lib_link += timings.lib_link;
+    sum.total += timings.total;
+    blendfile_free();
+  }
+
+  printf("Read %s, average of %d loads:\n", FLAGS_read_benchmark_file.c_str(), iterations);
+  printf("  reconstruct: %8.3f ms\n", sum.reconstruct * 1000.0 / iterations);
+  printf("  read blocks: %8.3f ms\n", sum.read_blocks * 1000.0 / iterations);
+  printf("  versioning:  %8.3f ms\n", sum.versioning * 1000.0 / iterations);
+  printf("  lib link:    %8.3f ms\n", sum.lib_link * 1000.0 / iterations);
+  printf("  total:       %8.3f ms\n", sum.total * 1000.0 / iterations);
+}
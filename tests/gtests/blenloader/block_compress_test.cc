@@ -0,0 +1,283 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include <fcntl.h>
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifndef WIN32
+#  include <unistd.h>
+#else
+#  include <io.h>
+#endif
+
+extern "C" {
+#include "BKE_appdir.h"
+
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+#include "BLI_threads.h"
+
+#include "block_compress.h"
+}
+
+/* Uncompressed frame size and footer length, see the layout in block_compress.h. */
+#define FRAME_SIZE (1 << 20)
+#define FOOTER_LEN (16 + BLOCK_COMPRESS_MAGIC_LEN + 1)
+
+class BlockCompressTest : public testing::Test {
+ protected:
+  std::string filepath;
+  std::vector<unsigned char> content;
+
+  static void SetUpTestCase()
+  {
+    BLI_threadapi_init();
+    BKE_tempdir_init(NULL);
+  }
+
+  static void TearDownTestCase()
+  {
+    BLI_threadapi_exit();
+  }
+
+  void SetUp() override
+  {
+    char path[FILE_MAX];
+    BLI_join_dirfile(path, sizeof(path), BKE_tempdir_base(), "block_compress_test.blend");
+    filepath = path;
+
+    /* Three and a half frames of data which doesn't compress, so frames differ in size. */
+    content.resize(FRAME_SIZE * 3 + FRAME_SIZE / 2);
+    unsigned int seed = 1;
+    for (unsigned char &c : content) {
+      seed = seed * 1103515245 + 12345;
+      c = (unsigned char)(seed >> 16);
+    }
+  }
+
+  void TearDown() override
+  {
+    BLI_delete(filepath.c_str(), false, false);
+  }
+
+  /* Write the content in chunks which don't line up with the frames. */
+  bool write_content()
+  {
+    const int file = BLI_open(filepath.c_str(), O_BINARY | O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (file == -1) {
+      return false;
+    }
+    BlockCompressWriter *writer = blo_block_writer_open(file);
+    if (writer == NULL) {
+      close(file);
+      return false;
+    }
+
+    const size_t chunk = 100003;
+    for (size_t offset = 0; offset < content.size(); offset += chunk) {
+      const size_t len = std::min(chunk, content.size() - offset);
+      if (!blo_block_writer_write(writer, &content[offset], len)) {
+        blo_block_writer_close(writer);
+        return false;
+      }
+    }
+    return blo_block_writer_close(writer);
+  }
+
+  std::vector<char> file_read()
+  {
+    std::ifstream stream(filepath, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(stream),
+                             std::istreambuf_iterator<char>());
+  }
+
+  void file_write(const std::vector<char> &data)
+  {
+    std::ofstream stream(filepath, std::ios::binary | std::ios::trunc);
+    stream.write(data.data(), (std::streamsize)data.size());
+  }
+
+  /* Check that opening the file fails. */
+  bool reader_open_fails()
+  {
+    const int file = BLI_open(filepath.c_str(), O_BINARY | O_RDONLY, 0);
+    if (file == -1) {
+      return false;
+    }
+    BlockCompressReader *reader = blo_block_reader_open(file);
+    if (reader != NULL) {
+      blo_block_reader_free(reader);
+    }
+    close(file);
+    return reader == NULL;
+  }
+
+  /* Read `size` bytes at `offset` and compare them with the content. */
+  void expect_read(BlockCompressReader *reader, uint64_t offset, size_t size)
+  {
+    const size_t size_expected = (size_t)std::min<uint64_t>(size, content.size() - offset);
+    std::vector<unsigned char> buffer(size);
+
+    EXPECT_EQ((int64_t)size_expected, blo_block_reader_read(reader, buffer.data(), offset, size));
+    EXPECT_TRUE(std::equal(buffer.begin(),
+                           buffer.begin() + (ptrdiff_t)size_expected,
+                           content.begin() + (ptrdiff_t)offset));
+  }
+};
+
+TEST_F(BlockCompressTest, RoundTrip)
+{
+  ASSERT_TRUE(write_content());
+
+  const std::vector<char> data = file_read();
+  ASSERT_GT(data.size(), (size_t)BLOCK_COMPRESS_MAGIC_LEN);
+  EXPECT_TRUE(blo_block_compress_check_magic(data.data()));
+
+  const int file = BLI_open(filepath.c_str(), O_BINARY | O_RDONLY, 0);
+  ASSERT_NE(-1, file);
+  BlockCompressReader *reader = blo_block_reader_open(file);
+  ASSERT_NE(nullptr, reader);
+  EXPECT_EQ(content.size(), blo_block_reader_size(reader));
+
+  /* Sequential reading, in chunks spanning several frames. */
+  const size_t chunk = FRAME_SIZE + FRAME_SIZE / 3;
+  for (size_t offset = 0; offset < content.size(); offset += chunk) {
+    expect_read(reader, offset, chunk);
+  }
+
+  /* Seeking back and forth across frame boundaries. */
+  expect_read(reader, FRAME_SIZE * 2 - 10, 20);
+  expect_read(reader, FRAME_SIZE - 1, 2);
+  expect_read(reader, FRAME_SIZE * 3, 100);
+  expect_read(reader, 0, FRAME_SIZE * 3 + 1);
+  expect_read(reader, FRAME_SIZE / 2, 10);
+
+  /* Reading past the end stops at the end. */
+  expect_read(reader, content.size() - 5, 100);
+  char c;
+  EXPECT_EQ(0, blo_block_reader_read(reader, &c, content.size(), 1));
+
+  blo_block_reader_free(reader);
+  close(file);
+}
+
+TEST_F(BlockCompressTest, Truncated)
+{
+  ASSERT_TRUE(write_content());
+  const std::vector<char> data = file_read();
+
+  /* Missing the end of the footer. */
+  file_write(std::vector<char>(data.begin(), data.end() - 1));
+  EXPECT_TRUE(reader_open_fails());
+
+  /* Missing the whole footer. */
+  file_write(std::vector<char>(data.begin(), data.end() - FOOTER_LEN));
+  EXPECT_TRUE(reader_open_fails());
+
+  /* Missing the last frame, the index and the footer. */
+  file_write(std::vector<char>(data.begin(), data.begin() + (ptrdiff_t)data.size() / 2));
+  EXPECT_TRUE(reader_open_fails());
+
+  /* Only the header. */
+  file_write(std::vector<char>(data.begin(), data.begin() + BLOCK_COMPRESS_MAGIC_LEN + 1));
+  EXPECT_TRUE(reader_open_fails());
+}
+
+TEST_F(BlockCompressTest, CorruptedFooter)
+{
+  ASSERT_TRUE(write_content());
+  const std::vector<char> data = file_read();
+  const size_t footer = data.size() - FOOTER_LEN;
+
+  /* Magic at the end of the footer. */
+  std::vector<char> corrupted = data;
+  corrupted[data.size() - 2] ^= 0x55;
+  file_write(corrupted);
+  EXPECT_TRUE(reader_open_fails());
+
+  /* Index offset. */
+  corrupted = data;
+  corrupted[footer] ^= 0x01;
+  file_write(corrupted);
+  EXPECT_TRUE(reader_open_fails());
+
+  /* Number of frames. */
+  corrupted = data;
+  corrupted[footer + 8] ^= 0x01;
+  file_write(corrupted);
+  EXPECT_TRUE(reader_open_fails());
+
+  /* Frame size, the full frames don't match it anymore. */
+  corrupted = data;
+  corrupted[footer + 14] ^= 0x01;
+  file_write(corrupted);
+  EXPECT_TRUE(reader_open_fails());
+}
+
+TEST_F(BlockCompressTest, CorruptedIndex)
+{
+  ASSERT_TRUE(write_content());
+  const std::vector<char> data = file_read();
+  const size_t frames_len = (content.size() + FRAME_SIZE - 1) / FRAME_SIZE;
+  const size_t index = data.size() - FOOTER_LEN - frames_len * 16;
+
+  /* Offset of the second frame. */
+  std::vector<char> corrupted = data;
+  corrupted[index + 16] ^= 0x01;
+  file_write(corrupted);
+  EXPECT_TRUE(reader_open_fails());
+
+  /* Compressed size of the first frame. */
+  corrupted = data;
+  corrupted[index + 8] ^= 0x01;
+  file_write(corrupted);
+  EXPECT_TRUE(reader_open_fails());
+
+  /* Uncompressed size of a frame which isn't the last. */
+  corrupted = data;
+  corrupted[index + 16 + 12] ^= 0x01;
+  file_write(corrupted);
+  EXPECT_TRUE(reader_open_fails());
+}
+
+TEST_F(BlockCompressTest, CorruptedFrame)
+{
+  ASSERT_TRUE(write_content());
+  std::vector<char> data = file_read();
+
+  /* The index is still valid, reading the frame fails. */
+  data[BLOCK_COMPRESS_MAGIC_LEN + 1 + 100] ^= 0x55;
+  file_write(data);
+
+  const int file = BLI_open(filepath.c_str(), O_BINARY | O_RDONLY, 0);
+  ASSERT_NE(-1, file);
+  BlockCompressReader *reader = blo_block_reader_open(file);
+  ASSERT_NE(nullptr, reader);
+
+  std::vector<unsigned char> buffer(100);
+  EXPECT_EQ(-1, blo_block_reader_read(reader, buffer.data(), 0, buffer.size()));
+
+  /* Other frames are still readable. */
+  expect_read(reader, FRAME_SIZE * 2, 100);
+
+  blo_block_reader_free(reader);
+  close(file);
+}
@@ -0,0 +1,244 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BKE_blender.h"
+#include "BKE_collection.h"
+#include "BKE_layer.h"
+#include "BKE_main.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "BLI_threads.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_debug.h"
+#include "DEG_depsgraph_query.h"
+
+#include "DNA_collection_types.h"
+#include "DNA_genfile.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "IMB_imbuf.h"
+
+#include "PIL_time.h"
+
+#include "RNA_define.h"
+}
+
+DEFINE_int32(update_benchmark_iterations,
+             100,
+             "Number of updates measured by the depsgraph update benchmark.");
+DEFINE_int32(relations_benchmark_iterations,
+             10,
+             "Number of relations updates measured by the depsgraph relations benchmark.");
+
+/* Scene of empties in a single collection, built without loading any file. */
+class DepsgraphUpdatePerformanceTest : public testing::Test {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  ViewLayer *view_layer = nullptr;
+  Collection *collection = nullptr;
+  Object **objects = nullptr;
+  int num_objects = 0;
+  Depsgraph *depsgraph = nullptr;
+
+ public:
+  /* Only the data-block types and the depsgraph are initialized, scenes need color
+   * management for their view settings. */
+  static void SetUpTestCase()
+  {
+    testing::Test::SetUpTestCase();
+
+    BLI_threadapi_init();
+    DNA_sdna_current_init();
+    BKE_blender_globals_init();
+    IMB_init();
+    DEG_register_node_types();
+    RNA_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    BKE_blender_free();
+    RNA_exit();
+    DEG_free_node_types();
+    DNA_sdna_current_free();
+    BLI_threadapi_exit();
+
+    testing::Test::TearDownTestCase();
+  }
+
+ protected:
+
+  void scene_create(const int size)
+  {
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+
+    /* Fill the collection before linking it to the scene, to only synchronize the view layer
+     * once. */
+    collection = BKE_collection_add(bmain, nullptr, "Objects");
+    objects = (Object **)MEM_mallocN(sizeof(Object *) * size, __func__);
+    for (int i = 0; i < size; i++) {
+      Object *object = BKE_object_add_only_object(bmain, OB_EMPTY, "Empty");
+      object->loc[0] = (float)i;
+      BKE_collection_object_add(bmain, collection, object);
+      objects[i] = object;
+    }
+    BKE_collection_child_add(bmain, scene->master_collection, collection);
+    num_objects = size;
+
+    view_layer = BKE_view_layer_default_view(scene);
+    depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(depsgraph, bmain, scene, view_layer);
+    BKE_scene_graph_update_tagged(depsgraph, bmain);
+  }
+
+  void scene_free()
+  {
+    DEG_graph_free(depsgraph);
+    depsgraph = nullptr;
+    MEM_SAFE_FREE(objects);
+    BKE_main_free(bmain);
+    bmain = nullptr;
+    scene = nullptr;
+    view_layer = nullptr;
+    collection = nullptr;
+  }
+
+  /* Average duration of an update of `num_tagged` objects transform, in milliseconds. */
+  double measure_update(const int num_tagged)
+  {
+    const int iterations = FLAGS_update_benchmark_iterations;
+    double total = 0.0;
+    for (int i = 0; i < iterations; i++) {
+      for (int j = 0; j < num_tagged; j++) {
+        Object *object = objects[(i * num_tagged + j) % num_objects];
+        object->loc[2] = (float)i;
+        DEG_id_tag_update_ex(bmain, &object->id, ID_RECALC_TRANSFORM);
+      }
+
+      const double start = PIL_check_seconds_timer();
+      BKE_scene_graph_update_tagged(depsgraph, bmain);
+      total += PIL_check_seconds_timer() - start;
+    }
+    return total * 1000.0 / iterations;
+  }
+
+  /* Check that the relations match the ones of a graph built from scratch. */
+  bool relations_match_full_build()
+  {
+    Depsgraph *full_depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(full_depsgraph, bmain, scene, view_layer);
+    const bool match = DEG_debug_compare(full_depsgraph, depsgraph);
+    DEG_graph_free(full_depsgraph);
+    return match;
+  }
+
+  /* Average duration of the relations updates after adding and removing an object, in
+   * milliseconds. Incremental updates are validated against a full build once. */
+  void measure_relations_update(const bool incremental,
+                                double *r_add_time,
+                                double *r_remove_time)
+  {
+    const int iterations = FLAGS_relations_benchmark_iterations;
+    Object *object = BKE_object_add_only_object(bmain, OB_EMPTY, "Added");
+    ID *ids[] = {&object->id};
+    double add_total = 0.0, remove_total = 0.0;
+    for (int i = 0; i < iterations; i++) {
+      BKE_collection_object_add(bmain, collection, object);
+      double start = PIL_check_seconds_timer();
+      if (incremental) {
+        EXPECT_TRUE(DEG_graph_relations_add_ids(depsgraph, bmain, ids, 1));
+      }
+      else {
+        DEG_graph_tag_relations_update(depsgraph);
+        DEG_graph_relations_update(depsgraph, bmain, scene, view_layer);
+      }
+      add_total += PIL_check_seconds_timer() - start;
+      if (incremental && i == 0) {
+        EXPECT_TRUE(relations_match_full_build());
+      }
+      BKE_scene_graph_update_tagged(depsgraph, bmain);
+      EXPECT_NE(DEG_get_evaluated_object(depsgraph, object), object);
+
+      BKE_collection_object_remove(bmain, collection, object, false);
+      start = PIL_check_seconds_timer();
+      if (incremental) {
+        EXPECT_TRUE(DEG_graph_relations_remove_ids(depsgraph, bmain, ids, 1));
+      }
+      else {
+        DEG_graph_tag_relations_update(depsgraph);
+        DEG_graph_relations_update(depsgraph, bmain, scene, view_layer);
+      }
+      remove_total += PIL_check_seconds_timer() - start;
+      if (incremental && i == 0) {
+        EXPECT_TRUE(relations_match_full_build());
+      }
+      BKE_scene_graph_update_tagged(depsgraph, bmain);
+    }
+    *r_add_time = add_total * 1000.0 / iterations;
+    *r_remove_time = remove_total * 1000.0 / iterations;
+  }
+};
+
+TEST_F(DepsgraphUpdatePerformanceTest, TaggedUpdate)
+{
+  const int sizes[] = {1000, 10000, 50000};
+  const int tagged[] = {0, 1, 10, 100};
+
+  for (const int size : sizes) {
+    const double start = PIL_check_seconds_timer();
+    scene_create(size);
+    const double build_time = PIL_check_seconds_timer() - start;
+
+    printf("%d objects, scene and graph built in %.3f ms\n", size, build_time * 1000.0);
+    for (const int num_tagged : tagged) {
+      printf("  update of %3d objects: %8.4f ms\n", num_tagged, measure_update(num_tagged));
+    }
+
+    /* The tagged objects are evaluated. */
+    Object *object_eval = DEG_get_evaluated_object(depsgraph, objects[0]);
+    EXPECT_EQ(object_eval->obmat[3][2], objects[0]->loc[2]);
+
+    scene_free();
+  }
+}
+
+TEST_F(DepsgraphUpdatePerformanceTest, RelationsUpdate)
+{
+  const int sizes[] = {1000, 10000, 50000};
+
+  for (const int size : sizes) {
+    scene_create(size);
+    printf("%d objects\n", size);
+    double add_time, remove_time;
+    measure_relations_update(false, &add_time, &remove_time);
+    printf("  full rebuild:       add %8.4f ms, remove %8.4f ms\n", add_time, remove_time);
+    measure_relations_update(true, &add_time, &remove_time);
+    printf("  incremental update: add %8.4f ms, remove %8.4f ms\n", add_time, remove_time);
+    scene_free();
+  }
+}
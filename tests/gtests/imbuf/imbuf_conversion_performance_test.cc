@@ -0,0 +1,255 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <functional>
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_math_color.h"
+#include "BLI_rand.h"
+#include "BLI_threads.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "PIL_time.h"
+}
+
+DEFINE_int32(conversion_benchmark_iterations,
+             10,
+             "Number of conversions measured per image size by the imbuf conversion benchmark.");
+
+static const int conversion_sizes[] = {512, 2048, 4096};
+
+/* Source pixels of one image size, shared by the reference per pixel conversion and the
+ * buffer conversions it is compared to. */
+class ImbufConversionPerformanceTest : public testing::Test {
+ protected:
+  int size = 0;
+  size_t num_pixels = 0;
+  /* Premultiplied, with values outside of the 0..1 range and fully transparent pixels. */
+  float *float_pixels = nullptr;
+  unsigned char *byte_pixels = nullptr;
+
+ public:
+  /* Threaded conversions use the task scheduler, the color spaces come from IMB_init. */
+  static void SetUpTestCase()
+  {
+    testing::Test::SetUpTestCase();
+
+    BLI_threadapi_init();
+    IMB_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    IMB_exit();
+    BLI_threadapi_exit();
+
+    testing::Test::TearDownTestCase();
+  }
+
+ protected:
+  void TearDown() override
+  {
+    pixels_free();
+
+    testing::Test::TearDown();
+  }
+
+  void pixels_generate(const int image_size)
+  {
+    pixels_free();
+
+    size = image_size;
+    num_pixels = (size_t)size * size;
+    float_pixels = (float *)MEM_mallocN(sizeof(float) * 4 * num_pixels, __func__);
+    byte_pixels = (unsigned char *)MEM_mallocN(4 * num_pixels, __func__);
+
+    RNG *rng = BLI_rng_new(0);
+    for (size_t i = 0; i < num_pixels; i++) {
+      float *pixel = float_pixels + i * 4;
+      pixel[3] = (i % 7 == 0) ? 0.0f : BLI_rng_get_float(rng);
+      pixel[0] = (BLI_rng_get_float(rng) * 1.2f - 0.1f) * pixel[3];
+      pixel[1] = (BLI_rng_get_float(rng) * 1.2f - 0.1f) * pixel[3];
+      pixel[2] = (BLI_rng_get_float(rng) * 1.2f - 0.1f) * pixel[3];
+    }
+    for (size_t i = 0; i < 4 * num_pixels; i++) {
+      byte_pixels[i] = (unsigned char)(BLI_rng_get_uint(rng) & 0xff);
+    }
+    BLI_rng_free(rng);
+  }
+
+  void pixels_free()
+  {
+    MEM_SAFE_FREE(float_pixels);
+    MEM_SAFE_FREE(byte_pixels);
+  }
+
+  /* Average duration of a conversion of the whole image, in milliseconds. */
+  double conversion_time(const std::function<void()> &convert) const
+  {
+    const int iterations = FLAGS_conversion_benchmark_iterations;
+    const double start = PIL_check_seconds_timer();
+    for (int i = 0; i < iterations; i++) {
+      convert();
+    }
+    return (PIL_check_seconds_timer() - start) * 1000.0 / iterations;
+  }
+};
+
+TEST_F(ImbufConversionPerformanceTest, ByteFromFloat)
+{
+  for (const int image_size : conversion_sizes) {
+    pixels_generate(image_size);
+    unsigned char *to_ref = (unsigned char *)MEM_mallocN(num_pixels * 4, __func__);
+    unsigned char *to = (unsigned char *)MEM_mallocN(num_pixels * 4, __func__);
+
+    printf("%dx%d pixels, float to byte with predivide\n", size, size);
+
+    /* Per pixel conversion, as done before the SIMD kernels. */
+    const double ref_time = conversion_time([&]() {
+      float straight[4];
+      for (size_t i = 0; i < num_pixels; i++) {
+        premul_to_straight_v4_v4(straight, float_pixels + i * 4);
+        rgba_float_to_uchar(to_ref + i * 4, straight);
+      }
+    });
+    const double serial_time = conversion_time([&]() {
+      IMB_buffer_byte_from_float(to,
+                                 float_pixels,
+                                 4,
+                                 0.0f,
+                                 IB_PROFILE_SRGB,
+                                 IB_PROFILE_SRGB,
+                                 true,
+                                 size,
+                                 size,
+                                 size,
+                                 size);
+    });
+    EXPECT_EQ(memcmp(to, to_ref, num_pixels * 4), 0);
+
+    memset(to, 0, num_pixels * 4);
+    const double threaded_time = conversion_time([&]() {
+      IMB_buffer_byte_from_float_threaded(to,
+                                          float_pixels,
+                                          4,
+                                          0.0f,
+                                          IB_PROFILE_SRGB,
+                                          IB_PROFILE_SRGB,
+                                          true,
+                                          size,
+                                          size,
+                                          size,
+                                          size);
+    });
+    EXPECT_EQ(memcmp(to, to_ref, num_pixels * 4), 0);
+
+    printf("  per pixel: %8.3f ms, serial: %8.3f ms, threaded: %8.3f ms\n",
+           ref_time,
+           serial_time,
+           threaded_time);
+
+    MEM_freeN(to_ref);
+    MEM_freeN(to);
+  }
+}
+
+TEST_F(ImbufConversionPerformanceTest, FloatFromByte)
+{
+  for (const int image_size : conversion_sizes) {
+    pixels_generate(image_size);
+    float *to_ref = (float *)MEM_mallocN(sizeof(float) * num_pixels * 4, __func__);
+    float *to = (float *)MEM_mallocN(sizeof(float) * num_pixels * 4, __func__);
+
+    printf("%dx%d pixels, byte to float\n", size, size);
+
+    const double ref_time = conversion_time([&]() {
+      for (size_t i = 0; i < num_pixels; i++) {
+        rgba_uchar_to_float(to_ref + i * 4, byte_pixels + i * 4);
+      }
+    });
+    const double serial_time = conversion_time([&]() {
+      IMB_buffer_float_from_byte(
+          to, byte_pixels, IB_PROFILE_SRGB, IB_PROFILE_SRGB, false, size, size, size, size);
+    });
+    EXPECT_EQ(memcmp(to, to_ref, sizeof(float) * num_pixels * 4), 0);
+
+    memset(to, 0, sizeof(float) * num_pixels * 4);
+    const double threaded_time = conversion_time([&]() {
+      IMB_buffer_float_from_byte_threaded(
+          to, byte_pixels, IB_PROFILE_SRGB, IB_PROFILE_SRGB, false, size, size, size, size);
+    });
+    EXPECT_EQ(memcmp(to, to_ref, sizeof(float) * num_pixels * 4), 0);
+
+    const double linear_time = conversion_time([&]() {
+      IMB_buffer_float_from_byte_threaded(
+          to, byte_pixels, IB_PROFILE_LINEAR_RGB, IB_PROFILE_SRGB, true, size, size, size, size);
+    });
+
+    printf("  per pixel: %8.3f ms, serial: %8.3f ms, threaded: %8.3f ms\n",
+           ref_time,
+           serial_time,
+           threaded_time);
+    printf("  threaded sRGB to linear: %8.3f ms\n", linear_time);
+
+    MEM_freeN(to_ref);
+    MEM_freeN(to);
+  }
+}
+
+TEST_F(ImbufConversionPerformanceTest, ImBufConversion)
+{
+  for (const int image_size : conversion_sizes) {
+    pixels_generate(image_size);
+
+    /* The image buffer takes ownership of the float pixels. */
+    ImBuf *ibuf = IMB_allocImBuf(size, size, 32, 0);
+    ibuf->rect_float = float_pixels;
+    ibuf->mall |= IB_rectfloat;
+    ibuf->flags |= IB_rectfloat;
+    ibuf->channels = 4;
+    float_pixels = nullptr;
+
+    printf("%dx%d pixels\n", size, size);
+
+    const double rect_time = conversion_time([&]() { IMB_rect_from_float(ibuf); });
+    printf("  rect from float: %8.3f ms\n", rect_time);
+
+    const double mipmap_time = conversion_time([&]() { IMB_makemipmap(ibuf, false); });
+    printf("  byte and float mipmaps: %8.3f ms\n", mipmap_time);
+    EXPECT_GT(ibuf->miptot, 1);
+
+    /* Mipmaps levels are the average of the four pixels above them. */
+    ImBuf *mip = ibuf->mipmap[0];
+    for (int c = 0; c < 4; c++) {
+      const float *p = ibuf->rect_float;
+      const float expected = 0.25f * (p[c] + p[size * 4 + c] + p[4 + c] + p[size * 4 + 4 + c]);
+      EXPECT_FLOAT_EQ(mip->rect_float[c], expected);
+    }
+
+    imb_freerectImBuf(ibuf);
+    const double float_mipmap_time = conversion_time([&]() { IMB_makemipmap(ibuf, false); });
+    printf("  float mipmaps: %8.3f ms\n", float_mipmap_time);
+
+    IMB_freeImBuf(ibuf);
+  }
+}
@@ -0,0 +1,199 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_rand.h"
+#include "BLI_threads.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "PIL_time.h"
+}
+
+DEFINE_int32(resample_benchmark_iterations,
+             5,
+             "Number of scalings measured by the imbuf resampling benchmark.");
+
+static bool scale_bilinear(ImBuf *ibuf, unsigned int newx, unsigned int newy)
+{
+  IMB_scaleImBuf_threaded(ibuf, newx, newy);
+  return true;
+}
+
+static bool scale_triangle(ImBuf *ibuf, unsigned int newx, unsigned int newy)
+{
+  return IMB_resampleImBuf(ibuf, newx, newy, IMB_RESAMPLE_TRIANGLE);
+}
+
+static bool scale_lanczos3(ImBuf *ibuf, unsigned int newx, unsigned int newy)
+{
+  return IMB_resampleImBuf(ibuf, newx, newy, IMB_RESAMPLE_LANCZOS3);
+}
+
+/* Scaling functions compared by the benchmark, `IMB_scaleImBuf` picks a box filter when
+ * shrinking and a triangle filter when enlarging. */
+static const struct {
+  const char *name;
+  bool (*scale)(ImBuf *ibuf, unsigned int newx, unsigned int newy);
+} scalers[] = {
+    {"nearest", IMB_scalefastImBuf},
+    {"bilinear", scale_bilinear},
+    {"area/linear", IMB_scaleImBuf},
+    {"triangle", scale_triangle},
+    {"lanczos3", scale_lanczos3},
+};
+
+class ImbufResamplePerformanceTest : public testing::Test {
+ public:
+  /* Threaded scaling uses the task scheduler, image buffers need color management. */
+  static void SetUpTestCase()
+  {
+    testing::Test::SetUpTestCase();
+
+    BLI_threadapi_init();
+    IMB_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    IMB_exit();
+    BLI_threadapi_exit();
+
+    testing::Test::TearDownTestCase();
+  }
+
+ protected:
+  /* Square image of random pixels, stored as bytes when `channels` is zero. */
+  static ImBuf *random_ibuf(const int size, const int channels)
+  {
+    RNG *rng = BLI_rng_new(0);
+    ImBuf *ibuf;
+    if (channels == 0) {
+      ibuf = IMB_allocImBuf(size, size, 32, IB_rect);
+      unsigned char *pixels = (unsigned char *)ibuf->rect;
+      for (size_t i = 0; i < (size_t)size * size * 4; i++) {
+        pixels[i] = (unsigned char)(BLI_rng_get_uint(rng) & 0xff);
+      }
+    }
+    else {
+      ibuf = IMB_allocImBuf(size, size, 32, 0);
+      const size_t num_values = (size_t)size * size * channels;
+      ibuf->rect_float = (float *)MEM_mallocN(sizeof(float) * num_values, __func__);
+      ibuf->mall |= IB_rectfloat;
+      ibuf->flags |= IB_rectfloat;
+      ibuf->channels = channels;
+      for (size_t i = 0; i < num_values; i++) {
+        ibuf->rect_float[i] = BLI_rng_get_float(rng);
+      }
+    }
+    BLI_rng_free(rng);
+    return ibuf;
+  }
+};
+
+TEST_F(ImbufResamplePerformanceTest, Resample)
+{
+  const int sizes[] = {512, 2048, 4096};
+  const struct {
+    int channels;
+    const char *name;
+  } formats[] = {{0, "byte"}, {4, "float RGBA"}, {1, "float single channel"}};
+
+  for (const int size : sizes) {
+    for (const auto &format : formats) {
+      ImBuf *ibuf = random_ibuf(size, format.channels);
+      const int new_sizes[][2] = {
+          {size / 2, size / 2}, {size / 3, size / 5}, {size * 3 / 2, size * 3 / 2}};
+
+      printf("%dx%d pixels, %s\n", size, size, format.name);
+      for (const int *new_size : new_sizes) {
+        printf("  to %dx%d:", new_size[0], new_size[1]);
+
+        /* Every iteration scales its own copy, copying is not measured. */
+        for (const auto &scaler : scalers) {
+          double total = 0.0;
+          for (int iteration = 0; iteration < FLAGS_resample_benchmark_iterations; iteration++) {
+            ImBuf *copy = IMB_dupImBuf(ibuf);
+            const double start = PIL_check_seconds_timer();
+            scaler.scale(copy, new_size[0], new_size[1]);
+            total += PIL_check_seconds_timer() - start;
+            IMB_freeImBuf(copy);
+          }
+          printf(" %s %.3f ms", scaler.name, total * 1000.0 / FLAGS_resample_benchmark_iterations);
+        }
+        printf("\n");
+      }
+
+      IMB_freeImBuf(ibuf);
+    }
+  }
+}
+
+TEST_F(ImbufResamplePerformanceTest, BoxAverage)
+{
+  const int size = 256;
+  ImBuf *ibuf = random_ibuf(size, 4);
+  ImBuf *scaled = IMB_dupImBuf(ibuf);
+
+  /* Halving with a box filter is the average of 2x2 pixels. */
+  EXPECT_TRUE(IMB_scaleImBuf(scaled, size / 2, size / 2));
+  EXPECT_EQ(scaled->x, size / 2);
+  EXPECT_EQ(scaled->y, size / 2);
+  for (int y = 0; y < size / 2; y++) {
+    for (int x = 0; x < size / 2; x++) {
+      for (int c = 0; c < 4; c++) {
+        const float *src = ibuf->rect_float + ((size_t)(y * 2) * size + x * 2) * 4 + c;
+        const float average = (src[0] + src[4] + src[size * 4] + src[size * 4 + 4]) * 0.25f;
+        EXPECT_NEAR(scaled->rect_float[((size_t)y * (size / 2) + x) * 4 + c], average, 1e-5f);
+      }
+    }
+  }
+
+  IMB_freeImBuf(scaled);
+  IMB_freeImBuf(ibuf);
+}
+
+TEST_F(ImbufResamplePerformanceTest, ConstantImage)
+{
+  const IMB_ResampleFilter filters[] = {
+      IMB_RESAMPLE_BOX, IMB_RESAMPLE_TRIANGLE, IMB_RESAMPLE_LANCZOS3};
+  const int new_sizes[][2] = {{37, 91}, {300, 150}, {511, 1}};
+
+  for (const IMB_ResampleFilter filter : filters) {
+    for (const int *new_size : new_sizes) {
+      ImBuf *ibuf = IMB_allocImBuf(200, 120, 32, IB_rect | IB_rectfloat);
+      const size_t num_pixels = (size_t)ibuf->x * ibuf->y;
+      for (size_t i = 0; i < num_pixels * 4; i++) {
+        ((unsigned char *)ibuf->rect)[i] = 200;
+        ibuf->rect_float[i] = 0.75f;
+      }
+
+      /* Weights are normalized, Lanczos ringing doesn't appear on flat areas. */
+      EXPECT_TRUE(IMB_resampleImBuf(ibuf, new_size[0], new_size[1], filter));
+      for (size_t i = 0; i < (size_t)new_size[0] * new_size[1] * 4; i++) {
+        EXPECT_EQ(((unsigned char *)ibuf->rect)[i], 200);
+        EXPECT_NEAR(ibuf->rect_float[i], 0.75f, 1e-5f);
+      }
+      IMB_freeImBuf(ibuf);
+    }
+  }
+}